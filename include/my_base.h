@@ -206,7 +206,9 @@ enum ha_extra_function {
   */
   HA_EXTRA_EXPORT,
   /** Do secondary sort by handler::ref (rowid) after key sort. */
-  HA_EXTRA_SECONDARY_SORT_ROWID
+  HA_EXTRA_SECONDARY_SORT_ROWID,
+  /** Number of values the next NEXTVAL of a sequence takes. */
+  HA_EXTRA_SEQUENCE_BATCH
 };
 
 /* Compatible option, to be deleted in 6.0 */
@@ -289,6 +289,239 @@ exit0:
 };
 
 
+/**
+  Hashes of the primary and unique key values a transaction changed.
+
+  They are logged in the Gtid_log_event of the transaction so that a
+  slave running with slave_pr_mode=WRITESET can apply transactions
+  that do not change the same rows in parallel. The Gtid_log_event is
+  the first event of the cache and is written before the rows are
+  known, so MYSQL_BIN_LOG::write_cache() writes it again with the
+  hashes in place of the one in the cache.
+
+  A transaction changing a row the hashes cannot identify, a table
+  with foreign keys, or more than binlog_writeset_size keys, gets no
+  writeset and is applied in isolation by the slave.
+*/
+class binlog_writeset
+{
+public:
+  binlog_writeset()
+    : m_hashes(NULL), m_alloced(0), m_capacity(0), m_count(0), m_valid(false)
+  { }
+
+  ~binlog_writeset()
+  {
+    my_free(m_hashes);
+  }
+
+  /**
+    Starts collecting the writeset of a transaction.
+
+    @param capacity  maximum number of hashes
+  */
+  void begin(uint capacity)
+  {
+    m_count= 0;
+    m_capacity= 0;
+    m_valid= false;
+    if (capacity > m_alloced)
+    {
+      ulonglong *hashes= (ulonglong *) my_realloc(m_hashes,
+                                                  capacity * sizeof(ulonglong),
+                                                  MYF(MY_ALLOW_ZERO_PTR));
+      if (!hashes)
+        return;
+      m_hashes= hashes;
+      m_alloced= capacity;
+    }
+    m_capacity= capacity;
+    m_valid= capacity > 0;
+  }
+
+  void reset()
+  {
+    m_count= 0;
+    m_capacity= 0;
+    m_valid= false;
+  }
+
+  /** The writeset is still collected */
+  bool is_valid() const { return m_valid; }
+
+  void invalidate() { m_valid= false; }
+
+  void check_table(THD *thd, TABLE *table);
+  void add_row(TABLE *table, const uchar *record,
+               const MY_BITMAP *read_cols, const MY_BITMAP *changed_cols,
+               bool after_image);
+
+  const ulonglong *hashes() const { return m_hashes; }
+  uint count() const { return m_valid ? m_count : 0; }
+
+private:
+  void add_hash(ulonglong hash);
+
+  ulonglong *m_hashes;
+  uint m_alloced;
+  uint m_capacity;
+  uint m_count;
+  bool m_valid;
+};
+
+
+static inline ulonglong writeset_mix(ulonglong hash, ulonglong value)
+{
+  hash^= value + ULL(0x9e3779b97f4a7c15) + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+
+static ulonglong writeset_hash_str(ulonglong hash, const char *str,
+                                   size_t length)
+{
+  /* FNV-1a, including a terminating zero to separate the names */
+  for (size_t i= 0; i < length; i++)
+    hash= (hash ^ (uchar) str[i]) * ULL(0x100000001b3);
+  return hash * ULL(0x100000001b3);
+}
+
+
+/**
+  Invalidates the writeset if the rows of the table can not be
+  identified by their key values, or changing them may change rows
+  of other tables through foreign keys.
+*/
+void binlog_writeset::check_table(THD *thd, TABLE *table)
+{
+  if (!m_valid)
+    return;
+
+  bool has_unique= false;
+  for (uint i= 0; i < table->s->keys && !has_unique; i++)
+    has_unique= (table->key_info[i].flags & HA_NOSAME);
+
+  if (!has_unique || table->file->referenced_by_foreign_key())
+  {
+    invalidate();
+    return;
+  }
+
+  List<FOREIGN_KEY_INFO> f_key_list;
+  if (table->file->get_foreign_key_list(thd, &f_key_list) ||
+      !f_key_list.is_empty())
+    invalidate();
+}
+
+
+void binlog_writeset::add_hash(ulonglong hash)
+{
+  for (uint i= 0; i < m_count; i++)
+  {
+    if (m_hashes[i] == hash)
+      return;
+  }
+  if (m_count == m_capacity)
+  {
+    invalidate();
+    return;
+  }
+  m_hashes[m_count++]= hash;
+}
+
+
+/**
+  Adds a hash of every unique key value of the row.
+
+  @param table        the table of the row
+  @param record       the row
+  @param read_cols    the columns read into the record, NULL if all are
+  @param changed_cols the columns the statement changes, NULL if it
+                      inserts or deletes the row
+  @param after_image  the record is the after image of an update
+
+  A changed key value that is not known, or a row without any known
+  non-NULL unique key value, invalidates the writeset.
+*/
+void binlog_writeset::add_row(TABLE *table, const uchar *record,
+                              const MY_BITMAP *read_cols,
+                              const MY_BITMAP *changed_cols,
+                              bool after_image)
+{
+  if (!m_valid)
+    return;
+
+  my_ptrdiff_t const offset= record - table->record[0];
+  ulonglong table_hash= ULL(0xcbf29ce484222325);
+  bool identified= false;
+
+  table_hash= writeset_hash_str(table_hash, table->s->db.str,
+                                table->s->db.length);
+  table_hash= writeset_hash_str(table_hash, table->s->table_name.str,
+                                table->s->table_name.length);
+
+  for (uint i= 0; i < table->s->keys; i++)
+  {
+    KEY *key= table->key_info + i;
+    bool known= true, changed= !changed_cols, has_null= false;
+
+    if (!(key->flags & HA_NOSAME))
+      continue;
+
+    for (uint j= 0; j < key->user_defined_key_parts; j++)
+    {
+      uint index= key->key_part[j].field->field_index;
+      bool is_changed= changed_cols && bitmap_is_set(changed_cols, index);
+
+      changed|= is_changed;
+      if (read_cols && !bitmap_is_set(read_cols, index) &&
+          !(after_image && is_changed))
+        known= false;
+      /* Different values may have an equal prefix */
+      if (key->key_part[j].key_part_flag & HA_PART_KEY_SEG)
+        known= false;
+    }
+
+    if (!known)
+    {
+      if (changed)
+      {
+        invalidate();
+        return;
+      }
+      continue;
+    }
+
+    ulonglong hash= writeset_hash_str(table_hash, key->name,
+                                      strlen(key->name));
+    for (uint j= 0; j < key->user_defined_key_parts && !has_null; j++)
+    {
+      Field *field= key->key_part[j].field;
+      ulong nr1= 1, nr2= 4;
+
+      if (field->is_null(offset))
+      {
+        has_null= true;
+        break;
+      }
+      field->move_field_offset(offset);
+      field->hash(&nr1, &nr2);
+      field->move_field_offset(-offset);
+      hash= writeset_mix(writeset_mix(hash, nr1), nr2);
+    }
+
+    if (!has_null)
+    {
+      add_hash(hash);
+      identified= true;
+    }
+  }
+
+  if (!identified)
+    invalidate();
+}
+
+
 /**
   Caches for non-transactional and transactional data before writing
   it to the binary log.
@@ -459,6 +692,12 @@ public:
   */
   Group_cache group_cache;
 
+  /**
+    The writeset logged in the Gtid_log_event of the transaction, only
+    collected in the trx-cache.
+  */
+  binlog_writeset writeset;
+
 protected:
   /*
     It truncates the cache to a certain position. This includes deleting the
@@ -469,6 +708,9 @@ protected:
     DBUG_PRINT("info", ("truncating to position %lu", (ulong) pos));
     remove_pending_event();
     reinit_io_cache(&cache_log, WRITE_CACHE, pos, 0, 0);
+    /* The Gtid_log_event of the writeset is removed */
+    if (pos == 0)
+      writeset.reset();
     cache_log.end_of_file= saved_max_binlog_cache_size;
   }
 
@@ -962,6 +1204,8 @@ int binlog_cache_data::write_event(THD *thd, Log_event *ev)
     else if (status == Group_cache::APPEND_NEW_GROUP)
     {
       Gtid_log_event gtid_ev(thd, is_trx_cache());
+      if (is_trx_cache())
+        writeset.begin(opt_binlog_writeset_size);
       if (gtid_ev.write(&cache_log) != 0)
         DBUG_RETURN(1);
     }
@@ -1075,10 +1319,14 @@ static int write_empty_groups_to_cache(THD *thd, binlog_cache_data *cache_data)
 
 /**
 
+  @param flushing  true when called by the flush stage, which gives
+                   the transaction its logical clock
+
   @todo Move this function into the cache class?
  */
 static int
-gtid_before_write_cache(THD* thd, binlog_cache_data* cache_data)
+gtid_before_write_cache(THD* thd, binlog_cache_data* cache_data,
+                        bool flushing)
 {
   DBUG_ENTER("gtid_before_write_cache");
   int error= 0;
@@ -1110,16 +1358,25 @@ gtid_before_write_cache(THD* thd, binlog_cache_data* cache_data)
   global_sid_lock->unlock();
 
   /*
-    If an automatic group number was generated, change the first event
-    into a "real" one.
+    Change the first event into a "real" one if an automatic group
+    number was generated, and fill in the logical clock. An event with
+    a writeset is longer, MYSQL_BIN_LOG::write_cache() writes it in
+    place of this one.
   */
-  if (thd->variables.gtid_next.type == AUTOMATIC_GROUP)
+  if (group_cache->get_n_groups() == 1 &&
+      !(flushing && cache_data->writeset.count() > 0))
   {
-    DBUG_ASSERT(group_cache->get_n_groups() == 1);
     Cached_group *cached_group= group_cache->get_unsafe_pointer(0);
     DBUG_ASSERT(cached_group->spec.type != AUTOMATIC_GROUP);
     Gtid_log_event gtid_ev(thd, cache_data->is_trx_cache(),
                            &cached_group->spec);
+    if (flushing)
+    {
+      ulonglong last_committed, sequence_number;
+      mysql_bin_log.get_logical_clock(thd, &last_committed,
+                                      &sequence_number);
+      gtid_ev.set_logical_clock(last_committed, sequence_number);
+    }
     bool using_file= cache_data->cache_log.pos_in_file > 0;
     my_off_t saved_position= cache_data->reset_write_pos(0, using_file);
     error= gtid_ev.write(&cache_data->cache_log);
@@ -1161,7 +1418,7 @@ int gtid_empty_group_log_and_cleanup(THD *thd)
   cache_data= &thd_get_cache_mngr(thd)->trx_cache;
   DBUG_PRINT("debug", ("Writing to trx_cache"));
   if (cache_data->write_event(thd, &qinfo) ||
-      gtid_before_write_cache(thd, cache_data))
+      gtid_before_write_cache(thd, cache_data, false))
     goto err;
 
   ret= mysql_bin_log.commit(thd, true);
@@ -1246,7 +1503,7 @@ binlog_cache_data::flush(THD *thd, my_off_t *bytes_written, bool *wrote_xid)
       transactions might trigger attempts to write to the binary log
       if the cache is not reset.
      */
-    if (!(error= gtid_before_write_cache(thd, this)))
+    if (!(error= gtid_before_write_cache(thd, this, true)))
       error= mysql_bin_log.write_cache(thd, this);
     else
       thd->commit_error= THD::CE_FLUSH_ERROR;
@@ -2544,6 +2801,8 @@ MYSQL_BIN_LOG::MYSQL_BIN_LOG(uint *sync_period)
    relay_log_checksum_alg(BINLOG_CHECKSUM_ALG_UNDEF),
    previous_gtid_set(0)
 {
+  m_sequence_number= m_commit_group_parent= 0;
+  m_max_committed= 0;
   /*
     We don't want to initialize locks here as such initialization depends on
     safe_mutex (when using safe_mutex) which depends on MY_INIT(), which is
@@ -5708,7 +5967,8 @@ uint MYSQL_BIN_LOG::next_file_id()
   SYNOPSIS
     do_write_cache()
     cache    Cache to write to the binary log
-    lock_log True if the LOCK_log mutex should be aquired, false otherwise
+    skip     Length of the events at the start of the cache that are
+             not written, the caller wrote other events in place of them
 
   DESCRIPTION
     Write the contents of the cache to the binary log. The cache will
@@ -5719,7 +5979,7 @@ uint MYSQL_BIN_LOG::next_file_id()
     events prior to fill in the binlog cache.
 */
 
-int MYSQL_BIN_LOG::do_write_cache(IO_CACHE *cache)
+int MYSQL_BIN_LOG::do_write_cache(IO_CACHE *cache, my_off_t skip)
 {
   DBUG_ENTER("MYSQL_BIN_LOG::do_write_cache(IO_CACHE *)");
 
@@ -5733,7 +5993,7 @@ int MYSQL_BIN_LOG::do_write_cache(IO_CACHE *cache)
                     DBUG_RETURN(ER_ERROR_ON_WRITE);
                   });
 
-  if (reinit_io_cache(cache, READ_CACHE, 0, 0, 0))
+  if (reinit_io_cache(cache, READ_CACHE, skip, 0, 0))
     DBUG_RETURN(ER_ERROR_ON_WRITE);
   uint length= my_b_bytes_in_cache(cache), group, carry, hdr_offs;
   ulong remains= 0; // part of unprocessed yet netto length of the event
@@ -5762,7 +6022,8 @@ int MYSQL_BIN_LOG::do_write_cache(IO_CACHE *cache)
     split.
   */
 
-  group= (uint)my_b_tell(&log_file);
+  /* end_log_pos of the events is relative to the start of the cache */
+  group= (uint)(my_b_tell(&log_file) - skip);
   DBUG_PRINT("debug", ("length: %llu, group: %llu",
                        (ulonglong) length, (ulonglong) group));
   hdr_offs= carry= 0;
@@ -6071,9 +6332,32 @@ bool MYSQL_BIN_LOG::write_cache(THD *thd, binlog_cache_data *cache_data)
      */
     if (my_b_tell(cache) > 0)
     {
+      /*
+        The Gtid_log_event at the start of the cache has no writeset:
+        the event with the writeset is written instead of it.
+      */
+      my_off_t skip= 0;
+      if (cache_data->writeset.count() > 0)
+      {
+        DBUG_ASSERT(cache_data->group_cache.get_n_groups() == 1);
+        Cached_group *cached_group=
+          cache_data->group_cache.get_unsafe_pointer(0);
+        Gtid_log_event gtid_ev(thd, true, &cached_group->spec);
+        ulonglong last_committed, sequence_number;
+
+        skip= LOG_EVENT_HEADER_LEN + gtid_ev.get_data_size();
+        get_logical_clock(thd, &last_committed, &sequence_number);
+        gtid_ev.set_logical_clock(last_committed, sequence_number);
+        gtid_ev.set_writeset(cache_data->writeset.hashes(),
+                             cache_data->writeset.count());
+        gtid_ev.checksum_alg= (uint8) binlog_checksum_options;
+        if (gtid_ev.write(&log_file))
+          goto err;
+      }
+
       DBUG_EXECUTE_IF("crash_before_writing_xid",
                       {
-                        if ((write_error= do_write_cache(cache)))
+                        if ((write_error= do_write_cache(cache, skip)))
                           DBUG_PRINT("info", ("error writing binlog cache: %d",
                                                write_error));
                         flush_and_sync(true);
@@ -6081,7 +6365,7 @@ bool MYSQL_BIN_LOG::write_cache(THD *thd, binlog_cache_data *cache_data)
                         DBUG_SUICIDE();
                       });
 
-      if ((write_error= do_write_cache(cache)))
+      if ((write_error= do_write_cache(cache, skip)))
         goto err;
 
       if (incident && write_incident(thd, false/*need_lock_log=false*/,
@@ -6733,6 +7017,12 @@ MYSQL_BIN_LOG::process_flush_stage_queue(my_off_t *total_bytes_var,
   THD *first_seen= stage_manager.fetch_queue_for(Stage_manager::FLUSH_STAGE);
   DBUG_ASSERT(first_seen != NULL);
 
+  /*
+    The transactions of the queue are all prepared, none of them waits
+    for another: they depend on the transactions committed so far only.
+  */
+  m_commit_group_parent= (ulonglong) my_atomic_load64(&m_max_committed);
+
   /* Do an explicit transaction log group write before flushing binary log
    * cache to file*/
   if (!first_seen->prepared_engine->is_empty())
@@ -6768,6 +7058,42 @@ MYSQL_BIN_LOG::process_flush_stage_queue(my_off_t *total_bytes_var,
 }
 
 
+/**
+  Gives the logical clock of a Gtid event the flush stage writes.
+
+  @param thd              the session whose cache is flushed
+  @param last_committed   set to the sequence_number of the last
+                          transaction committed before the flush stage
+  @param sequence_number  set to the number of the transaction
+*/
+void MYSQL_BIN_LOG::get_logical_clock(THD *thd, ulonglong *last_committed,
+                                      ulonglong *sequence_number)
+{
+  mysql_mutex_assert_owner(&LOCK_log);
+  *last_committed= m_commit_group_parent;
+  *sequence_number= ++m_sequence_number;
+  thd->binlog_sequence_number= *sequence_number;
+}
+
+
+/**
+  Marks the transactions of a queue as committed in the logical clock.
+
+  This is done before they commit in the engines: they still hold their
+  locks, so no transaction flushed later can conflict with them.
+
+  @param queue  the sessions leaving the sync stage
+*/
+void MYSQL_BIN_LOG::update_max_committed(THD *queue)
+{
+  ulonglong max_committed= (ulonglong) my_atomic_load64(&m_max_committed);
+
+  for (THD *head= queue; head; head= head->next_to_commit)
+    set_if_bigger(max_committed, head->binlog_sequence_number);
+  my_atomic_store64(&m_max_committed, (int64) max_committed);
+}
+
+
 /**
   Commit a sequence of sessions.
 
@@ -7265,6 +7591,7 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit)
   thd->stage_leader= false;
   thd->stage_cond_id= UNDEF_COND_SLOT;
   thd->prev_to_commit= NULL;
+  thd->binlog_sequence_number= 0;
   DBUG_ASSERT(!thd_get_cache_mngr(thd)->all_finalized() ||
               (thd->variables.gtid_next.type == AUTOMATIC_GROUP));
   thd->gtid_precommit= (gtid_mode &&
@@ -7436,6 +7763,8 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit)
     need to unlock it if we skip the stage.
    */
 commit_stage:
+  update_max_committed(final_queue);
+
   /*
     We are delaying the handling of sync error until
     all locks are released but we should not enter into
@@ -8013,6 +8342,8 @@ int THD::binlog_write_table_map(TABLE *table, bool is_transactional,
   if ((error= cache_data->write_event(this, &the_event)))
     DBUG_RETURN(error);
 
+  cache_data->writeset.check_table(this, table);
+
   binlog_table_maps++;
   DBUG_RETURN(0);
 }
@@ -9245,6 +9576,10 @@ int THD::binlog_write_row(TABLE* table, bool is_trans,
   if (unlikely(ev == 0))
     return HA_ERR_OUT_OF_MEM;
 
+  if (is_trans)
+    thd_get_cache_mngr(this)->trx_cache.writeset.add_row(table, record,
+                                                         NULL, NULL, false);
+
   return ev->add_row_data(row_data, len);
 }
 
@@ -9263,6 +9598,15 @@ int THD::binlog_update_row(TABLE* table, bool is_trans,
   MY_BITMAP *old_read_set= table->read_set;
   MY_BITMAP *old_write_set= table->write_set;
 
+  if (is_trans)
+  {
+    binlog_writeset *writeset= &thd_get_cache_mngr(this)->trx_cache.writeset;
+    writeset->add_row(table, before_record, old_read_set, old_write_set,
+                      false);
+    writeset->add_row(table, after_record, old_read_set, old_write_set,
+                      true);
+  }
+
   /** 
      This will remove spurious fields required during execution but
      not needed for binlogging. This is done according to the:
@@ -9329,6 +9673,11 @@ int THD::binlog_delete_row(TABLE* table, bool is_trans,
   MY_BITMAP *old_read_set= table->read_set;
   MY_BITMAP *old_write_set= table->write_set;
 
+  if (is_trans)
+    thd_get_cache_mngr(this)->trx_cache.writeset.add_row(table, record,
+                                                         old_read_set, NULL,
+                                                         false);
+
   /** 
      This will remove spurious fields required during execution but
      not needed for binlogging. This is done according to the:
@@ -452,6 +452,19 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   Stage_manager stage_manager;
   void do_flush(THD *thd);
 
+  /*
+    Logical clock of the transactions, see slave_pr_mode=LOGICAL_CLOCK.
+    m_sequence_number numbers the transactions as they are flushed, under
+    LOCK_log. m_max_committed is the highest sequence_number of the
+    transactions that reached the commit stage, and m_commit_group_parent
+    its value when the current flush stage started: it is the
+    last_committed of every transaction of the commit group.
+  */
+  ulonglong m_sequence_number;
+  ulonglong m_commit_group_parent;
+  volatile int64 m_max_committed;
+  void update_max_committed(THD *queue);
+
 public:
   using MYSQL_LOG::generate_name;
   using MYSQL_LOG::is_open;
@@ -615,6 +628,8 @@ public:
 #if !defined(MYSQL_CLIENT)
 
   void update_thd_next_event_pos(THD *thd);
+  void get_logical_clock(THD *thd, ulonglong *last_committed,
+                         ulonglong *sequence_number);
   int flush_and_set_pending_rows_event(THD *thd, Rows_log_event* event,
                                        bool is_transactional);
 
@@ -707,7 +722,7 @@ public:
 
   bool write_event(Log_event* event_info);
   bool write_cache(THD *thd, class binlog_cache_data *binlog_cache_data);
-  int  do_write_cache(IO_CACHE *cache);
+  int  do_write_cache(IO_CACHE *cache, my_off_t skip= 0);
 
   void set_write_error(THD *thd, bool is_transactional);
   bool check_write_error(THD *thd);
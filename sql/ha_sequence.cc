@@ -176,83 +176,217 @@ void Sequence_share::init(const char *name)
   uint length= (uint)strlen(name);
   table_name= my_strndup(name, length, MYF(MY_FAE | MY_ZEROFILL));
 
-  cache_valid= false;
+  /* Generation 0 is not loaded, the first read will reload the cache */
+  segments[0].gen= SEQ_SEGMENT_EMPTY;
+  segments[1].gen= SEQ_SEGMENT_EMPTY;
+  cache_pos= 0;
 
   seq_initialized= true;
   DBUG_VOID_RETURN;
 }
 /*
-  Change the sequence share cache valid state.
+  Invalid the sequence share caches, both the current and the next
+  segment will be reloaded from the based table.
 */
-void Sequence_share::set_valid(bool valid)
+void Sequence_share::invalidate()
 {
-  DBUG_ENTER("Sequence_share::set_valid");
+  ulonglong gen;
+  DBUG_ENTER("Sequence_share::invalidate");
   mysql_mutex_assert_owner(&seq_mutex);
-  cache_valid= valid;
+
+  gen= ((ulonglong) my_atomic_load64(&cache_pos)) >> SEQ_POS_INDEX_BITS;
+  my_atomic_store64(&segments[0].gen, SEQ_SEGMENT_EMPTY);
+  my_atomic_store64(&segments[1].gen, SEQ_SEGMENT_EMPTY);
+  my_atomic_store64(&cache_pos,
+                    (int64) (((gen + 1) & SEQ_POS_GEN_MASK)
+                             << SEQ_POS_INDEX_BITS));
   DBUG_VOID_RETURN;
 }
 /*
-  Quick read sequence value from cache.
+  Forget the next segment after a prefetch failed to write it back to the
+  based table, the current segment stays in use.
+*/
+void Sequence_share::discard_next_segment()
+{
+  ulonglong gen;
+  DBUG_ENTER("Sequence_share::discard_next_segment");
+  mysql_mutex_assert_owner(&seq_mutex);
+
+  my_atomic_store64(&next_segment(&gen)->gen, SEQ_SEGMENT_EMPTY);
+  DBUG_VOID_RETURN;
+}
+/*
+  The segment following the current one.
+
+  SYNOPSIS
+    next_gen    generation of the next segment
+*/
+Sequence_segment *Sequence_share::next_segment(ulonglong *next_gen)
+{
+  ulonglong gen;
+
+  gen= ((ulonglong) my_atomic_load64(&cache_pos)) >> SEQ_POS_INDEX_BITS;
+  *next_gen= (gen + 1) & SEQ_POS_GEN_MASK;
+  return &segments[*next_gen & 1];
+}
+/*
+  Read the values index .. index + batch - 1 of a segment, nextval is
+  the first one and currval the last one.
 
   SYNOPSIS
-    table       opened TABLE
+    segment     the segment
+    gen         generation the value was taken from
+    index       index of the first value in the segment
+    batch       number of values
+    prefetch    set if the next segment should be loaded now
+
+  RETURN VALUES
+    CACHE_INVALID       the segment is not of generation gen.
+    CACHE_ROUND_OUT     not enough values left in the segment.
+    CACHE_HIT           cache hit
+*/
+enum enum_cache_state
+Sequence_share::fill_value(Sequence_segment *segment, ulonglong gen,
+                           ulonglong index, ulonglong batch,
+                           ulonglong *local_values, bool *prefetch)
+{
+  ulonglong count;
+  ulonglong value;
+
+  if ((ulonglong) my_atomic_load64(&segment->gen) != gen)
+    return CACHE_INVALID;
+
+  count= segment->count;
+  if (index >= count || batch > count - index)
+    return CACHE_ROUND_OUT;
+
+  memcpy(local_values, segment->caches, sizeof(segment->caches));
+
+  /* The segment was reloaded while we read it */
+  if ((ulonglong) my_atomic_load64(&segment->gen) != gen)
+    return CACHE_INVALID;
+
+  value= local_values[FIELD_NUM_NEXTVAL] +
+         index * local_values[FIELD_NUM_INCREMENT];
+  local_values[FIELD_NUM_CURRVAL]= value +
+         (batch - 1) * local_values[FIELD_NUM_INCREMENT];
+  local_values[FIELD_NUM_NEXTVAL]= value;
+
+  /* Half of the segment is used up, only one caller takes this index */
+  *prefetch= (index <= count / 2 && count / 2 - index < batch);
+  return CACHE_HIT;
+}
+/*
+  Quick read sequence value from cache, without seq_mutex.
+
+  SYNOPSIS
+    local_values    the values returned
+    batch           number of values to take
+    prefetch        set if the next segment should be loaded now
 
   RETURN VALUES
     CACHE_INVALID       cache invalid, need reload from based table.
     CACHE_ROUND_OUT     cache run out, need reload next batch.
     CACHE_HIT           cache hit
 */
-enum enum_cache_state Sequence_share::quick_read(TABLE *table, ulonglong *local_values)
+enum enum_cache_state Sequence_share::quick_read(ulonglong *local_values,
+                                                 ulonglong batch,
+                                                 bool *prefetch)
 {
-  ulonglong *nextval_ptr;
-  ulonglong *currval_ptr;
-  ulonglong *increment_ptr;
-  bool last_round;
+  ulonglong pos;
+  ulonglong gen;
   DBUG_ENTER("Sequence_share::quick_read");
 
+  /*
+    Claim the next indexes of the current segment. If they don't fit,
+    the values left in the segment are skipped.
+  */
+  pos= (ulonglong) my_atomic_add64(&cache_pos, (int64) batch);
+  gen= pos >> SEQ_POS_INDEX_BITS;
+
+  DBUG_RETURN(fill_value(&segments[gen & 1], gen,
+                         pos & SEQ_POS_INDEX_MASK, batch,
+                         local_values, prefetch));
+}
+/*
+  Make the next segment the current one, and read its first values.
+  Only called when the current segment ran out or is invalid.
+
+  RETURN VALUES
+    CACHE_INVALID       the next segment is not loaded.
+    CACHE_ROUND_OUT     the next segment has less than batch values,
+                        it is left as it is.
+    CACHE_HIT           cache hit
+*/
+enum enum_cache_state Sequence_share::switch_segment(ulonglong *local_values,
+                                                     ulonglong batch,
+                                                     bool *prefetch)
+{
+  Sequence_segment *segment;
+  ulonglong gen;
+  DBUG_ENTER("Sequence_share::switch_segment");
   mysql_mutex_assert_owner(&seq_mutex);
-  nextval_ptr= &caches[FIELD_NUM_NEXTVAL];
-  currval_ptr= &caches[FIELD_NUM_CURRVAL];
-  increment_ptr= &caches[FIELD_NUM_INCREMENT];
 
-  if (!cache_valid)
+  segment= next_segment(&gen);
+  if ((ulonglong) my_atomic_load64(&segment->gen) != gen)
     DBUG_RETURN(CACHE_INVALID);
 
-  /* If cache_end roll upon maxvalue, then it is last round */
-  last_round = (caches[FIELD_NUM_MAXVALUE] == cache_end);
-
-  if (!last_round && ulonglong(*nextval_ptr) >= cache_end)
-  {
+  if (segment->count < batch)
     DBUG_RETURN(CACHE_ROUND_OUT);
-  }
-  else if (last_round)
-  {
-    if (*nextval_ptr > cache_end)
-      DBUG_RETURN(CACHE_ROUND_OUT);
-  }
 
-  /* Retrieve values from cache directly */
-  {
-    DBUG_ASSERT(*nextval_ptr <= cache_end);
-    *currval_ptr= *nextval_ptr;
-    memcpy(local_values, caches, sizeof(caches));
+  /*
+    All values of the current segment are taken, so no value is lost by
+    overwriting the adds done on it meanwhile. The first values are ours.
+  */
+  my_atomic_store64(&cache_pos,
+                    (int64) ((gen << SEQ_POS_INDEX_BITS) | batch));
 
-    if ((cache_end - *nextval_ptr) >= *increment_ptr)
-      *nextval_ptr+= *increment_ptr;
-    else
-    {
-      *nextval_ptr= cache_end;
-      cache_valid= false;
-    }
+  DBUG_RETURN(fill_value(segment, gen, 0, batch, local_values, prefetch));
+}
+/*
+  Whether the next segment has to be loaded from the based table.
+
+  SYNOPSIS
+    prefetch    the current segment is still in use
+    batch       number of values the next segment must have, a loaded
+                segment ending at maxvalue is kept unless the sequence
+                cycles
+*/
+bool Sequence_share::need_reload(bool prefetch, ulonglong batch)
+{
+  Sequence_segment *segment;
+  ulonglong gen;
+  DBUG_ENTER("Sequence_share::need_reload");
+  mysql_mutex_assert_owner(&seq_mutex);
+
+  segment= next_segment(&gen);
+  if ((ulonglong) my_atomic_load64(&segment->gen) == gen &&
+      (segment->count >= batch ||
+       (segment->last_round && segment->caches[FIELD_NUM_CYCLE] == 0)))
+    DBUG_RETURN(false);
+
+  if (prefetch)
+  {
+    /*
+      Never load ahead of a segment ending at maxvalue, the based table
+      would start a new round, or report the run out, too early.
+    */
+    Sequence_segment *current= &segments[(gen - 1) & 1];
+    if ((ulonglong) my_atomic_load64(&current->gen) !=
+        ((gen - 1) & SEQ_POS_GEN_MASK) ||
+        current->last_round)
+      DBUG_RETURN(false);
   }
-  DBUG_RETURN(CACHE_HIT);
+  DBUG_RETURN(true);
 }
 /*
-  Sequence reload the cache from the table if cache has run out.
+  Sequence load the next segment of the cache from the table.
 
   SYNOPSIS
     table       TABLE object
     state       sequence cache state
+    batch       the segment has at least so many values unless it
+                ends at maxvalue
     changed     whether sequence values changed
 
   RETURN VALUES
@@ -261,12 +395,18 @@ enum enum_cache_state Sequence_share::quick_read(TABLE *table, ulonglong *local_
 */
 int Sequence_share::reload_cache(TABLE *table,
                                   enum enum_cache_state state,
+                                  ulonglong batch,
                                   bool *changed)
 {
   ST_SEQ_FIELD_INFO *field_info;
   Field **field;
   ulonglong durable[FIELD_NUM_END];
   enum enum_sequence_field field_num;
+  Sequence_segment *segment;
+  ulonglong gen;
+  ulonglong *caches;
+  ulonglong cache_end;
+  ulonglong size;
   DBUG_ENTER("Sequence_share::reload_cache");
 
   DBUG_ASSERT(state == CACHE_INVALID || state == CACHE_ROUND_OUT);
@@ -285,6 +425,14 @@ int Sequence_share::reload_cache(TABLE *table,
   if (check_sequence_values_valid(durable))
     DBUG_RETURN(HA_ERR_SEQUENCE_INVALID);
 
+  /*
+    The next segment is only used after switch_segment(), which needs
+    seq_mutex, so it is not read while being written here.
+  */
+  segment= next_segment(&gen);
+  my_atomic_store64(&segment->gen, SEQ_SEGMENT_EMPTY);
+  caches= segment->caches;
+
   /* Calculate the next round cache values */
   ulonglong begin;
 
@@ -310,12 +458,24 @@ int Sequence_share::reload_cache(TABLE *table,
   {
     DBUG_RETURN(HA_ERR_SEQUENCE_INVALID);
   }
+
+  /* A batch never spans two rounds, skip the values left of this one */
+  if (caches[FIELD_NUM_CYCLE] > 0 &&
+      (caches[FIELD_NUM_MAXVALUE] - begin) / caches[FIELD_NUM_INCREMENT]
+      < batch - 1)
+  {
+    begin= caches[FIELD_NUM_MINVALUE];
+    durable[FIELD_NUM_ROUND]++;
+  }
   /* step 3: calc the left counter to cache */
   longlong left = (caches[FIELD_NUM_MAXVALUE] - begin)
                   / caches[FIELD_NUM_INCREMENT] - 1;
 
+  /* a NEXTVAL(seq, n) may need a larger segment than the cache size */
+  size= MY_MAX(caches[FIELD_NUM_CACHE] + 1, batch);
+
   /* the left counter is less than cache size */
-  if (left < 0 || ((ulonglong)left) <= caches[FIELD_NUM_CACHE])
+  if (left < 0 || ((ulonglong)left) < size)
   {
     /* if cycle, start again; else will report error! */
     cache_end= caches[FIELD_NUM_MAXVALUE];
@@ -326,13 +486,19 @@ int Sequence_share::reload_cache(TABLE *table,
     }
     else
       durable[FIELD_NUM_NEXTVAL]= caches[FIELD_NUM_MAXVALUE];
+
+    /* the last round hands out maxvalue too */
+    segment->count= (cache_end - begin) / caches[FIELD_NUM_INCREMENT] + 1;
+    segment->last_round= true;
   }
   else
   {
-    cache_end= begin + (caches[FIELD_NUM_CACHE] + 1) *
-                        caches[FIELD_NUM_INCREMENT];
+    cache_end= begin + size * caches[FIELD_NUM_INCREMENT];
     durable[FIELD_NUM_NEXTVAL]= cache_end;
     DBUG_ASSERT(cache_end < caches[FIELD_NUM_MAXVALUE]);
+
+    segment->count= size;
+    segment->last_round= false;
   }
   caches[FIELD_NUM_NEXTVAL]= begin;
 
@@ -347,6 +513,9 @@ int Sequence_share::reload_cache(TABLE *table,
   }
   *changed = compare_records(table);
 
+  /* step 5: publish the segment, the caller invalids it on failure */
+  my_atomic_store64(&segment->gen, (int64) gen);
+
 #ifndef DBUG_OFF
   fprintf(stderr, "Sequence will write values: "
                         "currval %llu "
@@ -427,6 +596,7 @@ void ha_sequence::init_variables()
   bitmap_set_all(&m_write_set);
 
   start_of_scan= 0;
+  m_batch= 1;
   DBUG_VOID_RETURN;
 }
 /*
@@ -529,6 +699,20 @@ int ha_sequence::info(uint flag)
   DBUG_ENTER("ha_sequence::info");
   DBUG_RETURN(false);
 }
+/*
+  HA_EXTRA_SEQUENCE_BATCH: the next NEXTVAL takes cache_size values.
+*/
+int ha_sequence::extra_opt(enum ha_extra_function operation, ulong cache_size)
+{
+  DBUG_ENTER("ha_sequence::extra_opt");
+  if (operation == HA_EXTRA_SEQUENCE_BATCH)
+  {
+    DBUG_ASSERT(cache_size >= 1 && cache_size <= SEQUENCE_MAX_BATCH);
+    m_batch= cache_size;
+    DBUG_RETURN(0);
+  }
+  DBUG_RETURN(handler::extra_opt(operation, cache_size));
+}
 const char *ha_sequence::table_type() const
 {
   DBUG_ENTER("ha_sequence::table_type");
@@ -618,7 +802,7 @@ int ha_sequence::write_row(uchar *buf)
 
   /* Binlog will decided by m_file engine. so disable here */
   tmp_disable_binlog(thd);
-  share->set_valid(false);
+  share->invalidate();
 
   error= m_file->ha_write_row(buf);
 
@@ -645,7 +829,7 @@ int ha_sequence::update_row(const uchar *old_data, uchar *new_data)
 
   /* Binlog will decided by m_file engine. so disable here */
   tmp_disable_binlog(thd);
-  share->set_valid(false);
+  share->invalidate();
   error= m_file->ha_update_row(old_data, new_data);
   reenable_binlog(thd);
 
@@ -666,7 +850,7 @@ int ha_sequence::delete_row(const uchar *buf)
 
   /* Binlog will decided by m_file engine. so disable here */
   tmp_disable_binlog(thd);
-  share->set_valid(false);
+  share->invalidate();
   error= m_file->ha_delete_row(buf);
   reenable_binlog(thd);
 
@@ -718,6 +902,13 @@ int ha_sequence::rnd_init(bool scan)
 
     4.Transaction
       a. begine autonomous transaction when updating base table.
+
+    5.Cache
+      a. take the value from the cache segment by an atomic add, the
+         seq_mutex is only held to load a segment;
+      b. load the next segment in advance if sequence_cache_prefetch;
+      c. NEXTVAL(seq, n) takes m_batch values at once, they never
+         span two segments or rounds.
 */
 int ha_sequence::rnd_next(uchar *buf)
 {
@@ -725,6 +916,8 @@ int ha_sequence::rnd_next(uchar *buf)
   enum enum_cache_state state;
   THD *thd;
   ulonglong local_values[FIELD_NUM_END];
+  bool prefetch= false;
+  bool reloaded= false;
   DBUG_ENTER("ha_sequence::rnd_next");
   error= 0;
   thd= ha_thd();
@@ -767,65 +960,77 @@ int ha_sequence::rnd_next(uchar *buf)
 
     DBUG_ASSERT(m_it_type == IT_NEXTVAL);
 
-    lock_share();
-
     /* Step 1: quick read from cache */
-    state= share->quick_read(table, local_values);
-    switch (state)
+    state= share->quick_read(local_values, m_batch, &prefetch);
+    if (state != CACHE_HIT)
     {
-      /* If hit, query back quickly */
-      case CACHE_HIT:
-        goto end;
-      case CACHE_ERROR:
+      lock_share();
+
+      /* Step 2: another session may have moved to the next segment */
+      state= share->quick_read(local_values, m_batch, &prefetch);
+      if (state != CACHE_HIT)
+      {
+        /* Step 3: cache reload unless the next segment is prefetched */
+        if (share->need_reload(false, m_batch))
+        {
+          if ((error= update_and_reload(buf, state, m_batch)))
+            goto err;
+          reloaded= true;
+        }
+
+        /*
+          Step 4: Read from the next segment. It may have less than
+          m_batch values if they are the last ones before maxvalue.
+        */
+        state= share->switch_segment(local_values, m_batch, &prefetch);
+        if (state == CACHE_ROUND_OUT)
+          goto run_out;
+
+        if (state != CACHE_HIT)
         {
-          /* Unlikely error.*/
           error= HA_ERR_SEQUENCE_ACCESS_ERROR;
           goto err;
         }
-      case CACHE_INVALID:
-      case CACHE_ROUND_OUT:
-        {
-          /* Step 2: cache reload */
-          if ((error= update_and_reload(buf, state)))
-            goto err;
+      }
+      unlock_share();
+    }
 
-          /* Step 3: Read from cache data again */
-          share->set_valid(true);
-          state= share->quick_read(table, local_values);
-          switch (state)
-          {
-            case CACHE_HIT:
-              { goto end; }
-            case CACHE_ROUND_OUT:
-              {
-                error= HA_ERR_SEQUENCE_RUN_OUT;
-                goto err;
-              }
-            default:
-              {
-                error= HA_ERR_SEQUENCE_ACCESS_ERROR;
-                goto err;
-              }
-          }/* step 3  switch end */
-        }
-    }/* step 1 switch end */
+    /*
+      Step 5: load the next segment while half of the current one is
+      left, so that the sessions using it up don't wait for the based
+      table. Skipped if another session is loading it, or if the based
+      table was read by this scan already. This is best-effort: if it
+      fails, the next segment is loaded when the current one runs out,
+      and the values taken above are still returned.
+    */
+    if (prefetch && !reloaded && opt_sequence_cache_prefetch &&
+        try_lock_share())
+    {
+      if (share->need_reload(true, m_batch) &&
+          update_and_reload(buf, CACHE_ROUND_OUT, m_batch))
+        share->discard_next_segment();
+      unlock_share();
+    }
   }
   else
     DBUG_RETURN(HA_ERR_END_OF_FILE);
 
-err:
-  share->set_valid(false);
-  unlock_share();
-  DBUG_RETURN(error);
-
-end:
-  unlock_share();
   /* Fill the sequence data into table->fields and session context */
   if (fill_sequence_fields(thd, table,
                            local_values))
     error= HA_ERR_SEQUENCE_ACCESS_ERROR;
 
   DBUG_RETURN(error);
+
+err:
+  share->invalidate();
+  unlock_share();
+  DBUG_RETURN(error);
+
+run_out:
+  /* The segment is left for NEXTVAL of less values */
+  unlock_share();
+  DBUG_RETURN(HA_ERR_SEQUENCE_RUN_OUT);
 }
 
 /*
@@ -961,7 +1166,8 @@ bool ha_sequence::fill_sequence_fields_from_thd(THD *thd, TABLE *table)
     !=0         Failure
 */
 int ha_sequence::update_and_reload(uchar *buf,
-                                   enum enum_cache_state state)
+                                   enum enum_cache_state state,
+                                   ulonglong batch)
 {
   int error= 0;
   bool changed;
@@ -989,7 +1195,7 @@ int ha_sequence::update_and_reload(uchar *buf,
     goto err_trans;
 
   /* Step 3: flush cache and ready data */
-  if ((error= share->reload_cache(table, state, &changed)))
+  if ((error= share->reload_cache(table, state, batch, &changed)))
     goto err_trans;
 
   /* Step 4: write back new data */
@@ -1110,6 +1316,7 @@ int ha_sequence::rnd_end()
   DBUG_ASSERT(m_file);
   DBUG_ASSERT(share);
   DBUG_ASSERT(table_share && table);
+  m_batch= 1;
   DBUG_RETURN(m_file->ha_rnd_end());
 }
 void ha_sequence::unbind_psi()
@@ -28,21 +28,55 @@ enum enum_cache_state
   CACHE_HIT,
   CACHE_ERROR
 };
+
 /*
-  The sequence caches will be stored here,
-  allowed to be accessed simultaneously that protected by seq_mutex.
+  Sequence_share::cache_pos is the generation of the current segment in
+  the high bits and the index of the next value to hand out in the low
+  bits, so that a single atomic add claims a value of a given segment.
 */
-class Sequence_share
+#define SEQ_POS_INDEX_BITS 40
+#define SEQ_POS_INDEX_MASK ((ULL(1) << SEQ_POS_INDEX_BITS) - 1)
+#define SEQ_POS_GEN_MASK ((ULL(1) << (64 - SEQ_POS_INDEX_BITS)) - 1)
+#define SEQ_SEGMENT_EMPTY (-1)
+
+/*
+  A range of cached values: caches[FIELD_NUM_NEXTVAL] +
+  i * caches[FIELD_NUM_INCREMENT] for i < count.
+  Written under seq_mutex with gen set to SEQ_SEGMENT_EMPTY, and read
+  without it, readers check that gen did not change while they read.
+*/
+struct Sequence_segment
 {
+  volatile int64 gen;
   ulonglong caches[FIELD_NUM_END];
-  ulonglong cache_end;
+  ulonglong count;
+  /* The segment ends at maxvalue */
+  bool last_round;
+};
+
+/*
+  The sequence caches will be stored here.
+  Values are taken from the current segment without seq_mutex, which
+  only serializes loading the segments from the based table. The next
+  segment may be loaded while the current one is still in use, so that
+  running out of the current one does not wait for the based table.
+*/
+class Sequence_share
+{
+  /* segments[gen & 1] holds the segment of generation gen */
+  Sequence_segment segments[2];
+  volatile int64 cache_pos;
+
+  Sequence_segment *next_segment(ulonglong *next_gen);
+  enum enum_cache_state fill_value(Sequence_segment *segment, ulonglong gen,
+                                   ulonglong index, ulonglong batch,
+                                   ulonglong *local_values, bool *prefetch);
 public:
   bool seq_initialized;
   /* In order to invalid the THD sequence when sequence is dropped or altered */
   ulonglong sequence_version;
   mysql_mutex_t seq_mutex;
 
-  bool cache_valid;
   uint ref_count;
 
   /* db_name + table_name */
@@ -65,11 +99,17 @@ public:
   };
 
   void init(const char *table_name);
-  enum enum_cache_state quick_read(TABLE *table, ulonglong *local_values);
+  enum enum_cache_state quick_read(ulonglong *local_values, ulonglong batch,
+                                   bool *prefetch);
+  enum enum_cache_state switch_segment(ulonglong *local_values,
+                                       ulonglong batch, bool *prefetch);
+  bool need_reload(bool prefetch, ulonglong batch);
   int reload_cache(TABLE *table,
                    enum enum_cache_state state,
+                   ulonglong batch,
                    bool *changed);
-  void set_valid(bool valid);
+  void invalidate();
+  void discard_next_segment();
 };
 
 /*
@@ -87,6 +127,9 @@ public:
          to update InnoDB table, and get the new values.
 
       3. Invalid the caches if any update on based table.
+
+      4. NEXTVAL(seq, n) takes n successive values of one segment, a
+         segment of at least n values is loaded if needed.
 */
 class ha_sequence :public handler
 {
@@ -102,6 +145,9 @@ private:
   /* Sequence iteration type */
   enum enum_seq_iteration m_it_type;
 
+  /* Number of values the next NEXTVAL takes, see HA_EXTRA_SEQUENCE_BATCH */
+  ulonglong m_batch;
+
   /* All setted read/write set. */
   MY_BITMAP m_read_set;
   MY_BITMAP m_write_set;
@@ -129,6 +175,7 @@ public:
   virtual int rnd_pos(uchar *buf, uchar *pos);
   virtual void position(const uchar * record);
   virtual int info(uint);
+  virtual int extra_opt(enum ha_extra_function operation, ulong cache_size);
   virtual const char *table_type() const;
   virtual ulong index_flags(uint inx, uint part, bool all_parts) const;
   virtual THR_LOCK_DATA **store_lock(THD * thd, THR_LOCK_DATA ** to,
@@ -149,7 +196,8 @@ public:
   int delete_row(const uchar *buf);
   int external_lock(THD *thd, int lock_type);
   int update_and_reload(uchar *buf,
-                        enum enum_cache_state state);
+                        enum enum_cache_state state,
+                        ulonglong batch);
 
   int rename_table(const char* from, const char* to);
   void print_error(int error, myf errflag);
@@ -176,6 +224,13 @@ public:
     DBUG_VOID_RETURN;
   };
 
+  bool try_lock_share()
+  {
+    DBUG_ENTER("ha_sequence::try_lock_share");
+    DBUG_ASSERT(share && share->seq_initialized);
+    DBUG_RETURN(mysql_mutex_trylock(&share->seq_mutex) == 0);
+  };
+
   void unlock_share()
   {
     DBUG_ENTER("ha_sequence::unlock_share");
@@ -1413,37 +1413,7 @@ inline void trans_unregist_execute_item(THD *thd)
   ic_hash_item_t *item= thd->execute_item;
 
   pthread_mutex_unlock(&item->execute_lock);
-  pthread_mutex_lock(&item->queue_lock);
-
-  if (item->left_thread_num > 1)
-  {
-    item->left_thread_num--;
-    pthread_mutex_unlock(&item->queue_lock);
-  }
-  else
-  {
-    DBUG_ASSERT(item->left_thread_num == 1);
-    pthread_mutex_unlock(&item->queue_lock);
-
-    DEBUG_SYNC(thd, "after_unlock_queue_lock_in_unregist");
-
-    pthread_mutex_lock(&ic_gather_hash_lock);
-    pthread_mutex_lock(&item->queue_lock);
-
-    item->left_thread_num--;
-
-    if (item->left_thread_num == 0)
-    {
-      pthread_mutex_unlock(&item->queue_lock);
-      my_hash_delete(&ic_gather_hash, (uchar*)item);
-    }
-    else
-    {
-      pthread_mutex_unlock(&item->queue_lock);
-    }
-
-    pthread_mutex_unlock(&ic_gather_hash_lock);
-  }
+  ic_hash_item_release(thd, item);
 
   thd->execute_item= NULL;
 }
@@ -693,6 +693,7 @@ enum enum_schema_tables
   SCH_FILES,
   SCH_GLOBAL_STATUS,
   SCH_GLOBAL_VARIABLES,
+  SCH_IC_REDUCE_PARTITIONS,
   SCH_KEY_COLUMN_USAGE,
   SCH_OPEN_TABLES,
   SCH_OPTIMIZER_TRACE,
@@ -707,6 +708,7 @@ enum enum_schema_tables
   SCH_SCHEMA_PRIVILEGES,
   SCH_SESSION_STATUS,
   SCH_SESSION_VARIABLES,
+  SCH_SQL_CCL_INFO,
   SCH_SQL_FILTER_INFO,
   SCH_STATISTICS,
   SCH_STATUS,
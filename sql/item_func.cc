@@ -7196,17 +7196,31 @@ longlong Item_func_uuid_short::val_int()
 longlong Item_func_nextval::val_int()
 {
   ulonglong value;
+  ulonglong batch= 1;
   int error;
   TABLE *table= table_list->table;
   DBUG_ENTER("Item_func_nextval::val_int");
   DBUG_ASSERT(table->file);
 
+  if (arg_count > 0)
+  {
+    longlong n= args[0]->val_int();
+    if (args[0]->null_value || n < 1 || n > SEQUENCE_MAX_BATCH)
+    {
+      my_error(ER_WRONG_ARGUMENTS, MYF(0), "NEXTVAL");
+      goto err;
+    }
+    batch= (ulonglong) n;
+  }
+
   bitmap_set_bit(table->read_set, FIELD_NUM_NEXTVAL);
 
   if (table->file->ha_rnd_init(1))
     goto err;
   else
   {
+   if (batch > 1)
+     table->file->extra_opt(HA_EXTRA_SEQUENCE_BATCH, (ulong) batch);
    if ((error= table->file->ha_rnd_next(table->record[0])))
    {
       table->file->print_error(error, MYF(0));
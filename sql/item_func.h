@@ -2250,6 +2250,9 @@ protected:
 public:
   Item_func_nextval(THD *thd, TABLE_LIST *table):
     Item_int_func(), m_thd(thd), table_list(table) {}
+  /* NEXTVAL(seq, n): take n values, return the first one */
+  Item_func_nextval(THD *thd, TABLE_LIST *table, Item *batch):
+    Item_int_func(batch), m_thd(thd), table_list(table) {}
 
   longlong val_int();
   const char *func_name() const { return "nextval"; }
@@ -2638,12 +2638,23 @@ bool Log_event::contains_partition_info(bool end_group_sets_max_dbs,
                                         Relay_log_info *rli)
 {
   bool res;
-  bool table_mode = (rli->pr_mode == SLAVE_PR_MODE_TABLE);
+  bool table_mode = (rli->pr_mode == SLAVE_PR_MODE_TABLE ||
+                     rli->pr_mode == SLAVE_PR_MODE_WRITESET ||
+                     rli->pr_mode == SLAVE_PR_MODE_LOGICAL_CLOCK);
 
   switch (get_type_code()) {
   case TABLE_MAP_EVENT:
+    res= true;
+
+    break;
+
   case EXECUTE_LOAD_QUERY_EVENT:
     res= true;
+    /* The group has no Table_map event, it is executed in isolation */
+    if (rli->pr_mode == SLAVE_PR_MODE_WRITESET ||
+        rli->pr_mode == SLAVE_PR_MODE_LOGICAL_CLOCK)
+      static_cast<Query_log_event*>(this)->mts_accessed_dbs=
+        OVER_MAX_DBS_IN_EVENT_MTS;
 
     break;
     
@@ -2657,8 +2668,8 @@ bool Log_event::contains_partition_info(bool end_group_sets_max_dbs,
     else if (table_mode && (!starts_group() && !ends_group()))
     {
       /*
-        In table mode MTS replication, all query event is executed
-        serially by worker 0.
+        In table, writeset and logical clock mode MTS replication, all
+        query event is executed serially by worker 0.
       */
       res= true;
       static_cast<Query_log_event*>(this)->mts_accessed_dbs=
@@ -2825,7 +2836,53 @@ Slave_worker *Log_event::get_slave_worker(Relay_log_info *rli)
     // partioning info is found which drops the flag
     rli->mts_end_group_sets_max_dbs= false;
     ret_worker= rli->last_assigned_worker;
-    if (mts_dbs.num == OVER_MAX_DBS_IN_EVENT_MTS)
+
+    /*
+      In writeset mode the group is distributed by the hashes of the keys
+      it changed, logged in its Gtid-event. In logical clock mode it goes
+      to any Worker once the groups it depends on, according to the
+      logical clock of its Gtid-event, have been applied. The group is
+      mapped at its first Table_map event, a later one maps to the same
+      Worker. A group without a writeset or a logical clock is executed
+      in isolation.
+    */
+    Gtid_log_event *gtid_ev= NULL;
+    bool group_mapped= false;
+    if ((rli->pr_mode == SLAVE_PR_MODE_WRITESET ||
+         rli->pr_mode == SLAVE_PR_MODE_LOGICAL_CLOCK) &&
+        mts_dbs.num != OVER_MAX_DBS_IN_EVENT_MTS)
+    {
+      DBUG_ASSERT(get_type_code() == TABLE_MAP_EVENT);
+      if (rli->curr_group_assigned_parts.elements > 0)
+        group_mapped= !rli->curr_group_isolated;
+      else if (rli->curr_group_seen_gtid)
+      {
+        gtid_ev= *(Gtid_log_event **)
+          dynamic_array_ptr(&rli->curr_group_da, 0);
+        DBUG_ASSERT(is_gtid_event(gtid_ev));
+        if (rli->pr_mode == SLAVE_PR_MODE_WRITESET)
+          group_mapped= gtid_ev->get_writeset_count() > 0;
+        else
+          group_mapped= mts_wait_for_commit_parent(rli, gtid_ev);
+      }
+      if (!group_mapped)
+        mts_dbs.num= OVER_MAX_DBS_IN_EVENT_MTS;
+    }
+
+    if (group_mapped)
+    {
+      if (!(ret_worker= map_group_to_worker(gtid_ev, rli,
+                                            &mts_assigned_partitions[0],
+                                            ret_worker)))
+      {
+        llstr(rli->get_event_relay_log_pos(), llbuff);
+        my_error(ER_MTS_CANT_PARALLEL, MYF(0),
+                 get_type_str(), rli->get_event_relay_log_name(), llbuff,
+                 "could not distribute the event to a Worker");
+        return ret_worker;
+      }
+    }
+    else if (mts_dbs.num == OVER_MAX_DBS_IN_EVENT_MTS)
     {
       // Worker with id 0 to handle serial execution
       if (!ret_worker)
@@ -2839,7 +2896,8 @@ Slave_worker *Log_event::get_slave_worker(Relay_log_info *rli)
     }
 
     /* One run of the loop in the case of over-max-db:s */
-    for (i= 0; i < ((mts_dbs.num != OVER_MAX_DBS_IN_EVENT_MTS) ? mts_dbs.num : 1);
+    for (i= 0; !group_mapped &&
+           i < ((mts_dbs.num != OVER_MAX_DBS_IN_EVENT_MTS) ? mts_dbs.num : 1);
          i++)
     {
       /*
@@ -2898,7 +2956,8 @@ Slave_worker *Log_event::get_slave_worker(Relay_log_info *rli)
       DBUG_ASSERT(ptr_group->group_relay_log_name == NULL);
     }
 
-    DBUG_ASSERT(i == mts_dbs.num || mts_dbs.num == OVER_MAX_DBS_IN_EVENT_MTS);
+    DBUG_ASSERT(i == mts_dbs.num || mts_dbs.num == OVER_MAX_DBS_IN_EVENT_MTS ||
+                group_mapped);
   }
   else
   {
@@ -7433,6 +7492,15 @@ int Xid_log_event::do_apply_event_worker(Slave_worker *w)
   ulong gaq_idx= mts_group_idx;
   Slave_job_group *ptr_group= coordinator_gaq->get_job_group(gaq_idx);
 
+  if (w->wait_for_commit_order(ptr_group->total_seqno))
+  {
+    /* a deadlock is resolved by Slave_worker::retry_group() */
+    my_error(w->found_commit_order_deadlock() ?
+             ER_LOCK_DEADLOCK : ER_QUERY_INTERRUPTED, MYF(0));
+    error= 1;
+    goto err;
+  }
+
   if ((error= w->commit_positions(this, ptr_group,
                                   w->c_rli->is_transactional())))
     goto err;
@@ -11448,6 +11516,9 @@ int Rows_log_event::do_apply_event(Relay_log_info const *rli)
      */
     const_cast<Relay_log_info*>(rli)->set_row_stmt_start_timestamp();
 
+    /* the event is applied again when a Worker retries its group */
+    m_curr_row= m_rows_buf;
+    m_curr_row_end= NULL;
     const uchar *saved_m_curr_row= m_curr_row;
 
     int (Rows_log_event::*do_apply_row_ptr)(Relay_log_info const *)= NULL;
@@ -13601,9 +13672,60 @@ Gtid_log_event::Gtid_log_event(const char *buffer, uint event_len,
   spec.gtid.gno= uint8korr(ptr_buffer);
   ptr_buffer+= ENCODED_GNO_LENGTH;
 
+  has_logical_clock= false;
+  last_committed= sequence_number= 0;
+  writeset= NULL;
+  writeset_count= 0;
+  writeset_alloced= false;
+#if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
+  mts_group_parts= NULL;
+  mts_group_parts_count= 0;
+#endif
+
+  /* The logical clock, if any, follows the post header */
+  uint body_len= event_len - common_header_len - POST_HEADER_LENGTH;
+  if (body_len >= ENCODED_LOGICAL_CLOCK_LENGTH)
+  {
+    has_logical_clock= true;
+    last_committed= uint8korr(ptr_buffer);
+    sequence_number= uint8korr(ptr_buffer + 8);
+    ptr_buffer+= ENCODED_LOGICAL_CLOCK_LENGTH;
+    body_len-= ENCODED_LOGICAL_CLOCK_LENGTH;
+  }
+
+  /* The writeset, if any, follows the logical clock */
+  if (has_logical_clock && body_len >= ENCODED_WRITESET_COUNT_LENGTH)
+  {
+    uint count= uint2korr(ptr_buffer);
+    ptr_buffer+= ENCODED_WRITESET_COUNT_LENGTH;
+    if (count > 0 &&
+        count <= (body_len - ENCODED_WRITESET_COUNT_LENGTH) /
+                 ENCODED_WRITESET_HASH_LENGTH &&
+        (writeset= (ulonglong *) my_malloc(count * sizeof(ulonglong),
+                                           MYF(MY_WME))))
+    {
+      writeset_alloced= true;
+      writeset_count= count;
+      for (uint i= 0; i < count; i++)
+      {
+        writeset[i]= uint8korr(ptr_buffer);
+        ptr_buffer+= ENCODED_WRITESET_HASH_LENGTH;
+      }
+    }
+  }
+
   DBUG_VOID_RETURN;
 }
 
+Gtid_log_event::~Gtid_log_event()
+{
+  if (writeset_alloced)
+    my_free(writeset);
+#if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
+  my_free(mts_group_parts);
+#endif
+}
+
 #ifndef MYSQL_CLIENT
 Gtid_log_event::Gtid_log_event(THD* thd_arg, bool using_trans,
                                const Gtid_specification *spec_arg)
@@ -13611,7 +13733,12 @@ Gtid_log_event::Gtid_log_event(THD* thd_arg, bool using_trans,
             LOG_EVENT_IGNORABLE_F : 0,
             using_trans ? Log_event::EVENT_TRANSACTIONAL_CACHE :
             Log_event::EVENT_STMT_CACHE, Log_event::EVENT_NORMAL_LOGGING),
-  commit_flag(true)
+  commit_flag(true), has_logical_clock(true), last_committed(0),
+  sequence_number(0), writeset(NULL), writeset_count(0),
+  writeset_alloced(false)
+#ifdef HAVE_REPLICATION
+  , mts_group_parts(NULL), mts_group_parts_count(0)
+#endif
 {
   DBUG_ENTER("Gtid_log_event::Gtid_log_event(THD *)");
   spec= spec_arg ? *spec_arg : thd_arg->variables.gtid_next;
@@ -13663,7 +13790,13 @@ Gtid_log_event::print(FILE *file, PRINT_EVENT_INFO *print_event_info)
   if (!print_event_info->short_form)
   {
     print_header(head, print_event_info, FALSE);
-    my_b_printf(head, "\tGTID [commit=%s]\n", commit_flag ? "yes" : "no");
+    my_b_printf(head, "\tGTID [commit=%s]", commit_flag ? "yes" : "no");
+    if (has_logical_clock)
+      my_b_printf(head, " last_committed=%llu sequence_number=%llu",
+                  last_committed, sequence_number);
+    if (writeset_count)
+      my_b_printf(head, " [writeset=%u]", writeset_count);
+    my_b_printf(head, "\n");
   }
   to_string(buffer);
   my_b_printf(head, "%s%s\n", buffer, print_event_info->delimiter);
@@ -13696,6 +13829,44 @@ bool Gtid_log_event::write_data_header(IO_CACHE *file)
   DBUG_ASSERT(ptr_buffer == (buffer + sizeof(buffer)));
   DBUG_RETURN(wrapper_my_b_safe_write(file, (uchar *) buffer, sizeof(buffer)));
 }
+
+bool Gtid_log_event::write_data_body(IO_CACHE *file)
+{
+  DBUG_ENTER("Gtid_log_event::write_data_body");
+  uchar buffer[ENCODED_WRITESET_HASH_LENGTH * 64];
+  uint i= 0;
+
+  if (!has_logical_clock)
+    DBUG_RETURN(0);
+
+  DBUG_PRINT("info", ("last_committed=%llu sequence_number=%llu",
+                      last_committed, sequence_number));
+  int8store(buffer, last_committed);
+  int8store(buffer + 8, sequence_number);
+  if (wrapper_my_b_safe_write(file, buffer, ENCODED_LOGICAL_CLOCK_LENGTH))
+    DBUG_RETURN(1);
+
+  if (!writeset_count)
+    DBUG_RETURN(0);
+
+  DBUG_PRINT("info", ("writeset count=%u", writeset_count));
+  int2store(buffer, writeset_count);
+  if (wrapper_my_b_safe_write(file, buffer, ENCODED_WRITESET_COUNT_LENGTH))
+    DBUG_RETURN(1);
+
+  while (i < writeset_count)
+  {
+    uchar *ptr_buffer= buffer;
+    for (; i < writeset_count && ptr_buffer < buffer + sizeof(buffer); i++)
+    {
+      int8store(ptr_buffer, writeset[i]);
+      ptr_buffer+= ENCODED_WRITESET_HASH_LENGTH;
+    }
+    if (wrapper_my_b_safe_write(file, buffer, ptr_buffer - buffer))
+      DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
 #endif // MYSQL_SERVER
 
 #if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
@@ -13781,6 +13952,30 @@ int Gtid_log_event::do_update_pos(Relay_log_info *rli)
                   DBUG_SUICIDE(););
   return 0;
 }
+
+/**
+  Copies the partitions of the current group from CGAP.
+
+  @return true on out of memory, false otherwise
+*/
+bool Gtid_log_event::mts_set_group_parts(DYNAMIC_ARRAY *parts)
+{
+  DBUG_ASSERT(!mts_group_parts);
+  if (!(mts_group_parts= (db_worker_hash_entry **)
+        my_malloc(parts->elements * sizeof(db_worker_hash_entry *),
+                  MYF(MY_WME))))
+    return true;
+  memcpy(mts_group_parts, parts->buffer,
+         parts->elements * sizeof(db_worker_hash_entry *));
+  mts_group_parts_count= parts->elements;
+  return false;
+}
+
+void Gtid_log_event::mts_add_group_parts(DYNAMIC_ARRAY *exec_parts)
+{
+  for (uint i= 0; i < mts_group_parts_count; i++)
+    insert_dynamic(exec_parts, (uchar *) &mts_group_parts[i]);
+}
 #endif
 
 Previous_gtids_log_event::Previous_gtids_log_event(
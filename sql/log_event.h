@@ -4974,7 +4974,7 @@ public:
   Gtid_log_event(const char *buffer, uint event_len,
                  const Format_description_log_event *descr_event);
 
-  virtual ~Gtid_log_event() {}
+  virtual ~Gtid_log_event();
 
   Log_event_type get_type_code()
   {
@@ -4985,7 +4985,14 @@ public:
     DBUG_RETURN(ret);
   }
 
-  int get_data_size() { return POST_HEADER_LENGTH; }
+  int get_data_size()
+  {
+    return POST_HEADER_LENGTH +
+      (has_logical_clock ? ENCODED_LOGICAL_CLOCK_LENGTH : 0) +
+      (writeset_count ?
+       ENCODED_WRITESET_COUNT_LENGTH +
+       writeset_count * ENCODED_WRITESET_HASH_LENGTH : 0);
+  }
 
 private:
   /// Used internally by both print() and pack_info().
@@ -4997,13 +5004,68 @@ public:
 #endif
 #ifdef MYSQL_SERVER
   bool write_data_header(IO_CACHE *file);
+  bool write_data_body(IO_CACHE *file);
+
+  /**
+    Sets the writeset logged with the event.
+
+    @param hashes    the hashes of the keys the transaction changed
+    @param count     number of hashes, 0 if the transaction has no writeset
+  */
+  void set_writeset(const ulonglong *hashes, uint count)
+  {
+    DBUG_ASSERT(has_logical_clock || !count);
+    writeset= const_cast<ulonglong *>(hashes);
+    writeset_count= count;
+  }
+
+  /**
+    Sets the logical clock of the transaction, see slave_pr_mode=
+    LOGICAL_CLOCK.
+
+    @param last_committed_arg   sequence_number of the last transaction
+                                committed when the commit group of the
+                                transaction was flushed
+    @param sequence_number_arg  number of the transaction in the binlog
+  */
+  void set_logical_clock(ulonglong last_committed_arg,
+                         ulonglong sequence_number_arg)
+  {
+    DBUG_ASSERT(has_logical_clock);
+    last_committed= last_committed_arg;
+    sequence_number= sequence_number_arg;
+  }
 #endif
 
 #if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
   int do_apply_event(Relay_log_info const *rli);
   int do_update_pos(Relay_log_info *rli);
+
+  /**
+    Keeps the partitions the group was mapped to by the Coordinator in
+    WRITESET and LOGICAL_CLOCK modes, for the Worker to release them
+    when the group ends.
+  */
+  bool mts_set_group_parts(DYNAMIC_ARRAY *parts);
+  void mts_add_group_parts(DYNAMIC_ARRAY *exec_parts);
 #endif
 
+  /**
+    Return the sequence_number of the last transaction committed before
+    the commit group of this one, 0 if the event has no logical clock.
+  */
+  ulonglong get_last_committed() const { return last_committed; }
+  /// Return the number of the transaction in the binlog, 0 if unknown.
+  ulonglong get_sequence_number() const { return sequence_number; }
+
+  /**
+    Return the hashes of the primary and unique key values the
+    transaction changed, see slave_pr_mode=WRITESET.
+  */
+  const ulonglong *get_writeset() const { return writeset; }
+  /// Return the number of hashes, 0 if the transaction has no writeset.
+  uint get_writeset_count() const { return writeset_count; }
+
   /**
     Return the group type for this Gtid_log_event: this can be
     either ANONYMOUS_GROUP, AUTOMATIC_GROUP, or GTID_GROUP.
@@ -5079,6 +5141,12 @@ private:
   static const int ENCODED_SID_LENGTH= rpl_sid::BYTE_LENGTH;
   /// Length of GNO in event encoding
   static const int ENCODED_GNO_LENGTH= 8;
+  /// Length of last_committed and sequence_number in event encoding
+  static const int ENCODED_LOGICAL_CLOCK_LENGTH= 16;
+  /// Length of the number of writeset hashes in event encoding
+  static const int ENCODED_WRITESET_COUNT_LENGTH= 2;
+  /// Length of a writeset hash in event encoding
+  static const int ENCODED_WRITESET_HASH_LENGTH= 8;
 
 public:
   /// Total length of post header
@@ -5095,6 +5163,26 @@ private:
   rpl_sid sid;
   /// True if this is the last group of the transaction, false otherwise.
   bool commit_flag;
+  /**
+    The logical clock of the transaction follows the post header in
+    events logged by this server, an event without one has zeros.
+  */
+  bool has_logical_clock;
+  ulonglong last_committed;
+  ulonglong sequence_number;
+  /**
+    Hashes of the keys the transaction changed, following the logical
+    clock as the number of hashes and the hashes. Events without a
+    writeset end with the logical clock.
+  */
+  ulonglong *writeset;
+  uint writeset_count;
+  /// The writeset was read from an event and is owned by it
+  bool writeset_alloced;
+#if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
+  db_worker_hash_entry **mts_group_parts;
+  uint mts_group_parts_count;
+#endif
 };
 
 
@@ -107,6 +107,7 @@
 #include "sp_rcontext.h"
 #include "sp_cache.h"
 #include "sql_reload.h"  // reload_acl_and_cache
+#include "sql_ccl.h"                   // free_ccl_rules
 
 #ifdef HAVE_POLL_H
 #include <poll.h>
@@ -557,11 +558,13 @@ bool thread_cache_size_specified= false;
 bool host_cache_size_specified= false;
 bool table_definition_cache_specified= false;
 my_bool opt_rds_allow_unsafe_stmt_with_gtid= FALSE;
+my_bool opt_sequence_cache_prefetch= FALSE;
 ulong slave_pr_mode_options;
+my_bool opt_slave_preserve_commit_order= FALSE;
+ulong opt_binlog_writeset_size= 0;
 
 my_bool ic_reduce_hint_enable= 0;
-HASH ic_gather_hash;
-pthread_mutex_t ic_gather_hash_lock;
+ulong ic_reduce_batch_size= 1;
 
 Error_log_throttle err_log_throttle(Log_throttle::LOG_THROTTLE_WINDOW_SIZE,
                                     sql_print_error,
@@ -768,6 +771,7 @@ mysql_mutex_t LOCK_des_key_file;
 mysql_rwlock_t LOCK_sys_init_connect, LOCK_sys_init_slave;
 mysql_rwlock_t LOCK_system_variables_hash;
 mysql_rwlock_t LOCK_filter_list;
+mysql_rwlock_t LOCK_ccl_rules;
 mysql_rwlock_t LOCK_unsafe_stmt;
 mysql_cond_t COND_thread_count;
 pthread_t signal_thread;
@@ -1956,6 +1960,8 @@ void clean_up(bool print_message)
   free_max_user_conn();
   free_global_table_stats();
   free_global_index_stats();
+  ic_gather_hash_free();
+  free_ccl_rules();
 #ifdef HAVE_REPLICATION
   end_slave_list();
 #endif
@@ -2065,6 +2071,7 @@ static void clean_up_mutexes()
   mysql_mutex_destroy(&LOCK_global_system_variables);
   mysql_rwlock_destroy(&LOCK_system_variables_hash);
   mysql_rwlock_destroy(&LOCK_filter_list);
+  mysql_rwlock_destroy(&LOCK_ccl_rules);
   mysql_rwlock_destroy(&LOCK_unsafe_stmt);
   mysql_mutex_destroy(&LOCK_uuid_generator);
   mysql_mutex_destroy(&LOCK_sql_rand);
@@ -4339,6 +4346,7 @@ static int init_thread_environment()
   mysql_rwlock_init(key_rwlock_LOCK_system_variables_hash,
                     &LOCK_system_variables_hash);
   mysql_rwlock_init(key_rwlock_LOCK_filter_list, &LOCK_filter_list);
+  mysql_rwlock_init(key_rwlock_LOCK_ccl_rules, &LOCK_ccl_rules);
   mysql_rwlock_init(key_rwlock_LOCK_unsafe_stmt, &LOCK_unsafe_stmt);
   mysql_mutex_init(key_LOCK_prepared_stmt_count,
                    &LOCK_prepared_stmt_count, MY_MUTEX_INIT_FAST);
@@ -5348,19 +5356,6 @@ static void test_lc_time_sz()
 }
 #endif//DBUG_OFF
 
-
-static uchar *hash_item_get_key(const uchar *record, size_t *length, my_bool not_used __attribute__((unused)))
-{
-  ic_hash_item_t *entry= (ic_hash_item_t*) record;
-  *length= entry->key_len;
-  return (uchar*) entry->key;
-}
-
-static void hash_item_free_entry(ic_hash_item_t *record)
-{
-  delete record;
-}
-
 #ifdef __WIN__
 int win_main(int argc, char **argv)
 #else
@@ -5636,11 +5631,7 @@ int mysqld_main(int argc, char **argv)
       unireg_abort(1);
   }
 
-  (void) my_hash_init(&ic_gather_hash, &my_charset_bin, 1024+16, 0, 0,
-                      (my_hash_get_key) hash_item_get_key,
-                      (my_hash_free_key) hash_item_free_entry, MYF(0));
-
-  pthread_mutex_init(&ic_gather_hash_lock, NULL);
+  ic_gather_hash_init();
 
   /*
     Each server should have one UUID. We will create it automatically, if it
@@ -9798,6 +9789,8 @@ PSI_mutex_key
   key_LOCK_global_table_stats, key_LOCK_global_index_stats,
   key_rwlock_LOCK_unsafe_stmt;
 PSI_mutex_key key_LOCK_thd_remove;
+PSI_mutex_key key_LOCK_ccl_rule;
+PSI_mutex_key key_mutex_slave_commit_order;
 PSI_mutex_key key_RELAYLOG_LOCK_commit;
 PSI_mutex_key key_RELAYLOG_LOCK_commit_queue;
 PSI_mutex_key key_RELAYLOG_LOCK_done;
@@ -9888,6 +9881,7 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_relay_log_info_run_lock, "Relay_log_info::run_lock", 0},
   { &key_mutex_slave_parallel_pend_jobs, "Relay_log_info::pending_jobs_lock", 0},
   { &key_mutex_slave_parallel_worker_count, "Relay_log_info::exit_count_lock", 0},
+  { &key_mutex_slave_commit_order, "Relay_log_info::mts_commit_order_lock", 0},
   { &key_mutex_mts_temp_tables_lock, "Relay_log_info::temp_tables_lock", 0},
   { &key_mutex_slave_parallel_worker, "Worker_info::jobs_lock", 0},
   { &key_structure_guard_mutex, "Query_cache::structure_guard_mutex", 0},
@@ -9896,6 +9890,7 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOG_INFO_lock, "LOG_INFO::lock", 0},
   { &key_LOCK_thread_count, "LOCK_thread_count", PSI_FLAG_GLOBAL},
   { &key_LOCK_thd_remove, "LOCK_thd_remove", PSI_FLAG_GLOBAL},
+  { &key_LOCK_ccl_rule, "ccl_rule::lock", 0},
   { &key_LOCK_log_throttle_qni, "LOCK_log_throttle_qni", PSI_FLAG_GLOBAL},
   { &key_gtid_ensure_index_mutex, "Gtid_state", PSI_FLAG_GLOBAL},
   { &key_LOCK_thread_created, "LOCK_thread_created", PSI_FLAG_GLOBAL },
@@ -9913,6 +9908,7 @@ PSI_rwlock_key key_rwlock_LOCK_grant, key_rwlock_LOCK_logger,
 
 PSI_rwlock_key key_rwlock_Trans_delegate_lock;
 PSI_rwlock_key key_rwlock_Binlog_storage_delegate_lock;
+PSI_rwlock_key key_rwlock_LOCK_ccl_rules;
 #ifdef HAVE_REPLICATION
 PSI_rwlock_key key_rwlock_Binlog_transmit_delegate_lock;
 PSI_rwlock_key key_rwlock_Binlog_relay_IO_delegate_lock;
@@ -9935,7 +9931,8 @@ static PSI_rwlock_info all_server_rwlocks[]=
   { &key_rwlock_query_cache_query_lock, "Query_cache_query::lock", 0},
   { &key_rwlock_global_sid_lock, "gtid_commit_rollback", PSI_FLAG_GLOBAL},
   { &key_rwlock_Trans_delegate_lock, "Trans_delegate::lock", PSI_FLAG_GLOBAL},
-  { &key_rwlock_Binlog_storage_delegate_lock, "Binlog_storage_delegate::lock", PSI_FLAG_GLOBAL}
+  { &key_rwlock_Binlog_storage_delegate_lock, "Binlog_storage_delegate::lock", PSI_FLAG_GLOBAL},
+  { &key_rwlock_LOCK_ccl_rules, "LOCK_ccl_rules", PSI_FLAG_GLOBAL}
 };
 
 #ifdef HAVE_MMAP
@@ -9965,6 +9962,8 @@ PSI_cond_key key_gtid_ensure_index_cond;
 
 PSI_cond_key key_ss_cond_COND_binlog_send_;
 PSI_cond_key key_ss_cond_Ack_receiver_cond;
+PSI_cond_key key_COND_ccl_rule;
+PSI_cond_key key_cond_slave_commit_order;
 
 static PSI_cond_info all_server_conds[]=
 {
@@ -9999,6 +9998,7 @@ static PSI_cond_info all_server_conds[]=
   { &key_relay_log_info_sleep_cond, "Relay_log_info::sleep_cond", 0},
   { &key_cond_slave_parallel_pend_jobs, "Relay_log_info::pending_jobs_cond", 0},
   { &key_cond_slave_parallel_worker, "Worker_info::jobs_cond", 0},
+  { &key_cond_slave_commit_order, "Relay_log_info::mts_commit_order_cond", 0},
   { &key_TABLE_SHARE_cond, "TABLE_SHARE::cond", 0},
   { &key_user_level_lock_cond, "User_level_lock::cond", 0},
   { &key_COND_thread_count, "COND_thread_count", PSI_FLAG_GLOBAL},
@@ -10007,7 +10007,8 @@ static PSI_cond_info all_server_conds[]=
   { &key_gtid_ensure_index_cond, "Gtid_state", PSI_FLAG_GLOBAL},
   { &key_ss_cond_COND_binlog_send_, "COND_binlog_send_", 0},
   { &key_ss_cond_Ack_receiver_cond, "Ack_receiver::m_cond", 0},
-  { &key_COND_connection_count, "COND_connection_count", PSI_FLAG_GLOBAL}
+  { &key_COND_connection_count, "COND_connection_count", PSI_FLAG_GLOBAL},
+  { &key_COND_ccl_rule, "ccl_rule::cond", 0}
 };
 
 PSI_thread_key key_thread_bootstrap, key_thread_delayed_insert,
@@ -10194,12 +10195,17 @@ PSI_stage_info stage_slave_waiting_worker_to_release_partition= { 0, "Waiting fo
 PSI_stage_info stage_slave_waiting_worker_to_free_events= { 0, "Waiting for Slave Workers to free pending events", 0};
 PSI_stage_info stage_slave_waiting_worker_queue= { 0, "Waiting for Slave Worker queue", 0};
 PSI_stage_info stage_slave_waiting_event_from_coordinator= { 0, "Waiting for an event from Coordinator", 0};
+PSI_stage_info stage_slave_waiting_for_commit_order= { 0, "Waiting for preceding transaction to commit", 0};
+PSI_stage_info stage_slave_waiting_for_commit_parent= { 0, "Waiting for dependent transaction to commit", 0};
 PSI_stage_info stage_waiting_for_semi_sync_ack_from_slave={ 0, "Waiting for semi-sync ACK from slave", 0};
 
 PSI_stage_info stage_waiting_for_semi_sync_slave={ 0, "Waiting for semi-sync slave connection", 0};
 
 PSI_stage_info stage_reading_semi_sync_ack={ 0, "Reading semi-sync ACK from slave", 0};
 
+PSI_stage_info stage_waiting_for_ic_batch_leader={ 0, "Waiting for batch leader", 0};
+PSI_stage_info stage_waiting_for_ccl_rule={ 0, "Waiting for concurrency control", 0};
+
 #ifdef HAVE_PSI_INTERFACE
 
 PSI_stage_info *all_server_stages[]=
@@ -10302,7 +10308,11 @@ PSI_stage_info *all_server_stages[]=
   & stage_waiting_to_get_readlock,
   & stage_waiting_for_semi_sync_ack_from_slave,
   & stage_waiting_for_semi_sync_slave,
-  & stage_reading_semi_sync_ack
+  & stage_reading_semi_sync_ack,
+  & stage_waiting_for_ic_batch_leader,
+  & stage_waiting_for_ccl_rule,
+  & stage_slave_waiting_for_commit_order,
+  & stage_slave_waiting_for_commit_parent
 };
 
 PSI_socket_key key_socket_tcpip, key_socket_unix, key_socket_client_connection;
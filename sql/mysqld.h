@@ -455,12 +455,14 @@ extern ulong log_warnings;
 extern uint host_cache_size;
 void init_sql_statement_names();
 extern my_bool opt_rds_allow_unsafe_stmt_with_gtid;
+extern my_bool opt_sequence_cache_prefetch;
 extern ulong slave_pr_mode_options;
+extern my_bool opt_slave_preserve_commit_order;
+extern ulong opt_binlog_writeset_size;
 
 
-extern HASH ic_gather_hash;
-extern pthread_mutex_t ic_gather_hash_lock;
 extern my_bool ic_reduce_hint_enable;
+extern ulong ic_reduce_batch_size;
 
 /*
   THR_MALLOC is a key which will be used to set/get MEM_ROOT** for a thread,
@@ -509,10 +511,10 @@ extern PSI_mutex_key
   key_relay_log_info_log_space_lock, key_relay_log_info_run_lock,
   key_mutex_slave_parallel_pend_jobs, key_mutex_mts_temp_tables_lock,
   key_mutex_slave_parallel_worker,
-  key_mutex_slave_parallel_worker_count,
+  key_mutex_slave_parallel_worker_count, key_mutex_slave_commit_order,
   key_structure_guard_mutex, key_TABLE_SHARE_LOCK_ha_data,
   key_LOCK_error_messages, key_LOCK_thread_count, key_LOCK_thd_remove,
-  key_LOCK_log_throttle_qni;
+  key_LOCK_log_throttle_qni, key_LOCK_ccl_rule;
 extern PSI_mutex_key key_RELAYLOG_LOCK_commit;
 extern PSI_mutex_key key_RELAYLOG_LOCK_commit_queue;
 extern PSI_mutex_key key_RELAYLOG_LOCK_done;
@@ -533,7 +535,7 @@ extern PSI_rwlock_key key_rwlock_LOCK_grant, key_rwlock_LOCK_logger,
   key_rwlock_LOCK_sys_init_connect, key_rwlock_LOCK_sys_init_slave,
   key_rwlock_LOCK_system_variables_hash, key_rwlock_query_cache_query_lock,
   key_rwlock_global_sid_lock, key_rwlock_LOCK_filter_list,
-  key_rwlock_LOCK_unsafe_stmt;
+  key_rwlock_LOCK_unsafe_stmt, key_rwlock_LOCK_ccl_rules;
 
 #ifdef HAVE_MMAP
 extern PSI_cond_key key_PAGE_cond, key_COND_active, key_COND_pool;
@@ -561,6 +563,8 @@ extern PSI_cond_key key_RELAYLOG_prep_xids_cond;
 extern PSI_cond_key key_gtid_ensure_index_cond;
 
 extern PSI_cond_key key_ss_cond_COND_binlog_send_, key_ss_cond_Ack_receiver_cond;
+extern PSI_cond_key key_COND_ccl_rule;
+extern PSI_cond_key key_cond_slave_commit_order;
 
 extern PSI_thread_key key_thread_bootstrap, key_thread_delayed_insert,
   key_thread_handle_manager, key_thread_kill_server, key_thread_main,
@@ -690,10 +694,14 @@ extern PSI_stage_info stage_slave_waiting_worker_to_release_partition;
 extern PSI_stage_info stage_slave_waiting_worker_to_free_events;
 extern PSI_stage_info stage_slave_waiting_worker_queue;
 extern PSI_stage_info stage_slave_waiting_event_from_coordinator;
+extern PSI_stage_info stage_slave_waiting_for_commit_order;
+extern PSI_stage_info stage_slave_waiting_for_commit_parent;
 extern PSI_stage_info stage_slave_waiting_workers_to_exit;
 extern PSI_stage_info stage_waiting_for_semi_sync_ack_from_slave;
 extern PSI_stage_info stage_waiting_for_semi_sync_slave;
 extern PSI_stage_info stage_reading_semi_sync_ack;
+extern PSI_stage_info stage_waiting_for_ic_batch_leader;
+extern PSI_stage_info stage_waiting_for_ccl_rule;
 #ifdef HAVE_PSI_STATEMENT_INTERFACE
 /**
   Statement instrumentation keys (sql).
@@ -773,6 +781,7 @@ extern mysql_cond_t COND_server_started;
 extern mysql_rwlock_t LOCK_sys_init_connect, LOCK_sys_init_slave;
 extern mysql_rwlock_t LOCK_system_variables_hash;
 extern mysql_rwlock_t LOCK_filter_list;
+extern mysql_rwlock_t LOCK_ccl_rules;
 extern mysql_rwlock_t LOCK_unsafe_stmt;
 extern mysql_cond_t COND_manager;
 extern int32 thread_running;
@@ -91,6 +91,8 @@ Relay_log_info::Relay_log_info(bool is_slave_recovery
    retried_trans(0),
    tables_to_lock(0), tables_to_lock_count(0),
    rows_query_ev(NULL), last_event_start_time(0), deferred_events(NULL),
+   mts_preserve_commit_order(false), mts_commit_order_aborted(false),
+   mts_commit_order_seqno(0),
    slave_parallel_workers(0),
    exit_counter(0),
    max_updated_index(0),
@@ -140,6 +142,9 @@ Relay_log_info::Relay_log_info(bool is_slave_recovery
   mysql_cond_init(key_cond_slave_parallel_pend_jobs, &pending_jobs_cond, NULL);
   mysql_mutex_init(key_mutex_slave_parallel_worker_count, &exit_count_lock,
                    MY_MUTEX_INIT_FAST);
+  mysql_mutex_init(key_mutex_slave_commit_order, &mts_commit_order_lock,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_cond_slave_commit_order, &mts_commit_order_cond, NULL);
   my_atomic_rwlock_init(&slave_open_temp_tables_lock);
 
   relay_log.init_pthread_objects();
@@ -183,6 +188,8 @@ Relay_log_info::~Relay_log_info()
   mysql_mutex_destroy(&pending_jobs_lock);
   mysql_cond_destroy(&pending_jobs_cond);
   mysql_mutex_destroy(&exit_count_lock);
+  mysql_mutex_destroy(&mts_commit_order_lock);
+  mysql_cond_destroy(&mts_commit_order_cond);
   my_atomic_rwlock_destroy(&slave_open_temp_tables_lock);
   relay_log.cleanup();
   set_rli_description_event(NULL);
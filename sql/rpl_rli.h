@@ -498,6 +498,16 @@ public:
   mysql_mutex_t pending_jobs_lock;
   mysql_cond_t pending_jobs_cond;
   mysql_mutex_t exit_count_lock; // mutex of worker exit count
+  /*
+    With slave_preserve_commit_order Workers commit groups in the order
+    they were assigned: the group of total_seqno N waits until
+    mts_commit_order_seqno reaches N - 1.
+  */
+  bool mts_preserve_commit_order;
+  bool mts_commit_order_aborted; // a Worker failed, waiting ones give up
+  ulonglong mts_commit_order_seqno; // total_seqno of the last committed group
+  mysql_mutex_t mts_commit_order_lock;
+  mysql_cond_t mts_commit_order_cond;
   ulong       mts_slave_worker_queue_len_max;
   ulonglong   mts_pending_jobs_size;      // actual mem usage by WQ:s
   ulonglong   mts_pending_jobs_size_max;  // max of WQ:s size forcing C to wait
@@ -514,6 +524,8 @@ public:
   DYNAMIC_ARRAY curr_group_assigned_parts;
   DYNAMIC_ARRAY curr_group_da;  // deferred array to hold partition-info-free events
   bool curr_group_seen_gtid;   // current group started with Gtid-event or not
+  /* sequence_number of the last group mapped in LOGICAL_CLOCK mode */
+  ulonglong mts_last_sequence_number;
   bool curr_group_seen_begin;   // current group started with B-event or not
   bool curr_group_isolated;     // current group requires execution in isolation
   bool mts_end_group_sets_max_dbs; // flag indicates if partitioning info is discovered
@@ -216,6 +216,7 @@ Slave_worker::Slave_worker(Relay_log_info *rli
   checkpoint_master_log_name[0]= 0;
   my_init_dynamic_array(&curr_group_exec_parts, sizeof(db_worker_hash_entry*),
                         SLAVE_INIT_DBS_IN_GROUP, 1);
+  my_init_dynamic_array(&curr_group_events, sizeof(Log_event*), 16, 16);
   mysql_mutex_init(key_mutex_slave_parallel_worker, &jobs_lock,
                    MY_MUTEX_INIT_FAST);
   mysql_cond_init(key_cond_slave_parallel_worker, &jobs_cond, NULL);
@@ -230,6 +231,8 @@ Slave_worker::~Slave_worker()
     delete_dynamic(&jobs.Q);
   }
   delete_dynamic(&curr_group_exec_parts);
+  clear_group_events();
+  delete_dynamic(&curr_group_events);
   mysql_mutex_destroy(&jobs_lock);
   mysql_cond_destroy(&jobs_cond);
   info_thd= NULL;
@@ -260,6 +263,9 @@ int Slave_worker::init_worker(Relay_log_info * rli, ulong i)
 
   id= i;
   curr_group_exec_parts.elements= 0;
+  clear_group_events();
+  curr_group_seqno= 0;
+  commit_order_deadlock= false;
   relay_log_change_notified= FALSE; // the 1st group to contain relaylog name
   checkpoint_notified= FALSE;       // the same as above
   master_log_change_notified= false;// W learns master log during 1st group exec
@@ -1102,6 +1108,139 @@ err:
   DBUG_RETURN(entry ? entry->worker : NULL);
 }
 
+/**
+   Maps the current group to a Worker in WRITESET and LOGICAL_CLOCK modes,
+   see @c map_db_to_worker().
+
+   In WRITESET mode each key hash of the writeset is a partition of the
+   Assigned Partition Hash, so that groups changing a same row are
+   executed by one Worker in order. In LOGICAL_CLOCK mode the group gets a
+   partition of its own, so any Worker can take it: the Coordinator has
+   waited for the groups it depends on in @c mts_wait_for_commit_parent().
+
+   @param  ev          the Gtid-event of the group, NULL if the group
+                       was mapped by an earlier event of the group
+   @param  rli         pointer to Coordinators relay-log-info instance
+   @param  ptr_entry   reference to a pointer to the first entry of the
+                       group in the Assigned Partition Hash
+   @param  last_worker rli->last_assigned_worker
+
+   @return the pointer to a Worker struct, NULL on error
+*/
+Slave_worker *map_group_to_worker(Gtid_log_event *ev, Relay_log_info *rli,
+                                  db_worker_hash_entry **ptr_entry,
+                                  Slave_worker *last_worker)
+{
+  Slave_worker *worker= last_worker;
+  DBUG_ENTER("map_group_to_worker");
+
+  if (!ev)
+  {
+    DBUG_ASSERT(rli->curr_group_assigned_parts.elements > 0 && last_worker);
+    *ptr_entry= *(db_worker_hash_entry **)
+      dynamic_array_ptr(&rli->curr_group_assigned_parts, 0);
+    DBUG_RETURN(last_worker);
+  }
+
+  if (rli->pr_mode == SLAVE_PR_MODE_LOGICAL_CLOCK)
+  {
+    char key[2 * sizeof(ulonglong) + 2];
+
+    /* Names of databases can't start with '#' */
+    my_snprintf(key, sizeof(key), "#%llx", rli->mts_groups_assigned);
+    if (!(worker= map_db_to_worker(key, rli, ptr_entry, FALSE, worker)))
+      DBUG_RETURN(NULL);
+  }
+  else
+  {
+    const ulonglong *writeset= ev->get_writeset();
+    for (uint i= 0; i < ev->get_writeset_count(); i++)
+    {
+      char key[2 * sizeof(ulonglong) + 1];
+      db_worker_hash_entry *entry;
+
+      my_snprintf(key, sizeof(key), "%llx", writeset[i]);
+      if (!(worker= map_db_to_worker(key, rli, &entry, FALSE, worker)))
+        DBUG_RETURN(NULL);
+      if (i == 0)
+        *ptr_entry= entry;
+    }
+  }
+
+  if (ev->mts_set_group_parts(&rli->curr_group_assigned_parts))
+    DBUG_RETURN(NULL);
+
+  DBUG_RETURN(worker);
+}
+
+/**
+   In LOGICAL_CLOCK mode, waits until the groups the group of @c ev
+   depends on have been applied: the groups whose sequence_number is not
+   greater than the last_committed of @c ev. The other groups were
+   prepared at the same time on the master and can't conflict with it.
+
+   The logical clock restarts with the master, a group without one or
+   out of sequence is applied in isolation instead.
+
+   @param  rli   pointer to Coordinators relay-log-info instance
+   @param  ev    the Gtid-event of the current group
+
+   @return true if the group can be applied in parallel with the groups
+           being applied, false if it has to be applied in isolation
+*/
+bool mts_wait_for_commit_parent(Relay_log_info *rli, Gtid_log_event *ev)
+{
+  THD *thd= rli->info_thd;
+  Slave_committed_queue *gaq= rli->gaq;
+  ulonglong last_committed= ev->get_last_committed();
+  ulonglong sequence_number= ev->get_sequence_number();
+  bool in_sequence= (last_committed < sequence_number &&
+                     sequence_number > rli->mts_last_sequence_number);
+  PSI_stage_info old_stage;
+  bool waited= false;
+  DBUG_ENTER("mts_wait_for_commit_parent");
+
+  rli->mts_last_sequence_number= sequence_number;
+  if (!in_sequence)
+    DBUG_RETURN(false);
+  gaq->get_job_group(gaq->assigned_group_index)->sequence_number=
+    sequence_number;
+
+  for (ulong i= gaq->entry; i != gaq->assigned_group_index;
+       i= (i + 1) % gaq->size)
+  {
+    Slave_job_group *ptr_g= gaq->get_job_group(i);
+
+    if (ptr_g->sequence_number == 0 ||
+        ptr_g->sequence_number > last_committed)
+      continue;
+
+    while (!ptr_g->done)
+    {
+      Slave_worker *w= *(Slave_worker **)
+        dynamic_array_ptr(&rli->workers, ptr_g->worker_id);
+
+      if (thd->killed || w->running_status != Slave_worker::RUNNING)
+      {
+        if (waited)
+          THD_STAGE_INFO(thd, old_stage);
+        DBUG_RETURN(false);
+      }
+      if (!waited)
+      {
+        thd->enter_stage(&stage_slave_waiting_for_commit_parent, &old_stage,
+                         __func__, __FILE__, __LINE__);
+        waited= true;
+      }
+      my_sleep(rli->mts_coordinator_basic_nap);
+    }
+  }
+
+  if (waited)
+    THD_STAGE_INFO(thd, old_stage);
+  DBUG_RETURN(true);
+}
+
 /**
    least_occupied in partition number sense.
    This might be too coarse and computing based on assigned task (todo)
@@ -1149,6 +1288,173 @@ Slave_worker *get_least_occupied_worker(DYNAMIC_ARRAY *ws)
   DBUG_RETURN(worker);
 }
 
+/**
+   With slave_preserve_commit_order, waits until the groups assigned
+   before the group of @c seqno have committed.
+
+   @param seqno  total_seqno of the group
+
+   @return true if a preceding group failed, the Worker was killed or
+           a preceding group waits for a row lock of this one (see
+           found_commit_order_deadlock()), false otherwise
+*/
+bool Slave_worker::wait_for_commit_order(ulonglong seqno)
+{
+  bool aborted;
+  PSI_stage_info old_stage;
+  DBUG_ENTER("Slave_worker::wait_for_commit_order");
+
+  if (!c_rli->mts_preserve_commit_order)
+    DBUG_RETURN(false);
+
+  mysql_mutex_lock(&c_rli->mts_commit_order_lock);
+  if (c_rli->mts_commit_order_seqno + 1 >= seqno)
+  {
+    mysql_mutex_unlock(&c_rli->mts_commit_order_lock);
+    DBUG_RETURN(false);
+  }
+  info_thd->ENTER_COND(&c_rli->mts_commit_order_cond,
+                       &c_rli->mts_commit_order_lock,
+                       &stage_slave_waiting_for_commit_order, &old_stage);
+  while (c_rli->mts_commit_order_seqno + 1 < seqno &&
+         !c_rli->mts_commit_order_aborted && !commit_order_deadlock &&
+         !info_thd->killed)
+    mysql_cond_wait(&c_rli->mts_commit_order_cond,
+                    &c_rli->mts_commit_order_lock);
+  aborted= c_rli->mts_commit_order_seqno + 1 < seqno;
+  info_thd->EXIT_COND(&old_stage);
+
+  DBUG_RETURN(aborted);
+}
+
+/**
+   Lets the group following the group of @c seqno commit, or on error
+   makes the Workers waiting for their turn give up.
+*/
+void Slave_worker::release_commit_order(ulonglong seqno, bool error)
+{
+  DBUG_ENTER("Slave_worker::release_commit_order");
+
+  if (!c_rli->mts_preserve_commit_order)
+    DBUG_VOID_RETURN;
+
+  mysql_mutex_lock(&c_rli->mts_commit_order_lock);
+  if (error)
+    c_rli->mts_commit_order_aborted= true;
+  else if (seqno > c_rli->mts_commit_order_seqno)
+    c_rli->mts_commit_order_seqno= seqno;
+  commit_order_deadlock= false;
+  mysql_cond_broadcast(&c_rli->mts_commit_order_cond);
+  mysql_mutex_unlock(&c_rli->mts_commit_order_lock);
+
+  DBUG_VOID_RETURN;
+}
+
+/**
+   Called through thd_report_row_lock_wait() when the group of this
+   Worker has to wait for a row lock held by the group of @c holder.
+   If @c holder applies a later group it would in turn wait for this
+   one to commit, so it is told to roll back and apply its group again.
+
+   The engine calls this with its lock table latched, so nothing here
+   may enter the engine.
+
+   @param holder  the Worker holding the row lock
+*/
+void Slave_worker::report_commit_order_wait(Slave_worker *holder)
+{
+  DBUG_ENTER("Slave_worker::report_commit_order_wait");
+
+  /*
+    holder has set curr_group_seqno before taking any lock in its group,
+    and the lock table latch orders that store before the read here.
+  */
+  if (!c_rli->mts_preserve_commit_order || holder == this ||
+      holder->c_rli != c_rli || curr_group_seqno >= holder->curr_group_seqno)
+    DBUG_VOID_RETURN;
+
+  DBUG_PRINT("mts", ("group %llu waits for a row lock of group %llu",
+                     curr_group_seqno, holder->curr_group_seqno));
+
+  mysql_mutex_lock(&c_rli->mts_commit_order_lock);
+  holder->commit_order_deadlock= true;
+  mysql_cond_broadcast(&c_rli->mts_commit_order_cond);
+  mysql_mutex_unlock(&c_rli->mts_commit_order_lock);
+
+  DBUG_VOID_RETURN;
+}
+
+/**
+   @return true if wait_for_commit_order() gave up because a preceding
+           group waits for a row lock of the current group
+*/
+bool Slave_worker::found_commit_order_deadlock()
+{
+  bool ret;
+
+  mysql_mutex_lock(&c_rli->mts_commit_order_lock);
+  ret= commit_order_deadlock;
+  mysql_mutex_unlock(&c_rli->mts_commit_order_lock);
+
+  return ret;
+}
+
+/**
+   Rolls back the current group after a commit order deadlock and
+   applies its events again, up to slave_transaction_retries times.
+
+   @param ev  the event that ends the group, it failed to apply
+
+   @return 0 if the group was applied, the error of the last attempt
+           otherwise
+*/
+int Slave_worker::retry_group(Log_event *ev)
+{
+  THD *thd= info_thd;
+  ulong retries= 0;
+  int error= 1;
+  DBUG_ENTER("Slave_worker::retry_group");
+
+  while (error && found_commit_order_deadlock() &&
+         retries++ < slave_trans_retries && !thd->killed)
+  {
+    thd->clear_error();
+    cleanup_context(thd, true);
+
+    mysql_mutex_lock(&c_rli->mts_commit_order_lock);
+    commit_order_deadlock= false;
+    mysql_mutex_unlock(&c_rli->mts_commit_order_lock);
+
+    mysql_mutex_lock(&c_rli->data_lock); // because of SHOW STATUS
+    c_rli->retried_trans++;
+    mysql_mutex_unlock(&c_rli->data_lock);
+    DBUG_PRINT("mts", ("Worker %lu retries group %llu, attempt %lu",
+                       id, curr_group_seqno, retries));
+
+    error= 0;
+    for (uint i= 0; i < curr_group_events.elements && !error; i++)
+    {
+      Log_event *group_ev=
+        *(Log_event**) dynamic_array_ptr(&curr_group_events, i);
+      error= group_ev->do_apply_event_worker(this);
+    }
+    if (!error)
+      error= ev->do_apply_event_worker(this);
+  }
+
+  DBUG_RETURN(error);
+}
+
+/**
+   Frees the events kept for retry_group().
+*/
+void Slave_worker::clear_group_events()
+{
+  for (uint i= 0; i < curr_group_events.elements; i++)
+    delete *(Log_event**) dynamic_array_ptr(&curr_group_events, i);
+  curr_group_events.elements= 0;
+}
+
 /**
    Deallocation routine to cancel out few effects of
    @c map_db_to_worker().
@@ -1189,6 +1495,10 @@ void Slave_worker::slave_worker_ends_group(Log_event* ev, int error)
     ptr_g->group_master_log_pos= group_master_log_pos;
     ptr_g->group_relay_log_pos= group_relay_log_pos;
 
+    /* Xid groups waited in do_apply_event_worker already */
+    wait_for_commit_order(ptr_g->total_seqno);
+    release_commit_order(ptr_g->total_seqno, false);
+
     ptr_g->done= 1;    // GAQ index is available to C now
 
     last_group_done_index= gaq_index;
@@ -1198,6 +1508,7 @@ void Slave_worker::slave_worker_ends_group(Log_event* ev, int error)
   }
   else
   {
+    release_commit_order(0, true);
     if (running_status != STOP_ACCEPTED)
     {
       // tagging as exiting so Coordinator won't be able synchronize with it
@@ -2011,6 +2322,7 @@ int slave_worker_exec_job(Slave_worker *worker, Relay_log_info *rli)
   THD *thd= worker->info_thd;
   Log_event *ev= NULL;
   bool part_event= FALSE;
+  bool group_ends= false;
 
   DBUG_ENTER("slave_worker_exec_job");
 
@@ -2074,18 +2386,29 @@ int slave_worker_exec_job(Slave_worker *worker, Relay_log_info *rli)
       worker->end_group_sets_max_dbs= false;
     }
   }
+  else
+  {
+    // partitions of the writeset are released when the group ends
+    static_cast<Gtid_log_event*>(ev)->
+      mts_add_group_parts(&worker->curr_group_exec_parts);
+  }
 
   worker->set_future_event_relay_log_pos(ev->future_event_relay_log_pos);
   worker->set_master_log_pos(ev->log_pos);
   worker->set_gaq_index(ev->mts_group_idx);
+  worker->curr_group_seqno=
+    rli->gaq->get_job_group(ev->mts_group_idx)->total_seqno;
   error= ev->do_apply_event_worker(worker);
-  if (ev->ends_group() || (!worker->curr_group_seen_begin &&
-                           /*
-                              p-events of B/T-less {p,g} group (see
-                              legends of Log_event::get_slave_worker)
-                              obviously can't commit.
-                           */
-                           part_event && !is_gtid_event(ev)))
+  if (error && worker->found_commit_order_deadlock())
+    error= worker->retry_group(ev);
+  group_ends= ev->ends_group() || (!worker->curr_group_seen_begin &&
+                                   /*
+                                     p-events of B/T-less {p,g} group (see
+                                     legends of Log_event::get_slave_worker)
+                                     obviously can't commit.
+                                   */
+                                   part_event && !is_gtid_event(ev));
+  if (group_ends)
   {
     DBUG_PRINT("slave_worker_exec_job:",
                (" commits GAQ index %lu, last committed  %lu",
@@ -2206,8 +2529,18 @@ err:
   // todo: simulate delay in delete
   if (ev && ev->worker && ev->get_type_code() != ROWS_QUERY_LOG_EVENT)
   {
-    delete ev;
+    /*
+      Keep the events of the group for retry_group(). Rows_query events
+      are owned by the Worker until the end of the statement and only
+      carry the query text, so the retry goes without them.
+    */
+    if (!error && !group_ends && rli->mts_preserve_commit_order)
+      insert_dynamic(&worker->curr_group_events, (uchar*) &ev);
+    else
+      delete ev;
   }
+  if (error || group_ends)
+    worker->clear_group_events();
 
 
   DBUG_RETURN(error);
@@ -69,6 +69,10 @@ void destroy_hash_workers(Relay_log_info*);
 Slave_worker *map_db_to_worker(const char *dbname, Relay_log_info *rli,
                                db_worker_hash_entry **ptr_entry,
                                bool need_temp_tables, Slave_worker *w);
+Slave_worker *map_group_to_worker(Gtid_log_event *ev, Relay_log_info *rli,
+                                  db_worker_hash_entry **ptr_entry,
+                                  Slave_worker *last_worker);
+bool mts_wait_for_commit_parent(Relay_log_info *rli, Gtid_log_event *ev);
 Slave_worker *get_least_occupied_worker(DYNAMIC_ARRAY *workers);
 int wait_for_workers_to_finish(Relay_log_info const *rli,
                                Slave_worker *ignore= NULL);
@@ -168,6 +172,7 @@ typedef struct st_slave_job_group
   ulong worker_id;
   Slave_worker *worker;
   ulonglong total_seqno;
+  ulonglong sequence_number; // master's logical clock, see LOGICAL_CLOCK
 
   my_off_t master_log_pos;       // B-event log_pos
   /* checkpoint coord are reset by periodical and special (Rotate event) CP:s */
@@ -194,6 +199,7 @@ typedef struct st_slave_job_group
     group_relay_log_name= NULL;
     worker_id= MTS_WORKER_UNDEF;
     total_seqno= seqno;
+    sequence_number= 0;
     checkpoint_log_name= NULL;
     checkpoint_log_pos= 0;
     checkpoint_relay_log_name= NULL;
@@ -322,6 +328,17 @@ public:
   Relay_log_info *c_rli;   // pointer to Coordinator's rli
   DYNAMIC_ARRAY curr_group_exec_parts; // Current Group Executed Partitions
   bool curr_group_seen_begin; // is set to TRUE with explicit B-event
+  /*
+    With slave_preserve_commit_order, events of the current group kept
+    to apply the group again after a commit order deadlock.
+  */
+  DYNAMIC_ARRAY curr_group_events;
+  volatile ulonglong curr_group_seqno; // total_seqno of the current group
+  /*
+    Set when a Worker applying an earlier group waits for a row lock held
+    by the current group, guarded by c_rli->mts_commit_order_lock.
+  */
+  bool commit_order_deadlock;
   ulong id;                 // numberic identifier of the Worker
 
   /*
@@ -401,6 +418,13 @@ public:
   ulonglong get_master_log_pos() { return master_log_pos; };
   ulonglong set_master_log_pos(ulong val) { return master_log_pos= val; };
   bool commit_positions(Log_event *evt, Slave_job_group *ptr_g, bool force);
+  /* slave_preserve_commit_order synchronization, see rpl_rli_pdb.cc */
+  bool wait_for_commit_order(ulonglong seqno);
+  void release_commit_order(ulonglong seqno, bool error);
+  void report_commit_order_wait(Slave_worker *holder);
+  bool found_commit_order_deadlock();
+  int retry_group(Log_event *ev);
+  void clear_group_events();
   /*
     When commit fails clear bitmap for executed worker group. Revert back the
     positions to the old positions that existed before commit using the checkpoint.
@@ -5933,11 +5933,16 @@ int slave_start_workers(Relay_log_info *rli, ulong n, bool *mts_inited)
   rli->mts_wq_underrun_w_id= MTS_WORKER_UNDEF;
   rli->mts_wq_excess_cnt= 0;
   rli->mts_wq_overrun_cnt= 0;
+  rli->pr_mode= slave_pr_mode_options;
+  rli->mts_preserve_commit_order= opt_slave_preserve_commit_order;
+  rli->mts_commit_order_seqno= rli->mts_groups_assigned;
+  rli->mts_commit_order_aborted= false;
   rli->mts_wq_oversize= FALSE;
   rli->mts_coordinator_basic_nap= mts_coordinator_basic_nap;
   rli->mts_worker_underrun_level= mts_worker_underrun_level;
   rli->curr_group_seen_begin= rli->curr_group_seen_gtid= false;
   rli->curr_group_isolated= FALSE;
+  rli->mts_last_sequence_number= 0;
   rli->checkpoint_seqno= 0;
   rli->mts_last_online_stat= my_time(0);
   rli->mts_group_status= Relay_log_info::MTS_NOT_IN_GROUP;
@@ -0,0 +1,489 @@
+
+#include "sql_ccl.h"
+#include "sql_digest.h"
+#include "debug_sync.h"
+
+/* rules in the order they were added, protected by LOCK_ccl_rules */
+ccl_rule *ccl_rule_list= NULL;
+
+/* number of DIGEST rules, the parser only computes digests if needed */
+uint ccl_digest_rule_count= 0;
+
+char *rds_sql_ccl_rule= NULL;
+ulong rds_sql_ccl_wait_timeout= 60;
+
+/* an increased value to indicate a rule */
+static ulonglong ccl_rule_id= 0;
+
+#define CCL_RULE_TYPE_DIGEST "DIGEST"
+#define CCL_RULE_TYPE_TABLE "TABLE"
+
+/*
+  Parse a number ended by ',', returns the position after the comma or
+  NULL if the string does not start with such a number.
+*/
+static const char *ccl_parse_num(const char *str, ulonglong *num)
+{
+  const char *end= str;
+
+  while (*end >= '0' && *end <= '9')
+    end++;
+
+  if (end == str || *end != ',')
+    return NULL;
+
+  *num= strtoull(str, NULL, 10);
+  return end + 1;
+}
+
+/*
+  Check if the rule setting is right, currently only the format bellow is
+  allowed:
+  +,{MAX_CONC},{MAX_QUEUE},DIGEST,{32 hex digits of the statement digest}
+  +,{MAX_CONC},{MAX_QUEUE},TABLE,{SCHEMA}.{TABLE}
+    means add a new rule, ONLY MAX_CONC statements matching it can run
+    concurrently and at most MAX_QUEUE others wait for them
+
+  -,NUM1,NUM2,NUM3...means delete rules with id NUM1, NUM2 and NUM3..
+*/
+my_bool check_ccl_rule_valid(const char *str)
+{
+  ulonglong num;
+
+  if (!str || str[0] == '\0')
+    return false;
+
+  if (strlen(str) >= SQL_FILTER_STR_LEN)
+    return true;
+
+  if ((str[0] != '-' && str[0] != '+') || str[1] != ',')
+    return true;
+
+  if (str[0] == '-')
+  {
+    const char *pos= str + 2;
+
+    do
+    {
+      const char *start= pos;
+      while (*pos >= '0' && *pos <= '9')
+        pos++;
+      if (pos == start)
+        return true;
+    } while (*pos++ == ',');
+
+    return pos[-1] != '\0';
+  }
+
+  const char *pos= str + 2;
+  if (!(pos= ccl_parse_num(pos, &num)) || !(pos= ccl_parse_num(pos, &num)))
+    return true;
+
+  if (!strncmp(pos, CCL_RULE_TYPE_DIGEST ",",
+               sizeof(CCL_RULE_TYPE_DIGEST)))
+  {
+    pos+= sizeof(CCL_RULE_TYPE_DIGEST);
+    if (strlen(pos) != MD5_HASH_SIZE * 2)
+      return true;
+    for (; *pos; pos++)
+    {
+      if (!my_isxdigit(&my_charset_latin1, *pos))
+        return true;
+    }
+    return false;
+  }
+
+  if (!strncmp(pos, CCL_RULE_TYPE_TABLE ",", sizeof(CCL_RULE_TYPE_TABLE)))
+  {
+    pos+= sizeof(CCL_RULE_TYPE_TABLE);
+    const char *dot= strchr(pos, '.');
+    /* such as "+,1,1,TABLE,t1" or "+,1,1,TABLE,.t1" is unvalid */
+    if (!dot || dot == pos || dot[1] == '\0' || strchr(dot + 1, '.'))
+      return true;
+    return false;
+  }
+
+  return true;
+}
+
+static void free_ccl_rule(ccl_rule *rule)
+{
+  DBUG_ASSERT(rule->ref_count == 0);
+
+  mysql_mutex_destroy(&rule->lock);
+  mysql_cond_destroy(&rule->cond);
+  my_free(rule->db);
+  my_free(rule->table_name);
+  my_free(rule->orig_str);
+  my_free(rule);
+}
+
+/* Create a new rule from a string accepted by check_ccl_rule_valid() */
+static ccl_rule *create_ccl_rule(const char *str)
+{
+  ccl_rule *rule= (ccl_rule *) my_malloc(sizeof(ccl_rule),
+                                         MYF(MY_ZEROFILL));
+
+  DBUG_EXECUTE_IF("create_ccl_rule_error",
+                  {
+                    my_free(rule);
+                    rule= NULL;
+                  };);
+
+  if (rule == NULL)
+    return NULL;
+
+  const char *pos= str + 2;
+  pos= ccl_parse_num(pos, &rule->max_conc);
+  pos= ccl_parse_num(pos, &rule->max_queue);
+
+  if (!strncmp(pos, CCL_RULE_TYPE_DIGEST ",", sizeof(CCL_RULE_TYPE_DIGEST)))
+  {
+    pos+= sizeof(CCL_RULE_TYPE_DIGEST);
+    rule->type= CCL_RULE_DIGEST;
+    for (uint i= 0; i < MD5_HASH_SIZE * 2; i++)
+      rule->digest[i]= my_tolower(&my_charset_latin1, pos[i]);
+  }
+  else
+  {
+    pos+= sizeof(CCL_RULE_TYPE_TABLE);
+    const char *dot= strchr(pos, '.');
+    rule->type= CCL_RULE_TABLE;
+    rule->db= my_strndup(pos, dot - pos, MYF(0));
+    rule->table_name= my_strdup(dot + 1, MYF(0));
+  }
+
+  rule->orig_str= my_strdup(str, MYF(0));
+
+  mysql_mutex_init(key_LOCK_ccl_rule, &rule->lock, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_ccl_rule, &rule->cond, NULL);
+
+  if (!rule->orig_str ||
+      (rule->type == CCL_RULE_TABLE && (!rule->db || !rule->table_name)))
+  {
+    free_ccl_rule(rule);
+    return NULL;
+  }
+
+  rule->id= ++ccl_rule_id;
+
+  return rule;
+}
+
+/*
+  Unlink a rule from the list. The rule is freed now if no statement
+  uses it, otherwise by the last one in ccl_exit(). Statements waiting
+  on it are let through.
+*/
+static void delete_ccl_rule(ccl_rule **prev)
+{
+  ccl_rule *rule= *prev;
+  bool can_free;
+
+  *prev= rule->next;
+  if (rule->type == CCL_RULE_DIGEST)
+    ccl_digest_rule_count--;
+
+  mysql_mutex_lock(&rule->lock);
+  rule->deleted= true;
+  can_free= rule->ref_count == 0;
+  mysql_cond_broadcast(&rule->cond);
+  mysql_mutex_unlock(&rule->lock);
+
+  if (can_free)
+    free_ccl_rule(rule);
+}
+
+/*
+  Called with LOCK_ccl_rules write locked when rds_sql_ccl_rule is set.
+  Returns true if a rule could not be added.
+*/
+my_bool modify_ccl_rules(const char *str)
+{
+  if (!str || str[0] == '\0')
+    return false;
+
+  if (str[0] == '+')
+  {
+    ccl_rule *rule= create_ccl_rule(str);
+    ccl_rule **last= &ccl_rule_list;
+
+    if (rule == NULL)
+      return true;
+
+    while (*last)
+      last= &(*last)->next;
+    *last= rule;
+
+    if (rule->type == CCL_RULE_DIGEST)
+      ccl_digest_rule_count++;
+
+    return false;
+  }
+
+  /* "-,3,5,6" means rules with id 3,5,6 should be removed */
+  const char *pos= str + 1;
+  while (pos != NULL)
+  {
+    ulonglong id= strtoull(++pos, NULL, 10);
+
+    for (ccl_rule **prev= &ccl_rule_list; *prev; prev= &(*prev)->next)
+    {
+      if ((*prev)->id == id)
+      {
+        delete_ccl_rule(prev);
+        break;
+      }
+    }
+
+    pos= strchr(pos, ',');
+  }
+
+  return false;
+}
+
+/* Free all rules at shutdown */
+void free_ccl_rules()
+{
+  while (ccl_rule_list)
+    delete_ccl_rule(&ccl_rule_list);
+}
+
+static bool ccl_rule_match(const ccl_rule *rule, THD *thd,
+                           const char *digest)
+{
+  if (rule->type == CCL_RULE_DIGEST)
+    return digest && !memcmp(rule->digest, digest, MD5_HASH_SIZE * 2);
+
+  for (TABLE_LIST *table= thd->lex->query_tables; table;
+       table= table->next_global)
+  {
+    if (table->db && table->table_name &&
+        !my_strcasecmp(table_alias_charset, table->db, rule->db) &&
+        !my_strcasecmp(table_alias_charset, table->table_name,
+                       rule->table_name))
+      return true;
+  }
+
+  return false;
+}
+
+/* Drop a reference taken in ccl_enter(), with rule->lock held */
+static void ccl_rule_release(ccl_rule *rule)
+{
+  bool can_free;
+
+  mysql_mutex_assert_owner(&rule->lock);
+  rule->ref_count--;
+  can_free= rule->deleted && rule->ref_count == 0;
+  if (rule->wait_head)
+    mysql_cond_broadcast(&rule->cond);
+  mysql_mutex_unlock(&rule->lock);
+
+  if (can_free)
+    free_ccl_rule(rule);
+}
+
+/*
+  Wait in the queue of a rule until the statement may run. Called with
+  rule->lock held, returns with it released.
+
+  @retval false   the statement may run
+  @retval true    the wait timed out or the statement was killed
+*/
+static my_bool ccl_wait(THD *thd, ccl_rule *rule)
+{
+  ccl_waiter waiter;
+  struct timespec abstime;
+  PSI_stage_info old_stage;
+  ulonglong start= my_micro_time();
+  bool timed_out= false;
+  bool admitted;
+
+  waiter.thd= thd;
+  waiter.next= NULL;
+  if (rule->wait_tail)
+    rule->wait_tail->next= &waiter;
+  else
+    rule->wait_head= &waiter;
+  rule->wait_tail= &waiter;
+  rule->waiting++;
+
+  set_timespec(abstime, rds_sql_ccl_wait_timeout);
+  thd->ENTER_COND(&rule->cond, &rule->lock, &stage_waiting_for_ccl_rule,
+                  &old_stage);
+  /* let the thread pool use another worker meanwhile */
+  thd_wait_begin(thd, THD_WAIT_USER_LOCK);
+
+  DEBUG_SYNC(thd, "ccl_wait_in_queue");
+
+  while (!(admitted= rule->deleted ||
+                     (rule->wait_head == &waiter &&
+                      rule->running < rule->max_conc)) &&
+         !thd->killed && !timed_out)
+  {
+    int error= mysql_cond_timedwait(&rule->cond, &rule->lock, &abstime);
+    timed_out= (error == ETIMEDOUT || error == ETIME);
+  }
+
+  thd_wait_end(thd);
+
+  /* unlink from the queue, we may not be the head if we give up */
+  for (ccl_waiter **prev= &rule->wait_head; *prev; prev= &(*prev)->next)
+  {
+    if (*prev == &waiter)
+    {
+      *prev= waiter.next;
+      break;
+    }
+  }
+  rule->wait_tail= NULL;
+  for (ccl_waiter *w= rule->wait_head; w; w= w->next)
+    rule->wait_tail= w;
+
+  rule->waiting--;
+  rule->waits++;
+  rule->wait_time+= my_micro_time() - start;
+
+  if (admitted)
+  {
+    rule->running++;
+    rule->admitted++;
+  }
+  else if (!thd->killed)
+    rule->timeouts++;
+
+  /* the next statement of the queue may run as well */
+  if (rule->wait_head)
+    mysql_cond_broadcast(&rule->cond);
+
+  thd->EXIT_COND(&old_stage);
+
+  if (admitted)
+    return false;
+
+  if (!thd->killed)
+    my_error(ER_CCL_WAIT_TIMEOUT, MYF(0), rule->id);
+
+  /* the reference keeps the rule alive until here */
+  mysql_mutex_lock(&rule->lock);
+  ccl_rule_release(rule);
+
+  return true;
+}
+
+/*
+  Statements inside stored programs are counted by their caller, and the
+  ones applied by a slave are never limited
+*/
+static bool ccl_skip_stmt(THD *thd)
+{
+  return thd->in_sub_stmt || thd->sp_runtime_ctx || thd->slave_thread;
+}
+
+/*
+  Check the statement against the concurrency control rules, waiting in
+  the queue of the first matching rule if it is at its limit.
+
+  @retval false   the statement may run, ccl_exit() must be called after it
+  @retval true    the statement is rejected, an error is set unless the
+                  statement was killed while waiting
+*/
+my_bool ccl_enter(THD *thd)
+{
+  char digest_buf[MD5_HASH_SIZE * 2 + 1];
+  const char *digest= NULL;
+  ccl_rule *rule= NULL;
+
+  if (!ccl_rule_list) //check without lock
+    return false;
+
+  if (ccl_skip_stmt(thd))
+    return false;
+
+  DBUG_ASSERT(thd->ccl_rule == NULL);
+
+  switch (thd->lex->sql_command)
+  {
+    case SQLCOM_SELECT:
+    case SQLCOM_INSERT:
+    case SQLCOM_INSERT_SELECT:
+    case SQLCOM_REPLACE:
+    case SQLCOM_REPLACE_SELECT:
+    case SQLCOM_UPDATE:
+    case SQLCOM_UPDATE_MULTI:
+    case SQLCOM_DELETE:
+    case SQLCOM_DELETE_MULTI:
+      break;
+    default:
+      return false;
+  }
+
+  if (ccl_digest_rule_count && thd->m_digest != NULL &&
+      !thd->m_digest->m_digest_storage.is_empty())
+  {
+    uchar md5[MD5_HASH_SIZE];
+
+    compute_digest_md5(&thd->m_digest->m_digest_storage, md5);
+    array_to_hex(digest_buf, md5, MD5_HASH_SIZE);
+    digest_buf[MD5_HASH_SIZE * 2]= '\0';
+    digest= digest_buf;
+  }
+
+  mysql_rwlock_rdlock(&LOCK_ccl_rules);
+  for (rule= ccl_rule_list; rule; rule= rule->next)
+  {
+    if (ccl_rule_match(rule, thd, digest))
+    {
+      mysql_mutex_lock(&rule->lock);
+      rule->ref_count++;
+      break;
+    }
+  }
+  mysql_rwlock_unlock(&LOCK_ccl_rules);
+
+  if (rule == NULL)
+    return false;
+
+  if (rule->deleted ||
+      (rule->wait_head == NULL && rule->running < rule->max_conc))
+  {
+    rule->running++;
+    rule->admitted++;
+    mysql_mutex_unlock(&rule->lock);
+  }
+  else if (rule->waiting >= rule->max_queue)
+  {
+    ulonglong id= rule->id;
+
+    rule->rejected++;
+    ccl_rule_release(rule);
+    my_error(ER_CCL_QUEUE_FULL, MYF(0), id);
+    return true;
+  }
+  else if (ccl_wait(thd, rule))
+    return true;
+
+  thd->ccl_rule= rule;
+  return false;
+}
+
+/*
+  Called when the statement admitted by ccl_enter() finishes, lets the
+  head of the queue run.
+*/
+void ccl_exit(THD *thd)
+{
+  ccl_rule *rule= thd->ccl_rule;
+
+  /* the slot of the calling statement is kept until it ends */
+  if (rule == NULL || ccl_skip_stmt(thd))
+    return;
+
+  thd->ccl_rule= NULL;
+
+  mysql_mutex_lock(&rule->lock);
+  DBUG_ASSERT(rule->running > 0);
+  rule->running--;
+  ccl_rule_release(rule);
+}
@@ -0,0 +1,67 @@
+
+#ifndef SQL_CCL_INCLUDED
+#define SQL_CCL_INCLUDED
+
+#include "mysqld.h"
+#include "sql_class.h"
+#include "my_md5.h"
+
+/*
+  Statement concurrency control.
+
+  A rule limits the number of statements running concurrently that have a
+  given digest or access a given table. Statements above the limit wait
+  in a bounded FIFO queue until a running one finishes, instead of being
+  rejected; they are rejected only when the queue is full or the wait
+  exceeds rds_sql_ccl_wait_timeout.
+*/
+
+#define CCL_RULE_DIGEST 0
+#define CCL_RULE_TABLE 1
+
+typedef struct ccl_waiter
+{
+  THD *thd;
+  struct ccl_waiter *next;
+} ccl_waiter;
+
+typedef struct ccl_rule
+{
+  ulonglong id; /* an increased value to indicate this rule */
+  uint type; /* CCL_RULE_DIGEST or CCL_RULE_TABLE */
+  char digest[MD5_HASH_SIZE * 2 + 1]; /* hex digest of a DIGEST rule */
+  char *db, *table_name; /* table of a TABLE rule */
+  ulonglong max_conc; /* max statements executed concurrently */
+  ulonglong max_queue; /* max statements waiting */
+  char *orig_str; /* used to print in I_S table */
+
+  mysql_mutex_t lock;
+  mysql_cond_t cond; /* signalled when the head of the queue may run */
+
+  /* protected by lock */
+  ulonglong running;
+  ulonglong waiting;
+  ccl_waiter *wait_head, *wait_tail; /* FIFO of waiting statements */
+  ulonglong admitted; /* statements that ran, after waiting or not */
+  ulonglong rejected; /* statements rejected because the queue was full */
+  ulonglong timeouts; /* statements that waited too long */
+  ulonglong waits; /* statements that had to wait */
+  ulonglong wait_time; /* total wait time of those, in microseconds */
+  uint ref_count; /* statements running or waiting on this rule */
+  bool deleted; /* removed from the list, freed by the last user */
+
+  struct ccl_rule *next;
+} ccl_rule;
+
+extern ccl_rule *ccl_rule_list;
+extern uint ccl_digest_rule_count;
+extern char *rds_sql_ccl_rule;
+extern ulong rds_sql_ccl_wait_timeout;
+
+my_bool check_ccl_rule_valid(const char *str);
+my_bool modify_ccl_rules(const char *str);
+void free_ccl_rules();
+my_bool ccl_enter(THD *thd);
+void ccl_exit(THD *thd);
+
+#endif /* SQL_CCL_INCLUDED */
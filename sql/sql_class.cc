@@ -36,6 +36,7 @@
 #include "sql_base.h"                         // close_temporary_tables
 #include "sql_handler.h"                      // mysql_ha_cleanup
 #include "rpl_rli.h"
+#include "rpl_rli_pdb.h"
 #include "rpl_filter.h"
 #include "rpl_record.h"
 #include "rpl_slave.h"
@@ -804,6 +805,23 @@ void thd_store_lsn(THD* thd, ulonglong lsn, int engine_type)
   thd->prepared_engine->update_lsn(engine_type, lsn);
 }
 
+/**
+  Called by a storage engine when the transaction of @c thd has to wait
+  for a row lock held by the transaction of @c wait_for, so that slave
+  Workers preserving the commit order can break the wait of an earlier
+  group for a later one.
+*/
+extern "C"
+void thd_report_row_lock_wait(THD* thd, THD* wait_for)
+{
+#if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
+  if (thd != NULL && wait_for != NULL &&
+      is_mts_worker(thd) && is_mts_worker(wait_for))
+    static_cast<Slave_worker*>(thd->rli_slave)->report_commit_order_wait(
+      static_cast<Slave_worker*>(wait_for->rli_slave));
+#endif
+}
+
 /**
   Dumps a text description of a thread, its security context
   (user, host) and the current query.
@@ -903,14 +921,192 @@ char *thd_security_context(THD *thd, char *buffer, unsigned int length,
 st_ic_hash_item::st_ic_hash_item()
 {
   left_thread_num= 0;
+  key_len= 0;
+  partition= 0;
+  next_free= NULL;
+  batch_leader= NULL;
+  batch_size= 0;
+  batch_head= batch_tail= NULL;
   pthread_mutex_init(&queue_lock, NULL);
   pthread_mutex_init(&execute_lock, NULL);
+  pthread_cond_init(&batch_cond, NULL);
 }
 
 st_ic_hash_item::~st_ic_hash_item()
 {
+  DBUG_ASSERT(batch_head == NULL);
   (void) pthread_mutex_destroy(&queue_lock);
   (void) pthread_mutex_destroy(&execute_lock);
+  (void) pthread_cond_destroy(&batch_cond);
+}
+
+ic_gather_partition_t ic_gather_partitions[IC_GATHER_HASH_PARTITIONS];
+static bool ic_gather_hash_inited= false;
+
+static uchar *ic_hash_item_get_key(const uchar *record, size_t *length,
+                                   my_bool not_used __attribute__((unused)))
+{
+  ic_hash_item_t *entry= (ic_hash_item_t*) record;
+  *length= entry->key_len;
+  return (uchar*) entry->key;
+}
+
+void ic_gather_hash_init()
+{
+  for (uint i= 0; i < IC_GATHER_HASH_PARTITIONS; i++)
+  {
+    ic_gather_partition_t *part= &ic_gather_partitions[i];
+
+    (void) my_hash_init(&part->hash, &my_charset_bin, 64, 0, 0,
+                        (my_hash_get_key) ic_hash_item_get_key, 0, MYF(0));
+    pthread_mutex_init(&part->lock, NULL);
+    part->free_items= NULL;
+    part->n_free= 0;
+    part->lookups= 0;
+    part->queue_waits= 0;
+    part->lock_waits= 0;
+  }
+  ic_gather_hash_inited= true;
+}
+
+void ic_gather_hash_free()
+{
+  if (!ic_gather_hash_inited)
+    return;
+
+  for (uint i= 0; i < IC_GATHER_HASH_PARTITIONS; i++)
+  {
+    ic_gather_partition_t *part= &ic_gather_partitions[i];
+
+    for (ulong j= 0; j < part->hash.records; j++)
+      delete (ic_hash_item_t*) my_hash_element(&part->hash, j);
+    my_hash_free(&part->hash);
+
+    while (part->free_items)
+    {
+      ic_hash_item_t *item= part->free_items;
+      part->free_items= item->next_free;
+      delete item;
+    }
+    part->n_free= 0;
+
+    pthread_mutex_destroy(&part->lock);
+  }
+  ic_gather_hash_inited= false;
+}
+
+static inline void ic_gather_partition_lock(ic_gather_partition_t *part)
+{
+  if (pthread_mutex_trylock(&part->lock))
+  {
+    pthread_mutex_lock(&part->lock);
+    part->lock_waits++;
+  }
+}
+
+/*
+   Find or create the queue item of a row and take a reference on it.
+   Returns with item->queue_lock held.
+*/
+ic_hash_item_t *ic_hash_item_acquire(const char *key, size_t key_len)
+{
+  ic_gather_partition_t *part;
+  ic_hash_item_t *item;
+  my_hash_value_type hash_value;
+
+  DBUG_ASSERT(key_len < IC_HASH_KEY_SIZE);
+
+  hash_value= my_calc_hash(&ic_gather_partitions[0].hash,
+                           (const uchar*) key, key_len);
+  part= &ic_gather_partitions[hash_value >>
+                              (sizeof(hash_value) * 8 -
+                               IC_GATHER_HASH_PARTITION_BITS)];
+
+  ic_gather_partition_lock(part);
+  part->lookups++;
+
+  item= (ic_hash_item_t*) my_hash_search_using_hash_value(&part->hash,
+                                                          hash_value,
+                                                          (const uchar*) key,
+                                                          key_len);
+  if (!item)
+  {
+    if ((item= part->free_items))
+    {
+      part->free_items= item->next_free;
+      part->n_free--;
+      item->next_free= NULL;
+    }
+    else
+    {
+      item= new ic_hash_item_t;
+      item->partition= (uint) (part - ic_gather_partitions);
+    }
+
+    memcpy(item->key, key, key_len);
+    item->key_len= key_len;
+    my_hash_insert(&part->hash, (const uchar*) item);
+  }
+
+  pthread_mutex_lock(&item->queue_lock);
+  if (item->left_thread_num)
+    part->queue_waits++;
+  pthread_mutex_unlock(&part->lock);
+
+  item->left_thread_num++;
+
+  return item;
+}
+
+/*
+   Drop one reference to a queue item, removing the item from its
+   partition when no session uses it any more.
+*/
+void ic_hash_item_release(THD *thd, ic_hash_item_t *item)
+{
+  ic_gather_partition_t *part= &ic_gather_partitions[item->partition];
+
+  pthread_mutex_lock(&item->queue_lock);
+
+  if (item->left_thread_num > 1)
+  {
+    item->left_thread_num--;
+    pthread_mutex_unlock(&item->queue_lock);
+    return;
+  }
+
+  DBUG_ASSERT(item->left_thread_num == 1);
+  pthread_mutex_unlock(&item->queue_lock);
+
+  DEBUG_SYNC(thd, "after_unlock_queue_lock_in_unregist");
+
+  ic_gather_partition_lock(part);
+  pthread_mutex_lock(&item->queue_lock);
+
+  item->left_thread_num--;
+
+  if (item->left_thread_num == 0)
+  {
+    pthread_mutex_unlock(&item->queue_lock);
+    my_hash_delete(&part->hash, (uchar*) item);
+
+    if (part->n_free < IC_GATHER_POOL_SIZE)
+    {
+      item->next_free= part->free_items;
+      part->free_items= item;
+      part->n_free++;
+      item= NULL;
+    }
+  }
+  else
+  {
+    pthread_mutex_unlock(&item->queue_lock);
+    item= NULL;
+  }
+
+  pthread_mutex_unlock(&part->lock);
+
+  delete item;
 }
 
 /**
@@ -1000,6 +1196,7 @@ THD::THD(bool enable_plugins)
    m_idle_psi(NULL),
    m_server_idle(false),
    next_to_commit(NULL),
+   binlog_sequence_number(0),
    is_fatal_error(0),
    transaction_rollback_request(0),
    is_fatal_sub_stmt_error(false),
@@ -1022,6 +1219,9 @@ THD::THD(bool enable_plugins)
   ulong tmp;
 
   execute_item= NULL;
+  ic_batch_item= NULL;
+  ic_batch_running= false;
+  ccl_rule= NULL;
 
   mdl_context.init(this);
   status_var.memory_used= 0;
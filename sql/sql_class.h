@@ -62,6 +62,9 @@ const char *set_thd_proc_info(void *thd_arg, const char *info,
 extern "C"
 void thd_store_lsn(THD* thd, ulonglong lsn, int engine_type);
 
+extern "C"
+void thd_report_row_lock_wait(THD* thd, THD* wait_for);
+
 #define thd_proc_info(thd, msg) \
   set_thd_proc_info(thd, msg, __func__, __FILE__, __LINE__)
 
@@ -110,7 +113,9 @@ enum enum_slave_rows_search_algorithms { SLAVE_ROWS_TABLE_SCAN = (1U << 0),
                                          SLAVE_ROWS_INDEX_SCAN = (1U << 1),
                                          SLAVE_ROWS_HASH_SCAN  = (1U << 2)};
 enum enum_slave_pr_mode { SLAVE_PR_MODE_SCHEMA,
-                          SLAVE_PR_MODE_TABLE };
+                          SLAVE_PR_MODE_TABLE,
+                          SLAVE_PR_MODE_WRITESET,
+                          SLAVE_PR_MODE_LOGICAL_CLOCK };
 
 enum enum_mark_columns
 { MARK_COLUMNS_NONE, MARK_COLUMNS_READ, MARK_COLUMNS_WRITE};
@@ -2139,20 +2144,83 @@ my_micro_time_to_timeval(ulonglong micro_time, struct timeval *tm)
   tm->tv_usec= (long) (micro_time % 1000000);
 }
 
+#define IC_HASH_KEY_SIZE (2*NAME_CHAR_LEN + 10)
+
+/**
+  A QUEUE_ON_PK statement handed over to the session that is executing
+  statements on the same row (the batch leader). The leader executes it in
+  its own transaction and reports the result back.
+*/
+typedef struct st_ic_batch_request
+{
+  THD *thd;                     /* session that sent the statement */
+  THD *leader;                  /* session that will execute it */
+  char *query;
+  size_t query_length;
+
+  /* Result, valid once done is set by the leader under queue_lock. */
+  bool done;
+  uint sql_errno;               /* 0 if the statement succeeded */
+  ulonglong affected_rows;
+  char message[MYSQL_ERRMSG_SIZE];
+
+  struct st_ic_batch_request *next;
+}ic_batch_request_t;
+
 typedef struct st_ic_hash_item
 {
   pthread_mutex_t queue_lock, execute_lock;
+  pthread_cond_t batch_cond;    /* signalled when a batch is finished */
 
   uint left_thread_num;
 
+  /* Batching state, protected by queue_lock. */
+  THD *batch_leader;            /* session accepting requests, or NULL */
+  uint batch_size;              /* statements in the leader's batch */
+  ic_batch_request_t *batch_head, *batch_tail;
+
   size_t key_len;
-  char key[2*NAME_CHAR_LEN + 10];
+  char key[IC_HASH_KEY_SIZE];
+
+  uint partition;               /* index in ic_gather_partitions */
+  struct st_ic_hash_item *next_free; /* next item in the partition pool */
 
   st_ic_hash_item();
   ~st_ic_hash_item();
 
 }ic_hash_item_t;
 
+/*
+  ic_gather_hash is split into partitions by the hash value of the key, each
+  with its own lock, so that hinted statements on different rows rarely
+  contend. Items removed from a partition are kept in a small pool and
+  reused. The partition is taken from the high bits of the hash value,
+  the hash of the partition uses the low bits to pick a bucket.
+*/
+#define IC_GATHER_HASH_PARTITION_BITS 6
+#define IC_GATHER_HASH_PARTITIONS (1U << IC_GATHER_HASH_PARTITION_BITS)
+#define IC_GATHER_POOL_SIZE 32
+
+typedef struct st_ic_gather_partition
+{
+  pthread_mutex_t lock;
+  HASH hash;                    /* rows that sessions are queued on */
+  ic_hash_item_t *free_items;   /* pool of unused items */
+  uint n_free;
+
+  /* Statistics, protected by lock */
+  ulonglong lookups;            /* items acquired */
+  ulonglong queue_waits;        /* acquires finding the row in use */
+  ulonglong lock_waits;         /* times lock was contended */
+}ic_gather_partition_t;
+
+extern ic_gather_partition_t ic_gather_partitions[IC_GATHER_HASH_PARTITIONS];
+
+void ic_gather_hash_init();
+void ic_gather_hash_free();
+ic_hash_item_t *ic_hash_item_acquire(const char *key, size_t key_len);
+void ic_hash_item_release(THD *thd, ic_hash_item_t *item);
+
 /**
   @class THD
   For each client connection we create a separate thread with THD serving as
@@ -2286,6 +2354,12 @@ public:
   const char *proc_info;
   bool trx_end_by_hint;
   ic_hash_item_t *execute_item;
+  /* Item on which this session leads a batch of QUEUE_ON_PK statements */
+  ic_hash_item_t *ic_batch_item;
+  /* True while this session executes statements of its batch followers */
+  bool ic_batch_running;
+  /* Concurrency control rule admitting the running statement */
+  struct ccl_rule *ccl_rule;
 
 private:
   unsigned int m_current_stage_key;
@@ -3129,6 +3203,12 @@ public:
   /* The previous node of commit queue for binary log group commit */
   THD *prev_to_commit;
 
+  /*
+    Highest sequence_number given by MYSQL_BIN_LOG to the Gtid events of
+    the transaction being committed, see Gtid_log_event::set_logical_clock.
+  */
+  ulonglong binlog_sequence_number;
+
   /*stage leader of group commit if true*/
   bool	stage_leader;
   /*if this thread is a leader, then allocate a mysql_cond_t for it*/
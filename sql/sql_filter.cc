@@ -1,5 +1,6 @@
 
 #include "sql_filter.h"
+#include "sql_digest.h"
 
 /*
   lists bellow are used to store all filter items,
@@ -10,12 +11,20 @@ LIST *select_filter_list= NULL;
 LIST *update_filter_list= NULL;
 LIST *delete_filter_list= NULL;
 
+/* compiled keys of the lists above, NULL if a list is empty */
+filter_matcher *select_filter_matcher= NULL;
+filter_matcher *update_filter_matcher= NULL;
+filter_matcher *delete_filter_matcher= NULL;
+
 /* if true, then the key words in filter item should
   be compared in order */
 my_bool rds_key_cmp_in_order= false;
 
 my_bool rds_reset_all_filter= false;
 
+/* if true, then keys are matched against the statement digest text */
+my_bool rds_filter_match_digest= false;
+
 /* an increased value to incicate a filter item */
 static int filter_item_id= 0;
 #define SQL_FILTER_SPLIT '~'
@@ -301,47 +310,391 @@ void reset_filter_list(LIST *filter_list)
   }
 }
 
+/*
+  Aho-Corasick automaton over the keys of a filter list.
+
+  State 0 is the root. Children of a state are kept in a singly linked
+  edge list, the root has a direct lookup table since most bytes of a
+  statement are consumed there. Identical keys share one pattern id.
+*/
+typedef struct filter_ac_edge
+{
+  uint to;
+  uint next; /* next edge of the same state, 0 if none */
+  uchar c;
+} filter_ac_edge;
+
+typedef struct filter_ac_state
+{
+  uint first_edge; /* 0 if none, edge 0 is unused */
+  uint fail; /* longest proper suffix that is also a state */
+  uint dict; /* nearest state on the fail chain ending a key, 0 if none */
+  int pattern; /* key ending in this state, -1 if none */
+} filter_ac_state;
+
+struct filter_matcher
+{
+  filter_ac_state *states;
+  uint n_states;
+  filter_ac_edge *edges;
+  uint n_edges;
+  uint root[256]; /* transitions of the root */
+  uint n_patterns;
+
+  /* items in list order, with the pattern ids of their keys */
+  uint n_items;
+  filter_item **items;
+  uint **item_patterns;
+};
+
+/* patterns tracked on the stack while matching, more need a heap buffer */
+#define FILTER_MATCH_STACK_PATTERNS 4096
+
+static uint filter_ac_child(const filter_matcher *matcher, uint state,
+                            uchar c)
+{
+  if (state == 0)
+    return matcher->root[c];
+
+  for (uint e= matcher->states[state].first_edge; e;
+       e= matcher->edges[e].next)
+  {
+    if (matcher->edges[e].c == c)
+      return matcher->edges[e].to;
+  }
+
+  return 0;
+}
+
+/* Add a key to the trie, returns its pattern id */
+static uint filter_ac_add_key(filter_matcher *matcher, const char *key)
+{
+  uint state= 0;
+
+  for (const uchar *p= (const uchar*) key; *p; p++)
+  {
+    uint next= filter_ac_child(matcher, state, *p);
+
+    if (next == 0)
+    {
+      next= matcher->n_states++;
+      matcher->states[next].first_edge= 0;
+      matcher->states[next].fail= 0;
+      matcher->states[next].dict= 0;
+      matcher->states[next].pattern= -1;
+
+      if (state == 0)
+        matcher->root[*p]= next;
+      else
+      {
+        uint e= matcher->n_edges++;
+        matcher->edges[e].to= next;
+        matcher->edges[e].c= *p;
+        matcher->edges[e].next= matcher->states[state].first_edge;
+        matcher->states[state].first_edge= e;
+      }
+    }
+
+    state= next;
+  }
+
+  if (matcher->states[state].pattern < 0)
+    matcher->states[state].pattern= matcher->n_patterns++;
+
+  return matcher->states[state].pattern;
+}
+
+/* Compute failure and dictionary links, breadth first */
+static void filter_ac_link(filter_matcher *matcher, uint *queue)
+{
+  uint head= 0, tail= 0;
+
+  for (uint c= 0; c < 256; c++)
+  {
+    if (matcher->root[c])
+      queue[tail++]= matcher->root[c];
+  }
+
+  while (head < tail)
+  {
+    uint state= queue[head++];
+
+    for (uint e= matcher->states[state].first_edge; e;
+         e= matcher->edges[e].next)
+    {
+      uint child= matcher->edges[e].to;
+      uint fail= matcher->states[state].fail;
+      uint target;
+
+      while (fail && !filter_ac_child(matcher, fail, matcher->edges[e].c))
+        fail= matcher->states[fail].fail;
+      target= filter_ac_child(matcher, fail, matcher->edges[e].c);
+
+      matcher->states[child].fail= target;
+      matcher->states[child].dict= matcher->states[target].pattern >= 0 ?
+                                   target : matcher->states[target].dict;
+      queue[tail++]= child;
+    }
+  }
+}
+
+void free_filter_matcher(filter_matcher *matcher)
+{
+  if (matcher == NULL)
+    return;
+
+  my_free(matcher->states);
+  my_free(matcher->edges);
+  my_free(matcher->items);
+  if (matcher->item_patterns)
+  {
+    for (uint i= 0; i < matcher->n_items; i++)
+      my_free(matcher->item_patterns[i]);
+    my_free(matcher->item_patterns);
+  }
+  my_free(matcher);
+}
+
+/*
+  Compile the keys of a filter list, returns NULL if the list is empty or
+  memory could not be allocated, matching then walks the list.
+*/
+filter_matcher *create_filter_matcher(LIST *filter_list)
+{
+  filter_matcher *matcher;
+  uint *queue= NULL;
+  uint n_items= 0;
+  size_t key_bytes= 0;
+  uint i;
+
+  for (LIST *node= filter_list; node; node= node->next)
+  {
+    filter_item *item= (filter_item *) node->data;
+    for (int k= 0; k < item->key_num; k++)
+      key_bytes+= strlen(item->key_array[k]);
+    n_items++;
+  }
+
+  if (n_items == 0)
+    return NULL;
+
+  matcher= (filter_matcher *) my_malloc(sizeof(filter_matcher),
+                                        MYF(MY_ZEROFILL));
+
+  DBUG_EXECUTE_IF("create_filter_matcher_error",
+                  {
+                    my_free(matcher);
+                    matcher= NULL;
+                  };);
+
+  if (matcher == NULL)
+    return NULL;
+
+  /* every key byte adds at most one state and one edge */
+  matcher->states= (filter_ac_state *) my_malloc((key_bytes + 1) *
+                                                 sizeof(filter_ac_state),
+                                                 MYF(0));
+  matcher->edges= (filter_ac_edge *) my_malloc((key_bytes + 1) *
+                                               sizeof(filter_ac_edge),
+                                               MYF(0));
+  matcher->items= (filter_item **) my_malloc(n_items * sizeof(filter_item *),
+                                             MYF(0));
+  matcher->item_patterns= (uint **) my_malloc(n_items * sizeof(uint *),
+                                              MYF(MY_ZEROFILL));
+  queue= (uint *) my_malloc((key_bytes + 1) * sizeof(uint), MYF(0));
+
+  if (!matcher->states || !matcher->edges || !matcher->items ||
+      !matcher->item_patterns || !queue)
+    goto error;
+
+  matcher->n_states= 1;
+  matcher->n_edges= 1;
+  matcher->states[0].first_edge= 0;
+  matcher->states[0].fail= 0;
+  matcher->states[0].dict= 0;
+  matcher->states[0].pattern= -1;
+
+  i= 0;
+  for (LIST *node= filter_list; node; node= node->next, i++)
+  {
+    filter_item *item= (filter_item *) node->data;
+
+    matcher->items[i]= item;
+    matcher->item_patterns[i]= (uint *) my_malloc(item->key_num *
+                                                  sizeof(uint), MYF(0));
+    matcher->n_items= i + 1;
+    if (!matcher->item_patterns[i])
+      goto error;
+
+    for (int k= 0; k < item->key_num; k++)
+      matcher->item_patterns[i][k]= filter_ac_add_key(matcher,
+                                                      item->key_array[k]);
+  }
+
+  filter_ac_link(matcher, queue);
+  my_free(queue);
+
+  return matcher;
+
+error:
+  my_free(queue);
+  free_filter_matcher(matcher);
+  return NULL;
+}
+
+/*
+  Replace the compiled matcher of a list after the list changed.
+  Called with LOCK_filter_list write locked.
+*/
+void refresh_filter_matcher(filter_matcher **matcher, LIST *filter_list)
+{
+  filter_matcher *old_matcher= *matcher;
+
+  *matcher= create_filter_matcher(filter_list);
+  free_filter_matcher(old_matcher);
+}
+
+/*
+  Check if all keys of item occur in sql, in order of the keys if in_order
+*/
+static my_bool filter_item_match(filter_item *item, const char *sql,
+                                 my_bool in_order)
+{
+  const char *pos= sql;
+
+  for (int i= 0; i < item->key_num; i++)
+  {
+    pos= strstr(pos, item->key_array[i]);
+    if (!pos)
+      return false;
+
+    if (!in_order)
+      pos= sql;
+    else
+      pos= pos + strlen(item->key_array[i]);
+  }
+
+  return true;
+}
+
+/*
+  Find the first item of the compiled list whose keys all occur in sql.
+  The statement is scanned once, recording which keys occur; keys that
+  must appear in order are then checked for the candidate items only.
+  Falls back to matching each item in turn if the key set can't be
+  allocated, so a failure never disables the filter.
+*/
+static filter_item *filter_matcher_find(const filter_matcher *matcher,
+                                        const char *sql, my_bool in_order)
+{
+  uchar seen_buf[FILTER_MATCH_STACK_PATTERNS / 8];
+  uchar *seen= seen_buf;
+  size_t seen_size= (matcher->n_patterns + 7) / 8;
+  filter_item *found= NULL;
+  uint state= 0;
+
+  if (matcher->n_patterns > FILTER_MATCH_STACK_PATTERNS)
+  {
+    seen= (uchar *) my_malloc(seen_size, MYF(0));
+    if (!seen)
+    {
+      /* out of memory: check the items one by one like the list does */
+      for (uint i= 0; i < matcher->n_items; i++)
+        if (filter_item_match(matcher->items[i], sql, in_order))
+          return matcher->items[i];
+      return NULL;
+    }
+  }
+  memset(seen, 0, seen_size);
+
+  /* stop at the first NUL like strstr() does */
+  for (const uchar *p= (const uchar *) sql; *p; p++)
+  {
+    uint next= 0;
+
+    while (state && !(next= filter_ac_child(matcher, state, *p)))
+      state= matcher->states[state].fail;
+
+    if (state == 0)
+      next= matcher->root[*p];
+
+    state= next;
+
+    for (uint o= matcher->states[state].pattern >= 0 ?
+                 state : matcher->states[state].dict;
+         o; o= matcher->states[o].dict)
+    {
+      uint pattern= matcher->states[o].pattern;
+      seen[pattern / 8]|= (uchar) (1 << (pattern % 8));
+    }
+  }
+
+  for (uint i= 0; i < matcher->n_items && !found; i++)
+  {
+    filter_item *item= matcher->items[i];
+    int k;
+
+    for (k= 0; k < item->key_num; k++)
+    {
+      uint pattern= matcher->item_patterns[i][k];
+      if (!(seen[pattern / 8] & (1 << (pattern % 8))))
+        break;
+    }
+
+    if (k == item->key_num &&
+        (!in_order || item->key_num == 1 ||
+         filter_item_match(item, sql, in_order)))
+      found= item;
+  }
+
+  if (seen != seen_buf)
+    my_free(seen);
+
+  return found;
+}
+
 /*
   Check if there are any filter matches the SQL and update the cur_conc of the matched filter item
 */
-my_bool find_matched_filter_and_update(LIST *filter_list, THD *thd)
+my_bool find_matched_filter_and_update(LIST *filter_list,
+                                       filter_matcher *matcher, THD *thd)
 {
   char *sql= thd->query();
-  
+  String digest_text;
+
   DBUG_ASSERT(sql);
 
-  char *pos= NULL;
   filter_item *item= NULL;
 
   my_bool in_order= rds_key_cmp_in_order;
 
-  while (filter_list != NULL)
+  /* match the normalized text if the parser computed a digest */
+  if (rds_filter_match_digest && thd->m_digest != NULL &&
+      !thd->m_digest->m_digest_storage.is_empty())
   {
-    int i=0;
-    item= (filter_item*) filter_list->data;
+    compute_digest_text(&thd->m_digest->m_digest_storage, &digest_text);
+    sql= digest_text.c_ptr_safe();
+  }
 
-    pos= sql;
-    while (i < item->key_num)
+  if (matcher)
+    item= filter_matcher_find(matcher, sql, in_order);
+  else
+  {
+    while (filter_list != NULL)
     {
-      pos= strstr(pos, item->key_array[i]);
-      if (!pos)
-        break;
+      item= (filter_item*) filter_list->data;
 
-      if (!in_order)
-        pos= sql;
-      else
-        pos= pos + strlen(item->key_array[i]);
+      if (filter_item_match(item, sql, in_order)) //all key matches
+        break;
 
-      i++;
+      filter_list= filter_list->next;
     }
 
-    if (i == item->key_num) //all key matches
-      break;
-
-    filter_list= filter_list->next;
-  } 
+    if (filter_list == NULL)
+      item= NULL;
+  }
 
-  if (filter_list == NULL) //no matched item
+  if (item == NULL) //no matched item
     return false;
 
   /*
@@ -386,7 +739,8 @@ my_bool need_traffic_control(THD *thd, uint command)
           {
             sleep(2);
           };);
-      ret= find_matched_filter_and_update(select_filter_list, thd);
+      ret= find_matched_filter_and_update(select_filter_list,
+                                           select_filter_matcher, thd);
       mysql_rwlock_unlock(&LOCK_filter_list);
       break;
 
@@ -396,7 +750,8 @@ my_bool need_traffic_control(THD *thd, uint command)
           break;
 
         mysql_rwlock_rdlock(&LOCK_filter_list);
-        ret= find_matched_filter_and_update(update_filter_list, thd);
+        ret= find_matched_filter_and_update(update_filter_list,
+                                             update_filter_matcher, thd);
         mysql_rwlock_unlock(&LOCK_filter_list);
         break;
 
@@ -406,7 +761,8 @@ my_bool need_traffic_control(THD *thd, uint command)
           break;
 
         mysql_rwlock_rdlock(&LOCK_filter_list);
-        ret= find_matched_filter_and_update(delete_filter_list, thd);
+        ret= find_matched_filter_and_update(delete_filter_list,
+                                             delete_filter_matcher, thd);
         mysql_rwlock_unlock(&LOCK_filter_list);
         break;
 
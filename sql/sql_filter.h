@@ -19,11 +19,22 @@ typedef struct filter_item
   char *orig_str; /* used to print in I_S table */
 } filter_item;
 
+/*
+  Keys of all items of a filter list compiled into one Aho-Corasick
+  automaton, so that a statement is scanned once whatever the number of
+  items. Rebuilt when the list changes, under LOCK_filter_list.
+*/
+typedef struct filter_matcher filter_matcher;
+
 extern LIST *select_filter_list;
 extern LIST *update_filter_list;
 extern LIST *delete_filter_list;
+extern filter_matcher *select_filter_matcher;
+extern filter_matcher *update_filter_matcher;
+extern filter_matcher *delete_filter_matcher;
 extern my_bool rds_key_cmp_in_order;
 extern my_bool rds_reset_all_filter;
+extern my_bool rds_filter_match_digest;
 
 my_bool need_traffic_control(THD *thd, uint command);
 my_bool check_sql_filter_valid(const char *str);
@@ -31,6 +42,7 @@ LIST *add_filter_item(LIST *filter_list, char *item_str);
 LIST *delete_filter_item(LIST *filter_list, const char *item_str);
 void reset_filter_list(LIST *filter_list);
 void dec_filter_item_conc(THD *thd, uint command);
+void refresh_filter_matcher(filter_matcher **matcher, LIST *filter_list);
 
 #endif /* SQL_FILTER_INCLUDED */
 
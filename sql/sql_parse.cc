@@ -102,6 +102,7 @@
 #include "table_cache.h" // table_cache_manager
 
 #include "sql_filter.h"
+#include "sql_ccl.h"
 #include "rpl_gtid.h" // set executed_gtid_set
 #include "sql_digest.h"
 #include "threadpool.h"
@@ -131,6 +132,7 @@ static bool execute_sqlcom_select(THD *thd, TABLE_LIST *all_tables);
 static bool check_show_access(THD *thd, TABLE_LIST *table);
 static void sql_kill(THD *thd, ulong id, bool only_kill_query);
 static bool lock_tables_precheck(THD *thd, TABLE_LIST *tables);
+static void ic_batch_execute(THD *thd);
 
 const char *any_db="*any*";	// Special symbol for check_access
 
@@ -1418,6 +1420,10 @@ bool dispatch_command(enum enum_server_command command, THD *thd,
     if (parser_state.init(thd, thd->query(), thd->query_length()))
       break;
 
+    /* SQL filters and concurrency control rules may match the digest */
+    parser_state.m_input.m_compute_digest= rds_filter_match_digest ||
+                                           ccl_digest_rule_count > 0;
+
     mysql_parse(thd, thd->query(), thd->query_length(), &parser_state);
 
     while (!thd->killed && (parser_state.m_lip.found_semicolon != NULL) &&
@@ -2111,6 +2117,8 @@ int prepare_schema_table(THD *thd, LEX *lex, Table_ident *table_ident,
   case SCH_TABLE_CONSTRAINTS:
   case SCH_KEY_COLUMN_USAGE:
   case SCH_SQL_FILTER_INFO:
+  case SCH_SQL_CCL_INFO:
+  case SCH_IC_REDUCE_PARTITIONS:
   default:
     break;
   }
@@ -2350,17 +2358,133 @@ err:
   return TRUE;
 }
 
+/**
+  Check if a QUEUE_ON_PK statement may be executed by a batch leader on
+  behalf of its session: a plain-text autocommit single-table UPDATE with
+  COMMIT_ON_SUCCESS whose result does not depend on session state.
+
+  @param thd                    Thread handler
+  @param lex                    LEX of the statement
+*/
+static bool ic_batch_stmt_eligible(THD *thd, LEX *lex)
+{
+  return ic_reduce_batch_size > 1 &&
+         lex->sql_command == SQLCOM_UPDATE &&
+         lex->ci_on_success &&
+         lex->safe_to_cache_query &&
+         lex->query_tables->next_global == NULL &&
+         thd->get_command() == COM_QUERY &&
+         thd->stmt_arena->is_conventional() &&
+         !thd->in_sub_stmt &&
+         !thd->sp_runtime_ctx &&
+         !thd->locked_tables_mode &&
+         !thd->in_multi_stmt_transaction_mode() &&
+         thd->variables.gtid_next.type == AUTOMATIC_GROUP;
+}
+
+static inline bool ic_batch_str_equal(const char *a, const char *b)
+{
+  return a == b || (a && b && !strcmp(a, b));
+}
+
+/**
+  Check if the leader can execute a statement of another session with the
+  same privileges and the same session settings that session would use.
+
+  @param leader                 Session leading the batch
+  @param thd                    Session that sent the statement
+*/
+static bool ic_batch_compatible(THD *leader, THD *thd)
+{
+  const Security_context *lctx= leader->security_ctx;
+  const Security_context *sctx= thd->security_ctx;
+  const ulonglong options= OPTION_BIN_LOG | OPTION_NO_FOREIGN_KEY_CHECKS |
+                           OPTION_RELAXED_UNIQUE_CHECKS;
+
+  return ic_batch_str_equal(lctx->priv_user, sctx->priv_user) &&
+         ic_batch_str_equal(lctx->priv_host, sctx->priv_host) &&
+         ic_batch_str_equal(leader->db, thd->db) &&
+         leader->variables.sql_mode == thd->variables.sql_mode &&
+         leader->variables.character_set_client ==
+           thd->variables.character_set_client &&
+         leader->variables.collation_connection ==
+           thd->variables.collation_connection &&
+         leader->variables.time_zone == thd->variables.time_zone &&
+         leader->variables.binlog_format == thd->variables.binlog_format &&
+         leader->variables.tx_isolation == thd->variables.tx_isolation &&
+         (leader->variables.option_bits & options) ==
+           (thd->variables.option_bits & options) &&
+         (leader->client_capabilities & CLIENT_FOUND_ROWS) ==
+           (thd->client_capabilities & CLIENT_FOUND_ROWS);
+}
+
+/**
+  Hand a statement over to the batch leader of the row and wait until the
+  leader has executed and committed it. Called with item->queue_lock held,
+  returns with it released.
+
+  @param thd                    Thread handler
+  @param item                   Queue item of the row
+*/
+static void ic_batch_follow(THD *thd, ic_hash_item_t *item)
+{
+  ic_batch_request_t request;
+  PSI_stage_info old_stage;
+
+  request.thd= thd;
+  request.leader= item->batch_leader;
+  request.query= thd->query();
+  request.query_length= thd->query_length();
+  request.done= false;
+  request.sql_errno= 0;
+  request.affected_rows= 0;
+  request.message[0]= '\0';
+  request.next= NULL;
+
+  if (item->batch_tail)
+    item->batch_tail->next= &request;
+  else
+    item->batch_head= &request;
+  item->batch_tail= &request;
+  item->batch_size++;
+
+  /*
+    The leader always finishes the batch, so the wait is not interruptible:
+    the statement may already be committed when KILL arrives.
+  */
+  thd->enter_stage(&stage_waiting_for_ic_batch_leader, &old_stage,
+                   __func__, __FILE__, __LINE__);
+  while (!request.done)
+    pthread_cond_wait(&item->batch_cond, &item->queue_lock);
+  pthread_mutex_unlock(&item->queue_lock);
+  THD_STAGE_INFO(thd, old_stage);
+
+  ic_hash_item_release(thd, item);
+
+  thd->trx_end_by_hint= TRUE;
+
+  if (request.sql_errno)
+    my_message(request.sql_errno, request.message, MYF(0));
+  else
+    my_ok(thd, request.affected_rows, 0, request.message);
+}
+
 /**
   Check if need to wait on pk, and waitting.
 
   @param thd                    Thread handler
   @param all_tables             global table list of query
   @param lex                    LEX for SELECT statement.
+
+  @retval false                 The statement must be executed by the caller
+  @retval true                  The statement was executed and committed by
+                                the batch leader of the row; its result is
+                                in the diagnostics area
 */
-void check_queue_on_pk(THD *thd, TABLE_LIST *all_tables, LEX *lex)
+bool check_queue_on_pk(THD *thd, TABLE_LIST *all_tables, LEX *lex)
 {
   if (thd->execute_item)
-    return;
+    return false;
 
   unsigned long long primary_id= 0;
 
@@ -2370,41 +2494,235 @@ void check_queue_on_pk(THD *thd, TABLE_LIST *all_tables, LEX *lex)
   }
 
   if (primary_id == 0)
-    return;
+    return false;
 
-  ic_hash_item_t *new_item, *item;
+  ic_hash_item_t *item;
+  bool batch= ic_batch_stmt_eligible(thd, lex);
+  char key[IC_HASH_KEY_SIZE];
+  size_t key_len;
 
-  new_item= new ic_hash_item_t;
+  key_len= my_snprintf(key, sizeof(key), "%s\1%s\1%llu",
+                       all_tables->db, all_tables->table_name, primary_id);
 
-  new_item->key_len= snprintf(new_item->key, sizeof(new_item->key), "%s\1%s\1%llu",
-                              all_tables->db, all_tables->table_name, primary_id);
-  pthread_mutex_lock(&ic_gather_hash_lock);
+  item= ic_hash_item_acquire(key, key_len);
 
-  item= (ic_hash_item_t*) my_hash_search(&ic_gather_hash, (const uchar*)new_item->key,
-                                         new_item->key_len);
+  if (batch && item->batch_leader &&
+      item->batch_size < ic_reduce_batch_size &&
+      ic_batch_compatible(item->batch_leader, thd))
+  {
+    ic_batch_follow(thd, item);
+    return true;
+  }
 
-  if (!item)
+  pthread_mutex_unlock(&item->queue_lock);
+
+  DEBUG_SYNC(thd, "after_unlock_queue_lock_in_check");
+
+  thd->execute_item= item;
+
+  pthread_mutex_lock(&item->execute_lock);
+
+  /*
+    Lead a batch: run inside an explicit transaction, so that the updates
+    of the sessions queued behind us can be added to it before the commit
+    in ic_batch_execute().
+  */
+  if (batch && !trans_begin(thd))
   {
-    item= new_item;
-    my_hash_insert(&ic_gather_hash, (const uchar*)new_item);
+    pthread_mutex_lock(&item->queue_lock);
+    /* Reference of the batch, dropped in ic_batch_execute() */
+    item->left_thread_num++;
+    item->batch_leader= thd;
+    item->batch_size= 1;
+    pthread_mutex_unlock(&item->queue_lock);
+
+    thd->ic_batch_item= item;
+
+    DEBUG_SYNC(thd, "after_ic_batch_leader_elected");
+  }
+
+  return false;
+}
+
+/**
+  Copy the outcome of a batched statement into its request.
+*/
+static void ic_batch_set_result(ic_batch_request_t *request,
+                                Diagnostics_area *da)
+{
+  if (da->is_error())
+  {
+    request->sql_errno= da->sql_errno();
+    strmake(request->message, da->message(), sizeof(request->message) - 1);
   }
   else
   {
-    delete new_item;
+    request->sql_errno= 0;
+    request->affected_rows= da->is_ok() ? da->affected_rows() : 0;
+    strmake(request->message, da->is_ok() ? da->message() : "",
+            sizeof(request->message) - 1);
   }
+}
 
-  pthread_mutex_lock(&item->queue_lock);
-  pthread_mutex_unlock(&ic_gather_hash_lock);
+/**
+  Finish the batch led by this session: execute the statements queued by
+  other sessions on the same row in the leader's transaction, commit them
+  all at once and hand every session its own result.
+
+  Each statement runs as a separate statement of the transaction, so a
+  failing one (including TARGET_AFFECT_ROW mismatches) is rolled back alone.
+  If the storage engine rolls back the whole transaction, every statement
+  executed so far in it fails with the same error. Called after the
+  leader's own statement has finished.
 
-  item->left_thread_num++;
+  @param thd                    Thread handler of the leader
+*/
+static void ic_batch_execute(THD *thd)
+{
+  ic_hash_item_t *item= thd->ic_batch_item;
+  ic_batch_request_t *head= NULL, *tail= NULL;
+  ic_batch_request_t *request, **prev;
 
+  if (!item)
+    return;
+
+  thd->ic_batch_item= NULL;
+
+  DEBUG_SYNC(thd, "before_ic_batch_execute");
+
+  /* Close the batch and take over the requests handed to us. */
+  pthread_mutex_lock(&item->queue_lock);
+  if (item->batch_leader == thd)
+  {
+    item->batch_leader= NULL;
+    item->batch_size= 0;
+  }
+  item->batch_tail= NULL;
+  for (prev= &item->batch_head; (request= *prev); )
+  {
+    if (request->leader == thd)
+    {
+      *prev= request->next;
+      request->next= NULL;
+      if (tail)
+        tail->next= request;
+      else
+        head= request;
+      tail= request;
+    }
+    else
+    {
+      item->batch_tail= request;
+      prev= &request->next;
+    }
+  }
   pthread_mutex_unlock(&item->queue_lock);
 
-  DEBUG_SYNC(thd, "after_unlock_queue_lock_in_check");
+  Diagnostics_area *leader_da= thd->get_stmt_da();
+  Diagnostics_area batch_da(thd->query_id, false);
+  char *leader_query= thd->query();
+  uint32 leader_query_length= thd->query_length();
+  query_id_t leader_query_id= thd->query_id;
+  sql_digest_state *leader_digest= thd->m_digest;
+  PSI_statement_locker *leader_psi= thd->m_statement_psi;
+  /* Statements that succeeded in the current transaction */
+  bool leader_pending= leader_da->is_ok();
+  ic_batch_request_t *pending_from= head;
+
+  thd->set_stmt_da(&batch_da);
+  thd->m_digest= NULL;
+  thd->m_statement_psi= NULL;
+  thd->ic_batch_running= true;
 
-  thd->execute_item= item;
+  for (request= head; request; request= request->next)
+  {
+    Parser_state parser_state;
 
-  pthread_mutex_lock(&item->execute_lock);
+    if (!thd->in_multi_stmt_transaction_mode() && trans_begin(thd))
+    {
+      ic_batch_set_result(request, &batch_da);
+      batch_da.reset_diagnostics_area();
+      continue;
+    }
+
+    batch_da.reset_diagnostics_area();
+    batch_da.clear_warning_info(thd->query_id);
+
+    thd->set_query_and_id(request->query, request->query_length,
+                          thd->charset(), next_query_id());
+
+    if (parser_state.init(thd, thd->query(), thd->query_length()))
+      my_error(ER_OUT_OF_RESOURCES, MYF(0));
+    else
+      mysql_parse(thd, thd->query(), thd->query_length(), &parser_state);
+
+    ic_batch_set_result(request, &batch_da);
+
+    if (request->sql_errno && thd->transaction.all.is_empty())
+    {
+      /*
+        The engine rolled back the whole transaction (e.g. on a deadlock):
+        everything executed before in this transaction is lost as well.
+      */
+      if (leader_pending)
+      {
+        leader_da->set_overwrite_status(true);
+        leader_da->reset_diagnostics_area();
+        leader_da->set_error_status(batch_da.sql_errno(), batch_da.message(),
+                                    batch_da.get_sqlstate(), NULL);
+        leader_da->set_overwrite_status(false);
+        leader_pending= false;
+      }
+      for (ic_batch_request_t *done= pending_from; done != request;
+           done= done->next)
+      {
+        if (!done->sql_errno)
+          ic_batch_set_result(done, &batch_da);
+      }
+      pending_from= request->next;
+      trans_rollback(thd);
+    }
+  }
+
+  batch_da.reset_diagnostics_area();
+  batch_da.clear_warning_info(thd->query_id);
+
+  DEBUG_SYNC(thd, "before_ic_batch_commit");
+
+  /* The commit also releases the execute_lock of the row. */
+  if (trans_commit(thd))
+  {
+    if (leader_pending)
+    {
+      leader_da->set_overwrite_status(true);
+      leader_da->reset_diagnostics_area();
+      leader_da->set_error_status(batch_da.sql_errno(), batch_da.message(),
+                                  batch_da.get_sqlstate(), NULL);
+      leader_da->set_overwrite_status(false);
+    }
+    for (request= pending_from; request; request= request->next)
+    {
+      if (!request->sql_errno)
+        ic_batch_set_result(request, &batch_da);
+    }
+  }
+  thd->mdl_context.release_transactional_locks();
+
+  thd->ic_batch_running= false;
+  thd->m_statement_psi= leader_psi;
+  thd->m_digest= leader_digest;
+  thd->set_query_and_id(leader_query, leader_query_length, thd->charset(),
+                        leader_query_id);
+  thd->set_stmt_da(leader_da);
+
+  /* Wake up the sessions whose statements were executed. */
+  pthread_mutex_lock(&item->queue_lock);
+  for (request= head; request; request= request->next)
+    request->done= true;
+  pthread_cond_broadcast(&item->batch_cond);
+  pthread_mutex_unlock(&item->queue_lock);
+
+  ic_hash_item_release(thd, item);
 }
 
 /**
@@ -2720,6 +3038,10 @@ mysql_execute_command(THD *thd)
     goto error;
   }
 
+  /* RDS: wait in the queue of a concurrency control rule if needed. */
+  if (ccl_enter(thd))
+    goto error;
+
   /*
     Check if we are in a read-only transaction and we're trying to
     execute a statement which should always be disallowed in such cases.
@@ -3472,7 +3794,13 @@ end_with_restore_list:
     DBUG_ASSERT(select_lex->offset_limit == 0);
     unit->set_limit(select_lex);
     MYSQL_UPDATE_START(thd->query());
-    check_queue_on_pk(thd, all_tables, lex);
+    if (check_queue_on_pk(thd, all_tables, lex))
+    {
+      /* Executed and committed by the batch leader of the row */
+      res= thd->is_error();
+      MYSQL_UPDATE_DONE(res, 0, 0);
+      break;
+    }
     res= (up_result= mysql_update(thd, all_tables,
                                   select_lex->item_list,
                                   lex->value_list,
@@ -3482,7 +3810,11 @@ end_with_restore_list:
                                   unit->select_limit_cnt,
                                   lex->duplicates, lex->ignore,
                                   &found, &updated));
-    if (!res && lex->ci_on_success)
+    if (thd->ic_batch_running || (!res && thd->ic_batch_item))
+    {
+      /* Committed by ic_batch_execute() together with the whole batch */
+    }
+    else if (!res && lex->ci_on_success)
     {
       trans_commit_stmt(thd);
       trans_commit(thd);
@@ -5229,6 +5561,7 @@ finish:
                thd->in_multi_stmt_transaction_mode());
 
 dec_filter_item_conc(thd, lex->sql_command);
+  ccl_exit(thd);
 
   if (! thd->in_sub_stmt)
   {
@@ -6614,7 +6947,8 @@ void mysql_parse(THD *thd, char *rawbuf, uint length,
           else
           {
             error= mysql_execute_command(thd);
-            if (!thd->trx_end_by_hint)
+            if (!thd->trx_end_by_hint &&
+                !thd->ic_batch_item && !thd->ic_batch_running)
             {
               if (!error && lex->ci_on_success)
                 trans_commit(thd);
@@ -6675,6 +7009,9 @@ void mysql_parse(THD *thd, char *rawbuf, uint length,
     thd->end_statement();
     thd->cleanup_after_query();
     DBUG_ASSERT(thd->change_list.is_empty());
+
+    /* Commit the QUEUE_ON_PK batch this statement leads, if any */
+    ic_batch_execute(thd);
   }
   else
   {
@@ -55,6 +55,9 @@ typedef struct st_seq_cache
   ulonglong round;
 }ST_SEQ_CACHE;
 
+/* Max number of values taken by one NEXTVAL(seq, n) */
+#define SEQUENCE_MAX_BATCH 1000000
+
 enum enum_seq_iteration
 {
   IT_NON,               /* Query the sequence base table */
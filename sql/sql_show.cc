@@ -57,6 +57,7 @@
 #include "sql_optimizer.h" // JOIN
 #include "global_threads.h"
 #include "sql_filter.h"
+#include "sql_ccl.h"
 #include "threadpool.h"
 
 #include <algorithm>
@@ -2203,6 +2204,58 @@ int fill_sql_filter_info(THD *thd, TABLE_LIST *tables, Item *cond)
   DBUG_RETURN(0);
 }
 
+int fill_sql_ccl_info(THD *thd, TABLE_LIST *tables, Item *cond)
+{
+  CHARSET_INFO *cs= system_charset_info;
+  TABLE *table= tables->table;
+  DBUG_ENTER("fill_sql_ccl_info");
+
+  mysql_rwlock_rdlock(&LOCK_ccl_rules);
+  for (ccl_rule *rule= ccl_rule_list; rule; rule= rule->next)
+  {
+    const char *type;
+    char key[NAME_LEN * 2 + 2];
+    uint key_len;
+
+    if (rule->type == CCL_RULE_DIGEST)
+    {
+      type= "DIGEST";
+      key_len= strxnmov(key, sizeof(key) - 1, rule->digest, NullS) - key;
+    }
+    else
+    {
+      type= "TABLE";
+      key_len= strxnmov(key, sizeof(key) - 1, rule->db, ".",
+                        rule->table_name, NullS) - key;
+    }
+
+    table->field[0]->store(rule->id, true);
+    table->field[1]->store(type, strlen(type), cs);
+    table->field[2]->store(key, key_len, cs);
+    table->field[3]->store(rule->max_conc, true);
+    table->field[4]->store(rule->max_queue, true);
+
+    mysql_mutex_lock(&rule->lock);
+    table->field[5]->store(rule->running, true);
+    table->field[6]->store(rule->waiting, true);
+    table->field[7]->store(rule->admitted, true);
+    table->field[8]->store(rule->rejected, true);
+    table->field[9]->store(rule->timeouts, true);
+    table->field[10]->store(rule->waits ? rule->wait_time / rule->waits : 0,
+                            true);
+    mysql_mutex_unlock(&rule->lock);
+
+    if (schema_table_store_record(thd, table))
+    {
+      mysql_rwlock_unlock(&LOCK_ccl_rules);
+      DBUG_RETURN(1);
+    }
+  }
+  mysql_rwlock_unlock(&LOCK_ccl_rules);
+
+  DBUG_RETURN(0);
+}
+
 void mysqld_list_processes(THD *thd,const char *user, bool verbose)
 {
   Item *field;
@@ -2419,6 +2472,46 @@ int fill_thread_group_info(THD *thd, TABLE_LIST* tables, Item* __attribute__((un
   DBUG_RETURN(0);
 }
 
+
+int fill_ic_reduce_partitions(THD *thd, TABLE_LIST *tables,
+                              Item* __attribute__((unused)))
+{
+  DBUG_ENTER("fill_ic_reduce_partitions");
+  TABLE *table= tables->table;
+
+  for (uint i= 0; i < IC_GATHER_HASH_PARTITIONS; i++)
+  {
+    ic_gather_partition_t *part= &ic_gather_partitions[i];
+    ulonglong items, queued_threads= 0, pooled_items;
+    ulonglong lookups, queue_waits, lock_waits;
+
+    pthread_mutex_lock(&part->lock);
+    items= part->hash.records;
+    /* left_thread_num is read without queue_lock, good enough for stats */
+    for (ulong j= 0; j < part->hash.records; j++)
+      queued_threads+= ((ic_hash_item_t*) my_hash_element(&part->hash, j))
+                       ->left_thread_num;
+    pooled_items= part->n_free;
+    lookups= part->lookups;
+    queue_waits= part->queue_waits;
+    lock_waits= part->lock_waits;
+    pthread_mutex_unlock(&part->lock);
+
+    table->field[0]->store(i);
+    table->field[1]->store(items, TRUE);
+    table->field[2]->store(queued_threads, TRUE);
+    table->field[3]->store(pooled_items, TRUE);
+    table->field[4]->store(lookups, TRUE);
+    table->field[5]->store(queue_waits, TRUE);
+    table->field[6]->store(lock_waits, TRUE);
+
+    if (schema_table_store_record(thd, table))
+      DBUG_RETURN(1);
+  }
+
+  DBUG_RETURN(0);
+}
+
 int fill_schema_processlist(THD* thd, TABLE_LIST* tables, Item* cond)
 {
   TABLE *table= tables->table;
@@ -8596,6 +8689,22 @@ ST_FIELD_INFO sql_filter_fields_info[] =
   {0, 0, MYSQL_TYPE_STRING, 0, 0, "", SKIP_OPEN_TABLE}
 };
 
+ST_FIELD_INFO sql_ccl_fields_info[] =
+{
+  {"ID", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"TYPE", 21, MYSQL_TYPE_STRING, 0, 0, "", SKIP_OPEN_TABLE},
+  {"KEY_STR", SQL_FILTER_STR_LEN, MYSQL_TYPE_STRING, 0, 0, "", SKIP_OPEN_TABLE},
+  {"MAX_CONC", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"MAX_QUEUE", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"RUNNING", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"WAITING", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"ADMITTED", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"REJECTED", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"TIMEOUTS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"AVG_WAIT_US", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, "", SKIP_OPEN_TABLE}
+};
+
 ST_FIELD_INFO thread_group_status_fields_info[] =
 {
   {"ID", 21, MYSQL_TYPE_LONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE },
@@ -8609,6 +8718,18 @@ ST_FIELD_INFO thread_group_status_fields_info[] =
   {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE }
 };
 
+ST_FIELD_INFO ic_reduce_partitions_fields_info[] =
+{
+  {"PARTITION_ID", 21, MYSQL_TYPE_LONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"ITEMS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"QUEUED_THREADS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"POOLED_ITEMS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"LOOKUPS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"QUEUE_WAITS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {"LOCK_WAITS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, "", SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
 
 /** For creating fields of information_schema.OPTIMIZER_TRACE */
 extern ST_FIELD_INFO optimizer_trace_info[];
@@ -8648,6 +8769,9 @@ ST_SCHEMA_TABLE schema_tables[]=
    fill_status, make_old_format, 0, 0, -1, 0, 0},
   {"GLOBAL_VARIABLES", variables_fields_info, create_schema_table,
    fill_variables, make_old_format, 0, 0, -1, 0, 0},
+  {"IC_REDUCE_PARTITIONS", ic_reduce_partitions_fields_info,
+   create_schema_table, fill_ic_reduce_partitions, make_old_format, 0, -1, -1,
+   0, 0},
   {"KEY_COLUMN_USAGE", key_column_usage_fields_info, create_schema_table,
    get_all_tables, 0, get_schema_key_column_usage_record, 4, 5, 0,
    OPTIMIZE_I_S_TABLE|OPEN_TABLE_ONLY},
@@ -8685,6 +8809,8 @@ ST_SCHEMA_TABLE schema_tables[]=
    fill_status, make_old_format, 0, 0, -1, 0, 0},
   {"SESSION_VARIABLES", variables_fields_info, create_schema_table,
    fill_variables, make_old_format, 0, 0, -1, 0, 0},
+  {"SQL_CCL_INFO", sql_ccl_fields_info, create_schema_table,
+   fill_sql_ccl_info, make_old_format, 0, -1, -1, 0, 0},
   {"SQL_FILTER_INFO", sql_filter_fields_info, create_schema_table,
    fill_sql_filter_info, make_old_format, 0, -1, -1, 0, 0},
   {"STATISTICS", stat_fields_info, create_schema_table, 
@@ -9738,6 +9738,18 @@ simple_expr:
             if (!($$= new (YYTHD->mem_root) Item_func_nextval(YYTHD, table)))
               MYSQL_YYABORT;
           }
+        | NEXTVAL_SYM '(' table_ident ',' expr ')'
+          {
+            TABLE_LIST *table;
+            if (!(table= Lex->current_select->add_table_to_list(YYTHD, $3, NULL,
+                                                                TL_OPTION_SEQUENCE,
+                                                                TL_READ,
+                                                                MDL_SHARED_READ,
+                                                                NULL, NULL, NULL, true)))
+              MYSQL_YYABORT;
+            if (!($$= new (YYTHD->mem_root) Item_func_nextval(YYTHD, table, $5)))
+              MYSQL_YYABORT;
+          }
         | CURRVAL_SYM '(' table_ident ')'
           {
             TABLE_LIST *table;
@@ -60,6 +60,7 @@
 #include "table_cache.h"                        // Table_cache_manager
 #include "my_aes.h" // my_aes_opmode_names
 #include "sql_filter.h"
+#include "sql_ccl.h"
 
 #include "log_event.h"
 #ifdef WITH_PERFSCHEMA_STORAGE_ENGINE
@@ -1884,6 +1885,15 @@ static Sys_var_mybool Sys_rds_ic_reduce_hint_enable(
        ON_CHECK(check_ic_reduce_hint_enable),
        ON_UPDATE(0));
 
+static Sys_var_ulong Sys_rds_ic_reduce_batch_size(
+       "rds_ic_reduce_batch_size",
+       "Maximum number of autocommit UPDATE statements with the "
+       "COMMIT_ON_SUCCESS and QUEUE_ON_PK hints on the same row that are "
+       "executed by one session in a single transaction. 1 disables "
+       "batching",
+       GLOBAL_VAR(ic_reduce_batch_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 1024), DEFAULT(1), BLOCK_SIZE(1));
+
 static bool fix_max_join_size(sys_var *self, THD *thd, enum_var_type type)
 {
   SV *sv= type == OPT_GLOBAL ? &global_system_variables : &thd->variables;
@@ -2014,6 +2024,15 @@ static Sys_var_mybool Sys_sequence_read_skip_cache(
        DEFAULT(FALSE), NO_MUTEX_GUARD,
        NOT_IN_BINLOG, ON_CHECK(0));
 
+static Sys_var_mybool Sys_sequence_cache_prefetch(
+       "sequence_cache_prefetch",
+       "Load the next cache of a sequence from the based table when half "
+       "of the current cache is used, so that NEXTVAL does not wait for "
+       "the based table when the cache runs out. Up to two caches of "
+       "values are skipped on restart",
+       GLOBAL_VAR(opt_sequence_cache_prefetch), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
 static bool 
 check_net_buffer_length(sys_var *self, THD *thd,  set_var *var)
 {
@@ -5001,6 +5020,8 @@ static bool update_select_filter(sys_var *self, THD *thd, enum_var_type type)
   if (tmp || rds_sql_select_filter[0] == '-')
     select_filter_list= tmp;
 
+  refresh_filter_matcher(&select_filter_matcher, select_filter_list);
+
   return false;
 }
 
@@ -5017,6 +5038,8 @@ static bool update_update_filter(sys_var *self, THD *thd, enum_var_type type)
   if (tmp || rds_sql_update_filter[0] == '-')
     update_filter_list= tmp;
 
+  refresh_filter_matcher(&update_filter_matcher, update_filter_list);
+
   return false;
 }
 
@@ -5033,6 +5056,8 @@ static bool update_delete_filter(sys_var *self, THD *thd, enum_var_type type)
   if (tmp || rds_sql_delete_filter[0] == '-')
     delete_filter_list= tmp;
 
+  refresh_filter_matcher(&delete_filter_matcher, delete_filter_list);
+
   return false;
 }
 
@@ -5047,6 +5072,9 @@ static bool rds_reset_all_filter_list(sys_var *self, THD *thd, enum_var_type typ
   select_filter_list= NULL;
   update_filter_list= NULL;
   delete_filter_list= NULL;
+  refresh_filter_matcher(&select_filter_matcher, NULL);
+  refresh_filter_matcher(&update_filter_matcher, NULL);
+  refresh_filter_matcher(&delete_filter_matcher, NULL);
 
   reset_filter_list(tmp_select_list);
   reset_filter_list(tmp_update_list);
@@ -5108,6 +5136,44 @@ static Sys_var_mybool Sys_rds_filter_key_cmp_in_order(
        "If enabled, then match keys stored in filter list in order",
        GLOBAL_VAR(rds_key_cmp_in_order), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
 
+static Sys_var_mybool Sys_rds_filter_match_digest(
+       "rds_filter_match_digest",
+       "If enabled, then match keys stored in filter list against the "
+       "normalized statement digest text instead of the query text",
+       GLOBAL_VAR(rds_filter_match_digest), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
+/* BEGIN: sql concurrency control */
+static bool check_sql_ccl_rule(sys_var *self, THD *thd, set_var *var)
+{
+  return check_ccl_rule_valid(var->save_result.string_value.str);
+}
+
+static bool update_sql_ccl_rule(sys_var *self, THD *thd, enum_var_type type)
+{
+  return modify_ccl_rules(rds_sql_ccl_rule);
+}
+
+static PolyLock_rwlock PLock_sys_rds_sql_ccl_rule(&LOCK_ccl_rules);
+static Sys_var_charptr Sys_rds_sql_ccl_rule(
+       "rds_sql_ccl_rule", "Used to add/remove a concurrency control rule, "
+       "statements above the limit of a rule wait in its queue",
+       GLOBAL_VAR(rds_sql_ccl_rule),
+       CMD_LINE(REQUIRED_ARG),
+       IN_SYSTEM_CHARSET,
+       DEFAULT(0),
+       &PLock_sys_rds_sql_ccl_rule,
+       NOT_IN_BINLOG,
+       ON_CHECK(check_sql_ccl_rule), ON_UPDATE(update_sql_ccl_rule));
+
+static Sys_var_ulong Sys_rds_sql_ccl_wait_timeout(
+       "rds_sql_ccl_wait_timeout",
+       "The number of seconds a statement waits in the queue of a "
+       "concurrency control rule before it is rejected",
+       GLOBAL_VAR(rds_sql_ccl_wait_timeout), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, LONG_TIMEOUT), DEFAULT(60), BLOCK_SIZE(1));
+/* END: sql concurrency control */
+
 /*new opition for semisync*/
 static bool fix_rpl_semi_sync_master_enabled(
                       sys_var *self, THD *thd, enum_var_type type)
@@ -5281,9 +5347,30 @@ static Sys_var_mybool Sys_rds_allow_unsafe_stmt_with_gtid(
        CMD_LINE(OPT_ARG), DEFAULT(FALSE),
        &PLock_sys_rds_allow_unsafe_stmt_with_gtid, NOT_IN_BINLOG);
 
-static const char *slave_pr_mode_names[]= {"SCHEMA", "TABLE", 0};
+static const char *slave_pr_mode_names[]=
+  {"SCHEMA", "TABLE", "WRITESET", "LOGICAL_CLOCK", 0};
 static Sys_var_enum Slave_pr_mode(
        "slave_pr_mode",
-       "Parallel-replication based on SCHEMA or TABLE",
+       "Parallel-replication based on SCHEMA, TABLE, WRITESET or "
+       "LOGICAL_CLOCK. WRITESET applies transactions that change different "
+       "rows in parallel, it requires the master to log the writesets, see "
+       "binlog_writeset_size. LOGICAL_CLOCK applies transactions that were "
+       "committed together by the master in parallel",
        GLOBAL_VAR(slave_pr_mode_options),CMD_LINE(REQUIRED_ARG),
        slave_pr_mode_names, DEFAULT(SLAVE_PR_MODE_TABLE));
+
+static Sys_var_mybool Sys_slave_preserve_commit_order(
+       "slave_preserve_commit_order",
+       "Make the slave worker threads commit transactions in the order "
+       "they have in the relay log. Takes effect at START SLAVE",
+       GLOBAL_VAR(opt_slave_preserve_commit_order), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
+static Sys_var_ulong Sys_binlog_writeset_size(
+       "binlog_writeset_size",
+       "Number of primary and unique key hashes a transaction can log "
+       "in its GTID event for slaves with slave_pr_mode=WRITESET. A "
+       "transaction changing more keys is applied alone by the slave. "
+       "Writesets are only logged with gtid_mode=ON, 0 disables them",
+       GLOBAL_VAR(opt_binlog_writeset_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024), DEFAULT(0), BLOCK_SIZE(1));
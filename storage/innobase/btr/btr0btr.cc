@@ -2071,7 +2071,7 @@ btr_page_reorganize(
 	dict_index_t*	index,	/*!< in: the index tree of the page */
 	mtr_t*		mtr)	/*!< in/out: mini-transaction */
 {
-	return(btr_page_reorganize_low(false, page_zip_level,
+	return(btr_page_reorganize_low(false, page_zip_level_get(),
 				       cursor, index, mtr));
 }
 #endif /* !UNIV_HOTBACKUP */
@@ -2105,10 +2105,11 @@ btr_parse_page_reorganize(
 
 		level = mach_read_from_1(ptr);
 
-		ut_a(level <= 9);
+		ut_a((level & ((1 << PAGE_ZIP_LEVEL_BITS) - 1)) <= 9);
+		ut_a(level >> PAGE_ZIP_LEVEL_BITS <= PAGE_ZIP_CODEC_LZ);
 		++ptr;
 	} else {
-		level = page_zip_level;
+		level = page_zip_level_get();
 	}
 
 	if (block != NULL) {
@@ -5154,7 +5155,8 @@ btr_can_merge_with_page(
 		/* We have to reorganize mpage */
 
 		if (!btr_page_reorganize_block(
-			    false, page_zip_level, mblock, index, mtr)) {
+			    false, page_zip_level_get(), mblock, index,
+			    mtr)) {
 
 			goto error;
 		}
@@ -0,0 +1,676 @@
+/*****************************************************************************
+
+Copyright (c) 2026, Aliyun and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/********************************************************************//**
+@file btr/btr0bulk.cc
+Bottom-up loading of an index tree from sorted index entries
+
+Instead of descending the tree and splitting pages for every entry, the
+loader keeps one page open on every level of the tree. The records are
+copied to the end of the record heap of the leaf page without any redo
+logging. When the page is full, its page directory and header are built,
+the page is written to the redo log with one MLOG_WRITE_STRING record for
+the records and one for the directory, and a node pointer to it is
+appended to the page of the level above in the same way. At the end, the
+single page of the top level is copied to the root page that btr_create()
+made for the index.
+
+Created 10/17/2026
+*************************************************************************/
+
+#include "btr0bulk.h"
+
+#include "btr0btr.h"
+#include "btr0cur.h"
+#include "fsp0fsp.h"
+#include "log0log.h"
+#include "mtr0log.h"
+#include "page0page.h"
+#include "page0zip.h"
+#include "rem0cmp.h"
+#include "srv0srv.h"
+
+/** The page being filled on one level of an index tree */
+struct btr_bulk_page_t {
+	mtr_t		mtr;		/*!< mini-transaction that
+					x-latches the index and block */
+	buf_block_t*	block;		/*!< the page */
+	page_t*		page;		/*!< frame of block */
+	ulint		page_no;	/*!< page number of block */
+	ulint		level;		/*!< level of the page */
+	bool		leftmost;	/*!< whether this is the first
+					page of the level */
+	rec_t*		last_rec;	/*!< last record on the page, or
+					the infimum */
+	byte*		heap_top;	/*!< end of the record heap */
+	ulint		n_recs;		/*!< number of user records */
+	ulint		free_space;	/*!< space left for records and
+					page directory slots */
+	ulint		reserved_space;	/*!< space to leave free */
+	ib_uint64_t	modify_clock;	/*!< modify clock of block, while
+					block is only buffer-fixed */
+};
+
+/** Bulk loader of an index tree */
+struct btr_bulk_t {
+	dict_index_t*	index;		/*!< the index */
+	trx_id_t	trx_id;		/*!< transaction creating the
+					index */
+	ulint		comp;		/*!< nonzero=compact page format */
+	ulint		n_levels;	/*!< number of levels that have
+					a page in pages[] */
+	btr_bulk_page_t*pages[BTR_MAX_LEVELS];
+					/*!< page being filled on each
+					level */
+	mem_heap_t*	heap;		/*!< memory heap for records and
+					node pointers, emptied after each
+					btr_bulk_insert() */
+};
+
+/*********************************************************************//**
+Starts a page of a level of the index tree being loaded.
+@return DB_SUCCESS or DB_OUT_OF_FILE_SPACE */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_page_start(
+/*================*/
+	btr_bulk_t*		bulk,	/*!< in/out: bulk loader */
+	ulint			level,	/*!< in: level of the page */
+	ulint			page_no,/*!< in: the empty root page, or
+					FIL_NULL to allocate a page */
+	btr_bulk_page_t**	page_bulk)/*!< out: the page */
+{
+	dict_index_t*		index = bulk->index;
+	btr_bulk_page_t*	pb;
+	buf_block_t*		block;
+	page_t*			page;
+
+	pb = static_cast<btr_bulk_page_t*>(mem_zalloc(sizeof *pb));
+
+	mtr_start(&pb->mtr);
+	mtr_x_lock(dict_index_get_lock(index), &pb->mtr);
+
+	if (page_no == FIL_NULL) {
+		mtr_t	alloc_mtr;
+		ulint	n_reserved;
+
+		/* Allocate in a separate mini-transaction, so that the
+		tablespace latch is not held while the page is filled. */
+		mtr_start(&alloc_mtr);
+
+		if (!fsp_reserve_free_extents(&n_reserved, index->space, 1,
+					      FSP_NORMAL, &alloc_mtr)) {
+			block = NULL;
+		} else {
+			block = btr_page_alloc(index, 0, FSP_UP, level,
+					       &alloc_mtr, &pb->mtr);
+			fil_space_release_free_extents(index->space,
+						       n_reserved);
+		}
+
+		mtr_commit(&alloc_mtr);
+
+		if (block == NULL) {
+			mtr_commit(&pb->mtr);
+			mem_free(pb);
+			return(DB_OUT_OF_FILE_SPACE);
+		}
+
+		page = page_create(block, &pb->mtr, bulk->comp);
+		btr_page_set_next(page, NULL, FIL_NULL, &pb->mtr);
+		btr_page_set_prev(page, NULL, FIL_NULL, &pb->mtr);
+		btr_page_set_index_id(page, NULL, index->id, &pb->mtr);
+	} else {
+		block = btr_block_get(index->space, 0, page_no,
+				      RW_X_LATCH, index, &pb->mtr);
+		page = buf_block_get_frame(block);
+		ut_ad(page_dir_get_n_heap(page) == PAGE_HEAP_NO_USER_LOW);
+	}
+
+	btr_page_set_level(page, NULL, level, &pb->mtr);
+
+	if (level == 0 && !dict_index_is_clust(index)) {
+		page_update_max_trx_id(block, NULL, bulk->trx_id, &pb->mtr);
+	}
+
+	pb->block = block;
+	pb->page = page;
+	pb->page_no = buf_block_get_page_no(block);
+	pb->level = level;
+	pb->last_rec = page_get_infimum_rec(page);
+	pb->heap_top = page_header_get_ptr(page, PAGE_HEAP_TOP);
+	pb->n_recs = 0;
+	pb->free_space = page_get_free_space_of_empty(bulk->comp);
+
+	if (srv_fill_factor == 100 && dict_index_is_clust(index)) {
+		/* Leave room for updates, like inserts do. */
+		pb->reserved_space = dict_index_get_space_reserve();
+	} else {
+		pb->reserved_space = UNIV_PAGE_SIZE
+			* (100 - srv_fill_factor) / 100;
+	}
+
+	*page_bulk = pb;
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Checks if a record fits on a page without going over the fill factor.
+A page always gets at least two records, so that the tree branches.
+@return true if the record fits */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+bool
+btr_bulk_page_has_space(
+/*====================*/
+	const btr_bulk_page_t*	pb,	/*!< in: page */
+	ulint			rec_size)/*!< in: size of the record */
+{
+	ulint	required = rec_size
+		+ page_dir_calc_reserved_space(pb->n_recs + 1)
+		- page_dir_calc_reserved_space(pb->n_recs);
+
+	if (required > pb->free_space) {
+		return(false);
+	}
+
+	return(pb->n_recs < 2
+	       || pb->free_space - required >= pb->reserved_space);
+}
+
+/*********************************************************************//**
+Appends a record to the record heap of a page. The page directory and
+the page header are not updated. */
+static MY_ATTRIBUTE((nonnull))
+void
+btr_bulk_page_insert(
+/*=================*/
+	btr_bulk_t*		bulk,	/*!< in/out: bulk loader */
+	btr_bulk_page_t*	pb,	/*!< in/out: page */
+	const rec_t*		rec,	/*!< in: record */
+	const ulint*		offsets)/*!< in: rec_get_offsets(rec) */
+{
+	ulint	rec_size = rec_offs_size(offsets);
+	ulint	slot_size = page_dir_calc_reserved_space(pb->n_recs + 1)
+		- page_dir_calc_reserved_space(pb->n_recs);
+	rec_t*	insert_rec;
+
+	ut_ad(rec_size + slot_size <= pb->free_space);
+
+#ifdef UNIV_DEBUG
+	/* The records must come in ascending order. */
+	if (!page_rec_is_infimum(pb->last_rec)) {
+		ulint*	last_offsets = rec_get_offsets(
+			pb->last_rec, bulk->index, NULL,
+			ULINT_UNDEFINED, &bulk->heap);
+
+		ut_ad(cmp_rec_rec(rec, pb->last_rec, offsets, last_offsets,
+				  bulk->index) > 0);
+	}
+#endif /* UNIV_DEBUG */
+
+	insert_rec = rec_copy(pb->heap_top, rec, offsets);
+
+	if (bulk->comp) {
+		rec_set_n_owned_new(insert_rec, NULL, 0);
+		rec_set_heap_no_new(insert_rec,
+				    PAGE_HEAP_NO_USER_LOW + pb->n_recs);
+		rec_set_next_offs_new(pb->last_rec, page_offset(insert_rec));
+	} else {
+		rec_set_n_owned_old(insert_rec, 0);
+		rec_set_heap_no_old(insert_rec,
+				    PAGE_HEAP_NO_USER_LOW + pb->n_recs);
+		rec_set_next_offs_old(pb->last_rec, page_offset(insert_rec));
+	}
+
+	pb->free_space -= rec_size + slot_size;
+	pb->heap_top += rec_size;
+	pb->n_recs++;
+	pb->last_rec = insert_rec;
+}
+
+/*********************************************************************//**
+Builds the page directory and the page header of a page, so that it is
+a valid index page. More records can be appended to it afterwards. */
+static MY_ATTRIBUTE((nonnull))
+void
+btr_bulk_page_close(
+/*================*/
+	btr_bulk_t*		bulk,	/*!< in: bulk loader */
+	btr_bulk_page_t*	pb)	/*!< in/out: page */
+{
+	page_t*			page = pb->page;
+	rec_t*			supremum = page_get_supremum_rec(page);
+	rec_t*			rec;
+	page_dir_slot_t*	slot = NULL;
+	ulint			n_slot = 0;
+	ulint			count = 0;
+
+	if (bulk->comp) {
+		rec_set_next_offs_new(pb->last_rec, PAGE_NEW_SUPREMUM);
+	} else {
+		rec_set_next_offs_old(pb->last_rec, PAGE_OLD_SUPREMUM);
+	}
+
+	/* Let every slot own half of the maximum number of records,
+	like a page that is filled by page_cur_insert_rec_low(). */
+	for (rec = page_rec_get_next(page_get_infimum_rec(page));
+	     rec != supremum; rec = page_rec_get_next(rec)) {
+
+		if (++count == (PAGE_DIR_SLOT_MAX_N_OWNED + 1) / 2) {
+			slot = page_dir_get_nth_slot(page, ++n_slot);
+			page_dir_slot_set_rec(slot, rec);
+			page_dir_slot_set_n_owned(slot, NULL, count);
+			count = 0;
+		}
+	}
+
+	if (n_slot > 0
+	    && count + 1 + (PAGE_DIR_SLOT_MAX_N_OWNED + 1) / 2
+	    <= PAGE_DIR_SLOT_MAX_N_OWNED) {
+		/* Merge the last two slots. */
+		count += (PAGE_DIR_SLOT_MAX_N_OWNED + 1) / 2;
+		page_dir_slot_set_n_owned(slot, NULL, 0);
+		n_slot--;
+	}
+
+	slot = page_dir_get_nth_slot(page, 1 + n_slot);
+	page_dir_slot_set_rec(slot, supremum);
+	page_dir_slot_set_n_owned(slot, NULL, count + 1);
+
+	page_dir_set_n_slots(page, NULL, 2 + n_slot);
+	page_header_set_ptr(page, NULL, PAGE_HEAP_TOP, pb->heap_top);
+	page_dir_set_n_heap(page, NULL, PAGE_HEAP_NO_USER_LOW + pb->n_recs);
+	page_header_set_field(page, NULL, PAGE_N_RECS, pb->n_recs);
+	page_header_set_ptr(page, NULL, PAGE_LAST_INSERT, pb->last_rec);
+	page_header_set_field(page, NULL, PAGE_DIRECTION, PAGE_RIGHT);
+	page_header_set_field(page, NULL, PAGE_N_DIRECTION, 0);
+}
+
+/*********************************************************************//**
+Builds the page directory and the page header of a page and writes the
+page to the redo log. */
+static MY_ATTRIBUTE((nonnull))
+void
+btr_bulk_page_finish(
+/*=================*/
+	btr_bulk_t*		bulk,	/*!< in: bulk loader */
+	btr_bulk_page_t*	pb)	/*!< in/out: page */
+{
+	page_t*	page = pb->page;
+	byte*	dir;
+
+	ut_ad(pb->n_recs > 0);
+
+	btr_bulk_page_close(bulk, pb);
+
+	ut_ad(bulk->comp
+	      ? page_simple_validate_new(page)
+	      : page_simple_validate_old(page));
+
+	/* The page header and the records, and then the directory. */
+	mlog_log_string(page + PAGE_HEADER,
+			pb->heap_top - (page + PAGE_HEADER), &pb->mtr);
+
+	dir = page_dir_get_nth_slot(page, page_dir_get_n_slots(page) - 1);
+	mlog_log_string(dir, page + UNIV_PAGE_SIZE - PAGE_DIR - dir,
+			&pb->mtr);
+}
+
+/*********************************************************************//**
+Releases a page without writing it, after an error. */
+static MY_ATTRIBUTE((nonnull))
+void
+btr_bulk_page_abort(
+/*================*/
+	btr_bulk_page_t*	pb)	/*!< in, own: page */
+{
+	mtr_commit(&pb->mtr);
+	mem_free(pb);
+}
+
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+btr_bulk_insert_low(
+/*================*/
+	btr_bulk_t*	bulk,
+	dtuple_t*	tuple,
+	ulint		level);
+
+/*********************************************************************//**
+Writes a full page, links it to the next page of its level and appends
+a node pointer to it to the level above.
+@return DB_SUCCESS or error code */
+static MY_ATTRIBUTE((warn_unused_result))
+dberr_t
+btr_bulk_page_commit(
+/*=================*/
+	btr_bulk_t*		bulk,	/*!< in/out: bulk loader */
+	btr_bulk_page_t*	pb,	/*!< in, own: page */
+	btr_bulk_page_t*	next,	/*!< in/out: next page of the
+					level, or NULL */
+	bool			insert_father)/*!< in: whether to append
+					a node pointer to the level above */
+{
+	dberr_t	err = DB_SUCCESS;
+
+	btr_bulk_page_finish(bulk, pb);
+
+	if (next != NULL) {
+		btr_page_set_next(pb->page, NULL, next->page_no, &pb->mtr);
+		btr_page_set_prev(next->page, NULL, pb->page_no, &next->mtr);
+	}
+
+	if (insert_father) {
+		dtuple_t*	node_ptr = dict_index_build_node_ptr(
+			bulk->index,
+			page_rec_get_next(page_get_infimum_rec(pb->page)),
+			pb->page_no, bulk->heap, pb->level);
+
+		err = btr_bulk_insert_low(bulk, node_ptr, pb->level + 1);
+	}
+
+	mtr_commit(&pb->mtr);
+	mem_free(pb);
+
+	return(err);
+}
+
+/*********************************************************************//**
+Commits the mini-transactions of all open pages, so that the thread can
+wait in log_free_check(). The pages stay buffer-fixed. */
+static MY_ATTRIBUTE((nonnull))
+void
+btr_bulk_release(
+/*=============*/
+	btr_bulk_t*	bulk)	/*!< in/out: bulk loader */
+{
+	for (ulint level = 0; level < bulk->n_levels; level++) {
+		btr_bulk_page_t*	pb = bulk->pages[level];
+
+		/* The page may be flushed while it is released. */
+		btr_bulk_page_close(bulk, pb);
+
+		buf_block_buf_fix_inc(pb->block, __FILE__, __LINE__);
+		pb->modify_clock = buf_block_get_modify_clock(pb->block);
+		mtr_commit(&pb->mtr);
+	}
+}
+
+/*********************************************************************//**
+Latches the pages released by btr_bulk_release() again. */
+static MY_ATTRIBUTE((nonnull))
+void
+btr_bulk_latch(
+/*===========*/
+	btr_bulk_t*	bulk)	/*!< in/out: bulk loader */
+{
+	for (ulint level = 0; level < bulk->n_levels; level++) {
+		btr_bulk_page_t*	pb = bulk->pages[level];
+		buf_block_t*		block = pb->block;
+
+		mtr_start(&pb->mtr);
+		mtr_x_lock(dict_index_get_lock(bulk->index), &pb->mtr);
+
+		if (!buf_page_optimistic_get(RW_X_LATCH, block,
+					     pb->modify_clock,
+					     __FILE__, __LINE__, &pb->mtr)) {
+			pb->block = btr_block_get(
+				bulk->index->space, 0, pb->page_no,
+				RW_X_LATCH, bulk->index, &pb->mtr);
+			ut_ad(pb->block == block);
+		}
+
+		buf_block_buf_fix_dec(block);
+	}
+}
+
+/*********************************************************************//**
+Appends a record to the page of a level, starting the level or a new
+page of the level when needed.
+@return DB_SUCCESS or error code */
+static
+dberr_t
+btr_bulk_insert_low(
+/*================*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	dtuple_t*	tuple,	/*!< in/out: index entry or node pointer */
+	ulint		level)	/*!< in: level of the tree */
+{
+	dict_index_t*		index = bulk->index;
+	btr_bulk_page_t*	pb;
+	big_rec_t*		big_rec = NULL;
+	ulint			n_ext = dtuple_get_n_ext(tuple);
+	ulint			rec_size;
+	rec_t*			rec;
+	ulint*			offsets;
+	dberr_t			err;
+
+	if (level == bulk->n_levels) {
+		if (level == BTR_MAX_LEVELS) {
+			return(DB_CORRUPTION);
+		}
+
+		err = btr_bulk_page_start(bulk, level, FIL_NULL, &pb);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+
+		pb->leftmost = true;
+		bulk->pages[level] = pb;
+		bulk->n_levels++;
+	}
+
+	pb = bulk->pages[level];
+
+	rec_size = rec_get_converted_size(index, tuple, n_ext);
+
+	if (page_zip_rec_needs_ext(rec_size, bulk->comp,
+				   dtuple_get_n_fields(tuple), 0)) {
+		ut_ad(level == 0);
+
+		big_rec = dtuple_convert_big_rec(index, tuple, &n_ext);
+
+		if (big_rec == NULL) {
+			return(DB_TOO_BIG_RECORD);
+		}
+
+		rec_size = rec_get_converted_size(index, tuple, n_ext);
+	}
+
+	if (!btr_bulk_page_has_space(pb, rec_size)) {
+		btr_bulk_page_t*	sibling;
+
+		err = btr_bulk_page_start(bulk, level, FIL_NULL, &sibling);
+
+		if (err == DB_SUCCESS) {
+			err = btr_bulk_page_commit(bulk, pb, sibling, true);
+			bulk->pages[level] = pb = sibling;
+		}
+
+		if (err != DB_SUCCESS) {
+			goto func_exit;
+		}
+
+		if (level == 0 && log_sys->check_flush_or_checkpoint) {
+			btr_bulk_release(bulk);
+			log_free_check();
+			btr_bulk_latch(bulk);
+			pb = bulk->pages[level];
+		}
+	}
+
+	if (pb->leftmost && level > 0 && pb->n_recs == 0) {
+		/* There is no lower limit to the keys in the leftmost
+		page of a non-leaf level. */
+		dtuple_set_info_bits(tuple, dtuple_get_info_bits(tuple)
+				     | REC_INFO_MIN_REC_FLAG);
+	}
+
+	rec = rec_convert_dtuple_to_rec(
+		static_cast<byte*>(mem_heap_alloc(bulk->heap, rec_size)),
+		index, tuple, n_ext);
+	offsets = rec_get_offsets(rec, index, NULL, ULINT_UNDEFINED,
+				  &bulk->heap);
+
+	btr_bulk_page_insert(bulk, pb, rec, offsets);
+
+	err = DB_SUCCESS;
+
+	if (big_rec != NULL) {
+		rec_offs_make_valid(pb->last_rec, index, offsets);
+
+		err = btr_store_big_rec_extern_fields(
+			index, pb->block, pb->last_rec, offsets, big_rec,
+			&pb->mtr, BTR_STORE_INSERT);
+	}
+
+func_exit:
+	if (big_rec != NULL) {
+		dtuple_convert_back_big_rec(index, tuple, big_rec);
+	}
+
+	return(err);
+}
+
+/*********************************************************************//**
+Creates a bulk loader for an empty index tree of an uncompressed table.
+The index entries must be passed to btr_bulk_insert() in ascending
+order; the leaf pages are filled left to right up to innodb_fill_factor
+and the node pointer levels are built bottom-up on the way.
+@return own: bulk loader */
+UNIV_INTERN
+btr_bulk_t*
+btr_bulk_create(
+/*============*/
+	dict_index_t*	index,	/*!< in/out: empty index tree */
+	trx_id_t	trx_id)	/*!< in: transaction creating the index */
+{
+	btr_bulk_t*	bulk;
+
+	ut_ad(!dict_table_zip_size(index->table));
+	ut_ad(!dict_index_is_ibuf(index));
+
+	bulk = static_cast<btr_bulk_t*>(mem_zalloc(sizeof *bulk));
+	bulk->index = index;
+	bulk->trx_id = trx_id;
+	bulk->comp = dict_table_is_comp(index->table);
+	bulk->n_levels = 0;
+	bulk->heap = mem_heap_create(1024);
+
+	return(bulk);
+}
+
+/*********************************************************************//**
+Appends an index entry to the index tree being loaded.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_insert(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	dtuple_t*	tuple)	/*!< in/out: index entry, greater than
+				the previous one */
+{
+	dberr_t	err = btr_bulk_insert_low(bulk, tuple, 0);
+
+	mem_heap_empty(bulk->heap);
+
+	return(err);
+}
+
+/*********************************************************************//**
+Writes the last page of every level, copies the single page of the top
+level to the root page and frees the bulk loader.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_finish(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in, own: bulk loader */
+	dberr_t		err)	/*!< in: DB_SUCCESS, or the error that
+				aborted the load; the pages are then
+				only released */
+{
+	dict_index_t*	index = bulk->index;
+	ulint		last_page_no = FIL_NULL;
+	ulint		level;
+
+	/* Committing a page appends a node pointer to the level above,
+	which may start another page there, or even a new level. */
+	for (level = 0; level < bulk->n_levels; level++) {
+		btr_bulk_page_t*	pb = bulk->pages[level];
+
+		last_page_no = pb->page_no;
+
+		if (err == DB_SUCCESS) {
+			err = btr_bulk_page_commit(
+				bulk, pb, NULL, level + 1 < bulk->n_levels);
+		} else {
+			btr_bulk_page_abort(pb);
+		}
+	}
+
+	if (err == DB_SUCCESS && last_page_no != FIL_NULL) {
+		btr_bulk_page_t*	root;
+		buf_block_t*		last_block;
+		const rec_t*		rec;
+		mtr_t			mtr;
+
+		/* Move the records of the top level page to the root
+		page and free the top level page. */
+		mtr_start(&mtr);
+		mtr_x_lock(dict_index_get_lock(index), &mtr);
+
+		last_block = btr_block_get(index->space, 0, last_page_no,
+					   RW_X_LATCH, index, &mtr);
+
+		err = btr_bulk_page_start(bulk, bulk->n_levels - 1,
+					  dict_index_get_page(index), &root);
+
+		if (err == DB_SUCCESS) {
+			for (rec = page_rec_get_next_const(page_get_infimum_rec(
+					   buf_block_get_frame(last_block)));
+			     !page_rec_is_supremum(rec);
+			     rec = page_rec_get_next_const(rec)) {
+
+				btr_bulk_page_insert(
+					bulk, root, rec,
+					rec_get_offsets(rec, index, NULL,
+							ULINT_UNDEFINED,
+							&bulk->heap));
+			}
+
+			btr_page_free_low(index, last_block,
+					  bulk->n_levels - 1, &mtr);
+			mtr_commit(&mtr);
+
+			err = btr_bulk_page_commit(bulk, root, NULL, false);
+		} else {
+			mtr_commit(&mtr);
+		}
+	}
+
+	mem_heap_free(bulk->heap);
+	mem_free(bulk);
+
+	ut_ad(err != DB_SUCCESS || btr_validate_index(index, NULL));
+
+	return(err);
+}
@@ -169,6 +169,7 @@ btr_pcur_store_position(
 
 	cursor->block_when_stored = block;
 	cursor->modify_clock = buf_block_get_modify_clock(block);
+	cursor->withdraw_clock = buf_withdraw_clock;
 }
 
 /**************************************************************//**
@@ -265,12 +266,14 @@ btr_pcur_restore_position_func(
 
 	if (UNIV_LIKELY(latch_mode == BTR_SEARCH_LEAF)
 	    || UNIV_LIKELY(latch_mode == BTR_MODIFY_LEAF)) {
-		/* Try optimistic restoration. */
-
-		if (buf_page_optimistic_get(latch_mode,
-					    cursor->block_when_stored,
-					    cursor->modify_clock,
-					    file, line, mtr)) {
+		/* Try optimistic restoration, unless a resize of
+		the buffer pool may have withdrawn the block. */
+
+		if (!buf_pool_is_obsolete(cursor->withdraw_clock)
+		    && buf_page_optimistic_get(latch_mode,
+					       cursor->block_when_stored,
+					       cursor->modify_clock,
+					       file, line, mtr)) {
 			cursor->pos_state = BTR_PCUR_IS_POSITIONED;
 			cursor->latch_mode = latch_mode;
 
@@ -362,6 +365,7 @@ btr_pcur_restore_position_func(
 			cursor->modify_clock =
 				buf_block_get_modify_clock(
 					cursor->block_when_stored);
+			cursor->withdraw_clock = buf_withdraw_clock;
 			cursor->old_stored = BTR_PCUR_OLD_STORED;
 
 			mem_heap_free(heap);
@@ -228,6 +228,48 @@ btr_search_sys_free(void)
 	btr_search_sys = NULL;
 }
 
+/*****************************************************************//**
+Resizes the hash tables of the adaptive search system. The adaptive hash
+index must be disabled. */
+UNIV_INTERN
+void
+btr_search_sys_resize(
+/*==================*/
+	ulint	hash_size)	/*!< in: hash index hash table size */
+{
+	ulint	i;
+
+	btr_search_x_lock_all();
+
+	if (btr_search_enabled) {
+		btr_search_x_unlock_all();
+
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Cannot resize the adaptive hash index while it"
+			" is enabled.");
+		ut_ad(0);
+		return;
+	}
+
+	hash_size /= btr_search_index_num;
+
+	for (i = 0; i < btr_search_index_num; i++) {
+
+		mem_heap_free(btr_search_sys->hash_tables[i]->heap);
+
+		hash_table_free(btr_search_sys->hash_tables[i]);
+
+		btr_search_sys->hash_tables[i]
+			= ha_create(hash_size, 0, MEM_HEAP_FOR_BTR_SEARCH, 0);
+
+#if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
+		btr_search_sys->hash_tables[i]->adaptive = TRUE;
+#endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
+	}
+
+	btr_search_x_unlock_all();
+}
+
 /********************************************************************//**
 Set index->ref_count = 0 on all indexes of a table. */
 static
@@ -295,12 +337,22 @@ btr_search_disable(void)
 }
 
 /********************************************************************//**
-Enable the adaptive hash search system. */
+Enable the adaptive hash search system. Does nothing while the buffer
+pool is being resized; the resize enables it when it completes. */
 UNIV_INTERN
 void
 btr_search_enable(void)
 /*====================*/
 {
+	buf_pool_mutex_enter_all();
+
+	if (srv_buf_pool_old_size != srv_buf_pool_size) {
+		buf_pool_mutex_exit_all();
+		return;
+	}
+
+	buf_pool_mutex_exit_all();
+
 	btr_search_x_lock_all();
 
 	btr_search_enabled = TRUE;
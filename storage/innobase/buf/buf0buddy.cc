@@ -324,6 +324,17 @@ buf_buddy_alloc_zip(
 
 	buf = UT_LIST_GET_FIRST(buf_pool->zip_free[i]);
 
+	if (buf_get_withdraw_depth(buf_pool) > 0) {
+
+		/* Do not hand out memory that a shrinking resize
+		is going to withdraw. */
+		while (buf != NULL
+		       && buf_frame_will_withdrawn(
+			       buf_pool, reinterpret_cast<byte*>(buf))) {
+			buf = UT_LIST_GET_NEXT(list, buf);
+		}
+	}
+
 	if (buf) {
 		buf_buddy_remove_from_free(buf_pool, buf, i);
 	} else if (i + 1 < BUF_BUDDY_SIZES) {
@@ -528,8 +539,10 @@ buf_buddy_relocate(
 	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
 	void*		src,		/*!< in: block to relocate */
 	void*		dst,		/*!< in: free block to relocate to */
-	ulint		i)		/*!< in: index of
+	ulint		i,		/*!< in: index of
 					buf_pool->zip_free[] */
+	bool		force)		/*!< in: true if we must relocate
+					always */
 {
 	buf_page_t*	bpage;
 	const ulint	size	= BUF_BUDDY_LOW << i;
@@ -570,7 +583,29 @@ buf_buddy_relocate(
 
 		rw_lock_x_unlock(hash_lock);
 
-		return(false);
+		if (!force || space != 0 || offset != 0) {
+			return(false);
+		}
+
+		/* It may be a page that has not been initialized
+		yet. Search for it in the LRU list. */
+		for (bpage = UT_LIST_GET_FIRST(buf_pool->LRU);
+		     bpage != NULL;
+		     bpage = UT_LIST_GET_NEXT(LRU, bpage)) {
+
+			if (bpage->zip.data == src) {
+				break;
+			}
+		}
+
+		if (bpage == NULL) {
+			return(false);
+		}
+
+		fold = buf_page_address_fold(bpage->space, bpage->offset);
+		hash_lock = buf_page_hash_lock_get(buf_pool, fold);
+
+		rw_lock_x_lock(hash_lock);
 	}
 
 	if (page_zip_get_size(&bpage->zip) != size) {
@@ -662,8 +697,11 @@ recombine:
 
 	/* Do not recombine blocks if there are few free blocks.
 	We may waste up to 15360*max_len bytes to free blocks
-	(1024 + 2048 + 4096 + 8192 = 15360) */
-	if (UT_LIST_GET_LEN(buf_pool->zip_free[i]) < 16) {
+	(1024 + 2048 + 4096 + 8192 = 15360). A shrinking resize
+	recombines them, to free whole frames in the withdrawn
+	chunks. */
+	if (UT_LIST_GET_LEN(buf_pool->zip_free[i]) < 16
+	    && buf_pool->curr_size >= buf_pool->old_size) {
 		goto func_exit;
 	}
 
@@ -698,7 +736,8 @@ buddy_is_free:
 
 			/* Try to relocate the buddy of buf to the free
 			block. */
-			if (buf_buddy_relocate(buf_pool, buddy, zip_buf, i)) {
+			if (buf_buddy_relocate(buf_pool, buddy, zip_buf, i,
+					       false)) {
 
 				goto buddy_is_free;
 			}
@@ -719,3 +758,126 @@ func_exit:
 			      reinterpret_cast<buf_buddy_free_t*>(buf),
 			      i);
 }
+
+/**********************************************************************//**
+Try to reallocate a block, to move it out of the chunks that a shrinking
+resize is going to remove.
+@return	true if there was enough free memory to allocate the new block */
+UNIV_INTERN
+bool
+buf_buddy_realloc(
+/*==============*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	void*		buf,		/*!< in: block to be reallocated,
+					must be pointed to by the
+					buffer pool */
+	ulint		size)		/*!< in: block size, up to
+					UNIV_PAGE_SIZE */
+{
+	buf_block_t*	block = NULL;
+	ulint		i = buf_buddy_get_slot(size);
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+	ut_ad(!mutex_own(&buf_pool->zip_mutex));
+	ut_ad(i <= BUF_BUDDY_SIZES);
+	ut_ad(i >= buf_buddy_get_slot(UNIV_ZIP_SIZE_MIN));
+
+	if (i < BUF_BUDDY_SIZES) {
+		/* Try to allocate from the buddy system. */
+		block = reinterpret_cast<buf_block_t*>(
+			buf_buddy_alloc_zip(buf_pool, i));
+	}
+
+	if (block == NULL) {
+		/* Try allocating from the buf_pool->free list. */
+		block = buf_LRU_get_free_only(buf_pool);
+
+		if (block == NULL) {
+			return(false);
+		}
+
+		buf_buddy_block_register(block);
+
+		block = reinterpret_cast<buf_block_t*>(
+			buf_buddy_alloc_from(
+				buf_pool, block->frame, i, BUF_BUDDY_SIZES));
+	}
+
+	buf_pool->buddy_stat[i].used++;
+
+	/* Try to relocate the buddy of buf to the free block. */
+	if (buf_buddy_relocate(buf_pool, buf, block, i, true)) {
+		buf_buddy_free_low(buf_pool, buf, i);
+	} else {
+		buf_buddy_free_low(buf_pool, block, i);
+	}
+
+	return(true);
+}
+
+/**********************************************************************//**
+Combine all pairs of free buddies in the chunks that a shrinking resize
+is going to remove, so that whole frames can be withdrawn. */
+UNIV_INTERN
+void
+buf_buddy_condense_free(
+/*====================*/
+	buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	ulint	i;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+	ut_ad(buf_pool->curr_size < buf_pool->old_size);
+
+	for (i = 0; i < UT_ARR_SIZE(buf_pool->zip_free); ++i) {
+		buf_buddy_free_t*	buf
+			= UT_LIST_GET_FIRST(buf_pool->zip_free[i]);
+
+		/* Seek to the first block to withdraw. */
+		while (buf != NULL
+		       && !buf_frame_will_withdrawn(
+			       buf_pool, reinterpret_cast<byte*>(buf))) {
+			buf = UT_LIST_GET_NEXT(list, buf);
+		}
+
+		while (buf != NULL) {
+			buf_buddy_free_t*	next
+				= UT_LIST_GET_NEXT(list, buf);
+			buf_buddy_free_t*	buddy
+				= reinterpret_cast<buf_buddy_free_t*>(
+					buf_buddy_get(
+						reinterpret_cast<byte*>(buf),
+						BUF_BUDDY_LOW << i));
+
+			/* Seek to the next block to withdraw, skipping
+			the buddy, which may be freed below. */
+			for (;;) {
+				while (next != NULL
+				       && !buf_frame_will_withdrawn(
+					       buf_pool,
+					       reinterpret_cast<byte*>(
+						       next))) {
+					next = UT_LIST_GET_NEXT(list, next);
+				}
+
+				if (buddy != next) {
+					break;
+				}
+
+				next = UT_LIST_GET_NEXT(list, next);
+			}
+
+			if (buf_buddy_is_free(buddy, i)
+			    == BUF_BUDDY_STATE_FREE) {
+				/* Both buf and buddy are free.
+				Try to combine them. */
+				buf_buddy_remove_from_free(buf_pool, buf, i);
+				buf_pool->buddy_stat[i].used++;
+
+				buf_buddy_free_low(buf_pool, buf, i);
+			}
+
+			buf = next;
+		}
+	}
+}
@@ -53,6 +53,14 @@ Created 11/5/1995 Heikki Tuuri
 #include "page0zip.h"
 #include "srv0mon.h"
 #include "buf0checksum.h"
+#ifndef UNIV_HOTBACKUP
+#include "buf0dump.h"
+#include "buf0flu.h"
+#include "buf0lru.h"
+#include "ha_prototypes.h"
+#include "srv0start.h"
+#endif /* !UNIV_HOTBACKUP */
+#include <algorithm>
 #ifdef HAVE_LIBNUMA
 #include <numa.h>
 #include <numaif.h>
@@ -255,6 +263,40 @@ static const ulint BUF_PAGE_READ_MAX_RETRIES = 100;
 /** The buffer pools of the database */
 UNIV_INTERN buf_pool_t*	buf_pool_ptr;
 
+/** Address range of a buffer pool chunk, an element of buf_chunk_map_t */
+struct buf_chunk_range_t {
+	buf_block_t*	blocks;		/*!< block descriptors of the chunk */
+	const byte*	frame;		/*!< first page frame of the chunk */
+	ulint		size;		/*!< number of blocks in the chunk */
+	ulint		instance_no;	/*!< buffer pool instance */
+};
+
+/** The chunks of all buffer pool instances, sorted by address.
+buf_block_align() and buf_pointer_is_block_field() search it without
+holding any buffer pool mutex, so a resize does not modify it but
+publishes a new map. The replaced map is freed only by the next resize,
+because other threads may still be searching it. */
+struct buf_chunk_map_t {
+	ulint			n_chunks;	/*!< number of chunks */
+	buf_chunk_range_t*	chunks;		/*!< chunks sorted by the
+						address of the blocks */
+};
+
+/** The current chunk map */
+static buf_chunk_map_t*	buf_chunk_map;
+/** The chunk map that was replaced by the last resize */
+static buf_chunk_map_t*	buf_chunk_map_old;
+
+/** Set while a shrinking resize is withdrawing blocks */
+UNIV_INTERN volatile bool	buf_pool_withdrawing;
+
+/** Incremented by every resize that withdrew blocks */
+UNIV_INTERN volatile ulint	buf_withdraw_clock;
+
+/** The buffer pool size in bytes that page_hash, zip_hash and the other
+hash tables whose size depends on it were last sized for */
+static ulint		buf_pool_base_size;
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 static ulint	buf_dbg_counter	= 0; /*!< This is used to insert validation
 					operations in execution in the
@@ -321,10 +363,6 @@ buf_pool_get_oldest_modification(void)
 	lsn_t		lsn = 0;
 	lsn_t		oldest_lsn = 0;
 
-	/* When we traverse all the flush lists we don't want another
-	thread to add a dirty page to any flush list. */
-	log_flush_order_mutex_enter();
-
 	for (i = 0; i < srv_buf_pool_instances; i++) {
 		buf_pool_t*	buf_pool;
 
@@ -346,10 +384,10 @@ buf_pool_get_oldest_modification(void)
 		}
 	}
 
-	log_flush_order_mutex_exit();
-
 	/* The returned answer may be out of date: the flush_list can
-	change after the mutex has been released. */
+	change after the mutex has been released. Pages that are added
+	later have an oldest_modification of at least
+	log_get_closed_lsn() at the time of the insertion. */
 
 	return(oldest_lsn);
 }
@@ -1314,6 +1352,156 @@ buf_pool_set_sizes(void)
 	buf_pool_mutex_exit_all();
 }
 
+/********************************************************************//**
+Frees a chunk that was allocated by buf_chunk_init(), together with the
+latches of its blocks. */
+static
+void
+buf_chunk_free(
+/*===========*/
+	buf_chunk_t*	chunk)	/*!< in,own: chunk to free */
+{
+	buf_block_t*	block = chunk->blocks;
+	ulint		i;
+
+	for (i = chunk->size; i--; block++) {
+		mutex_free(&block->mutex);
+		rw_lock_free(&block->lock);
+#ifdef UNIV_SYNC_DEBUG
+		rw_lock_free(&block->debug_latch);
+#endif /* UNIV_SYNC_DEBUG */
+	}
+
+	os_mem_free_large(chunk->mem, chunk->mem_size);
+}
+
+/********************************************************************//**
+Orders the chunks in buf_chunk_map by address.
+@return	true if a precedes b */
+static
+bool
+buf_chunk_range_less(
+/*=================*/
+	const buf_chunk_range_t&	a,	/*!< in: chunk */
+	const buf_chunk_range_t&	b)	/*!< in: chunk */
+{
+	return(a.blocks < b.blocks);
+}
+
+/********************************************************************//**
+Builds the map of the chunks of all buffer pool instances and makes
+buf_block_align() search it. Called at startup and by a resize that
+holds all the buffer pool mutexes. */
+static
+void
+buf_chunk_map_publish(void)
+/*=======================*/
+{
+	buf_chunk_map_t*	map;
+	buf_chunk_range_t*	range;
+	ulint			n_chunks = 0;
+	ulint			i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		n_chunks += buf_pool_from_array(i)->n_chunks;
+	}
+
+	map = static_cast<buf_chunk_map_t*>(
+		mem_alloc(sizeof *map + n_chunks * sizeof *range));
+
+	map->n_chunks = n_chunks;
+	map->chunks = range = reinterpret_cast<buf_chunk_range_t*>(map + 1);
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		const buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		const buf_chunk_t*	chunk = buf_pool->chunks;
+		const buf_chunk_t*	echunk = chunk + buf_pool->n_chunks;
+
+		for (; chunk < echunk; chunk++, range++) {
+			range->blocks = chunk->blocks;
+			range->frame = chunk->blocks->frame;
+			range->size = chunk->size;
+			range->instance_no = buf_pool->instance_no;
+		}
+	}
+
+	std::sort(map->chunks, map->chunks + n_chunks, buf_chunk_range_less);
+
+	/* The map replaced by the previous resize is no longer
+	being searched. */
+	if (buf_chunk_map_old != NULL) {
+		mem_free(buf_chunk_map_old);
+	}
+
+	buf_chunk_map_old = buf_chunk_map;
+
+	/* Make the contents of the map visible before the map. */
+	os_wmb;
+
+	buf_chunk_map = map;
+}
+
+/********************************************************************//**
+Determines if a block is in a chunk that is being removed from the
+buffer pool instance by a shrinking resize.
+@return	true if the block will be withdrawn */
+UNIV_INTERN
+bool
+buf_block_will_withdrawn(
+/*=====================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	const buf_block_t*	block)		/*!< in: block */
+{
+	const buf_chunk_t*	chunk;
+	const buf_chunk_t*	echunk;
+
+	ut_ad(buf_pool->curr_size < buf_pool->old_size);
+
+	chunk = buf_pool->chunks + buf_pool->n_chunks_new;
+	echunk = buf_pool->chunks + buf_pool->n_chunks;
+
+	for (; chunk < echunk; chunk++) {
+		if (block >= chunk->blocks
+		    && block < chunk->blocks + chunk->size) {
+
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/********************************************************************//**
+Determines if a frame is in a chunk that is being removed from the
+buffer pool instance by a shrinking resize.
+@return	true if the frame will be withdrawn */
+UNIV_INTERN
+bool
+buf_frame_will_withdrawn(
+/*=====================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	const byte*		ptr)		/*!< in: pointer to a frame */
+{
+	const buf_chunk_t*	chunk;
+	const buf_chunk_t*	echunk;
+
+	ut_ad(buf_pool->curr_size < buf_pool->old_size);
+
+	chunk = buf_pool->chunks + buf_pool->n_chunks_new;
+	echunk = buf_pool->chunks + buf_pool->n_chunks;
+
+	for (; chunk < echunk; chunk++) {
+		if (ptr >= chunk->blocks->frame
+		    && ptr < chunk->blocks->frame
+		    + chunk->size * UNIV_PAGE_SIZE) {
+
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
 /********************************************************************//**
 Initialize a buffer pool instance.
 @return DB_SUCCESS if all goes well. */
@@ -1338,25 +1526,42 @@ buf_pool_init_instance(
 	buf_pool_mutex_enter(buf_pool);
 
 	if (buf_pool_size > 0) {
-		buf_pool->n_chunks = 1;
+		/* The size is a multiple of srv_buf_pool_chunk_unit,
+		see buf_pool_size_align() */
+		buf_pool->n_chunks = ut_max(
+			buf_pool_size / srv_buf_pool_chunk_unit, 1);
 
-		buf_pool->chunks = chunk =
-			(buf_chunk_t*) mem_zalloc(sizeof *chunk);
+		buf_pool->chunks = chunk = static_cast<buf_chunk_t*>(
+			mem_zalloc(buf_pool->n_chunks * sizeof *chunk));
 
 		UT_LIST_INIT(buf_pool->free);
+		UT_LIST_INIT(buf_pool->withdraw);
+		buf_pool->withdraw_target = 0;
 
-		if (!buf_chunk_init(buf_pool, chunk, buf_pool_size)) {
-			mem_free(chunk);
-			mem_free(buf_pool);
+		buf_pool->curr_size = 0;
 
-			buf_pool_mutex_exit(buf_pool);
+		for (i = 0; i < buf_pool->n_chunks; i++, chunk++) {
+			if (!buf_chunk_init(buf_pool, chunk,
+					    srv_buf_pool_chunk_unit)) {
 
-			return(DB_ERROR);
+				while (--chunk >= buf_pool->chunks) {
+					buf_chunk_free(chunk);
+				}
+
+				mem_free(buf_pool->chunks);
+
+				buf_pool_mutex_exit(buf_pool);
+
+				return(DB_ERROR);
+			}
+
+			buf_pool->curr_size += chunk->size;
 		}
 
+		buf_pool->n_chunks_new = buf_pool->n_chunks;
 		buf_pool->instance_no = instance_no;
 		buf_pool->old_pool_size = buf_pool_size;
-		buf_pool->curr_size = chunk->size;
+		buf_pool->old_size = buf_pool->curr_size;
 		buf_pool->curr_pool_size = buf_pool->curr_size * UNIV_PAGE_SIZE;
 
 		/* Number of locks protecting page_hash must be a
@@ -1456,6 +1661,12 @@ buf_pool_free_instance(
 	ha_clear(buf_pool->page_hash);
 	hash_table_free(buf_pool->page_hash);
 	hash_table_free(buf_pool->zip_hash);
+
+	if (buf_pool->page_hash_old != NULL) {
+		/* The sync objects were freed by ha_clear() above,
+		see ha_recreate(). */
+		hash_table_free(buf_pool->page_hash_old);
+	}
 }
 
 /********************************************************************//**
@@ -1506,6 +1717,8 @@ buf_pool_init(
 	}
 
 	buf_pool_set_sizes();
+	buf_chunk_map_publish();
+	buf_pool_base_size = srv_buf_pool_size;
 	buf_LRU_old_ratio_update(100 * 3/ 8, FALSE);
 
 	btr_search_sys_create(buf_pool_get_curr_size() / sizeof(void*) / 64);
@@ -1542,6 +1755,16 @@ buf_pool_free(
 
 	mem_free(buf_pool_ptr);
 	buf_pool_ptr = NULL;
+
+	if (buf_chunk_map_old != NULL) {
+		mem_free(buf_chunk_map_old);
+		buf_chunk_map_old = NULL;
+	}
+
+	if (buf_chunk_map != NULL) {
+		mem_free(buf_chunk_map);
+		buf_chunk_map = NULL;
+	}
 }
 
 /********************************************************************//**
@@ -1588,6 +1811,825 @@ buf_pool_clear_hash_index(void)
 	}
 }
 
+/********************************************************************//**
+Sets the global variable that feeds MySQL's innodb_buffer_pool_resize_status
+to the specified string, and writes it to the error log. The format and
+the following parameters are the same as the ones used for printf(3). */
+static MY_ATTRIBUTE((format(printf, 1, 2)))
+void
+buf_resize_status(
+/*==============*/
+	const char*	fmt,	/*!< in: format */
+	...)			/*!< in: extra parameters according to fmt */
+{
+	va_list	ap;
+
+	va_start(ap, fmt);
+
+	ut_vsnprintf(
+		export_vars.innodb_buffer_pool_resize_status,
+		sizeof(export_vars.innodb_buffer_pool_resize_status),
+		fmt, ap);
+
+	va_end(ap);
+
+	ib_logf(IB_LOG_LEVEL_INFO, "%s",
+		export_vars.innodb_buffer_pool_resize_status);
+}
+
+/********************************************************************//**
+Reallocates a file page to a free block outside the chunks that are
+being withdrawn, if it is not buffer-fixed or I/O-fixed. The caller must
+hold buf_pool->mutex and must not hold the block mutex.
+@return	false if there was no free block to reallocate the page to */
+static
+bool
+buf_page_realloc(
+/*=============*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_block_t*	block)		/*!< in: file page to reallocate */
+{
+	buf_block_t*	new_block;
+	rw_lock_t*	hash_lock;
+	ulint		fold;
+
+	ut_ad(buf_pool_withdrawing);
+	ut_ad(buf_pool_mutex_own(buf_pool));
+	ut_ad(buf_block_get_state(block) == BUF_BLOCK_FILE_PAGE);
+
+	new_block = buf_LRU_get_free_only(buf_pool);
+
+	if (new_block == NULL) {
+		return(false);
+	}
+
+	fold = buf_page_address_fold(block->page.space, block->page.offset);
+	hash_lock = buf_page_hash_lock_get(buf_pool, fold);
+
+	rw_lock_x_lock(hash_lock);
+	mutex_enter(&block->mutex);
+
+	if (!buf_page_can_relocate(&block->page)) {
+		rw_lock_x_unlock(hash_lock);
+		mutex_exit(&block->mutex);
+
+		/* The page is in use. Give the new block back. */
+		mutex_enter(&new_block->mutex);
+		buf_LRU_block_free_non_file_page(new_block);
+		mutex_exit(&new_block->mutex);
+
+		return(true);
+	}
+
+	mutex_enter(&new_block->mutex);
+
+	memcpy(new_block->frame, block->frame, UNIV_PAGE_SIZE);
+	memcpy(&new_block->page, &block->page, sizeof block->page);
+
+	/* Relocate buf_pool->LRU. Adjust the hazard pointers before
+	removing the block from the list. */
+	ut_ad(block->page.in_LRU_list);
+	ut_ad(!block->page.in_zip_hash);
+	ut_d(block->page.in_LRU_list = FALSE);
+
+	buf_LRU_adjust_hp(buf_pool, &block->page);
+
+	buf_page_t*	prev_b = UT_LIST_GET_PREV(LRU, &block->page);
+
+	UT_LIST_REMOVE(LRU, buf_pool->LRU, &block->page);
+
+	if (prev_b != NULL) {
+		UT_LIST_INSERT_AFTER(LRU, buf_pool->LRU, prev_b,
+				     &new_block->page);
+	} else {
+		UT_LIST_ADD_FIRST(LRU, buf_pool->LRU, &new_block->page);
+	}
+
+	if (buf_pool->LRU_old == &block->page) {
+		buf_pool->LRU_old = &new_block->page;
+	}
+
+	/* Relocate buf_pool->unzip_LRU. The compressed page frame
+	stays where it is; see buf_buddy_realloc(). */
+	if (block->page.zip.data != NULL) {
+		buf_block_t*	prev_block = UT_LIST_GET_PREV(unzip_LRU, block);
+
+		ut_ad(block->in_unzip_LRU_list);
+		ut_d(new_block->in_unzip_LRU_list = TRUE);
+
+		UT_LIST_REMOVE(unzip_LRU, buf_pool->unzip_LRU, block);
+		ut_d(block->in_unzip_LRU_list = FALSE);
+
+		block->page.zip.data = NULL;
+		page_zip_set_size(&block->page.zip, 0);
+
+		if (prev_block != NULL) {
+			UT_LIST_INSERT_AFTER(unzip_LRU, buf_pool->unzip_LRU,
+					     prev_block, new_block);
+		} else {
+			UT_LIST_ADD_FIRST(unzip_LRU, buf_pool->unzip_LRU,
+					  new_block);
+		}
+	} else {
+		ut_ad(!block->in_unzip_LRU_list);
+		ut_d(new_block->in_unzip_LRU_list = FALSE);
+	}
+
+	/* Relocate buf_pool->page_hash */
+	ut_ad(block->page.in_page_hash);
+	ut_ad(&block->page == buf_page_hash_get_low(
+		      buf_pool, block->page.space, block->page.offset, fold));
+	ut_d(block->page.in_page_hash = FALSE);
+
+	HASH_DELETE(buf_page_t, hash, buf_pool->page_hash, fold,
+		    (&block->page));
+	HASH_INSERT(buf_page_t, hash, buf_pool->page_hash, fold,
+		    (&new_block->page));
+
+	ut_ad(new_block->page.in_page_hash);
+
+	/* Make a stale optimistic restore of a cursor fail. */
+	buf_block_modify_clock_inc(block);
+	memset(block->frame + FIL_PAGE_OFFSET, 0xff, 4);
+	memset(block->frame + FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID, 0xff, 4);
+	UNIV_MEM_INVALID(block->frame, UNIV_PAGE_SIZE);
+	buf_block_set_state(block, BUF_BLOCK_REMOVE_HASH);
+
+	/* Relocate buf_pool->flush_list */
+	if (block->page.oldest_modification) {
+		buf_flush_relocate_on_flush_list(
+			&block->page, &new_block->page);
+	}
+
+	/* The adaptive hash index is disabled during a resize. */
+	ut_ad(block->index == NULL);
+	new_block->index = NULL;
+	new_block->n_hash_helps = 0;
+	new_block->n_fields = 1;
+	new_block->left_side = TRUE;
+
+	new_block->lock_hash_val = block->lock_hash_val;
+	new_block->check_index_page_at_flush
+		= block->check_index_page_at_flush;
+
+	rw_lock_x_unlock(hash_lock);
+	mutex_exit(&new_block->mutex);
+
+	/* Free the old block, buf_LRU_block_free_non_file_page()
+	puts it in buf_pool->withdraw */
+	buf_block_set_state(block, BUF_BLOCK_MEMORY);
+	buf_LRU_block_free_non_file_page(block);
+
+	mutex_exit(&block->mutex);
+
+	return(true);
+}
+
+/********************************************************************//**
+Withdraws the blocks of the chunks that a shrinking resize is going to
+remove from a buffer pool instance: moves the free ones to
+buf_pool->withdraw, evicts or flushes pages from the tail of the LRU
+list, and moves the remaining pages and compressed pages out of the
+chunks.
+@return	true if the blocks could not all be withdrawn yet */
+static
+bool
+buf_pool_withdraw_blocks(
+/*=====================*/
+	buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	buf_block_t*	block;
+	ulint		loop_count = 0;
+	ulint		i = buf_pool_index(buf_pool);
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Buffer pool %lu: withdrawing the last %lu blocks.",
+		i, buf_pool->withdraw_target);
+
+	/* Minimize buf_pool->zip_free[] */
+	buf_pool_mutex_enter(buf_pool);
+	buf_buddy_condense_free(buf_pool);
+	buf_pool_mutex_exit(buf_pool);
+
+	while (UT_LIST_GET_LEN(buf_pool->withdraw)
+	       < buf_pool->withdraw_target) {
+
+		ulint	count1 = 0;
+		ulint	count2 = 0;
+
+		/* Withdraw the free blocks */
+		buf_pool_mutex_enter(buf_pool);
+
+		block = reinterpret_cast<buf_block_t*>(
+			UT_LIST_GET_FIRST(buf_pool->free));
+
+		while (block != NULL
+		       && UT_LIST_GET_LEN(buf_pool->withdraw)
+		       < buf_pool->withdraw_target) {
+
+			buf_block_t*	next_block;
+
+			ut_ad(block->page.in_free_list);
+			ut_ad(!block->page.in_flush_list);
+			ut_ad(!block->page.in_LRU_list);
+			ut_a(!buf_page_in_file(&block->page));
+
+			next_block = reinterpret_cast<buf_block_t*>(
+				UT_LIST_GET_NEXT(list, &block->page));
+
+			if (buf_block_will_withdrawn(buf_pool, block)) {
+				UT_LIST_REMOVE(list, buf_pool->free,
+					       &block->page);
+				ut_d(block->page.in_free_list = FALSE);
+				UT_LIST_ADD_LAST(list, buf_pool->withdraw,
+						 &block->page);
+				count1++;
+			}
+
+			block = next_block;
+		}
+
+		buf_pool_mutex_exit(buf_pool);
+
+		/* Evict or flush pages from the tail of the LRU list, to
+		get free blocks to move the remaining pages to. */
+		if (UT_LIST_GET_LEN(buf_pool->withdraw)
+		    < buf_pool->withdraw_target) {
+
+			buf_flush_LRU_list(buf_pool);
+			buf_flush_wait_batch_end(buf_pool, BUF_FLUSH_LRU);
+		}
+
+		/* Move the pages and compressed pages out of the
+		chunks that are going to be removed. */
+		buf_pool_mutex_enter(buf_pool);
+
+		buf_page_t*	bpage = UT_LIST_GET_FIRST(buf_pool->LRU);
+
+		while (bpage != NULL) {
+			ib_mutex_t*	block_mutex;
+			buf_page_t*	next_bpage;
+
+			block_mutex = buf_page_get_mutex(bpage);
+			mutex_enter(block_mutex);
+
+			next_bpage = UT_LIST_GET_NEXT(LRU, bpage);
+
+			if (bpage->zip.data != NULL
+			    && buf_frame_will_withdrawn(
+				    buf_pool,
+				    static_cast<byte*>(bpage->zip.data))
+			    && buf_page_can_relocate(bpage)) {
+
+				mutex_exit(block_mutex);
+				buf_pool_mutex_exit_forbid(buf_pool);
+
+				if (!buf_buddy_realloc(
+					    buf_pool, bpage->zip.data,
+					    page_zip_get_size(&bpage->zip))) {
+					/* No free block */
+					buf_pool_mutex_exit_allow(buf_pool);
+					break;
+				}
+
+				buf_pool_mutex_exit_allow(buf_pool);
+				mutex_enter(block_mutex);
+				count2++;
+			}
+
+			if (buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE
+			    && buf_block_will_withdrawn(
+				    buf_pool,
+				    reinterpret_cast<buf_block_t*>(bpage))
+			    && buf_page_can_relocate(bpage)) {
+
+				mutex_exit(block_mutex);
+				buf_pool_mutex_exit_forbid(buf_pool);
+
+				if (!buf_page_realloc(
+					    buf_pool,
+					    reinterpret_cast<buf_block_t*>(
+						    bpage))) {
+					/* No free block */
+					buf_pool_mutex_exit_allow(buf_pool);
+					break;
+				}
+
+				buf_pool_mutex_exit_allow(buf_pool);
+				count2++;
+			} else {
+				mutex_exit(block_mutex);
+			}
+
+			/* A page that is in use is retried in the
+			next round. */
+			bpage = next_bpage;
+		}
+
+		buf_pool_mutex_exit(buf_pool);
+
+		buf_resize_status(
+			"Buffer pool %lu: withdrawing blocks (%lu/%lu).",
+			i, UT_LIST_GET_LEN(buf_pool->withdraw),
+			buf_pool->withdraw_target);
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Buffer pool %lu: withdrew %lu blocks from the free"
+			" list. Tried to relocate %lu pages (%lu/%lu).",
+			i, count1, count2,
+			UT_LIST_GET_LEN(buf_pool->withdraw),
+			buf_pool->withdraw_target);
+
+		if (++loop_count >= 10) {
+			/* Give the other instances a chance and retry
+			later. */
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"Buffer pool %lu: will retry to withdraw"
+				" later.", i);
+			return(true);
+		}
+	}
+
+	/* Check that all the blocks were withdrawn */
+	const buf_chunk_t*	chunk = buf_pool->chunks
+		+ buf_pool->n_chunks_new;
+	const buf_chunk_t*	echunk = buf_pool->chunks
+		+ buf_pool->n_chunks;
+
+	for (; chunk < echunk; chunk++) {
+		ulint	j;
+
+		block = chunk->blocks;
+
+		for (j = chunk->size; j--; block++) {
+			ut_a(buf_block_get_state(block) == BUF_BLOCK_NOT_USED);
+			ut_ad(!block->page.in_free_list);
+		}
+	}
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Buffer pool %lu: withdrew the target of %lu blocks.",
+		i, UT_LIST_GET_LEN(buf_pool->withdraw));
+
+	return(false);
+}
+
+/********************************************************************//**
+Computes the fold of a page in buf_pool->page_hash.
+@return	fold */
+static
+ulint
+buf_page_hash_fold(
+/*===============*/
+	const buf_page_t*	bpage)	/*!< in: page */
+{
+	return(buf_page_address_fold(bpage->space, bpage->offset));
+}
+
+/********************************************************************//**
+Computes the fold of a block in buf_pool->zip_hash.
+@return	fold */
+static
+ulint
+buf_page_zip_hash_fold(
+/*===================*/
+	const buf_page_t*	bpage)	/*!< in: block */
+{
+	return(BUF_POOL_ZIP_FOLD_BPAGE(bpage));
+}
+
+/********************************************************************//**
+Resizes page_hash and zip_hash of a buffer pool instance to its current
+size. The caller must hold buf_pool->mutex and all the page_hash latches.
+The replaced page_hash is kept in buf_pool->page_hash_old until the next
+resize, because other threads may still be reading its sync objects,
+which it shares with the new page_hash. */
+static
+void
+buf_pool_resize_hash(
+/*=================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	hash_table_t*	new_hash_table;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	/* Recreate page_hash */
+	new_hash_table = ha_recreate(
+		buf_pool->page_hash, 2 * buf_pool->curr_size);
+
+	HASH_MIGRATE(buf_pool->page_hash, new_hash_table, buf_page_t, hash,
+		     buf_page_hash_fold);
+
+	if (buf_pool->page_hash_old != NULL) {
+		hash_table_free(buf_pool->page_hash_old);
+	}
+
+	buf_pool->page_hash_old = buf_pool->page_hash;
+	buf_pool->page_hash = new_hash_table;
+
+	/* Recreate zip_hash, which is only protected by buf_pool->mutex */
+	new_hash_table = hash_create(2 * buf_pool->curr_size);
+
+	HASH_MIGRATE(buf_pool->zip_hash, new_hash_table, buf_page_t, hash,
+		     buf_page_zip_hash_fold);
+
+	hash_table_free(buf_pool->zip_hash);
+	buf_pool->zip_hash = new_hash_table;
+}
+
+/********************************************************************//**
+Resizes the buffer pool to srv_buf_pool_size. A shrinking resize first
+withdraws the blocks of the chunks to be removed while the buffer pool is
+in use; then the chunks are removed or added while holding all the buffer
+pool mutexes and page_hash latches. */
+static
+void
+buf_pool_resize(void)
+/*=================*/
+{
+	buf_pool_t*	buf_pool;
+	ulint		new_instance_size;
+	bool		btr_search_disabled;
+	bool		warning = false;
+	ulint		i;
+
+	ut_ad(!buf_pool_withdrawing);
+	ut_ad(srv_buf_pool_chunk_unit > 0);
+
+	new_instance_size = srv_buf_pool_size / srv_buf_pool_instances;
+	new_instance_size /= UNIV_PAGE_SIZE;
+
+	buf_resize_status("Resizing buffer pool from %lu to %lu"
+			  " (unit=%lu).",
+			  srv_buf_pool_old_size, srv_buf_pool_size,
+			  srv_buf_pool_chunk_unit);
+
+	/* Set the new limits of all the instances */
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
+		buf_pool_mutex_enter(buf_pool);
+
+		ut_ad(buf_pool->curr_size == buf_pool->old_size);
+		ut_ad(buf_pool->n_chunks_new == buf_pool->n_chunks);
+		ut_ad(UT_LIST_GET_LEN(buf_pool->withdraw) == 0);
+
+		buf_pool->curr_size = new_instance_size;
+
+		buf_pool->n_chunks_new = new_instance_size * UNIV_PAGE_SIZE
+			/ srv_buf_pool_chunk_unit;
+
+		buf_pool_mutex_exit(buf_pool);
+	}
+
+	/* Disable the adaptive hash index: it points to the blocks
+	that are relocated. btr_search_enable() does nothing until
+	the resize has completed. */
+	buf_resize_status("Disabling adaptive hash index.");
+
+	btr_search_disabled = btr_search_enabled;
+
+	btr_search_disable();
+
+	/* Set the withdraw targets */
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
+
+		if (buf_pool->curr_size < buf_pool->old_size) {
+			ulint			withdraw_target = 0;
+			const buf_chunk_t*	chunk = buf_pool->chunks
+				+ buf_pool->n_chunks_new;
+			const buf_chunk_t*	echunk = buf_pool->chunks
+				+ buf_pool->n_chunks;
+
+			for (; chunk < echunk; chunk++) {
+				withdraw_target += chunk->size;
+			}
+
+			buf_pool_mutex_enter(buf_pool);
+			buf_pool->withdraw_target = withdraw_target;
+			buf_pool_mutex_exit(buf_pool);
+
+			buf_pool_withdrawing = true;
+		}
+	}
+
+	buf_resize_status("Withdrawing blocks to be shrunken.");
+
+	ib_time_t	withdraw_started = ut_time();
+	ulint		message_interval = 60;
+	ulint		retry_interval = 1;
+
+	for (;;) {
+		bool	should_retry_withdraw = false;
+
+		for (i = 0; i < srv_buf_pool_instances; i++) {
+			buf_pool = buf_pool_from_array(i);
+
+			if (buf_pool->curr_size < buf_pool->old_size) {
+				should_retry_withdraw
+					|= buf_pool_withdraw_blocks(buf_pool);
+			}
+		}
+
+		if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+			/* Abort the resize for shutdown. The
+			withdrawn blocks are freed with their chunks. */
+			buf_pool_withdrawing = false;
+			return;
+		}
+
+		/* A buffer pool load would keep reading pages in. */
+		buf_load_abort();
+
+		if (!should_retry_withdraw) {
+			break;
+		}
+
+		if (ut_difftime(ut_time(), withdraw_started)
+		    >= message_interval) {
+
+			ib_logf(IB_LOG_LEVEL_WARN,
+				"Buffer pool resize is waiting for blocks"
+				" that are still in use. It can complete"
+				" only after the transactions that use"
+				" them release them.");
+
+			message_interval = ut_min(message_interval * 2, 1800);
+			withdraw_started = ut_time();
+		}
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Will retry to withdraw %lu seconds later.",
+			retry_interval);
+
+		os_thread_sleep(retry_interval * 1000000);
+
+		retry_interval = ut_min(retry_interval * 2, 10);
+	}
+
+	buf_pool_withdrawing = false;
+
+	buf_resize_status("Latching whole of buffer pool.");
+
+	/* Acquire all buf_pool mutexes and page_hash latches. The
+	adaptive hash index latches keep buf_pool_clear_hash_index()
+	away from the chunks. */
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_mutex_enter(buf_pool_from_array(i));
+	}
+
+	btr_search_x_lock_all();
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		hash_lock_x_all(buf_pool_from_array(i)->page_hash);
+	}
+
+	/* Remove or add chunks */
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_chunk_t*	chunk;
+		buf_chunk_t*	echunk;
+		buf_chunk_t*	new_chunks;
+		ulint		n_chunks_copy;
+		ulint		new_size = 0;
+
+		buf_pool = buf_pool_from_array(i);
+
+		buf_resize_status("Buffer pool %lu: resizing with chunks"
+				  " %lu to %lu.",
+				  i, buf_pool->n_chunks,
+				  buf_pool->n_chunks_new);
+
+		if (buf_pool->n_chunks_new < buf_pool->n_chunks) {
+			ulint	sum_freed = 0;
+
+			chunk = buf_pool->chunks + buf_pool->n_chunks_new;
+			echunk = buf_pool->chunks + buf_pool->n_chunks;
+
+			for (; chunk < echunk; chunk++) {
+				sum_freed += chunk->size;
+				buf_chunk_free(chunk);
+			}
+
+			/* The withdrawn blocks were in the freed chunks */
+			UT_LIST_INIT(buf_pool->withdraw);
+			buf_pool->withdraw_target = 0;
+
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"Buffer pool %lu: %lu chunks (%lu blocks)"
+				" were freed.",
+				i, buf_pool->n_chunks - buf_pool->n_chunks_new,
+				sum_freed);
+
+			buf_pool->n_chunks = buf_pool->n_chunks_new;
+		}
+
+		/* Reallocate buf_pool->chunks */
+		new_chunks = static_cast<buf_chunk_t*>(
+			mem_zalloc(buf_pool->n_chunks_new
+				   * sizeof *new_chunks));
+
+		n_chunks_copy = ut_min(buf_pool->n_chunks_new,
+				       buf_pool->n_chunks);
+
+		memcpy(new_chunks, buf_pool->chunks,
+		       n_chunks_copy * sizeof *new_chunks);
+
+		mem_free(buf_pool->chunks);
+		buf_pool->chunks = new_chunks;
+
+		if (buf_pool->n_chunks_new > buf_pool->n_chunks) {
+			ulint	sum_added = 0;
+			ulint	n_chunks = buf_pool->n_chunks;
+
+			chunk = buf_pool->chunks + buf_pool->n_chunks;
+			echunk = buf_pool->chunks + buf_pool->n_chunks_new;
+
+			for (; chunk < echunk; chunk++) {
+				if (!buf_chunk_init(buf_pool, chunk,
+						    srv_buf_pool_chunk_unit)) {
+
+					ib_logf(IB_LOG_LEVEL_ERROR,
+						"Buffer pool %lu: failed to"
+						" allocate new memory.", i);
+					warning = true;
+					break;
+				}
+
+				sum_added += chunk->size;
+				++n_chunks;
+			}
+
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"Buffer pool %lu: %lu chunks (%lu blocks)"
+				" were added.",
+				i, n_chunks - buf_pool->n_chunks, sum_added);
+
+			buf_pool->n_chunks = n_chunks;
+		}
+
+		/* Recalculate buf_pool->curr_size */
+		chunk = buf_pool->chunks;
+		echunk = chunk + buf_pool->n_chunks;
+
+		for (; chunk < echunk; chunk++) {
+			new_size += chunk->size;
+		}
+
+		buf_pool->curr_size = new_size;
+		buf_pool->n_chunks_new = buf_pool->n_chunks;
+	}
+
+	buf_chunk_map_publish();
+
+	/* Set the instance sizes */
+	ulint	curr_size = 0;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool = buf_pool_from_array(i);
+
+		ut_ad(UT_LIST_GET_LEN(buf_pool->withdraw) == 0);
+
+		buf_pool->curr_pool_size = buf_pool->curr_size * UNIV_PAGE_SIZE;
+		curr_size += buf_pool->curr_pool_size;
+		buf_pool->old_size = buf_pool->curr_size;
+	}
+
+	srv_buf_pool_curr_size = curr_size;
+
+	if (warning) {
+		/* Report the size that could be allocated */
+		srv_buf_pool_size = buf_pool_size_align(curr_size);
+		innodb_set_buf_pool_size(srv_buf_pool_size);
+	}
+
+	const bool	new_size_too_diff
+		= buf_pool_base_size > srv_buf_pool_size * 2
+		|| buf_pool_base_size * 2 < srv_buf_pool_size;
+
+	/* Resize page_hash and zip_hash if the size changed much */
+	if (!warning && new_size_too_diff) {
+		buf_resize_status("Resizing hash tables.");
+
+		for (i = 0; i < srv_buf_pool_instances; i++) {
+			buf_pool_resize_hash(buf_pool_from_array(i));
+		}
+	}
+
+	++buf_withdraw_clock;
+
+	/* Release all buf_pool mutexes and page_hash latches */
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		hash_unlock_x_all(buf_pool_from_array(i)->page_hash);
+	}
+
+	btr_search_x_unlock_all();
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_mutex_exit(buf_pool_from_array(i));
+	}
+
+	/* Resize the other hash tables if the size changed much */
+	if (!warning && new_size_too_diff) {
+		buf_pool_base_size = srv_buf_pool_size;
+
+		buf_resize_status("Resizing also other hash tables.");
+
+		srv_lock_table_size = 5 * (srv_buf_pool_size / UNIV_PAGE_SIZE);
+		lock_sys_resize(srv_lock_table_size);
+
+		btr_search_sys_resize(
+			buf_pool_get_curr_size() / sizeof(void*) / 64);
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Resized hash tables at lock_sys and adaptive"
+			" hash index.");
+	}
+
+	/* The change buffer may use a percentage of the buffer pool */
+	ibuf_max_size_update(srv_change_buffer_max_size);
+
+	if (srv_buf_pool_old_size != srv_buf_pool_size) {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Completed to resize buffer pool from %lu to %lu.",
+			srv_buf_pool_old_size, srv_buf_pool_size);
+
+		srv_buf_pool_old_size = srv_buf_pool_size;
+	}
+
+	if (btr_search_disabled) {
+		btr_search_enable();
+		ib_logf(IB_LOG_LEVEL_INFO, "Re-enabled adaptive hash index.");
+	}
+
+	char	now[32];
+
+	ut_sprintf_timestamp(now);
+
+	if (!warning) {
+		buf_resize_status("Completed resizing buffer pool at %s.",
+				  now);
+	} else {
+		buf_resize_status("Resizing buffer pool failed,"
+				  " finished resizing at %s.", now);
+	}
+
+#if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
+	ut_a(buf_validate());
+#endif /* UNIV_DEBUG || UNIV_BUF_DEBUG */
+}
+
+/*********************************************************************//**
+This is the thread that resizes the buffer pool when
+innodb_buffer_pool_size is changed. It waits for srv_buf_resize_event.
+@return	this function does not return, it calls os_thread_exit() */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_resize_thread)(
+/*==============================*/
+	void*	arg MY_ATTRIBUTE((unused)))	/*!< in: a dummy parameter
+						required by os_thread_create */
+{
+	ut_ad(!srv_read_only_mode);
+
+	srv_buf_resize_thread_active = TRUE;
+
+	buf_resize_status("not started");
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+
+		os_event_wait(srv_buf_resize_event);
+		os_event_reset(srv_buf_resize_event);
+
+		if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+			break;
+		}
+
+		buf_pool_mutex_enter_all();
+
+		if (srv_buf_pool_old_size == srv_buf_pool_size) {
+			buf_pool_mutex_exit_all();
+
+			buf_resize_status("Size did not change (old size ="
+					  " new size = %lu). Nothing to do.",
+					  srv_buf_pool_size);
+			continue;
+		}
+
+		buf_pool_mutex_exit_all();
+
+		buf_pool_resize();
+	}
+
+	srv_buf_resize_thread_active = FALSE;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /********************************************************************//**
 Relocate a buffer control block.  Relocates the block on the LRU list
 and in buf_pool->page_hash.  Does not relocate bpage->list.
@@ -2424,32 +3466,54 @@ buf_zip_decompress(
 
 #ifndef UNIV_HOTBACKUP
 /*******************************************************************//**
-Gets the block to whose frame the pointer is pointing to if found
-in this buffer pool instance.
-@return	pointer to block */
-UNIV_INTERN
-buf_block_t*
-buf_block_align_instance(
-/*=====================*/
- 	buf_pool_t*	buf_pool,	/*!< in: buffer in which the block
-					resides */
-	const byte*	ptr)		/*!< in: pointer to a frame */
+Finds the chunk whose memory may contain a pointer, that is, the last
+chunk in buf_chunk_map whose block descriptors start at or below it.
+The chunk memory is not dereferenced.
+@return chunk range, or NULL if the pointer precedes all chunks */
+static
+const buf_chunk_range_t*
+buf_chunk_map_find(
+/*===============*/
+	const void*	ptr)	/*!< in: pointer not dereferenced */
 {
-	buf_chunk_t*	chunk;
-	ulint		i;
+	const buf_chunk_map_t*		map = buf_chunk_map;
+	const buf_chunk_range_t*	first;
+	const buf_chunk_range_t*	last;
 
-	/* TODO: protect buf_pool->chunks with a mutex (it will
-	currently remain constant after buf_pool_init()) */
-	for (chunk = buf_pool->chunks, i = buf_pool->n_chunks; i--; chunk++) {
-		ulint	offs;
+	/* Pairs with the os_wmb in buf_chunk_map_publish() */
+	os_rmb;
 
-		if (UNIV_UNLIKELY(ptr < chunk->blocks->frame)) {
+	first = map->chunks;
+	last = first + map->n_chunks;
 
-			continue;
+	/* Binary search for the first chunk that starts above ptr */
+	while (first < last) {
+		const buf_chunk_range_t*	mid
+			= first + (last - first) / 2;
+
+		if (ptr < (const void*) mid->blocks) {
+			last = mid;
+		} else {
+			first = mid + 1;
 		}
-		/* else */
+	}
+
+	return(first == map->chunks ? NULL : first - 1);
+}
+
+/*******************************************************************//**
+Gets the block to whose frame the pointer is pointing to.
+@return	pointer to block, never NULL */
+UNIV_INTERN
+buf_block_t*
+buf_block_align(
+/*============*/
+	const byte*	ptr)	/*!< in: pointer to a frame */
+{
+	const buf_chunk_range_t*	chunk = buf_chunk_map_find(ptr);
 
-		offs = ptr - chunk->blocks->frame;
+	if (chunk != NULL && ptr >= chunk->frame) {
+		ulint	offs = ptr - chunk->frame;
 
 		offs >>= UNIV_PAGE_SIZE_SHIFT;
 
@@ -2511,30 +3575,6 @@ buf_block_align_instance(
 		}
 	}
 
-	return(NULL);
-}
-
-/*******************************************************************//**
-Gets the block to whose frame the pointer is pointing to.
-@return	pointer to block, never NULL */
-UNIV_INTERN
-buf_block_t*
-buf_block_align(
-/*============*/
-	const byte*	ptr)	/*!< in: pointer to a frame */
-{
-	ulint		i;
-
-	for (i = 0; i < srv_buf_pool_instances; i++) {
-		buf_block_t*	block;
-
-		block = buf_block_align_instance(
-			buf_pool_from_array(i), ptr);
-		if (block) {
-			return(block);
-		}
-	}
-
 	/* The block should always be found. */
 	ut_error;
 	return(NULL);
@@ -2552,22 +3592,11 @@ buf_pointer_is_block_field_instance(
 	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
 	const void*	ptr)		/*!< in: pointer not dereferenced */
 {
-	const buf_chunk_t*		chunk	= buf_pool->chunks;
-	const buf_chunk_t* const	echunk	= chunk + buf_pool->n_chunks;
+	const buf_chunk_range_t*	chunk = buf_chunk_map_find(ptr);
 
-	/* TODO: protect buf_pool->chunks with a mutex (it will
-	currently remain constant after buf_pool_init()) */
-	while (chunk < echunk) {
-		if (ptr >= (void*) chunk->blocks
-		    && ptr < (void*) (chunk->blocks + chunk->size)) {
-
-			return(TRUE);
-		}
-
-		chunk++;
-	}
-
-	return(FALSE);
+	return(chunk != NULL
+	       && chunk->instance_no == buf_pool->instance_no
+	       && ptr < (const void*) (chunk->blocks + chunk->size));
 }
 
 /********************************************************************//**
@@ -2580,19 +3609,10 @@ buf_pointer_is_block_field(
 /*=======================*/
 	const void*	ptr)	/*!< in: pointer not dereferenced */
 {
-	ulint	i;
-
-	for (i = 0; i < srv_buf_pool_instances; i++) {
-		ibool	found;
+	const buf_chunk_range_t*	chunk = buf_chunk_map_find(ptr);
 
-		found = buf_pointer_is_block_field_instance(
-			buf_pool_from_array(i), ptr);
-		if (found) {
-			return(TRUE);
-		}
-	}
-
-	return(FALSE);
+	return(chunk != NULL
+	       && ptr < (const void*) (chunk->blocks + chunk->size));
 }
 
 /********************************************************************//**
@@ -4342,6 +5362,24 @@ buf_page_io_complete(
 				goto page_not_corrupt;
 				;);
 corrupt:
+			if (srv_use_atomic_writes && recv_recovery_is_on()
+			    && srv_force_recovery < SRV_FORCE_IGNORE_CORRUPT) {
+				/* The page was not written through the
+				doublewrite buffer, and the redo log cannot
+				repair a torn page. Refuse to start rather
+				than apply the log to a corrupt page. */
+				ib_logf(IB_LOG_LEVEL_FATAL,
+					"Torn page %lu:%lu found in crash"
+					" recovery although"
+					" innodb_atomic_writes is in use: the"
+					" storage does not write pages"
+					" atomically. Restore the database"
+					" from a backup and disable"
+					" innodb_atomic_writes.",
+					(ulong) bpage->space,
+					(ulong) bpage->offset);
+			}
+
 			fprintf(stderr,
 				"InnoDB: Database page corruption on disk"
 				" or a failed\n"
@@ -4826,7 +5864,8 @@ assert_s_latched:
 
 	mutex_exit(&buf_pool->zip_mutex);
 
-	if (n_lru + n_free > buf_pool->curr_size + n_zip) {
+	if (buf_pool->curr_size == buf_pool->old_size
+	    && n_lru + n_free > buf_pool->curr_size + n_zip) {
 		fprintf(stderr, "n LRU %lu, n free %lu, pool %lu zip %lu\n",
 			(ulong) n_lru, (ulong) n_free,
 			(ulong) buf_pool->curr_size, (ulong) n_zip);
@@ -4834,7 +5873,8 @@ assert_s_latched:
 	}
 
 	ut_a(UT_LIST_GET_LEN(buf_pool->LRU) == n_lru);
-	if (UT_LIST_GET_LEN(buf_pool->free) != n_free) {
+	if (UT_LIST_GET_LEN(buf_pool->free)
+	    + UT_LIST_GET_LEN(buf_pool->withdraw) != n_free) {
 		fprintf(stderr, "Free list len %lu, free blocks %lu\n",
 			(ulong) UT_LIST_GET_LEN(buf_pool->free),
 			(ulong) n_free);
@@ -31,6 +31,7 @@ Created 2011/12/19
 
 #include "buf0buf.h"
 #include "buf0checksum.h"
+#include "buf0flu.h"
 #include "srv0start.h"
 #include "srv0srv.h"
 #include "page0zip.h"
@@ -49,6 +50,10 @@ UNIV_INTERN buf_dblwr_t*	buf_dblwr = NULL;
 /** Set to TRUE when the doublewrite buffer is being created */
 UNIV_INTERN ibool	buf_dblwr_being_created = FALSE;
 
+/** Number of single page flush slots in the LRU shard of an instance */
+#define BUF_DBLWR_N_SINGLE_PAGE_SLOTS				\
+	(2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE - srv_doublewrite_batch_size)
+
 /****************************************************************//**
 Determines if a page number is located inside the doublewrite buffer.
 @return TRUE if the location is inside the two blocks of the
@@ -119,6 +124,148 @@ buf_dblwr_sync_datafiles()
 	fil_flush_file_spaces(FIL_TABLESPACE);
 }
 
+/****************************************************************//**
+Builds the name of the doublewrite file of a buffer pool instance.
+@return own: file name, to be freed with mem_free() */
+static
+char*
+buf_dblwr_file_name(
+/*================*/
+	ulint	i)	/*!< in: buffer pool instance number */
+{
+	const char*	dir = srv_doublewrite_dir != NULL
+		? srv_doublewrite_dir : srv_data_home;
+	ulint		dirlen = strlen(dir);
+	ulint		len = dirlen + sizeof BUF_DBLWR_FILE_NAME + 22;
+	char*		name = static_cast<char*>(mem_alloc(len));
+
+	if (dirlen > 0 && dir[dirlen - 1] == SRV_PATH_SEPARATOR) {
+		dirlen--;
+	}
+
+	ut_snprintf(name, len, "%.*s%c%s%lu", (int) dirlen, dir,
+		    SRV_PATH_SEPARATOR, BUF_DBLWR_FILE_NAME, (ulong) i);
+
+	return(name);
+}
+
+/****************************************************************//**
+Initializes a doublewrite shard of a buffer pool instance. */
+static
+void
+buf_dblwr_shard_init(
+/*=================*/
+	buf_dblwr_shard_t*	shard,	/*!< out: shard to initialize */
+	ulint			i,	/*!< in: buffer pool instance
+					number */
+	buf_flush_t		flush_type)/*!< in: BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+{
+	ulint	batch_size = srv_doublewrite_batch_size;
+	ulint	buf_size;
+
+	mutex_create(buf_dblwr_mutex_key, &shard->mutex, SYNC_DOUBLEWRITE);
+
+	shard->file = buf_dblwr->files[i];
+	shard->file_name = buf_dblwr->file_names[i];
+
+	/* The file of an instance holds the flush list batch region,
+	the LRU batch region and the single page flush slots. */
+	shard->offset = (flush_type == BUF_FLUSH_LRU ? batch_size : 0)
+		* UNIV_PAGE_SIZE;
+	shard->s_offset = 2 * batch_size * UNIV_PAGE_SIZE;
+	shard->n_slots = flush_type == BUF_FLUSH_LRU
+		? BUF_DBLWR_N_SINGLE_PAGE_SLOTS : 0;
+
+	shard->b_event = os_event_create();
+	shard->s_event = os_event_create();
+	shard->first_free = 0;
+	shard->s_reserved = 0;
+	shard->b_reserved = 0;
+	shard->batch_running = false;
+
+	buf_size = batch_size + shard->n_slots;
+
+	shard->in_use = static_cast<bool*>(
+		mem_zalloc((shard->n_slots + 1) * sizeof(bool)));
+
+	shard->write_buf_unaligned = static_cast<byte*>(
+		ut_malloc((1 + buf_size) * UNIV_PAGE_SIZE));
+
+	shard->write_buf = static_cast<byte*>(
+		ut_align(shard->write_buf_unaligned,
+			 UNIV_PAGE_SIZE));
+
+	shard->buf_block_arr = static_cast<buf_page_t**>(
+		mem_zalloc(buf_size * sizeof(void*)));
+}
+
+/****************************************************************//**
+Opens or creates the doublewrite files, one for each buffer pool instance,
+and initializes the doublewrite shards writing to them. */
+static
+void
+buf_dblwr_open_files(void)
+/*======================*/
+{
+	ulint		n_files = srv_buf_pool_instances;
+	os_offset_t	size = BUF_DBLWR_FILE_PAGES * UNIV_PAGE_SIZE;
+
+	buf_dblwr->files = static_cast<os_file_t*>(
+		mem_zalloc(n_files * sizeof(os_file_t)));
+	buf_dblwr->file_names = static_cast<char**>(
+		mem_zalloc(n_files * sizeof(char*)));
+
+	for (ulint i = 0; i < n_files; i++) {
+		char*	name = buf_dblwr_file_name(i);
+		ibool	success;
+
+		buf_dblwr->file_names[i] = name;
+
+		buf_dblwr->files[i] = os_file_create(
+			innodb_file_data_key, name,
+			OS_FILE_OPEN | OS_FILE_ON_ERROR_NO_EXIT
+			| OS_FILE_ON_ERROR_SILENT,
+			OS_FILE_NORMAL, OS_DATA_FILE, &success);
+
+		if (!success) {
+			buf_dblwr->files[i] = os_file_create(
+				innodb_file_data_key, name,
+				OS_FILE_CREATE | OS_FILE_ON_ERROR_NO_EXIT,
+				OS_FILE_NORMAL, OS_DATA_FILE, &success);
+
+			if (!success) {
+				ib_logf(IB_LOG_LEVEL_FATAL,
+					"Cannot create doublewrite file %s",
+					name);
+			}
+
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"Created doublewrite file %s", name);
+		}
+
+		if (os_file_get_size(buf_dblwr->files[i]) < size
+		    && !os_file_set_size(name, buf_dblwr->files[i], size)) {
+			ib_logf(IB_LOG_LEVEL_FATAL,
+				"Cannot set doublewrite file %s size"
+				" to %lu pages",
+				name, (ulong) BUF_DBLWR_FILE_PAGES);
+		}
+	}
+
+	buf_dblwr->shards = static_cast<buf_dblwr_shard_t*>(
+		mem_zalloc(2 * n_files * sizeof(buf_dblwr_shard_t)));
+
+	for (ulint i = 0; i < n_files; i++) {
+		buf_dblwr_shard_init(&buf_dblwr->shards[2 * i], i,
+				     BUF_FLUSH_LIST);
+		buf_dblwr_shard_init(&buf_dblwr->shards[2 * i + 1], i,
+				     BUF_FLUSH_LRU);
+	}
+
+	buf_dblwr->n_files = n_files;
+}
+
 /****************************************************************//**
 Creates or initialializes the doublewrite buffer at a database start. */
 static
@@ -128,46 +275,62 @@ buf_dblwr_init(
 	byte*	doublewrite)	/*!< in: pointer to the doublewrite buf
 				header on trx sys page */
 {
-	ulint	buf_size;
-
 	buf_dblwr = static_cast<buf_dblwr_t*>(
 		mem_zalloc(sizeof(buf_dblwr_t)));
 
-	/* There are two blocks of same size in the doublewrite
-	buffer. */
-	buf_size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
-
 	/* There must be atleast one buffer for single page writes
 	and one buffer for batch writes. */
 	ut_a(srv_doublewrite_batch_size > 0
-	     && srv_doublewrite_batch_size < buf_size);
-
-	mutex_create(buf_dblwr_mutex_key,
-		     &buf_dblwr->mutex, SYNC_DOUBLEWRITE);
-
-	buf_dblwr->b_event = os_event_create();
-	buf_dblwr->s_event = os_event_create();
-	buf_dblwr->first_free = 0;
-	buf_dblwr->s_reserved = 0;
-	buf_dblwr->b_reserved = 0;
+	     && srv_doublewrite_batch_size
+	     < 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE);
 
 	buf_dblwr->block1 = mach_read_from_4(
 		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK1);
 	buf_dblwr->block2 = mach_read_from_4(
 		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK2);
 
-	buf_dblwr->in_use = static_cast<bool*>(
-		mem_zalloc(buf_size * sizeof(bool)));
+	if (srv_use_doublewrite_buf && !srv_read_only_mode) {
+		buf_dblwr_open_files();
+	}
+}
 
-	buf_dblwr->write_buf_unaligned = static_cast<byte*>(
-		ut_malloc((1 + buf_size) * UNIV_PAGE_SIZE));
+/****************************************************************//**
+Gets the doublewrite shard of a flush batch type of a buffer pool instance.
+@return doublewrite shard */
+UNIV_INLINE
+buf_dblwr_shard_t*
+buf_dblwr_get_shard(
+/*================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t		flush_type)	/*!< in: flush type; the single
+						page flushes use the LRU
+						shard */
+{
+	ulint	i = buf_pool_index(buf_pool);
 
-	buf_dblwr->write_buf = static_cast<byte*>(
-		ut_align(buf_dblwr->write_buf_unaligned,
-			 UNIV_PAGE_SIZE));
+	ut_ad(i < buf_dblwr->n_files);
 
-	buf_dblwr->buf_block_arr = static_cast<buf_page_t**>(
-		mem_zalloc(buf_size * sizeof(void*)));
+	return(&buf_dblwr->shards[2 * i
+				  + (flush_type == BUF_FLUSH_LIST ? 0 : 1)]);
+}
+
+/****************************************************************//**
+Writes pages to a doublewrite file. The write is synchronous. */
+static
+void
+buf_dblwr_write_to_file(
+/*====================*/
+	const buf_dblwr_shard_t*	shard,	/*!< in: doublewrite shard */
+	const void*			buf,	/*!< in: pages to write */
+	os_offset_t			offset,	/*!< in: file offset */
+	ulint				len)	/*!< in: length in bytes */
+{
+	if (!os_file_write(shard->file_name, shard->file, buf, offset, len)) {
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"Cannot write %lu bytes to doublewrite file %s"
+			" at offset " UINT64PF,
+			(ulong) len, shard->file_name, offset);
+	}
 }
 
 /****************************************************************//**
@@ -346,12 +509,38 @@ start_again:
 	goto start_again;
 }
 
+/****************************************************************//**
+Opens an existing doublewrite file for reading.
+@return true if the file exists and was opened */
+static
+bool
+buf_dblwr_open_file_for_read(
+/*=========================*/
+	const char*	name,	/*!< in: file name */
+	os_file_t*	file)	/*!< out: file handle */
+{
+	ibool		exists;
+	ibool		success;
+	os_file_type_t	type;
+
+	if (!os_file_status(name, &exists, &type) || !exists) {
+		return(false);
+	}
+
+	*file = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, name, OS_FILE_OPEN,
+		OS_FILE_READ_ONLY, &success);
+
+	return(success);
+}
+
 /****************************************************************//**
 At a database startup initializes the doublewrite buffer memory structure if
 we already have a doublewrite buffer created in the data files. If we are
 upgrading to an InnoDB version which supports multiple tablespaces, then this
 function performs the necessary update operations. If we are in a crash
-recovery, this function loads the pages from double write buffer into memory. */
+recovery, this function loads the pages from double write buffer and the
+doublewrite files into memory. */
 void
 buf_dblwr_init_or_load_pages(
 /*=========================*/
@@ -369,6 +558,7 @@ buf_dblwr_init_or_load_pages(
 	byte*	doublewrite;
 	ulint	space_id;
 	ulint	i;
+	ulint	n_files;
         ulint	block_bytes = 0;
 	recv_dblwr_t& recv_dblwr = recv_sys->dblwr;
 
@@ -387,19 +577,46 @@ buf_dblwr_init_or_load_pages(
 	doublewrite = read_buf + TRX_SYS_DOUBLEWRITE;
 
 	if (mach_read_from_4(doublewrite + TRX_SYS_DOUBLEWRITE_MAGIC)
-	    == TRX_SYS_DOUBLEWRITE_MAGIC_N) {
-		/* The doublewrite buffer has been created */
+	    != TRX_SYS_DOUBLEWRITE_MAGIC_N) {
 
-		buf_dblwr_init(doublewrite);
+		goto leave_func;
+	}
 
-		block1 = buf_dblwr->block1;
-		block2 = buf_dblwr->block2;
+	/* The doublewrite buffer has been created. Count the doublewrite
+	files, including those left over from a run with more buffer pool
+	instances, before they are opened for writing. */
 
-		buf = buf_dblwr->write_buf;
-	} else {
-		goto leave_func;
+	for (n_files = 0;; n_files++) {
+		char*		name = buf_dblwr_file_name(n_files);
+		os_file_t	dblwr_file;
+		bool		exists;
+
+		exists = buf_dblwr_open_file_for_read(name, &dblwr_file);
+		mem_free(name);
+
+		if (!exists) {
+			break;
+		}
+
+		os_file_close(dblwr_file);
 	}
 
+	buf_dblwr_init(doublewrite);
+
+	block1 = buf_dblwr->block1;
+	block2 = buf_dblwr->block2;
+
+	block_bytes = TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE;
+
+	buf_dblwr->read_buf_unaligned = static_cast<byte*>(
+		ut_malloc(UNIV_PAGE_SIZE + 2 * block_bytes
+			  + n_files * BUF_DBLWR_FILE_PAGES * UNIV_PAGE_SIZE));
+
+	buf_dblwr->read_buf = static_cast<byte*>(
+		ut_align(buf_dblwr->read_buf_unaligned, UNIV_PAGE_SIZE));
+
+	buf = buf_dblwr->read_buf;
+
 	if (mach_read_from_4(doublewrite + TRX_SYS_DOUBLEWRITE_SPACE_ID_STORED)
 	    != TRX_SYS_DOUBLEWRITE_SPACE_ID_STORED_N) {
 
@@ -417,8 +634,6 @@ buf_dblwr_init_or_load_pages(
 
 	/* Read the pages from the doublewrite buffer to memory */
 
-        block_bytes = TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE;
-
 	os_file_read(file, buf, block1 * UNIV_PAGE_SIZE, block_bytes);
 	os_file_read(file, buf + block_bytes, block2 * UNIV_PAGE_SIZE,
 		     block_bytes);
@@ -464,10 +679,98 @@ buf_dblwr_init_or_load_pages(
 		os_file_flush(file);
 	}
 
+	if (!load_corrupt_pages) {
+		goto leave_func;
+	}
+
+	/* Read the pages of the doublewrite files */
+
+	for (ulint f = 0; f < n_files; f++) {
+		char*		name = buf_dblwr_file_name(f);
+		os_file_t	dblwr_file;
+		ulint		n_pages;
+
+		if (!buf_dblwr_open_file_for_read(name, &dblwr_file)) {
+			mem_free(name);
+			continue;
+		}
+
+		n_pages = static_cast<ulint>(
+			ut_min(os_file_get_size(dblwr_file)
+			       / UNIV_PAGE_SIZE,
+			       static_cast<os_offset_t>(
+				       BUF_DBLWR_FILE_PAGES)));
+
+		if (n_pages > 0
+		    && !os_file_read(dblwr_file, page, 0,
+				     n_pages * UNIV_PAGE_SIZE)) {
+			ib_logf(IB_LOG_LEVEL_WARN,
+				"Cannot read doublewrite file %s", name);
+			n_pages = 0;
+		}
+
+		os_file_close(dblwr_file);
+		mem_free(name);
+
+		for (i = 0; i < n_pages; i++) {
+			/* Slots that were never written are zero
+			filled */
+			if (!buf_page_is_zeroes(page, 0)) {
+				recv_dblwr.add(page);
+			}
+
+			page += UNIV_PAGE_SIZE;
+		}
+	}
+
 leave_func:
 	ut_free(unaligned_read_buf);
 }
 
+/****************************************************************//**
+Finds the newest copy of a page in the doublewrite buffer and files that is
+not corrupted.
+@return copy of the page, or NULL if there is no valid copy */
+static
+byte*
+buf_dblwr_find_valid_page(
+/*======================*/
+	ulint	space_id,	/*!< in: tablespace id */
+	ulint	page_no,	/*!< in: page number */
+	ulint	zip_size,	/*!< in: compressed page size, or 0 */
+	lsn_t	min_lsn)	/*!< in: ignore copies older than this */
+{
+	recv_dblwr_t&	recv_dblwr = recv_sys->dblwr;
+	byte*		result = NULL;
+	lsn_t		max_lsn = 0;
+
+	for (std::list<byte*>::iterator i = recv_dblwr.pages.begin();
+	     i != recv_dblwr.pages.end(); ++i) {
+
+		byte*	page = *i;
+
+		if (page_get_space_id(page) != space_id
+		    || page_get_page_no(page) != page_no
+		    || buf_page_is_zeroes(page, zip_size)
+		    || buf_page_is_corrupted(true, page, zip_size)) {
+			continue;
+		}
+
+		lsn_t	page_lsn = mach_read_from_8(page + FIL_PAGE_LSN);
+
+		if (page_lsn < min_lsn) {
+			continue;
+		}
+
+		if (result == NULL || page_lsn > max_lsn) {
+			max_lsn = page_lsn;
+			result = page;
+		}
+	}
+
+	return(result);
+}
+
 /****************************************************************//**
 Process the double write buffer pages. */
 void
@@ -509,6 +812,7 @@ buf_dblwr_process()
 				page_no_dblwr);
 		} else {
 			ulint	zip_size = fil_space_get_zip_size(space_id);
+			byte*	valid_page;
 
 			/* Read in the actual page from the file */
 			fil_io(OS_FILE_READ, true, space_id, zip_size,
@@ -516,6 +820,18 @@ buf_dblwr_process()
 			       zip_size ? zip_size : UNIV_PAGE_SIZE,
 			       read_buf, NULL);
 
+			/* The page may have been written to several
+			doublewrite files or slots: restore the newest
+			valid copy. With atomic writes the doublewrite
+			buffer was not written in this run, and a copy
+			older than the checkpoint is from an earlier run:
+			the torn write was of a newer version of the
+			page. */
+			valid_page = buf_dblwr_find_valid_page(
+				space_id, page_no, zip_size,
+				srv_use_atomic_writes
+				? recv_sys->parse_start_lsn : 0);
+
 			/* Check if the page is corrupt */
 
 			if (buf_page_is_corrupted(true, read_buf, zip_size)) {
@@ -529,8 +845,7 @@ buf_dblwr_process()
 					" the doublewrite buffer.\n",
 					(ulong) space_id, (ulong) page_no);
 
-				if (buf_page_is_corrupted(true,
-							  page, zip_size)) {
+				if (valid_page == NULL) {
 					fprintf(stderr,
 						"InnoDB: Dump of the page:\n");
 					buf_page_print(
@@ -566,7 +881,7 @@ buf_dblwr_process()
 				fil_io(OS_FILE_WRITE, true, space_id,
 				       zip_size, page_no, 0,
 				       zip_size ? zip_size : UNIV_PAGE_SIZE,
-				       page, NULL);
+				       valid_page, NULL);
 
 				ib_logf(IB_LOG_LEVEL_INFO,
 					"Recovered the page from"
@@ -574,9 +889,7 @@ buf_dblwr_process()
 
 			} else if (buf_page_is_zeroes(read_buf, zip_size)) {
 
-				if (!buf_page_is_zeroes(page, zip_size)
-				    && !buf_page_is_corrupted(true, page,
-							      zip_size)) {
+				if (valid_page != NULL) {
 
 					/* Database page contained only
 					zeroes, while a valid copy is
@@ -586,7 +899,7 @@ buf_dblwr_process()
 					       zip_size, page_no, 0,
 					       zip_size ? zip_size
 							: UNIV_PAGE_SIZE,
-					       page, NULL);
+					       valid_page, NULL);
 				}
 			}
 		}
@@ -596,6 +909,21 @@ buf_dblwr_process()
 	ut_free(unaligned_read_buf);
 }
 
+/****************************************************************//**
+Frees the pages read from the doublewrite buffer and the doublewrite files
+at startup, once crash recovery no longer needs them. */
+UNIV_INTERN
+void
+buf_dblwr_free_read_buf(void)
+/*=========================*/
+{
+	if (buf_dblwr != NULL && buf_dblwr->read_buf_unaligned != NULL) {
+		ut_free(buf_dblwr->read_buf_unaligned);
+		buf_dblwr->read_buf_unaligned = NULL;
+		buf_dblwr->read_buf = NULL;
+	}
+}
+
 /****************************************************************//**
 Frees doublewrite buffer. */
 UNIV_INTERN
@@ -605,21 +933,34 @@ buf_dblwr_free(void)
 {
 	/* Free the double write data structures. */
 	ut_a(buf_dblwr != NULL);
-	ut_ad(buf_dblwr->s_reserved == 0);
-	ut_ad(buf_dblwr->b_reserved == 0);
 
-	os_event_free(buf_dblwr->b_event);
-	os_event_free(buf_dblwr->s_event);
-	ut_free(buf_dblwr->write_buf_unaligned);
-	buf_dblwr->write_buf_unaligned = NULL;
+	for (ulint i = 0; i < 2 * buf_dblwr->n_files; i++) {
+		buf_dblwr_shard_t*	shard = &buf_dblwr->shards[i];
 
-	mem_free(buf_dblwr->buf_block_arr);
-	buf_dblwr->buf_block_arr = NULL;
+		ut_ad(shard->s_reserved == 0);
+		ut_ad(shard->b_reserved == 0);
 
-	mem_free(buf_dblwr->in_use);
-	buf_dblwr->in_use = NULL;
+		os_event_free(shard->b_event);
+		os_event_free(shard->s_event);
+		ut_free(shard->write_buf_unaligned);
+		mem_free(shard->buf_block_arr);
+		mem_free(shard->in_use);
+		mutex_free(&shard->mutex);
+	}
+
+	for (ulint i = 0; i < buf_dblwr->n_files; i++) {
+		os_file_close(buf_dblwr->files[i]);
+		mem_free(buf_dblwr->file_names[i]);
+	}
+
+	if (buf_dblwr->n_files > 0) {
+		mem_free(buf_dblwr->shards);
+		mem_free(buf_dblwr->files);
+		mem_free(buf_dblwr->file_names);
+	}
+
+	buf_dblwr_free_read_buf();
 
-	mutex_free(&buf_dblwr->mutex);
 	mem_free(buf_dblwr);
 	buf_dblwr = NULL;
 }
@@ -633,56 +974,63 @@ buf_dblwr_update(
 	const buf_page_t*	bpage,	/*!< in: buffer block descriptor */
 	buf_flush_t		flush_type)/*!< in: flush type */
 {
-	if (!srv_use_doublewrite_buf || buf_dblwr == NULL) {
+	buf_dblwr_shard_t*	shard;
+
+	if (!srv_use_doublewrite_buf || buf_dblwr == NULL
+	    || buf_dblwr->n_files == 0) {
 		return;
 	}
 
+	shard = buf_dblwr_get_shard(buf_pool_from_bpage(bpage), flush_type);
+
 	switch (flush_type) {
 	case BUF_FLUSH_LIST:
 	case BUF_FLUSH_LRU:
-		mutex_enter(&buf_dblwr->mutex);
+		mutex_enter(&shard->mutex);
 
-		ut_ad(buf_dblwr->batch_running);
-		ut_ad(buf_dblwr->b_reserved > 0);
-		ut_ad(buf_dblwr->b_reserved <= buf_dblwr->first_free);
+		ut_ad(shard->batch_running);
+		ut_ad(shard->b_reserved > 0);
+		ut_ad(shard->b_reserved <= shard->first_free);
 
-		buf_dblwr->b_reserved--;
+		shard->b_reserved--;
 
-		if (buf_dblwr->b_reserved == 0) {
-			mutex_exit(&buf_dblwr->mutex);
+		if (shard->b_reserved == 0) {
+			mutex_exit(&shard->mutex);
 			/* This will finish the batch. Sync data files
 			to the disk. */
 			fil_flush_file_spaces(FIL_TABLESPACE);
-			mutex_enter(&buf_dblwr->mutex);
+			mutex_enter(&shard->mutex);
 
 			/* We can now reuse the doublewrite memory buffer: */
-			buf_dblwr->first_free = 0;
-			buf_dblwr->batch_running = false;
-			os_event_set(buf_dblwr->b_event);
+			shard->first_free = 0;
+			shard->batch_running = false;
+			os_event_set(shard->b_event);
 		}
 
-		mutex_exit(&buf_dblwr->mutex);
+		mutex_exit(&shard->mutex);
 		break;
 	case BUF_FLUSH_SINGLE_PAGE:
 		{
-			const ulint size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
-			ulint i;
-			mutex_enter(&buf_dblwr->mutex);
-			for (i = srv_doublewrite_batch_size; i < size; ++i) {
-				if (buf_dblwr->buf_block_arr[i] == bpage) {
-					buf_dblwr->s_reserved--;
-					buf_dblwr->buf_block_arr[i] = NULL;
-					buf_dblwr->in_use[i] = false;
+			const ulint	batch_size = srv_doublewrite_batch_size;
+			ulint		i;
+			mutex_enter(&shard->mutex);
+			for (i = 0; i < shard->n_slots; ++i) {
+				if (shard->buf_block_arr[batch_size + i]
+				    == bpage) {
+					shard->s_reserved--;
+					shard->buf_block_arr[batch_size + i]
+						= NULL;
+					shard->in_use[i] = false;
 					break;
 				}
 			}
 
 			/* The block we are looking for must exist as a
 			reserved block. */
-			ut_a(i < size);
+			ut_a(i < shard->n_slots);
 		}
-		os_event_set(buf_dblwr->s_event);
-		mutex_exit(&buf_dblwr->mutex);
+		os_event_set(shard->s_event);
+		mutex_exit(&shard->mutex);
 		break;
 	case BUF_FLUSH_N_TYPES:
 		ut_error;
@@ -815,73 +1163,64 @@ buf_dblwr_write_block_to_datafile(
 }
 
 /********************************************************************//**
-Flushes possible buffered writes from the doublewrite memory buffer to disk,
-and also wakes up the aio thread if simulated aio is used. It is very
-important to call this function after a batch of writes has been posted,
-and also when we may have to wait for a page latch! Otherwise a deadlock
-of threads can occur. */
-UNIV_INTERN
+Flushes possible buffered writes from a doublewrite shard to disk, and also
+wakes up the aio thread if simulated aio is used. */
+static
 void
-buf_dblwr_flush_buffered_writes(void)
-/*=================================*/
+buf_dblwr_flush_shard(
+/*==================*/
+	buf_dblwr_shard_t*	shard)	/*!< in/out: doublewrite shard */
 {
 	byte*		write_buf;
 	ulint		first_free;
-	ulint		len;
-
-	if (!srv_use_doublewrite_buf || buf_dblwr == NULL) {
-		/* Sync the writes to the disk. */
-		buf_dblwr_sync_datafiles();
-		return;
-	}
 
 try_again:
-	mutex_enter(&buf_dblwr->mutex);
+	mutex_enter(&shard->mutex);
 
-	/* Write first to doublewrite buffer blocks. We use synchronous
-	aio and thus know that file write has been completed when the
+	/* Write first to the doublewrite file. We use synchronous
+	i/o and thus know that file write has been completed when the
 	control returns. */
 
-	if (buf_dblwr->first_free == 0) {
+	if (shard->first_free == 0) {
 
-		mutex_exit(&buf_dblwr->mutex);
+		mutex_exit(&shard->mutex);
 
 		return;
 	}
 
-	if (buf_dblwr->batch_running) {
+	if (shard->batch_running) {
 		/* Another thread is running the batch right now. Wait
 		for it to finish. */
-		ib_int64_t	sig_count = os_event_reset(buf_dblwr->b_event);
-		mutex_exit(&buf_dblwr->mutex);
+		ib_int64_t	sig_count = os_event_reset(shard->b_event);
+		mutex_exit(&shard->mutex);
 
-		os_event_wait_low(buf_dblwr->b_event, sig_count);
+		os_event_wait_low(shard->b_event, sig_count);
 		goto try_again;
 	}
 
-	ut_a(!buf_dblwr->batch_running);
-	ut_ad(buf_dblwr->first_free == buf_dblwr->b_reserved);
+	ut_a(!shard->batch_running);
+	ut_ad(shard->first_free == shard->b_reserved);
 
 	/* Disallow anyone else to post to doublewrite buffer or to
 	start another batch of flushing. */
-	buf_dblwr->batch_running = true;
-	first_free = buf_dblwr->first_free;
+	shard->batch_running = true;
+	first_free = shard->first_free;
 
 	/* Now safe to release the mutex. Note that though no other
 	thread is allowed to post to the doublewrite batch flushing
 	but any threads working on single page flushes are allowed
 	to proceed. */
-	mutex_exit(&buf_dblwr->mutex);
+	mutex_exit(&shard->mutex);
 
-	write_buf = buf_dblwr->write_buf;
+	write_buf = shard->write_buf;
 
 	for (ulint len2 = 0, i = 0;
-	     i < buf_dblwr->first_free;
+	     i < first_free;
 	     len2 += UNIV_PAGE_SIZE, i++) {
 
 		const buf_block_t*	block;
 
-		block = (buf_block_t*) buf_dblwr->buf_block_arr[i];
+		block = (buf_block_t*) shard->buf_block_arr[i];
 
 		if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
 		    || block->page.zip.data) {
@@ -899,57 +1238,40 @@ try_again:
 		buf_dblwr_check_page_lsn(write_buf + len2);
 	}
 
-	/* Write out the first block of the doublewrite buffer */
-	len = ut_min(TRX_SYS_DOUBLEWRITE_BLOCK_SIZE,
-		     buf_dblwr->first_free) * UNIV_PAGE_SIZE;
-
-	fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
-	       buf_dblwr->block1, 0, len,
-	       (void*) write_buf, NULL);
-
-	if (buf_dblwr->first_free <= TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
-		/* No unwritten pages in the second block. */
-		goto flush;
-	}
-
-	/* Write out the second block of the doublewrite buffer. */
-	len = (buf_dblwr->first_free - TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)
-	       * UNIV_PAGE_SIZE;
+	/* Write out the batch to the doublewrite file of the instance */
+	buf_dblwr_write_to_file(shard, write_buf, shard->offset,
+				first_free * UNIV_PAGE_SIZE);
 
-	write_buf = buf_dblwr->write_buf
-		    + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE;
-
-	fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
-	       buf_dblwr->block2, 0, len,
-	       (void*) write_buf, NULL);
-
-flush:
 	/* increment the doublewrite flushed pages counter */
-	srv_stats.dblwr_pages_written.add(buf_dblwr->first_free);
+	srv_stats.dblwr_pages_written.add(first_free);
 	srv_stats.dblwr_writes.inc();
 
 	/* Now flush the doublewrite buffer data to disk */
-	fil_flush(TRX_SYS_SPACE);
+	if (!os_file_flush(shard->file)) {
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"Cannot flush doublewrite file %s",
+			shard->file_name);
+	}
 
 	/* We know that the writes have been flushed to disk now
-	and in recovery we will find them in the doublewrite buffer
-	blocks. Next do the writes to the intended positions. */
+	and in recovery we will find them in the doublewrite file.
+	Next do the writes to the intended positions. */
 
-	/* Up to this point first_free and buf_dblwr->first_free are
-	same because we have set the buf_dblwr->batch_running flag
+	/* Up to this point first_free and shard->first_free are
+	same because we have set the shard->batch_running flag
 	disallowing any other thread to post any request but we
-	can't safely access buf_dblwr->first_free in the loop below.
+	can't safely access shard->first_free in the loop below.
 	This is so because it is possible that after we are done with
 	the last iteration and before we terminate the loop, the batch
 	gets finished in the IO helper thread and another thread posts
-	a new batch setting buf_dblwr->first_free to a higher value.
-	If this happens and we are using buf_dblwr->first_free in the
+	a new batch setting shard->first_free to a higher value.
+	If this happens and we are using shard->first_free in the
 	loop termination condition then we'll end up dispatching
 	the same block twice from two different threads. */
-	ut_ad(first_free == buf_dblwr->first_free);
+	ut_ad(first_free == shard->first_free);
 	for (ulint i = 0; i < first_free; i++) {
 		buf_dblwr_write_block_to_datafile(
-			buf_dblwr->buf_block_arr[i], false);
+			shard->buf_block_arr[i], false);
 	}
 
 	/* Wake possible simulated aio thread to actually post the
@@ -959,9 +1281,54 @@ flush:
 	os_aio_simulated_wake_handler_threads();
 }
 
+/********************************************************************//**
+Flushes possible buffered writes from the doublewrite memory buffers to disk,
+and also wakes up the aio thread if simulated aio is used. It is very
+important to call this function after a batch of writes has been posted,
+and also when we may have to wait for a page latch! Otherwise a deadlock
+of threads can occur. */
+UNIV_INTERN
+void
+buf_dblwr_flush_buffered_writes(void)
+/*=================================*/
+{
+	if (!srv_use_doublewrite_buf || buf_dblwr == NULL
+	    || buf_dblwr->n_files == 0) {
+		/* Sync the writes to the disk. */
+		buf_dblwr_sync_datafiles();
+		return;
+	}
+
+	for (ulint i = 0; i < 2 * buf_dblwr->n_files; i++) {
+		buf_dblwr_flush_shard(&buf_dblwr->shards[i]);
+	}
+}
+
+/********************************************************************//**
+Flushes the buffered writes of one flush batch type of a buffer pool
+instance from its doublewrite memory buffer to disk. This is called at the
+end of a flush batch. */
+UNIV_INTERN
+void
+buf_dblwr_flush_batch_writes(
+/*=========================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t	flush_type)	/*!< in: BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+{
+	if (!srv_use_doublewrite_buf || buf_dblwr == NULL
+	    || buf_dblwr->n_files == 0) {
+		/* Sync the writes to the disk. */
+		buf_dblwr_sync_datafiles();
+		return;
+	}
+
+	buf_dblwr_flush_shard(buf_dblwr_get_shard(buf_pool, flush_type));
+}
+
 /********************************************************************//**
 Posts a buffer page for writing. If the doublewrite memory buffer is
-full, calls buf_dblwr_flush_buffered_writes and waits for for free
+full, calls buf_dblwr_flush_shard and waits for for free
 space to appear. */
 UNIV_INTERN
 void
@@ -969,34 +1336,39 @@ buf_dblwr_add_to_batch(
 /*====================*/
 	buf_page_t*	bpage)	/*!< in: buffer block to write */
 {
-	ulint	zip_size;
+	ulint			zip_size;
+	buf_dblwr_shard_t*	shard;
 
 	ut_a(buf_page_in_file(bpage));
 
+	shard = buf_dblwr_get_shard(buf_pool_from_bpage(bpage),
+				    buf_page_get_flush_type(bpage));
+
 try_again:
-	mutex_enter(&buf_dblwr->mutex);
+	mutex_enter(&shard->mutex);
 
-	ut_a(buf_dblwr->first_free <= srv_doublewrite_batch_size);
+	ut_a(shard->first_free <= srv_doublewrite_batch_size);
 
-	if (buf_dblwr->batch_running) {
+	if (shard->batch_running) {
 
-		/* This not nearly as bad as it looks. There is only
-		page_cleaner thread which does background flushing
-		in batches therefore it is unlikely to be a contention
-		point. The only exception is when a user thread is
-		forced to do a flush batch because of a sync
+		/* This not nearly as bad as it looks. Each buffer pool
+		instance has its own shard for each batch type, and
+		only one page_cleaner thread at a time flushes an
+		instance in batches therefore it is unlikely to be a
+		contention point. The only exception is when a user
+		thread is forced to do a flush batch because of a sync
 		checkpoint. */
-		ib_int64_t	sig_count = os_event_reset(buf_dblwr->b_event);
-		mutex_exit(&buf_dblwr->mutex);
+		ib_int64_t	sig_count = os_event_reset(shard->b_event);
+		mutex_exit(&shard->mutex);
 
-		os_event_wait_low(buf_dblwr->b_event, sig_count);
+		os_event_wait_low(shard->b_event, sig_count);
 		goto try_again;
 	}
 
-	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
-		mutex_exit(&(buf_dblwr->mutex));
+	if (shard->first_free == srv_doublewrite_batch_size) {
+		mutex_exit(&shard->mutex);
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_shard(shard);
 
 		goto try_again;
 	}
@@ -1006,40 +1378,40 @@ try_again:
 	if (zip_size) {
 		UNIV_MEM_ASSERT_RW(bpage->zip.data, zip_size);
 		/* Copy the compressed page and clear the rest. */
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
+		memcpy(shard->write_buf
+		       + UNIV_PAGE_SIZE * shard->first_free,
 		       bpage->zip.data, zip_size);
-		memset(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free
+		memset(shard->write_buf
+		       + UNIV_PAGE_SIZE * shard->first_free
 		       + zip_size, 0, UNIV_PAGE_SIZE - zip_size);
 	} else {
 		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE);
 		UNIV_MEM_ASSERT_RW(((buf_block_t*) bpage)->frame,
 				   UNIV_PAGE_SIZE);
 
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
+		memcpy(shard->write_buf
+		       + UNIV_PAGE_SIZE * shard->first_free,
 		       ((buf_block_t*) bpage)->frame, UNIV_PAGE_SIZE);
 	}
 
-	buf_dblwr->buf_block_arr[buf_dblwr->first_free] = bpage;
+	shard->buf_block_arr[shard->first_free] = bpage;
 
-	buf_dblwr->first_free++;
-	buf_dblwr->b_reserved++;
+	shard->first_free++;
+	shard->b_reserved++;
 
-	ut_ad(!buf_dblwr->batch_running);
-	ut_ad(buf_dblwr->first_free == buf_dblwr->b_reserved);
-	ut_ad(buf_dblwr->b_reserved <= srv_doublewrite_batch_size);
+	ut_ad(!shard->batch_running);
+	ut_ad(shard->first_free == shard->b_reserved);
+	ut_ad(shard->b_reserved <= srv_doublewrite_batch_size);
 
-	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
-		mutex_exit(&(buf_dblwr->mutex));
+	if (shard->first_free == srv_doublewrite_batch_size) {
+		mutex_exit(&shard->mutex);
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_shard(shard);
 
 		return;
 	}
 
-	mutex_exit(&(buf_dblwr->mutex));
+	mutex_exit(&shard->mutex);
 }
 
 /********************************************************************//**
@@ -1057,22 +1429,20 @@ buf_dblwr_write_single_page(
 	buf_page_t*	bpage,	/*!< in: buffer block to write */
 	bool		sync)	/*!< in: true if sync IO requested */
 {
-	ulint		n_slots;
-	ulint		size;
-	ulint		zip_size;
-	ulint		offset;
-	ulint		i;
+	ulint			zip_size;
+	ulint			i;
+	ulint			slot;
+	buf_dblwr_shard_t*	shard;
 
 	ut_a(buf_page_in_file(bpage));
 	ut_a(srv_use_doublewrite_buf);
 	ut_a(buf_dblwr != NULL);
 
-	/* total number of slots available for single page flushes
-	starts from srv_doublewrite_batch_size to the end of the
-	buffer. */
-	size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
-	ut_a(size > srv_doublewrite_batch_size);
-	n_slots = size - srv_doublewrite_batch_size;
+	/* The single page flush slots of an instance follow the
+	LRU batch pages in the LRU shard. */
+	shard = buf_dblwr_get_shard(buf_pool_from_bpage(bpage),
+				    BUF_FLUSH_SINGLE_PAGE);
+	ut_a(shard->n_slots > 0);
 
 	if (buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE) {
 
@@ -1089,52 +1459,43 @@ buf_dblwr_write_single_page(
 	}
 
 retry:
-	mutex_enter(&buf_dblwr->mutex);
-	if (buf_dblwr->s_reserved == n_slots) {
+	mutex_enter(&shard->mutex);
+	if (shard->s_reserved == shard->n_slots) {
 
 		/* All slots are reserved. */
 		ib_int64_t	sig_count =
-			os_event_reset(buf_dblwr->s_event);
-		mutex_exit(&buf_dblwr->mutex);
-		os_event_wait_low(buf_dblwr->s_event, sig_count);
+			os_event_reset(shard->s_event);
+		mutex_exit(&shard->mutex);
+		os_event_wait_low(shard->s_event, sig_count);
 
 		goto retry;
 	}
 
-	for (i = srv_doublewrite_batch_size; i < size; ++i) {
+	for (i = 0; i < shard->n_slots; ++i) {
 
-		if (!buf_dblwr->in_use[i]) {
+		if (!shard->in_use[i]) {
 			break;
 		}
 	}
 
 	/* We are guaranteed to find a slot. */
-	ut_a(i < size);
-	buf_dblwr->in_use[i] = true;
-	buf_dblwr->s_reserved++;
-	buf_dblwr->buf_block_arr[i] = bpage;
+	ut_a(i < shard->n_slots);
+	slot = srv_doublewrite_batch_size + i;
+	shard->in_use[i] = true;
+	shard->s_reserved++;
+	shard->buf_block_arr[slot] = bpage;
 
 	/* increment the doublewrite flushed pages counter */
 	srv_stats.dblwr_pages_written.inc();
 	srv_stats.dblwr_writes.inc();
 
-	mutex_exit(&buf_dblwr->mutex);
-
-	/* Lets see if we are going to write in the first or second
-	block of the doublewrite buffer. */
-	if (i < TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
-		offset = buf_dblwr->block1 + i;
-	} else {
-		offset = buf_dblwr->block2 + i
-			 - TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
-	}
+	mutex_exit(&shard->mutex);
 
 	/* We deal with compressed and uncompressed pages a little
 	differently here. In case of uncompressed pages we can
 	directly write the block to the allocated slot in the
-	doublewrite buffer in the system tablespace and then after
-	syncing the system table space we can proceed to write the page
-	in the datafile.
+	doublewrite file and then after syncing the file we can
+	proceed to write the page in the datafile.
 	In case of compressed page we first do a memcpy of the block
 	to the in-memory buffer of doublewrite before proceeding to
 	write it. This is so because we want to pad the remaining
@@ -1142,30 +1503,34 @@ retry:
 
 	zip_size = buf_page_get_zip_size(bpage);
 	if (zip_size) {
-		memcpy(buf_dblwr->write_buf + UNIV_PAGE_SIZE * i,
+		memcpy(shard->write_buf + UNIV_PAGE_SIZE * slot,
 		       bpage->zip.data, zip_size);
-		memset(buf_dblwr->write_buf + UNIV_PAGE_SIZE * i
+		memset(shard->write_buf + UNIV_PAGE_SIZE * slot
 		       + zip_size, 0, UNIV_PAGE_SIZE - zip_size);
 
-		fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
-		       offset, 0, UNIV_PAGE_SIZE,
-		       (void*) (buf_dblwr->write_buf
-				+ UNIV_PAGE_SIZE * i), NULL);
+		buf_dblwr_write_to_file(
+			shard, shard->write_buf + UNIV_PAGE_SIZE * slot,
+			shard->s_offset + i * UNIV_PAGE_SIZE,
+			UNIV_PAGE_SIZE);
 	} else {
 		/* It is a regular page. Write it directly to the
-		doublewrite buffer */
-		fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
-		       offset, 0, UNIV_PAGE_SIZE,
-		       (void*) ((buf_block_t*) bpage)->frame,
-		       NULL);
+		doublewrite file */
+		buf_dblwr_write_to_file(
+			shard, ((buf_block_t*) bpage)->frame,
+			shard->s_offset + i * UNIV_PAGE_SIZE,
+			UNIV_PAGE_SIZE);
 	}
 
-	/* Now flush the doublewrite buffer data to disk */
-	fil_flush(TRX_SYS_SPACE);
+	/* Now flush the doublewrite file data to disk */
+	if (!os_file_flush(shard->file)) {
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"Cannot flush doublewrite file %s",
+			shard->file_name);
+	}
 
 	/* We know that the write has been flushed to disk now
-	and during recovery we will find it in the doublewrite buffer
-	blocks. Next do the write to the intended position. */
+	and during recovery we will find it in the doublewrite file.
+	Next do the write to the intended position. */
 	buf_dblwr_write_block_to_datafile(bpage, sync);
 }
 #endif /* !UNIV_HOTBACKUP */
@@ -30,6 +30,8 @@ Created April 08, 2011 Vasil Dimov
 
 #include "buf0buf.h" /* buf_pool_mutex_enter(), srv_buf_pool_instances */
 #include "buf0dump.h"
+#include "buf0lru.h" /* BUF_LRU_OLD_RATIO_DIV */
+#include "buf0rea.h" /* buf_read_load_pages() */
 #include "db0err.h"
 #include "dict0dict.h" /* dict_operation_lock */
 #include "os0file.h" /* OS_FILE_MAX_PATH */
@@ -57,6 +59,10 @@ static ibool	buf_load_should_start = FALSE;
 
 static ibool	buf_load_abort_flag = FALSE;
 
+/* Changes of the LRU lists as counted by buf_dump_lru_changes() when the
+last dump started */
+static ulint	buf_dump_lru_changes_at_dump = ULINT_UNDEFINED;
+
 /* Used to temporary store dump info in order to avoid IO while holding
 buffer pool mutex during dump and also to sort the contents of the dump
 before reading the pages from disk during load.
@@ -68,6 +74,10 @@ typedef ib_uint64_t	buf_dump_t;
 #define BUF_DUMP_SPACE(a)		((ulint) ((a) >> 32))
 #define BUF_DUMP_PAGE(a)		((ulint) ((a) & 0xFFFFFFFFUL))
 
+/** Maximum number of pages of one tablespace that a buffer pool load
+thread posts as one batch of read requests */
+#define BUF_LOAD_BATCH			64
+
 /*****************************************************************//**
 Wakes up the buffer pool dump/load thread and instructs it to start
 a dump. This function is called by MySQL code via buffer_pool_dump_now()
@@ -186,6 +196,29 @@ get_buf_dump_dir()
 	return(dump_dir);
 }
 
+/*****************************************************************//**
+Counts the pages that were read or created in the buffer pool(s) or made
+young since startup. The working set that a dump records has not
+changed while this count stays the same.
+@return number of changes of the LRU lists */
+static
+ulint
+buf_dump_lru_changes()
+/*==================*/
+{
+	ulint	n_changes = 0;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		const buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		n_changes += buf_pool->stat.n_pages_read
+			+ buf_pool->stat.n_pages_created
+			+ buf_pool->stat.n_pages_made_young;
+	}
+
+	return(n_changes);
+}
+
 /*****************************************************************//**
 Perform a buffer pool dump into the file specified by
 innodb_buffer_pool_filename. If any errors occur then the value of
@@ -196,8 +229,12 @@ static
 void
 buf_dump(
 /*=====*/
-	ibool	obey_shutdown)	/*!< in: quit if we are in a shutting down
+	ibool	obey_shutdown,	/*!< in: quit if we are in a shutting down
 				state */
+	bool	periodic)	/*!< in: whether this is a dump of
+				innodb_buffer_pool_dump_interval, which
+				does not write to the error log unless
+				it fails */
 {
 #define SHOULD_QUIT()	(SHUTTING_DOWN() && obey_shutdown)
 
@@ -205,8 +242,12 @@ buf_dump(
 	char	tmp_filename[OS_FILE_MAX_PATH];
 	char	now[32];
 	FILE*	f;
-	ulint	i;
+	ulint	k;
 	int	ret;
+	const enum status_severity
+		notice = periodic ? STATUS_INFO : STATUS_NOTICE;
+
+	buf_dump_lru_changes_at_dump = buf_dump_lru_changes();
 
 	ut_snprintf(full_filename, sizeof(full_filename),
 		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
@@ -215,7 +256,7 @@ buf_dump(
 	ut_snprintf(tmp_filename, sizeof(tmp_filename),
 		    "%s.incomplete", full_filename);
 
-	buf_dump_status(STATUS_NOTICE, "Dumping buffer pool(s) to %s",
+	buf_dump_status(notice, "Dumping buffer pool(s) to %s",
 			full_filename);
 
 	f = fopen(tmp_filename, "w");
@@ -227,12 +268,20 @@ buf_dump(
 	}
 	/* else */
 
-	/* walk through each buffer pool */
-	for (i = 0; i < srv_buf_pool_instances && !SHOULD_QUIT(); i++) {
+	/* Walk through the young sublists of all buffer pools, then
+	through their old sublists, each from the most recently used page
+	on. buf_load() thus finds the hottest pages at the start of the
+	file, and a dump that is bigger than the buffer pool loses its
+	coldest pages. Of every buffer pool, only the hottest
+	innodb_buffer_pool_dump_pct percent of the pages are written. */
+	for (k = 0; k < 2 * srv_buf_pool_instances && !SHOULD_QUIT(); k++) {
+		ulint			i = k % srv_buf_pool_instances;
 		buf_pool_t*		buf_pool;
 		const buf_page_t*	bpage;
 		buf_dump_t*		dump;
 		ulint			n_pages;
+		ulint			n_young;
+		ulint			n_max;
 		ulint			j;
 
 		buf_pool = buf_pool_from_array(i);
@@ -241,7 +290,26 @@ buf_dump(
 		UT_LIST_GET_LEN(buf_pool->LRU) could change */
 		buf_pool_mutex_enter(buf_pool);
 
-		n_pages = UT_LIST_GET_LEN(buf_pool->LRU);
+		n_young = UT_LIST_GET_LEN(buf_pool->LRU);
+
+		if (buf_pool->LRU_old != NULL) {
+			n_young -= buf_pool->LRU_old_len;
+		}
+
+		n_max = (UT_LIST_GET_LEN(buf_pool->LRU)
+			 * srv_buf_pool_dump_pct + 99) / 100;
+
+		if (k < srv_buf_pool_instances) {
+			bpage = UT_LIST_GET_FIRST(buf_pool->LRU);
+			n_pages = ut_min(n_young, n_max);
+		} else if (n_young < n_max && buf_pool->LRU_old != NULL) {
+			bpage = buf_pool->LRU_old;
+			n_pages = ut_min(buf_pool->LRU_old_len,
+					 n_max - n_young);
+		} else {
+			bpage = NULL;
+			n_pages = 0;
+		}
 
 		/* skip empty buffer pools */
 		if (n_pages == 0) {
@@ -263,9 +331,8 @@ buf_dump(
 			return;
 		}
 
-		for (bpage = UT_LIST_GET_LAST(buf_pool->LRU), j = 0;
-		     bpage != NULL;
-		     bpage = UT_LIST_GET_PREV(LRU, bpage), j++) {
+		for (j = 0; j < n_pages;
+		     bpage = UT_LIST_GET_NEXT(LRU, bpage), j++) {
 
 			ut_a(buf_page_in_file(bpage));
 
@@ -273,8 +340,6 @@ buf_dump(
 						  buf_page_get_page_no(bpage));
 		}
 
-		ut_a(j == n_pages);
-
 		buf_pool_mutex_exit(buf_pool);
 
 		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
@@ -339,7 +404,7 @@ buf_dump(
 
 	ut_sprintf_timestamp(now);
 
-	buf_dump_status(STATUS_NOTICE,
+	buf_dump_status(notice,
 			"Buffer pool(s) dump completed at %s", now);
 }
 
@@ -379,6 +444,110 @@ buf_dump_sort(
 			      buf_dump_cmp);
 }
 
+/** A buffer pool load that is shared by the load threads */
+struct buf_load_pll_t {
+	os_fast_mutex_t		mutex;		/*!< protects next and
+						n_threads */
+	const buf_dump_t*	dump;		/*!< pages to read: the hot
+						ones first, each part sorted
+						on space_no,page_no */
+	ulint			dump_n;		/*!< size of dump[] */
+	ulint			next;		/*!< first entry of dump[]
+						that no thread has picked */
+	ulint			max_pending;	/*!< number of pending page
+						reads above which the load
+						leaves the i/o to the user
+						threads */
+	ulint			n_threads;	/*!< number of running
+						helper threads */
+	os_event_t		done;		/*!< set when n_threads
+						drops to 0 */
+};
+
+/*****************************************************************//**
+Reads the pages of a buffer pool load that no thread has picked yet, in
+batches of adjacent entries of one tablespace. */
+static
+void
+buf_load_pll_read(
+/*==============*/
+	buf_load_pll_t*	pll,	/*!< in/out: buffer pool load */
+	bool		report)	/*!< in: whether to update
+				innodb_buffer_pool_load_status */
+{
+	ulint	page_nos[BUF_LOAD_BATCH];
+
+	for (;;) {
+		ulint	space_id;
+		ulint	n;
+
+		/* Page reads that user threads wait for take
+		precedence: do not add to the i/o queue while it holds
+		more than max_pending reads. */
+		while (buf_get_n_pending_read_ios() > pll->max_pending
+		       && !SHUTTING_DOWN() && !buf_load_abort_flag) {
+			os_thread_sleep(1000);
+		}
+
+		if (SHUTTING_DOWN() || buf_load_abort_flag) {
+			return;
+		}
+
+		os_fast_mutex_lock(&pll->mutex);
+
+		space_id = pll->next < pll->dump_n
+			? BUF_DUMP_SPACE(pll->dump[pll->next])
+			: ULINT_UNDEFINED;
+
+		for (n = 0;
+		     n < BUF_LOAD_BATCH && pll->next < pll->dump_n
+		     && BUF_DUMP_SPACE(pll->dump[pll->next]) == space_id;
+		     n++) {
+			page_nos[n] = BUF_DUMP_PAGE(pll->dump[pll->next++]);
+		}
+
+		os_fast_mutex_unlock(&pll->mutex);
+
+		if (n == 0) {
+			return;
+		}
+
+		buf_read_load_pages(space_id, page_nos, n);
+
+		if (report) {
+			buf_load_status(STATUS_INFO,
+					"Loaded " ULINTPF "/" ULINTPF " pages",
+					pll->next, pll->dump_n);
+		}
+	}
+}
+
+/*****************************************************************//**
+This is a helper thread of a buffer pool load.
+@return this function does not return, it calls os_thread_exit() */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_load_pll_thread)(
+/*================================*/
+	void*	arg)	/*!< in/out: buffer pool load, buf_load_pll_t */
+{
+	buf_load_pll_t*	pll = static_cast<buf_load_pll_t*>(arg);
+
+	buf_load_pll_read(pll, false);
+
+	os_fast_mutex_lock(&pll->mutex);
+
+	if (--pll->n_threads == 0) {
+		os_event_set(pll->done);
+	}
+
+	os_fast_mutex_unlock(&pll->mutex);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /*****************************************************************//**
 Perform a buffer pool load from the file specified by
 innodb_buffer_pool_filename. If any errors occur then the value of
@@ -396,8 +565,11 @@ buf_load()
 	buf_dump_t*	dump;
 	buf_dump_t*	dump_tmp;
 	ulint		dump_n;
+	ulint		n_hot;
+	ulint		n_helpers;
 	ulint		total_buffer_pools_pages;
 	ulint		i;
+	buf_load_pll_t	pll;
 	ulint		space_id;
 	ulint		page_no;
 	int		fscanf_ret;
@@ -446,8 +618,9 @@ buf_load()
 	}
 
 	/* If dump is larger than the buffer pool(s), then we ignore the
-	extra trailing. This could happen if a dump is made, then buffer
-	pool is shrunk and then load it attempted. */
+	extra trailing, which holds the coldest pages. This could happen
+	if a dump is made, then buffer pool is shrunk and then load it
+	attempted. */
 	total_buffer_pools_pages = buf_pool_get_n_pages()
 		* srv_buf_pool_instances;
 	if (dump_n > total_buffer_pools_pages) {
@@ -534,39 +707,64 @@ buf_load()
 		return;
 	}
 
-	if (!SHUTTING_DOWN()) {
-		buf_dump_sort(dump, dump_tmp, 0, dump_n);
+	/* buf_dump() wrote the young sublists first. Load the share of
+	the dump that the young sublists have now before the rest, and
+	sort each of the two parts on its own. */
+	n_hot = dump_n - dump_n * buf_pool_from_array(0)->LRU_old_ratio
+		/ BUF_LRU_OLD_RATIO_DIV;
+
+	if (!SHUTTING_DOWN() && n_hot > 0) {
+		buf_dump_sort(dump, dump_tmp, 0, n_hot);
+	}
+
+	if (!SHUTTING_DOWN() && n_hot < dump_n) {
+		buf_dump_sort(dump, dump_tmp, n_hot, dump_n);
 	}
 
 	ut_free(dump_tmp);
 
-	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+	os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &pll.mutex);
+	pll.dump = dump;
+	pll.dump_n = dump_n;
+	pll.next = 0;
+	pll.max_pending = srv_n_read_io_threads
+		* OS_AIO_N_PENDING_IOS_PER_THREAD;
+	n_helpers = ut_min(srv_buf_load_threads,
+			   (dump_n + BUF_LOAD_BATCH - 1) / BUF_LOAD_BATCH) - 1;
+	pll.n_threads = n_helpers;
+	pll.done = os_event_create();
+
+	if (n_helpers == 0) {
+		os_event_set(pll.done);
+	}
 
-		buf_read_page_async(BUF_DUMP_SPACE(dump[i]),
-				    BUF_DUMP_PAGE(dump[i]));
+	/* The helper threads that have already finished decrement
+	pll.n_threads. */
+	for (i = 0; i < n_helpers; i++) {
+		os_thread_create(buf_load_pll_thread, &pll, NULL);
+	}
 
-		if (i % 64 == 63) {
-			os_aio_simulated_wake_handler_threads();
-		}
+	buf_load_pll_read(&pll, true);
 
-		if (i % 128 == 0) {
-			buf_load_status(STATUS_INFO,
-					"Loaded " ULINTPF "/" ULINTPF " pages",
-					i + 1, dump_n);
-		}
+	os_event_wait(pll.done);
 
-		if (buf_load_abort_flag) {
-			buf_load_abort_flag = FALSE;
-			ut_free(dump);
-			buf_load_status(
-				STATUS_NOTICE,
-				"Buffer pool(s) load aborted on request");
-			return;
-		}
-	}
+	/* Let the last helper thread release the mutex. */
+	os_fast_mutex_lock(&pll.mutex);
+	os_fast_mutex_unlock(&pll.mutex);
+
+	os_event_free(pll.done);
+	os_fast_mutex_free(&pll.mutex);
 
 	ut_free(dump);
 
+	if (buf_load_abort_flag) {
+		buf_load_abort_flag = FALSE;
+		buf_load_status(
+			STATUS_NOTICE,
+			"Buffer pool(s) load aborted on request");
+		return;
+	}
+
 	ut_sprintf_timestamp(now);
 
 	buf_load_status(STATUS_NOTICE,
@@ -597,6 +795,8 @@ DECLARE_THREAD(buf_dump_thread)(
 	void*	arg MY_ATTRIBUTE((unused)))	/*!< in: a dummy parameter
 						required by os_thread_create */
 {
+	ib_time_t	last_dump_time;
+
 	ut_ad(!srv_read_only_mode);
 
 	srv_buf_dump_thread_active = TRUE;
@@ -608,13 +808,35 @@ DECLARE_THREAD(buf_dump_thread)(
 		buf_load();
 	}
 
-	while (!SHUTTING_DOWN()) {
+	last_dump_time = ut_time();
 
-		os_event_wait(srv_buf_dump_event);
+	while (!SHUTTING_DOWN()) {
+		ulint	interval = srv_buf_dump_interval;
+		ulint	elapsed = (ulint) (ut_time() - last_dump_time);
+
+		if (interval == 0) {
+			os_event_wait(srv_buf_dump_event);
+		} else if (elapsed < interval) {
+			os_event_wait_time(srv_buf_dump_event,
+					   (interval - elapsed) * 1000000);
+		}
 
 		if (buf_dump_should_start) {
 			buf_dump_should_start = FALSE;
-			buf_dump(TRUE /* quit on shutdown */);
+			buf_dump(TRUE /* quit on shutdown */, false);
+			last_dump_time = ut_time();
+		} else if (srv_buf_dump_interval > 0
+			   && (ulint) (ut_time() - last_dump_time)
+			   >= srv_buf_dump_interval
+			   && !SHUTTING_DOWN()) {
+			/* Rewrite the dump only when the working set has
+			changed since the last one. */
+			if (buf_dump_lru_changes()
+			    != buf_dump_lru_changes_at_dump) {
+				buf_dump(TRUE /* quit on shutdown */, true);
+			}
+
+			last_dump_time = ut_time();
 		}
 
 		if (buf_load_should_start) {
@@ -627,7 +849,7 @@ DECLARE_THREAD(buf_dump_thread)(
 
 	if (srv_buffer_pool_dump_at_shutdown && srv_fast_shutdown != 2) {
 		buf_dump(FALSE /* ignore shutdown down flag,
-		keep going even if we are in a shutdown state */);
+		keep going even if we are in a shutdown state */, false);
 	}
 
 	srv_buf_dump_thread_active = FALSE;
@@ -67,6 +67,76 @@ reduce the wait time for the threads waiting for a clean block */
 UNIV_INTERN mysql_pfs_key_t buf_page_cleaner_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
+#ifdef UNIV_PFS_MUTEX
+/* Key to register the mutex with performance schema */
+UNIV_INTERN mysql_pfs_key_t	page_cleaner_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/** State of a flush request for a buffer pool instance */
+enum page_cleaner_state_t {
+	PAGE_CLEANER_STATE_NONE = 0,	/*!< not requested */
+	PAGE_CLEANER_STATE_REQUESTED,	/*!< requested, not taken by
+					a page_cleaner thread yet */
+	PAGE_CLEANER_STATE_FLUSHING,	/*!< being flushed */
+	PAGE_CLEANER_STATE_FINISHED	/*!< flushed */
+};
+
+/** Flush request for a buffer pool instance */
+struct page_cleaner_slot_t {
+	page_cleaner_state_t	state;	/*!< state of the request, protected
+					by page_cleaner_t::mutex */
+	ulint		n_pages_requested;
+					/*!< number of pages to flush from
+					the flush_list of the instance */
+	bool		succeeded_list;	/*!< false if another flush_list
+					batch was running in the instance */
+	ulint		n_flushed_lru;	/*!< pages processed at the tail of
+					the LRU list */
+	ulint		n_flushed_list;	/*!< pages flushed from the
+					flush_list */
+	ulint		flush_lru_time;	/*!< ms spent in LRU flushing */
+	ulint		flush_list_time;/*!< ms spent in flush_list
+					flushing */
+	ulint		flush_lru_pass;	/*!< number of LRU flushes */
+	ulint		flush_list_pass;/*!< number of flush_list flushes */
+};
+
+/** The page_cleaner coordinator thread requests a flush of every buffer
+pool instance in each round. The requests are taken one by one by the
+coordinator and the worker threads, so that the instances are flushed
+in parallel. */
+struct page_cleaner_t {
+	ib_mutex_t	mutex;		/*!< protects the requests */
+	os_event_t	is_requested;	/*!< set when there are requests
+					not taken yet */
+	os_event_t	is_finished;	/*!< set when all the requests of
+					the round are flushed */
+	volatile ulint	n_workers;	/*!< number of worker threads not
+					exited yet */
+	bool		is_running;	/*!< false when the worker threads
+					have to exit */
+	lsn_t		lsn_limit;	/*!< upper limit of LSN to flush
+					from the flush_lists */
+	ulint		n_slots;	/*!< number of slots, one for each
+					buffer pool instance */
+	ulint		n_slots_requested;
+					/*!< number of slots in the state
+					PAGE_CLEANER_STATE_REQUESTED */
+	ulint		n_slots_flushing;
+					/*!< number of slots in the state
+					PAGE_CLEANER_STATE_FLUSHING */
+	ulint		n_slots_finished;
+					/*!< number of slots in the state
+					PAGE_CLEANER_STATE_FINISHED */
+	ulint		flush_time;	/*!< ms spent by the coordinator in
+					flushing rounds */
+	ulint		flush_pass;	/*!< number of flushing rounds */
+	page_cleaner_slot_t*	slots;	/*!< the flush requests */
+};
+
+/** The page_cleaner threads, NULL when they are not running */
+static page_cleaner_t*	page_cleaner = NULL;
+
 /** If LRU list of a buf_pool is less than this size then LRU eviction
 should not happen. This is because when we do LRU flushing we also put
 the blocks on free list. If LRU list is very small then we can end up
@@ -294,14 +364,21 @@ buf_flush_insert_into_flush_list(
 /*=============================*/
 	buf_pool_t*	buf_pool,	/*!< buffer pool instance */
 	buf_block_t*	block,		/*!< in/out: block which is modified */
-	lsn_t		lsn)		/*!< in: oldest modification */
+	lsn_t		lsn)		/*!< in: start lsn of the mtr */
 {
 	ut_ad(!buf_pool_mutex_own(buf_pool));
-	ut_ad(log_flush_order_mutex_own());
 	ut_ad(mutex_own(&block->mutex));
 
 	buf_flush_list_mutex_enter(buf_pool);
 
+	/* The mini-transactions add their dirty pages concurrently, so
+	the page is not inserted with the start lsn of the mtr but with
+	the lsn below which all mtrs have added their pages. It is read
+	while holding the flush list mutex, which keeps the flush list
+	ordered. It is less than LOG_RECENT_CLOSED_SIZE below the start
+	lsn of the mtr, see log_recent_closed_wait(). */
+	lsn = log_get_closed_lsn();
+
 	ut_ad((UT_LIST_GET_FIRST(buf_pool->flush_list) == NULL)
 	      || (UT_LIST_GET_FIRST(buf_pool->flush_list)->oldest_modification
 		  <= lsn));
@@ -901,7 +978,7 @@ buf_flush_write_block_low(
 		break;
 	}
 
-	if (!srv_use_doublewrite_buf || !buf_dblwr) {
+	if (!srv_use_doublewrite_buf || !buf_dblwr || !buf_dblwr->n_files) {
 		fil_io(OS_FILE_WRITE | OS_AIO_SIMULATED_WAKE_LATER,
 		       sync, buf_page_get_space(bpage), zip_size,
 		       buf_page_get_page_no(bpage), 0,
@@ -1400,12 +1477,17 @@ buf_flush_LRU_list_batch(
 	ulint		flush_count = 0;
 	ulint		free_len = UT_LIST_GET_LEN(buf_pool->free);
 	ulint		lru_len = UT_LIST_GET_LEN(buf_pool->LRU);
+	ulint		withdraw_depth;
 
 	ut_ad(buf_pool_mutex_own(buf_pool));
 
+	/* A shrinking resize needs the blocks it has still to
+	withdraw on top of the usual free blocks. */
+	withdraw_depth = buf_get_withdraw_depth(buf_pool);
+
 	for (bpage = UT_LIST_GET_LAST(buf_pool->LRU);
 	     bpage != NULL && (flush_count + evict_count) < max
-	     && free_len < srv_LRU_scan_depth
+	     && free_len < srv_LRU_scan_depth + withdraw_depth
 	     && lru_len > BUF_LRU_MIN_LEN;
 	     ++scanned,
 	     bpage = buf_pool->lru_hp.get()) {
@@ -1644,10 +1726,11 @@ static
 void
 buf_flush_common(
 /*=============*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
 	buf_flush_t	flush_type,	/*!< in: type of flush */
 	ulint		page_count)	/*!< in: number of pages flushed */
 {
-	buf_dblwr_flush_buffered_writes();
+	buf_dblwr_flush_batch_writes(buf_pool, flush_type);
 
 	ut_a(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
 
@@ -1749,6 +1832,54 @@ buf_flush_wait_batch_end(
 	}
 }
 
+/*******************************************************************//**
+This utility flushes dirty blocks from the end of the flush list of
+a buffer pool instance.
+NOTE: The calling thread is not allowed to own any latches on pages!
+@return true if the batch was run, false if another batch of the same
+type was already running in the buffer pool instance */
+static
+bool
+buf_flush_do_batch(
+/*===============*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	ulint		min_n,		/*!< in: wished minimum mumber of blocks
+					flushed (it is not guaranteed that the
+					actual number is that big, though) */
+	lsn_t		lsn_limit,	/*!< in: all blocks whose
+					oldest_modification is smaller than
+					this should be flushed (if their number
+					does not exceed min_n) */
+	ulint*		n_processed)	/*!< out: the number of pages
+					which were processed */
+{
+	std::pair<ulint, ulint>	res;
+
+	*n_processed = 0;
+
+	if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		return(false);
+	}
+
+	res = buf_flush_batch(buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
+
+	buf_flush_end(buf_pool, BUF_FLUSH_LIST);
+
+	buf_flush_common(buf_pool, BUF_FLUSH_LIST, res.first);
+
+	if (res.first) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_FLUSH_BATCH_TOTAL_PAGE,
+			MONITOR_FLUSH_BATCH_COUNT,
+			MONITOR_FLUSH_BATCH_PAGES,
+			res.first);
+	}
+
+	*n_processed = res.first;
+
+	return(true);
+}
+
 /*******************************************************************//**
 This utility flushes dirty blocks from the end of the flush list of
 all buffer pool instances.
@@ -1791,12 +1922,13 @@ buf_flush_list(
 
 	/* Flush to lsn_limit in all buffer pool instances */
 	for (i = 0; i < srv_buf_pool_instances; i++) {
-		buf_pool_t*		buf_pool;
-		std::pair<ulint, ulint>	res;
+		buf_pool_t*	buf_pool;
+		ulint		n_flushed;
 
 		buf_pool = buf_pool_from_array(i);
 
-		if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		if (!buf_flush_do_batch(buf_pool, min_n, lsn_limit,
+					&n_flushed)) {
 			/* We have two choices here. If lsn_limit was
 			specified then skipping an instance of buffer
 			pool means we cannot guarantee that all pages
@@ -1812,23 +1944,8 @@ buf_flush_list(
 			continue;
 		}
 
-		res = buf_flush_batch(
-			buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
-
-		buf_flush_end(buf_pool, BUF_FLUSH_LIST);
-
-		buf_flush_common(BUF_FLUSH_LIST, res.first);
-
 		if (n_processed) {
-			*n_processed += res.first;
-		}
-
-		if (res.first) {
-			MONITOR_INC_VALUE_CUMULATIVE(
-				MONITOR_FLUSH_BATCH_TOTAL_PAGE,
-				MONITOR_FLUSH_BATCH_COUNT,
-				MONITOR_FLUSH_BATCH_PAGES,
-				res.first);
+			*n_processed += n_flushed;
 		}
 	}
 
@@ -1916,64 +2033,82 @@ buf_flush_single_page_from_LRU(
 }
 
 /*********************************************************************//**
-Clears up tail of the LRU lists:
+Clears up tail of the LRU list of a buffer pool instance:
 * Put replaceable pages at the tail of LRU to the free list
 * Flush dirty pages at the tail of LRU to the disk
-The depth to which we scan each buffer pool is controlled by dynamic
+The depth to which we scan the buffer pool is controlled by dynamic
 config parameter innodb_LRU_scan_depth.
 @return total pages processed. */
 UNIV_INTERN
 ulint
-buf_flush_LRU_tail(void)
-/*====================*/
+buf_flush_LRU_list(
+/*===============*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
 {
-	ulint	total_processed = 0;
+	std::pair<ulint, ulint>	res;
+	ulint	scan_depth;
+	ulint	withdraw_depth;
 
-	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+	/* srv_LRU_scan_depth can be arbitrarily large value.
+	We cap it with current LRU size. */
+	buf_pool_mutex_enter(buf_pool);
+	scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
+	withdraw_depth = buf_get_withdraw_depth(buf_pool);
+	buf_pool_mutex_exit(buf_pool);
 
-		buf_pool_t*	buf_pool = buf_pool_from_array(i);
-		std::pair<ulint, ulint>	res;
-		ulint	scan_depth;
+	scan_depth = ut_min(ut_max(srv_LRU_scan_depth, withdraw_depth),
+			    scan_depth);
 
-		/* srv_LRU_scan_depth can be arbitrarily large value.
-		We cap it with current LRU size. */
-		buf_pool_mutex_enter(buf_pool);
-		scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
-		buf_pool_mutex_exit(buf_pool);
+	/* Currently the page_cleaner threads are the only threads
+	that can trigger an LRU flush, one at a time for an instance.
+	It is possible that a batch triggered during last iteration
+	is still running, */
+	if (!buf_flush_start(buf_pool, BUF_FLUSH_LRU)) {
+		return(0);
+	}
 
-		scan_depth = ut_min(srv_LRU_scan_depth, scan_depth);
+	res = buf_flush_batch(buf_pool, BUF_FLUSH_LRU, scan_depth, 0);
 
-		/* Currently page_cleaner is the only thread
-		that can trigger an LRU flush. It is possible
-		that a batch triggered during last iteration is
-		still running, */
-		if (!buf_flush_start(buf_pool, BUF_FLUSH_LRU)) {
-			continue;
-		}
+	buf_flush_end(buf_pool, BUF_FLUSH_LRU);
 
-		res = buf_flush_batch(buf_pool, BUF_FLUSH_LRU, scan_depth, 0);
+	buf_flush_common(buf_pool, BUF_FLUSH_LRU, res.first);
 
-		buf_flush_end(buf_pool, BUF_FLUSH_LRU);
+	if (res.first) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_LRU_BATCH_FLUSH_TOTAL_PAGE,
+			MONITOR_LRU_BATCH_FLUSH_COUNT,
+			MONITOR_LRU_BATCH_FLUSH_PAGES,
+			res.first);
+	}
 
-		buf_flush_common(BUF_FLUSH_LRU, res.first);
+	if (res.second) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_LRU_BATCH_EVICT_TOTAL_PAGE,
+			MONITOR_LRU_BATCH_EVICT_COUNT,
+			MONITOR_LRU_BATCH_EVICT_PAGES,
+			res.second);
+	}
 
-		if (res.first) {
-			MONITOR_INC_VALUE_CUMULATIVE(
-				MONITOR_LRU_BATCH_FLUSH_TOTAL_PAGE,
-				MONITOR_LRU_BATCH_FLUSH_COUNT,
-				MONITOR_LRU_BATCH_FLUSH_PAGES,
-				res.first);
-		}
+	return(res.first + res.second);
+}
 
-		if (res.second) {
-			MONITOR_INC_VALUE_CUMULATIVE(
-				MONITOR_LRU_BATCH_EVICT_TOTAL_PAGE,
-				MONITOR_LRU_BATCH_EVICT_COUNT,
-				MONITOR_LRU_BATCH_EVICT_PAGES,
-				res.second);
-		}
+/*********************************************************************//**
+Clears up tail of the LRU lists:
+* Put replaceable pages at the tail of LRU to the free list
+* Flush dirty pages at the tail of LRU to the disk
+The depth to which we scan each buffer pool is controlled by dynamic
+config parameter innodb_LRU_scan_depth.
+@return total pages processed. */
+UNIV_INTERN
+ulint
+buf_flush_LRU_tail(void)
+/*====================*/
+{
+	ulint	total_processed = 0;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
 
-		total_processed += (res.first + res.second);
+		total_processed += buf_flush_LRU_list(buf_pool_from_array(i));
 	}
 
 	return(total_processed);
@@ -2004,26 +2139,6 @@ buf_flush_wait_LRU_batch_end(void)
 	}
 }
 
-/*********************************************************************//**
-Flush a batch of dirty pages from the flush list
-@return number of pages flushed, 0 if no page is flushed or if another
-flush_list type batch is running */
-static
-ulint
-page_cleaner_do_flush_batch(
-/*========================*/
-	ulint		n_to_flush,	/*!< in: number of pages that
-					we should attempt to flush. */
-	lsn_t		lsn_limit)	/*!< in: LSN up to which flushing
-					must happen */
-{
-	ulint n_flushed;
-
-	buf_flush_list(n_to_flush, lsn_limit, &n_flushed);
-
-	return(n_flushed);
-}
-
 /*********************************************************************//**
 Calculates if flushing is required based on number of dirty pages in
 the buffer pool.
@@ -2102,14 +2217,21 @@ af_get_pct_for_lsn(
 
 /*********************************************************************//**
 This function is called approximately once every second by the
-page_cleaner thread. Based on various factors it decides if there is a
-need to do flushing. If flushing is needed it is performed and the
-number of pages flushed is returned.
-@return number of pages flushed */
+page_cleaner coordinator thread. Based on various factors it decides if
+there is a need to do flushing. If flushing is needed it sets the number
+of pages to flush from each buffer pool instance in its slot, in
+proportion to the pages of the instance that are older than the LSN up
+to which flushing must happen.
+@return number of pages recommended to be flushed */
 static
 ulint
-page_cleaner_flush_pages_if_needed(void)
+page_cleaner_flush_pages_recommendation(
 /*====================================*/
+	lsn_t*	lsn_limitp,	/*!< out: LSN up to which flushing
+				must happen */
+	ulint	last_pages_in)	/*!< in: number of pages flushed
+				following the previous
+				recommendation */
 {
 	static	lsn_t		lsn_avg_rate = 0;
 	static	lsn_t		prev_lsn = 0;
@@ -2119,16 +2241,25 @@ page_cleaner_flush_pages_if_needed(void)
 	static	ulint		prev_pages = 0;
 	static	ulint		avg_page_rate = 0;
 	static	ulint		n_iterations = 0;
+	static	bool		recommended = false;
 	lsn_t			oldest_lsn;
 	lsn_t			cur_lsn;
 	lsn_t			age;
 	lsn_t			lsn_rate;
+	lsn_t			lsn_limit;
 	ulint			n_pages = 0;
 	ulint			pct_for_dirty = 0;
 	ulint			pct_for_lsn = 0;
 	ulint			pct_total = 0;
+	ulint			sum_pages_for_lsn = 0;
 	int			age_factor = 0;
 
+	if (recommended) {
+		last_pages = last_pages_in + 1;
+		sum_pages += last_pages_in;
+		recommended = false;
+	}
+
 	cur_lsn = log_get_lsn();
 
 	if (prev_lsn == 0) {
@@ -2186,26 +2317,58 @@ page_cleaner_flush_pages_if_needed(void)
 	MONITOR_SET(MONITOR_FLUSH_N_TO_FLUSH_REQUESTED, n_pages);
 
 	prev_pages = n_pages;
-	n_pages = page_cleaner_do_flush_batch(
-		n_pages, oldest_lsn + lsn_avg_rate * (age_factor + 1));
+	lsn_limit = oldest_lsn + lsn_avg_rate * (age_factor + 1);
+
+	/* Count the pages below lsn_limit at the tail of the flush_list
+	of each instance. No instance needs more than n_pages. */
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		ulint		pages_for_lsn = 0;
+
+		buf_flush_list_mutex_enter(buf_pool);
+
+		for (buf_page_t* bpage = UT_LIST_GET_LAST(buf_pool->flush_list);
+		     bpage != NULL && pages_for_lsn < n_pages;
+		     bpage = UT_LIST_GET_PREV(list, bpage)) {
+
+			if (bpage->oldest_modification >= lsn_limit) {
+				break;
+			}
+
+			++pages_for_lsn;
+		}
+
+		buf_flush_list_mutex_exit(buf_pool);
+
+		page_cleaner->slots[i].n_pages_requested = pages_for_lsn;
+		sum_pages_for_lsn += pages_for_lsn;
+	}
 
-	last_lsn= cur_lsn;
-	last_pages= n_pages + 1;
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+		page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		if (sum_pages_for_lsn == 0) {
+			/* Flushing for the dirty page ratio, spread it
+			evenly amongst the buffer pool instances. */
+			slot->n_pages_requested = (n_pages
+				+ page_cleaner->n_slots - 1)
+				/ page_cleaner->n_slots;
+		} else {
+			slot->n_pages_requested = (n_pages
+				* slot->n_pages_requested
+				+ sum_pages_for_lsn - 1) / sum_pages_for_lsn;
+		}
+	}
+
+	last_lsn = cur_lsn;
+	recommended = true;
 
 	MONITOR_SET(MONITOR_FLUSH_AVG_PAGE_RATE, avg_page_rate);
 	MONITOR_SET(MONITOR_FLUSH_LSN_AVG_RATE, lsn_avg_rate);
 	MONITOR_SET(MONITOR_FLUSH_PCT_FOR_DIRTY, pct_for_dirty);
 	MONITOR_SET(MONITOR_FLUSH_PCT_FOR_LSN, pct_for_lsn);
 
-	if (n_pages) {
-		MONITOR_INC_VALUE_CUMULATIVE(
-			MONITOR_FLUSH_ADAPTIVE_TOTAL_PAGE,
-			MONITOR_FLUSH_ADAPTIVE_COUNT,
-			MONITOR_FLUSH_ADAPTIVE_PAGES,
-			n_pages);
-
-		sum_pages += n_pages;
-	}
+	*lsn_limitp = lsn_limit;
 
 	return(n_pages);
 }
@@ -2233,8 +2396,329 @@ page_cleaner_sleep_if_needed(
 }
 
 /******************************************************************//**
-page_cleaner thread tasked with flushing dirty pages from the buffer
-pools. As of now we'll have only one instance of this thread.
+Initializes the state shared by the page_cleaner threads. Must be called
+before the threads are created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void)
+/*=============================*/
+{
+	ut_ad(page_cleaner == NULL);
+	ut_ad(srv_n_page_cleaners >= 1);
+
+	page_cleaner = static_cast<page_cleaner_t*>(
+		mem_zalloc(sizeof(*page_cleaner)));
+
+	mutex_create(page_cleaner_mutex_key,
+		     &page_cleaner->mutex, SYNC_PAGE_CLEANER);
+
+	page_cleaner->is_requested = os_event_create();
+	page_cleaner->is_finished = os_event_create();
+
+	page_cleaner->n_slots = srv_buf_pool_instances;
+	page_cleaner->slots = static_cast<page_cleaner_slot_t*>(
+		mem_zalloc(page_cleaner->n_slots
+			   * sizeof(*page_cleaner->slots)));
+
+	page_cleaner->n_workers = srv_n_page_cleaners - 1;
+	page_cleaner->is_running = true;
+}
+
+/******************************************************************//**
+Makes the page_cleaner worker threads exit, waits for them and frees
+the state shared by the page_cleaner threads. */
+static
+void
+buf_flush_page_cleaner_close(void)
+/*==============================*/
+{
+	mutex_enter(&page_cleaner->mutex);
+	page_cleaner->is_running = false;
+	mutex_exit(&page_cleaner->mutex);
+
+	while (page_cleaner->n_workers > 0) {
+		os_event_set(page_cleaner->is_requested);
+		os_thread_sleep(10000);
+	}
+
+	mutex_free(&page_cleaner->mutex);
+	os_event_free(page_cleaner->is_requested);
+	os_event_free(page_cleaner->is_finished);
+	mem_free(page_cleaner->slots);
+	mem_free(page_cleaner);
+	page_cleaner = NULL;
+}
+
+/*********************************************************************//**
+Requests the page_cleaner threads to flush every buffer pool instance:
+its LRU tail and, up to lsn_limit, its flush_list. */
+static
+void
+pc_request(
+/*=======*/
+	ulint	min_n,		/*!< in: wished minimum number of pages
+				to flush from the flush_lists, spread
+				evenly amongst the instances; 0 to
+				flush the numbers set in the slots by
+				page_cleaner_flush_pages_recommendation() */
+	lsn_t	lsn_limit)	/*!< in: LSN up to which flushing
+				must happen */
+{
+	if (min_n != 0 && min_n != ULINT_MAX) {
+		min_n = (min_n + page_cleaner->n_slots - 1)
+			/ page_cleaner->n_slots;
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+
+	ut_ad(page_cleaner->n_slots_requested == 0);
+	ut_ad(page_cleaner->n_slots_flushing == 0);
+	ut_ad(page_cleaner->n_slots_finished == 0);
+
+	page_cleaner->lsn_limit = lsn_limit;
+
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+		page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		ut_ad(slot->state == PAGE_CLEANER_STATE_NONE);
+
+		if (min_n != 0) {
+			slot->n_pages_requested = min_n;
+		}
+
+		slot->state = PAGE_CLEANER_STATE_REQUESTED;
+	}
+
+	page_cleaner->n_slots_requested = page_cleaner->n_slots;
+
+	os_event_set(page_cleaner->is_requested);
+
+	mutex_exit(&page_cleaner->mutex);
+}
+
+/*********************************************************************//**
+Takes a requested slot, if any, and flushes its buffer pool instance.
+@return number of slots still requested */
+static
+ulint
+pc_flush_slot(void)
+/*===============*/
+{
+	ulint	n_slots_requested;
+
+	mutex_enter(&page_cleaner->mutex);
+
+	if (page_cleaner->n_slots_requested > 0) {
+		page_cleaner_slot_t*	slot = NULL;
+		buf_pool_t*		buf_pool;
+		lsn_t			lsn_limit;
+		ulint			i;
+		ulint			tm;
+
+		for (i = 0; i < page_cleaner->n_slots; i++) {
+			slot = &page_cleaner->slots[i];
+
+			if (slot->state == PAGE_CLEANER_STATE_REQUESTED) {
+				break;
+			}
+		}
+
+		ut_a(i < page_cleaner->n_slots);
+
+		buf_pool = buf_pool_from_array(i);
+		lsn_limit = page_cleaner->lsn_limit;
+
+		slot->state = PAGE_CLEANER_STATE_FLUSHING;
+		page_cleaner->n_slots_requested--;
+		page_cleaner->n_slots_flushing++;
+
+		if (page_cleaner->n_slots_requested == 0) {
+			os_event_reset(page_cleaner->is_requested);
+		}
+
+		mutex_exit(&page_cleaner->mutex);
+
+		/* Flush pages from end of LRU if required */
+		tm = ut_time_ms();
+		slot->n_flushed_lru = buf_flush_LRU_list(buf_pool);
+		slot->flush_lru_time += ut_time_ms() - tm;
+		slot->flush_lru_pass++;
+
+		/* Flush pages from flush_list if required */
+		slot->n_flushed_list = 0;
+		slot->succeeded_list = true;
+
+		if (slot->n_pages_requested > 0) {
+			tm = ut_time_ms();
+			slot->succeeded_list = buf_flush_do_batch(
+				buf_pool, slot->n_pages_requested,
+				lsn_limit, &slot->n_flushed_list);
+			slot->flush_list_time += ut_time_ms() - tm;
+			slot->flush_list_pass++;
+		}
+
+		mutex_enter(&page_cleaner->mutex);
+
+		slot->state = PAGE_CLEANER_STATE_FINISHED;
+		page_cleaner->n_slots_flushing--;
+		page_cleaner->n_slots_finished++;
+
+		if (page_cleaner->n_slots_requested == 0
+		    && page_cleaner->n_slots_flushing == 0) {
+			os_event_set(page_cleaner->is_finished);
+		}
+	}
+
+	n_slots_requested = page_cleaner->n_slots_requested;
+
+	mutex_exit(&page_cleaner->mutex);
+
+	return(n_slots_requested);
+}
+
+/*********************************************************************//**
+Waits until all the slots of the round are flushed and releases them.
+@return false if a flush_list batch could not run in an instance
+because another one was running */
+static
+bool
+pc_wait_finished(
+/*=============*/
+	ulint*	n_flushed_lru,	/*!< out: pages processed at the tail
+				of the LRU lists */
+	ulint*	n_flushed_list)	/*!< out: pages flushed from the
+				flush_lists */
+{
+	bool	all_succeeded = true;
+
+	*n_flushed_lru = 0;
+	*n_flushed_list = 0;
+
+	os_event_wait(page_cleaner->is_finished);
+
+	mutex_enter(&page_cleaner->mutex);
+
+	ut_ad(page_cleaner->n_slots_requested == 0);
+	ut_ad(page_cleaner->n_slots_flushing == 0);
+	ut_ad(page_cleaner->n_slots_finished == page_cleaner->n_slots);
+
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+		page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		ut_ad(slot->state == PAGE_CLEANER_STATE_FINISHED);
+
+		*n_flushed_lru += slot->n_flushed_lru;
+		*n_flushed_list += slot->n_flushed_list;
+		all_succeeded &= slot->succeeded_list;
+
+		slot->state = PAGE_CLEANER_STATE_NONE;
+		slot->n_pages_requested = 0;
+	}
+
+	page_cleaner->n_slots_finished = 0;
+
+	os_event_reset(page_cleaner->is_finished);
+
+	mutex_exit(&page_cleaner->mutex);
+
+	return(all_succeeded);
+}
+
+/*********************************************************************//**
+Runs a flushing round of the page_cleaner threads, the coordinator
+flushes instances as well while the workers do.
+@return false if a flush_list batch could not run in an instance
+because another one was running */
+static
+bool
+page_cleaner_flush_round(
+/*=====================*/
+	ulint	min_n,		/*!< in: see pc_request() */
+	lsn_t	lsn_limit,	/*!< in: LSN up to which flushing
+				must happen */
+	ulint*	n_flushed_lru,	/*!< out: pages processed at the tail
+				of the LRU lists */
+	ulint*	n_flushed_list)	/*!< out: pages flushed from the
+				flush_lists */
+{
+	ulint	tm = ut_time_ms();
+	bool	success;
+
+	pc_request(min_n, lsn_limit);
+
+	while (pc_flush_slot() > 0) {
+		/* Flush the instances not taken by the workers yet */
+	}
+
+	success = pc_wait_finished(n_flushed_lru, n_flushed_list);
+
+	page_cleaner->flush_time += ut_time_ms() - tm;
+	page_cleaner->flush_pass++;
+
+	return(success);
+}
+
+/*********************************************************************//**
+Sets the average times spent by the page_cleaner threads in the
+monitor counters. Called every srv_flushing_avg_loops rounds. */
+static
+void
+page_cleaner_update_avg_time(void)
+/*==============================*/
+{
+	ulint	lru_tm = 0;
+	ulint	list_tm = 0;
+	ulint	lru_pass = 0;
+	ulint	list_pass = 0;
+	ulint	n_threads = srv_n_page_cleaners;
+
+	if (page_cleaner->flush_pass == 0) {
+		return;
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+		page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		lru_tm += slot->flush_lru_time;
+		lru_pass += slot->flush_lru_pass;
+		list_tm += slot->flush_list_time;
+		list_pass += slot->flush_list_pass;
+
+		slot->flush_lru_time = 0;
+		slot->flush_lru_pass = 0;
+		slot->flush_list_time = 0;
+		slot->flush_list_pass = 0;
+	}
+
+	mutex_exit(&page_cleaner->mutex);
+
+	MONITOR_SET(MONITOR_FLUSH_AVG_TIME,
+		    page_cleaner->flush_time / page_cleaner->flush_pass);
+	MONITOR_SET(MONITOR_FLUSH_AVG_PASS, page_cleaner->flush_pass);
+
+	/* Time spent per buffer pool instance */
+	MONITOR_SET(MONITOR_FLUSH_ADAPTIVE_AVG_TIME_SLOT,
+		    list_pass ? list_tm / list_pass : 0);
+	MONITOR_SET(MONITOR_LRU_BATCH_FLUSH_AVG_TIME_SLOT,
+		    lru_pass ? lru_tm / lru_pass : 0);
+
+	/* Time spent per page_cleaner thread in a round */
+	MONITOR_SET(MONITOR_FLUSH_ADAPTIVE_AVG_TIME_THREAD,
+		    list_tm / (n_threads * page_cleaner->flush_pass));
+	MONITOR_SET(MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD,
+		    lru_tm / (n_threads * page_cleaner->flush_pass));
+
+	page_cleaner->flush_time = 0;
+	page_cleaner->flush_pass = 0;
+}
+
+/******************************************************************//**
+page_cleaner coordinator thread tasked with flushing dirty pages from
+the buffer pools. It decides what to flush in each round and flushes
+the buffer pool instances together with the page_cleaner worker
+threads.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -2246,6 +2730,10 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 {
 	ulint	next_loop_time = ut_time_ms() + 1000;
 	ulint	n_flushed = 0;
+	ulint	n_flushed_lru = 0;
+	ulint	n_flushed_list = 0;
+	ulint	last_pages = 0;
+	ulint	n_rounds = 0;
 	ulint	last_activity = srv_get_activity_count();
 
 	ut_ad(!srv_read_only_mode);
@@ -2275,25 +2763,48 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 		next_loop_time = ut_time_ms() + 1000;
 
 		if (srv_check_activity(last_activity)) {
+			lsn_t	lsn_limit = 0;
+
 			last_activity = srv_get_activity_count();
 
-			/* Flush pages from end of LRU if required */
-			n_flushed = buf_flush_LRU_tail();
+			/* Flush pages from end of LRU and from
+			flush_list if required */
+			page_cleaner_flush_pages_recommendation(
+				&lsn_limit, last_pages);
+
+			page_cleaner_flush_round(
+				0, lsn_limit, &n_flushed_lru, &n_flushed_list);
+
+			last_pages = n_flushed_list;
+
+			if (n_flushed_list) {
+				MONITOR_INC_VALUE_CUMULATIVE(
+					MONITOR_FLUSH_ADAPTIVE_TOTAL_PAGE,
+					MONITOR_FLUSH_ADAPTIVE_COUNT,
+					MONITOR_FLUSH_ADAPTIVE_PAGES,
+					n_flushed_list);
+			}
 
-			/* Flush pages from flush_list if required */
-			n_flushed += page_cleaner_flush_pages_if_needed();
+			n_flushed = n_flushed_lru + n_flushed_list;
 		} else {
-			n_flushed = page_cleaner_do_flush_batch(
-							PCT_IO(100),
-							LSN_MAX);
+			page_cleaner_flush_round(
+				PCT_IO(100), LSN_MAX,
+				&n_flushed_lru, &n_flushed_list);
 
-			if (n_flushed) {
+			if (n_flushed_list) {
 				MONITOR_INC_VALUE_CUMULATIVE(
 					MONITOR_FLUSH_BACKGROUND_TOTAL_PAGE,
 					MONITOR_FLUSH_BACKGROUND_COUNT,
 					MONITOR_FLUSH_BACKGROUND_PAGES,
-					n_flushed);
+					n_flushed_list);
 			}
+
+			n_flushed = n_flushed_list;
+		}
+
+		if (++n_rounds >= srv_flushing_avg_loops) {
+			page_cleaner_update_avg_time();
+			n_rounds = 0;
 		}
 	}
 
@@ -2317,7 +2828,8 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	dirtied until we enter SRV_SHUTDOWN_FLUSH_PHASE phase. */
 
 	do {
-		n_flushed = page_cleaner_do_flush_batch(PCT_IO(100), LSN_MAX);
+		page_cleaner_flush_round(PCT_IO(100), LSN_MAX,
+					 &n_flushed_lru, &n_flushed);
 
 		/* We sleep only if there are no pages to flush */
 		if (n_flushed == 0) {
@@ -2360,6 +2872,8 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	/* We have lived our life. Time to die. */
 
 thread_exit:
+	buf_flush_page_cleaner_close();
+
 	buf_page_cleaner_is_active = FALSE;
 
 	/* We count the number of threads in os_thread_exit(). A created
@@ -2369,6 +2883,50 @@ thread_exit:
 	OS_THREAD_DUMMY_RETURN;
 }
 
+/******************************************************************//**
+page_cleaner worker thread, flushes the buffer pool instances requested
+by the page_cleaner coordinator thread.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
+/*==========================================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_page_cleaner_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: page_cleaner worker running, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	for (;;) {
+		os_event_wait(page_cleaner->is_requested);
+
+		if (!page_cleaner->is_running) {
+			break;
+		}
+
+		pc_flush_slot();
+	}
+
+	/* The coordinator frees page_cleaner once no worker is left,
+	this must be the last access to it. */
+	os_atomic_decrement_ulint(&page_cleaner->n_workers, 1);
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 
 /** Functor to validate the flush list. */
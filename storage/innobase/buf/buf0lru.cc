@@ -1125,7 +1125,7 @@ buf_LRU_get_free_only(
 
 	block = (buf_block_t*) UT_LIST_GET_FIRST(buf_pool->free);
 
-	if (block) {
+	while (block != NULL) {
 
 		ut_ad(block->page.in_free_list);
 		ut_d(block->page.in_free_list = FALSE);
@@ -1134,14 +1134,25 @@ buf_LRU_get_free_only(
 		ut_a(!buf_page_in_file(&block->page));
 		UT_LIST_REMOVE(list, buf_pool->free, (&block->page));
 
-		mutex_enter(&block->mutex);
+		if (buf_get_withdraw_depth(buf_pool) == 0
+		    || !buf_block_will_withdrawn(buf_pool, block)) {
 
-		buf_block_set_state(block, BUF_BLOCK_READY_FOR_USE);
-		UNIV_MEM_ALLOC(block->frame, UNIV_PAGE_SIZE);
+			mutex_enter(&block->mutex);
 
-		ut_ad(buf_pool_from_block(block) == buf_pool);
+			buf_block_set_state(block, BUF_BLOCK_READY_FOR_USE);
+			UNIV_MEM_ALLOC(block->frame, UNIV_PAGE_SIZE);
 
-		mutex_exit(&block->mutex);
+			ut_ad(buf_pool_from_block(block) == buf_pool);
+
+			mutex_exit(&block->mutex);
+			break;
+		}
+
+		/* The block is in a chunk that a shrinking resize is
+		going to remove. */
+		UT_LIST_ADD_LAST(list, buf_pool->withdraw, &block->page);
+
+		block = (buf_block_t*) UT_LIST_GET_FIRST(buf_pool->free);
 	}
 
 	return(block);
@@ -2122,8 +2133,15 @@ buf_LRU_block_free_non_file_page(
 		page_zip_set_size(&block->page.zip, 0);
 	}
 
-	UT_LIST_ADD_FIRST(list, buf_pool->free, (&block->page));
-	ut_d(block->page.in_free_list = TRUE);
+	if (buf_get_withdraw_depth(buf_pool) > 0
+	    && buf_block_will_withdrawn(buf_pool, block)) {
+		/* The block is in a chunk that a shrinking resize is
+		going to remove. */
+		UT_LIST_ADD_LAST(list, buf_pool->withdraw, &block->page);
+	} else {
+		UT_LIST_ADD_FIRST(list, buf_pool->free, (&block->page));
+		ut_d(block->page.in_free_list = TRUE);
+	}
 
 	UNIV_MEM_ASSERT_AND_FREE(block->frame, UNIV_PAGE_SIZE);
 }
@@ -481,6 +481,70 @@ buf_read_page_async(
 	return(count > 0);
 }
 
+/********************************************************************//**
+Issues asynchronous read requests for pages of one tablespace that a
+buffer pool load wants in the buffer pool. The requests are posted as
+one batch, so that the aio layer can merge the adjacent pages of the
+sorted batch into larger reads.
+@return number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_load_pages(
+/*================*/
+	ulint		space,		/*!< in: space id */
+	const ulint*	page_nos,	/*!< in: ascending page numbers */
+	ulint		n_stored)	/*!< in: number of page numbers
+					in the array */
+{
+	ulint		zip_size;
+	ulint		space_size;
+	ib_int64_t	tablespace_version;
+	ulint		count;
+	ulint		i;
+	dberr_t		err;
+
+	zip_size = fil_space_get_zip_size(space);
+
+	if (zip_size == ULINT_UNDEFINED) {
+		return(0);
+	}
+
+	tablespace_version = fil_space_get_version(space);
+
+	/* An asynchronous read of a page of the system tablespace looks
+	up the ibuf bitmap page of the read page, which must exist. */
+	space_size = fil_space_get_size(space);
+
+	count = 0;
+
+	os_aio_simulated_put_read_threads_to_sleep();
+
+	for (i = 0; i < n_stored && page_nos[i] < space_size; i++) {
+		count += buf_read_page_low(
+			&err, false, BUF_READ_ANY_PAGE
+			| OS_AIO_SIMULATED_WAKE_LATER
+			| BUF_READ_IGNORE_NONEXISTENT_PAGES,
+			space, zip_size, FALSE,
+			tablespace_version, page_nos[i], true);
+
+		if (err == DB_TABLESPACE_DELETED) {
+			break;
+		}
+	}
+#if defined(LINUX_NATIVE_AIO)
+	os_aio_linux_dispatch_read_array_submit();
+#endif
+
+	os_aio_simulated_wake_handler_threads();
+
+	srv_stats.buf_pool_reads.add(count);
+
+	/* As in buf_read_page_async(), these deliberate reads are not
+	counted in buf_LRU_stat_inc_io(). */
+
+	return(count);
+}
+
 /********************************************************************//**
 Applies linear read-ahead if in the buf_pool the page is a border page of
 a linear read-ahead area and all the pages in the area have been accessed.
@@ -5245,6 +5245,86 @@ retry:
 	return(success);
 }
 
+/**********************************************************************//**
+Truncates a tablespace that consists of a single file, such as an undo
+tablespace, to the given size and fills the file with zeros. The pages of
+the tablespace must have been removed from the buffer pool.
+@return	true if success */
+UNIV_INTERN
+bool
+fil_truncate_tablespace(
+/*====================*/
+	ulint	space_id,	/*!< in: space id */
+	ulint	size_in_pages)	/*!< in: new size in pages */
+{
+	fil_node_t*	node;
+	fil_space_t*	space;
+	ulint		page_size;
+	bool		success;
+
+	ut_ad(!srv_read_only_mode);
+
+retry:
+	fil_mutex_enter_and_prepare_for_io(space_id);
+
+	space = fil_space_get_by_id(space_id);
+	ut_a(space);
+	ut_a(UT_LIST_GET_LEN(space->chain) == 1);
+
+	page_size = fsp_flags_get_zip_size(space->flags);
+	if (!page_size) {
+		page_size = UNIV_PAGE_SIZE;
+	}
+
+	node = UT_LIST_GET_FIRST(space->chain);
+
+	if (node->being_extended) {
+		/* Wait for the extension by another thread to finish. */
+		mutex_exit(&fil_system->mutex);
+		os_thread_sleep(100000);
+		goto retry;
+	}
+
+	/* Keep the file from being extended, closed or renamed while
+	we change its size. */
+	node->being_extended = TRUE;
+
+	if (!fil_node_prepare_for_io(node, fil_system, space)) {
+		node->being_extended = FALSE;
+		mutex_exit(&fil_system->mutex);
+
+		return(false);
+	}
+
+	mutex_exit(&fil_system->mutex);
+
+	success = os_file_truncate(node->name, node->handle, 0)
+		&& os_file_set_size(node->name, node->handle,
+				    (os_offset_t) size_in_pages * page_size);
+
+	mutex_enter(&fil_system->mutex);
+
+	if (!success) {
+		os_offset_t	size = os_file_get_size(node->handle);
+
+		ut_a(size != (os_offset_t) -1);
+
+		size_in_pages = (ulint) (size / page_size);
+	}
+
+	space->size = size_in_pages;
+	node->size = size_in_pages;
+	node->being_extended = FALSE;
+
+	fil_node_complete_io(node, fil_system, OS_FILE_WRITE);
+
+	mutex_exit(&fil_system->mutex);
+
+	fil_flush(space_id);
+
+	return(success);
+}
+
 #ifdef UNIV_HOTBACKUP
 /********************************************************************//**
 Extends all tablespaces to the size stored in the space header. During the
@@ -64,7 +64,14 @@ ha_create_func(
 	     || type == MEM_HEAP_FOR_PAGE_HASH);
 
 	ut_ad(ut_is_2pow(n_sync_obj));
-	table = hash_create(n);
+
+	if (type == MEM_HEAP_FOR_PAGE_HASH && n_sync_obj > 0) {
+		/* Keep the sync object of a fold unchanged when
+		buf_pool->page_hash is resized by ha_recreate(). */
+		table = hash_create_aligned(n, n_sync_obj);
+	} else {
+		table = hash_create(n);
+	}
 
 	/* Creating MEM_HEAP_BTR_SEARCH type heaps can potentially fail,
 	but in practise it never should in this case, hence the asserts. */
@@ -98,6 +105,34 @@ ha_create_func(
 	return(table);
 }
 
+/*************************************************************//**
+Creates a hash table of at least n array cells that takes over the
+sync objects and memory heaps of a MEM_HEAP_FOR_PAGE_HASH table.
+@return	own: created table */
+UNIV_INTERN
+hash_table_t*
+ha_recreate(
+/*========*/
+	hash_table_t*	table,	/*!< in: hash table to replace */
+	ulint		n)	/*!< in: number of array cells */
+{
+	hash_table_t*	new_table;
+
+	ut_ad(table->magic_n == HASH_TABLE_MAGIC_N);
+	ut_ad(table->type != HASH_TABLE_SYNC_NONE);
+	ut_ad(table->n_sync_obj > 0);
+
+	new_table = hash_create_aligned(n, table->n_sync_obj);
+
+	new_table->type = table->type;
+	new_table->n_sync_obj = table->n_sync_obj;
+	new_table->sync_obj = table->sync_obj;
+	new_table->heaps = table->heaps;
+	new_table->heap = table->heap;
+
+	return(new_table);
+}
+
 #ifdef UNIV_SYNC_DEBUG
 /*************************************************************//**
 Verifies that the specified hash table is a part of adaptive hash index and
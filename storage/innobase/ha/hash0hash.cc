@@ -285,31 +285,27 @@ hash_unlock_x_all_but(
 #endif /* !UNIV_HOTBACKUP */
 
 /*************************************************************//**
-Creates a hash table with >= n array cells. The actual number of cells is
-chosen to be a prime number slightly bigger than n.
+Creates a hash table with exactly n_cells array cells.
 @return	own: created table */
-UNIV_INTERN
+static
 hash_table_t*
-hash_create(
-/*========*/
-	ulint	n)	/*!< in: number of array cells */
+hash_create_low(
+/*============*/
+	ulint	n_cells)	/*!< in: number of array cells */
 {
 	hash_cell_t*	array;
-	ulint		prime;
 	hash_table_t*	table;
 
-	prime = ut_find_prime(n);
-
 	table = static_cast<hash_table_t*>(mem_alloc(sizeof(hash_table_t)));
 
 	array = static_cast<hash_cell_t*>(
-		ut_malloc(sizeof(hash_cell_t) * prime));
+		ut_malloc(sizeof(hash_cell_t) * n_cells));
 
 	/* The default type of hash_table is HASH_TABLE_SYNC_NONE i.e.:
 	the caller is responsible for access control to the table. */
 	table->type = HASH_TABLE_SYNC_NONE;
 	table->array = array;
-	table->n_cells = prime;
+	table->n_cells = n_cells;
 #ifndef UNIV_HOTBACKUP
 # if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
 	table->adaptive = FALSE;
@@ -327,6 +323,39 @@ hash_create(
 	return(table);
 }
 
+/*************************************************************//**
+Creates a hash table with >= n array cells. The actual number of cells is
+chosen to be a prime number slightly bigger than n.
+@return	own: created table */
+UNIV_INTERN
+hash_table_t*
+hash_create(
+/*========*/
+	ulint	n)	/*!< in: number of array cells */
+{
+	return(hash_create_low(ut_find_prime(n)));
+}
+
+/*************************************************************//**
+Creates a hash table with >= n array cells. The number of cells is
+chosen to be a multiple of align, so that hash_get_sync_obj_index()
+maps a fold to the same sync object in every table created with the
+same align, whatever its size.
+@return	own: created table */
+UNIV_INTERN
+hash_table_t*
+hash_create_aligned(
+/*================*/
+	ulint	n,	/*!< in: number of array cells */
+	ulint	align)	/*!< in: power of 2 that the number of
+			cells must be a multiple of */
+{
+	ut_ad(ut_is_2pow(align));
+
+	return(hash_create_low(
+		align * ut_find_prime(ut_max(n / align, 1))));
+}
+
 /*************************************************************//**
 Frees a hash table. */
 UNIV_INTERN
@@ -400,4 +429,45 @@ hash_create_sync_obj_func(
 
 	table->n_sync_obj = n_sync_obj;
 }
+
+/*************************************************************//**
+Frees the sync object array of a hash table that was created with
+hash_create_sync_obj(). */
+UNIV_INTERN
+void
+hash_free_sync_obj(
+/*===============*/
+	hash_table_t*	table)	/*!< in/out: hash table */
+{
+	ulint	i;
+
+	ut_ad(table);
+	ut_ad(table->magic_n == HASH_TABLE_MAGIC_N);
+
+	switch (table->type) {
+	case HASH_TABLE_SYNC_MUTEX:
+		for (i = 0; i < table->n_sync_obj; i++) {
+			mutex_free(table->sync_obj.mutexes + i);
+		}
+
+		mem_free(table->sync_obj.mutexes);
+		table->sync_obj.mutexes = NULL;
+		break;
+
+	case HASH_TABLE_SYNC_RW_LOCK:
+		for (i = 0; i < table->n_sync_obj; i++) {
+			rw_lock_free(table->sync_obj.rw_locks + i);
+		}
+
+		mem_free(table->sync_obj.rw_locks);
+		table->sync_obj.rw_locks = NULL;
+		break;
+
+	case HASH_TABLE_SYNC_NONE:
+		break;
+	}
+
+	table->n_sync_obj = 0;
+	table->type = HASH_TABLE_SYNC_NONE;
+}
 #endif /* !UNIV_HOTBACKUP */
@@ -140,10 +140,6 @@ static long long innobase_buffer_pool_size, innobase_log_file_size;
 Connected to buf_LRU_old_ratio. */
 static uint innobase_old_blocks_pct;
 
-/** Maximum on-disk size of change buffer in terms of percentage
-of the buffer pool. */
-static uint innobase_change_buffer_max_size = CHANGE_BUFFER_DEFAULT_SIZE;
-
 /* The default values for the following char* start-up parameters
 are determined in innobase_init below: */
 
@@ -228,6 +224,56 @@ static TYPELIB innodb_checksum_algorithm_typelib = {
 	NULL
 };
 
+/** Possible values for system variable "innodb_compression_algorithm",
+in the order of page_zip_codec_t. */
+static const char* innodb_compression_algorithm_names[] = {
+	"zlib",
+	"lz",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_compression_algorithm. */
+static TYPELIB innodb_compression_algorithm_typelib = {
+	array_elements(innodb_compression_algorithm_names) - 1,
+	"innodb_compression_algorithm_typelib",
+	innodb_compression_algorithm_names,
+	NULL
+};
+
+/** Possible values for system variable "innodb_atomic_writes". */
+static const char* innodb_atomic_writes_names[] = {
+	"OFF",
+	"ON",
+	"AUTO",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_atomic_writes. */
+static TYPELIB innodb_atomic_writes_typelib = {
+	array_elements(innodb_atomic_writes_names) - 1,
+	"innodb_atomic_writes_typelib",
+	innodb_atomic_writes_names,
+	NULL
+};
+
+/** Possible values for system variable "innodb_lock_schedule_algorithm". */
+static const char* innodb_lock_schedule_algorithm_names[] = {
+	"fcfs",
+	"cats",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_lock_schedule_algorithm. */
+static TYPELIB innodb_lock_schedule_algorithm_typelib = {
+	array_elements(innodb_lock_schedule_algorithm_names) - 1,
+	"innodb_lock_schedule_algorithm_typelib",
+	innodb_lock_schedule_algorithm_names,
+	NULL
+};
+
 /* The following counter is used to convey information to InnoDB
 about server activity: in case of normal DML ops it is not
 sensible to call srv_active_wake_master_thread after each
@@ -333,6 +379,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&sync_thread_mutex_key, "sync_thread_mutex", 0},
 #  endif /* UNIV_SYNC_DEBUG */
 	{&buf_dblwr_mutex_key, "buf_dblwr_mutex", 0},
+	{&page_cleaner_mutex_key, "page_cleaner_mutex", 0},
 	{&trx_undo_mutex_key, "trx_undo_mutex", 0},
 	{&srv_sys_mutex_key, "srv_sys_mutex", 0},
 	{&lock_sys_mutex_key, "lock_mutex", 0},
@@ -352,6 +399,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 #endif /* !HAVE_ATOMIC_BUILTINS_64 */
 	{&ut_list_mutex_key, "ut_list_mutex", 0},
 	{&trx_sys_mutex_key, "trx_sys_mutex", 0},
+	{&trx_sys_view_mutex_key, "trx_sys_view_mutex", 0},
 	{&zip_pad_mutex_key, "zip_pad_mutex", 0},
 };
 # endif /* UNIV_PFS_MUTEX */
@@ -398,7 +446,10 @@ static PSI_thread_info	all_innodb_threads[] = {
 	{&srv_master_thread_key, "srv_master_thread", 0},
 	{&srv_purge_thread_key, "srv_purge_thread", 0},
 	{&buf_page_cleaner_thread_key, "page_cleaner_thread", 0},
-	{&recv_writer_thread_key, "recv_writer_thread", 0}
+	{&recv_writer_thread_key, "recv_writer_thread", 0},
+	{&recv_apply_thread_key, "recv_apply_thread", 0},
+	{&log_writer_thread_key, "log_writer_thread", 0},
+	{&log_flusher_thread_key, "log_flusher_thread", 0}
 };
 # endif /* UNIV_PFS_THREAD */
 
@@ -658,6 +709,8 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_buffer_pool_dump_status,	  SHOW_CHAR},
   {"buffer_pool_load_status",
   (char*) &export_vars.innodb_buffer_pool_load_status,	  SHOW_CHAR},
+  {"buffer_pool_resize_status",
+  (char*) &export_vars.innodb_buffer_pool_resize_status,  SHOW_CHAR},
   {"buffer_pool_pages_data",
   (char*) &export_vars.innodb_buffer_pool_pages_data,	  SHOW_LONG},
   {"buffer_pool_bytes_data",
@@ -1226,6 +1279,20 @@ thd_is_replication_slave_thread(
 	return((ibool) thd_slave_thread(thd));
 }
 
+/******************************************************************//**
+Reports that the transaction of a thread has to wait for a row lock
+held by the transaction of another thread. Used by replication slave
+workers to find waits that conflict with their commit order. */
+UNIV_INTERN
+void
+thd_report_lock_wait(
+/*=================*/
+	THD*	thd,		/*!< in: thread waiting for the lock */
+	THD*	wait_for)	/*!< in: thread holding the lock */
+{
+	thd_report_row_lock_wait(thd, wait_for);
+}
+
 /******************************************************************//**
 Gets information on the durability property requested by thread.
 Used when writing either a prepare or commit record to the log
@@ -1964,6 +2031,18 @@ innobase_get_table_cache_size(void)
 	return(table_def_size);
 }
 
+/**********************************************************************//**
+Sets the value shown for innodb_buffer_pool_size, after the buffer pool
+has been resized. */
+UNIV_INTERN
+void
+innodb_set_buf_pool_size(
+/*=====================*/
+	ulint	buf_pool_size)	/*!< in: new buffer pool size in bytes */
+{
+	innobase_buffer_pool_size = static_cast<long long>(buf_pool_size);
+}
+
 /**********************************************************************//**
 Get the current setting of the lower_case_table_names global parameter from
 mysqld.cc. We do a dirty read because for one there is no synchronization
@@ -2423,7 +2502,8 @@ ha_innobase::ha_innobase(
 		  HA_TABLE_SCAN_ON_INDEX | HA_CAN_FULLTEXT |
 		  HA_CAN_FULLTEXT_EXT | HA_CAN_EXPORT),
 	start_of_scan(0),
-	num_write_row(0)
+	num_write_row(0),
+	atm_sql_stat_start(FALSE)
 {}
 
 /*********************************************************************//**
@@ -3490,13 +3570,17 @@ innobase_change_buffering_inited_ok:
 		goto mem_free_and_error;
 	}
 
+	/* The buffer pool size was rounded to a multiple of the
+	chunk size at startup. */
+	innobase_buffer_pool_size = static_cast<long long>(srv_buf_pool_size);
+
 	/* Adjust the innodb_undo_logs config object */
 	innobase_undo_logs_init_default_max();
 
 	innobase_old_blocks_pct = static_cast<uint>(
 		buf_LRU_old_ratio_update(innobase_old_blocks_pct, TRUE));
 
-	ibuf_max_size_update(innobase_change_buffer_max_size);
+	ibuf_max_size_update(srv_change_buffer_max_size);
 
 	innobase_open_tables = hash_create(200);
 	mysql_mutex_init(innobase_share_mutex_key,
@@ -7282,6 +7366,11 @@ ha_innobase::begin_autonomous_trans()
 	prebuilt->select_lock_type= LOCK_X;
 	++atm_trx->will_lock;
 
+	/* The autonomous trx is a statement of its own, even if this
+	handle was already used by the parent trx in this statement */
+	atm_sql_stat_start = prebuilt->sql_stat_start;
+	prebuilt->sql_stat_start = TRUE;
+
 	/* Overlap current trx */
 	parent_trx = atm_trx;
 	row_update_prebuilt_trx(prebuilt, atm_trx);
@@ -7310,6 +7399,7 @@ ha_innobase::end_autonomous_trans()
 	/* Restore trx */
 	trx = (trx_t *)thd_get_atm_ha_data(user_thd);
 	prebuilt->select_lock_type = thd_get_atm_lock_type(user_thd);
+	prebuilt->sql_stat_start = atm_sql_stat_start;
 	row_update_prebuilt_trx(prebuilt, trx);
 	ut_ad(thd_to_trx(user_thd) == prebuilt->trx);
 
@@ -14861,6 +14951,137 @@ innodb_internal_table_update(
 	fts_internal_tbl_name = *(char**) var_ptr;
 }
 
+/****************************************************************//**
+Check the new value of innodb_buffer_pool_size and round it to a multiple
+of innodb_buffer_pool_chunk_size * innodb_buffer_pool_instances.
+@return	0 if the buffer pool can be resized to the value */
+static
+int
+innodb_buffer_pool_size_validate(
+/*=============================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				save,	/*!< out: immediate result
+						for update function */
+	struct st_mysql_value*		value)	/*!< in: incoming value */
+{
+	longlong	intbuf;
+	ulint		requested_buf_pool_size;
+
+	value->val_int(value, &intbuf);
+
+	if (srv_read_only_mode) {
+		push_warning_printf(
+			thd, Sql_condition::WARN_LEVEL_WARN,
+			ER_WRONG_ARGUMENTS,
+			"Cannot update innodb_buffer_pool_size"
+			" in read-only mode.");
+		return(1);
+	}
+
+	if (intbuf < 5 * 1024 * 1024L) {
+		intbuf = 5 * 1024 * 1024L;
+	}
+
+	buf_pool_mutex_enter_all();
+
+	if (srv_buf_pool_old_size != srv_buf_pool_size) {
+		buf_pool_mutex_exit_all();
+		my_printf_error(ER_WRONG_ARGUMENTS,
+				"Another buffer pool resize is already"
+				" in progress.", MYF(0));
+		return(1);
+	}
+
+	if (srv_buf_pool_instances > 1
+	    && intbuf < BUF_POOL_SIZE_THRESHOLD) {
+		buf_pool_mutex_exit_all();
+		push_warning_printf(
+			thd, Sql_condition::WARN_LEVEL_WARN,
+			ER_WRONG_ARGUMENTS,
+			"Cannot update innodb_buffer_pool_size to less"
+			" than 1GB if innodb_buffer_pool_instances > 1.");
+		return(1);
+	}
+
+	requested_buf_pool_size = buf_pool_size_align(
+		static_cast<ulint>(intbuf));
+
+	*static_cast<longlong*>(save) = requested_buf_pool_size;
+
+	if (srv_buf_pool_size == requested_buf_pool_size) {
+		buf_pool_mutex_exit_all();
+
+		if (static_cast<ulint>(intbuf) != requested_buf_pool_size) {
+			push_warning_printf(
+				thd, Sql_condition::WARN_LEVEL_WARN,
+				ER_WRONG_ARGUMENTS,
+				"innodb_buffer_pool_size must be a multiple"
+				" of innodb_buffer_pool_chunk_size=%lu *"
+				" innodb_buffer_pool_instances=%lu",
+				srv_buf_pool_chunk_unit,
+				(ulong) srv_buf_pool_instances);
+		}
+
+		/* Nothing to do */
+		return(0);
+	}
+
+	srv_buf_pool_size = requested_buf_pool_size;
+
+	buf_pool_mutex_exit_all();
+
+	if (static_cast<ulint>(intbuf) != requested_buf_pool_size) {
+		char	buf[64];
+		int	len = sizeof(buf);
+
+		push_warning_printf(
+			thd, Sql_condition::WARN_LEVEL_WARN,
+			ER_TRUNCATED_WRONG_VALUE,
+			"Truncated incorrect %-.32s value: '%-.128s'",
+			"innodb_buffer_pool_size",
+			value->val_str(value, buf, &len));
+	}
+
+	return(0);
+}
+
+/****************************************************************//**
+Update the system variable innodb_buffer_pool_size and wake up the
+buffer pool resize thread. This function is registered as a callback
+with MySQL. */
+static
+void
+innodb_buffer_pool_size_update(
+/*===========================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to
+						system variable */
+	void*				var_ptr,/*!< out: where the
+						formal string goes */
+	const void*			save)	/*!< in: immediate result
+						from check function */
+{
+	longlong	in_val = *static_cast<const longlong*>(save);
+
+	*static_cast<longlong*>(var_ptr) = in_val;
+
+	if (static_cast<ulint>(in_val) == srv_buf_pool_old_size) {
+		return;
+	}
+
+	ut_snprintf(export_vars.innodb_buffer_pool_resize_status,
+		    sizeof(export_vars.innodb_buffer_pool_resize_status),
+		    "Requested to resize buffer pool.");
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Requested to resize buffer pool. (new size: %lld bytes)",
+		in_val);
+
+	os_event_set(srv_buf_resize_event);
+}
+
 /****************************************************************//**
 Update the system variable innodb_adaptive_hash_index using the "saved"
 value. This function is registered as a callback with MySQL. */
@@ -14883,6 +15104,37 @@ innodb_adaptive_hash_index_update(
 	}
 }
 
+/****************************************************************//**
+Update the system variable innodb_log_writer_threads using the "saved"
+value, starting or stopping the log writer and log flusher threads. This
+function is registered as a callback with MySQL. */
+static
+void
+innodb_log_writer_threads_update(
+/*=============================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to
+						system variable */
+	void*				var_ptr,/*!< out: where the
+						formal string goes */
+	const void*			save)	/*!< in: immediate result
+						from check function */
+{
+	my_bool	enable = *static_cast<const my_bool*>(save);
+
+	*static_cast<my_bool*>(var_ptr) = enable;
+
+	if (srv_read_only_mode) {
+		return;
+	}
+
+	if (enable) {
+		log_start_writer_threads();
+	} else {
+		log_stop_writer_threads();
+	}
+}
+
 /****************************************************************//**
 Update the system variable innodb_cmp_per_index using the "saved"
 value. This function is registered as a callback with MySQL. */
@@ -14942,9 +15194,9 @@ innodb_change_buffer_max_size_update(
 	const void*			save)	/*!< in: immediate result
 						from check function */
 {
-	innobase_change_buffer_max_size =
+	srv_change_buffer_max_size =
 			(*static_cast<const uint*>(save));
-	ibuf_max_size_update(innobase_change_buffer_max_size);
+	ibuf_max_size_update(srv_change_buffer_max_size);
 }
 
 #ifdef UNIV_DEBUG
@@ -16155,6 +16407,31 @@ buffer_pool_load_abort(
 	}
 }
 
+/****************************************************************//**
+Update the system variable innodb_buffer_pool_dump_interval and wake up
+the buffer pool dump/load thread, so that it sleeps for the new interval.
+This function is registered as a callback with MySQL. */
+static
+void
+innodb_buffer_pool_dump_interval_update(
+/*====================================*/
+	THD*				thd	/*!< in: thread handle */
+					MY_ATTRIBUTE((unused)),
+	struct st_mysql_sys_var*	var	/*!< in: pointer to system
+						variable */
+					MY_ATTRIBUTE((unused)),
+	void*				var_ptr,/*!< out: where the formal
+						string goes */
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	*static_cast<ulong*>(var_ptr) = *static_cast<const ulong*>(save);
+
+	if (!srv_read_only_mode) {
+		os_event_set(srv_buf_dump_event);
+	}
+}
+
 /** Update innodb_status_output or innodb_status_output_locks,
 which control InnoDB "status monitor" output to the error log.
 @param[in]	thd	thread handle
@@ -16228,6 +16505,26 @@ static MYSQL_SYSVAR_BOOL(doublewrite, innobase_use_doublewrite,
   "Disable with --skip-innodb-doublewrite.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_ENUM(atomic_writes, srv_atomic_writes,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Whether the storage writes pages atomically, so that the doublewrite "
+  "buffer can be skipped. "
+  "OFF: always write pages through the doublewrite buffer; "
+  "ON: the storage (for example ext4 with data=journal) never tears a "
+  "page write; "
+  "AUTO: skip the doublewrite buffer if innodb_flush_method is O_DIRECT "
+  "and the storage reports atomic writes of a page. "
+  "With atomic writes a torn page found in crash recovery stops the "
+  "server.",
+  NULL, NULL, SRV_ATOMIC_WRITES_OFF,
+  &innodb_atomic_writes_typelib);
+
+static MYSQL_SYSVAR_STR(doublewrite_dir, srv_doublewrite_dir,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Directory where the doublewrite files, one for each buffer pool "
+  "instance, live. Defaults to the InnoDB data home directory.",
+  NULL, NULL, NULL);
+
 static MYSQL_SYSVAR_ULONG(io_capacity, srv_io_capacity,
   PLUGIN_VAR_RQCMDARG,
   "Number of IOPs the server can do. Tunes the background IO rate",
@@ -16336,6 +16633,19 @@ static MYSQL_SYSVAR_UINT(flush_log_at_timeout, srv_flush_log_at_timeout,
   "Write and flush logs every (n) second.",
   NULL, NULL, 1, 0, 2700, 0);
 
+static MYSQL_SYSVAR_BOOL(log_writer_threads, srv_log_writer_threads,
+  PLUGIN_VAR_OPCMDARG,
+  "Write and flush the redo log in dedicated log writer and log flusher"
+  " threads, which committing transactions wait for. Disabling this can"
+  " help on systems with few CPUs or low concurrency.",
+  NULL, innodb_log_writer_threads_update, TRUE);
+
+static MYSQL_SYSVAR_ULONG(log_wait_spin_rounds, srv_log_wait_spin_rounds,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of spin rounds a thread waiting for the log writer or log flusher"
+  " thread does before it waits on an event.",
+  NULL, NULL, 30, 0, 1000000, 0);
+
 static MYSQL_SYSVAR_ULONG(flush_log_at_trx_commit, srv_flush_log_at_trx_commit,
   PLUGIN_VAR_OPCMDARG,
   "Set to 0 (write and flush once per second),"
@@ -16418,6 +16728,24 @@ static MYSQL_SYSVAR_ULONG(flushing_avg_loops,
   "Number of iterations over which the background flushing is averaged.",
   NULL, NULL, 30, 1, 1000, 0);
 
+static MYSQL_SYSVAR_ULONG(page_cleaners, srv_n_page_cleaners,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Page cleaner threads can be from 1 to 64, at most one per buffer pool"
+  " instance. Default is 1.",
+  NULL, NULL,
+  1,			/* Default setting */
+  1,			/* Minimum value */
+  64, 0);		/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(recovery_apply_threads, srv_n_recovery_apply_threads,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads applying the redo log records to the pages during"
+  " crash recovery, from 1 to 64. Default is 4.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  64, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(max_purge_lag, srv_max_purge_lag,
   PLUGIN_VAR_RQCMDARG,
   "Desired maximum length of the purge queue (0 = no limit)",
@@ -16505,6 +16833,21 @@ static MYSQL_SYSVAR_UINT(compression_level, page_zip_level,
   ", 1 is fastest, 9 is best compression and default is 6.",
   NULL, NULL, DEFAULT_COMPRESSION_LEVEL, 0, 9, 0);
 
+static MYSQL_SYSVAR_ENUM(compression_algorithm, page_zip_codec,
+  PLUGIN_VAR_RQCMDARG,
+  "The codec used for pages of compressed tables that are compressed from"
+  " now on. Possible values are "
+  "ZLIB "
+    "deflate at innodb_compression_level (default); "
+  "LZ "
+    "a faster LZ77 codec without entropy coding, at a lower compression"
+    " ratio. "
+  "Pages that were compressed with either codec remain readable."
+  " Servers without the LZ codec cannot read pages compressed with it,"
+  " so a tablespace that has such pages cannot be downgraded.",
+  NULL, NULL, PAGE_ZIP_CODEC_ZLIB,
+  &innodb_compression_algorithm_typelib);
+
 static MYSQL_SYSVAR_BOOL(log_compressed_pages, page_zip_log_pages,
        PLUGIN_VAR_OPCMDARG,
   "Enables/disables the logging of entire compressed page images."
@@ -16528,9 +16871,18 @@ static MYSQL_SYSVAR_ULONG(autoextend_increment, srv_auto_extend_increment,
   NULL, NULL, 64L, 1L, 1000L, 0);
 
 static MYSQL_SYSVAR_LONGLONG(buffer_pool_size, innobase_buffer_pool_size,
-  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  PLUGIN_VAR_RQCMDARG,
   "The size of the memory buffer InnoDB uses to cache data and indexes of its tables.",
-  NULL, NULL, 128*1024*1024L, 5*1024*1024L, LONGLONG_MAX, 1024*1024L);
+  innodb_buffer_pool_size_validate,
+  innodb_buffer_pool_size_update,
+  128*1024*1024L, 5*1024*1024L, LONGLONG_MAX, 1024*1024L);
+
+static MYSQL_SYSVAR_ULONG(buffer_pool_chunk_size, srv_buf_pool_chunk_unit,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Size of a single memory chunk within each buffer pool instance"
+  " for resizing buffer pool. Online buffer pool resizing happens"
+  " at this granularity.",
+  NULL, NULL, 128*1024*1024L, 1024*1024L, LONG_MAX, 1024*1024L);
 
 #if defined UNIV_DEBUG || defined UNIV_PERF_DEBUG
 static MYSQL_SYSVAR_ULONG(page_hash_locks, srv_n_page_hash_locks,
@@ -16564,6 +16916,17 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_dump_at_shutdown, srv_buffer_pool_dump_at_s
   "Dump the buffer pool into a file named @@innodb_buffer_pool_filename",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_ULONG(buffer_pool_dump_pct, srv_buf_pool_dump_pct,
+  PLUGIN_VAR_RQCMDARG,
+  "Dump only the hottest N% of each buffer pool, defaults to 100",
+  NULL, NULL, 100, 1, 100, 0);
+
+static MYSQL_SYSVAR_ULONG(buffer_pool_dump_interval, srv_buf_dump_interval,
+  PLUGIN_VAR_RQCMDARG,
+  "Dump the buffer pool every N seconds if its working set has changed,"
+  " 0 (the default) disables the periodic dumps",
+  NULL, innodb_buffer_pool_dump_interval_update, 0, 0, 86400, 0);
+
 #ifdef UNIV_DEBUG
 static MYSQL_SYSVAR_STR(buffer_pool_evict, srv_buffer_pool_evict,
   PLUGIN_VAR_RQCMDARG,
@@ -16587,6 +16950,11 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_load_at_startup, srv_buffer_pool_load_at_st
   "Load the buffer pool from a file named @@innodb_buffer_pool_filename",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_ULONG(buffer_pool_load_threads, srv_buf_load_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads that read the pages of a buffer pool load",
+  NULL, NULL, 1, 1, 64, 0);
+
 static MYSQL_SYSVAR_ULONG(lru_scan_depth, srv_LRU_scan_depth,
   PLUGIN_VAR_RQCMDARG,
   "How deep to scan LRU to keep it clean",
@@ -16682,6 +17050,20 @@ static MYSQL_SYSVAR_ULONG(sort_buffer_size, srv_sort_buf_size,
   "Memory buffer size for index creation",
   NULL, NULL, 1048576, 65536, 64<<20, 0);
 
+static MYSQL_SYSVAR_ULONG(index_build_threads, srv_index_build_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads that build the secondary indexes created by one "
+  "ALTER TABLE, each with its own sort buffers. Unless the table is "
+  "rebuilt, they scan key ranges of the clustered index in parallel; "
+  "they merge sort and load the non-unique indexes in parallel",
+  NULL, NULL, 1, 1, 64, 0);
+
+static MYSQL_SYSVAR_ULONG(fill_factor, srv_fill_factor,
+  PLUGIN_VAR_RQCMDARG,
+  "Percentage of each B-tree page filled when an index is built from "
+  "sorted entries; at 100, clustered index leaf pages keep 1/16 free",
+  NULL, NULL, 100, 10, 100, 0);
+
 static MYSQL_SYSVAR_ULONGLONG(online_alter_log_max_size, srv_online_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum modification log file size for online index creation",
@@ -16820,6 +17202,32 @@ static MYSQL_SYSVAR_ULONG(undo_logs, srv_undo_logs,
   1,			/* Minimum value */
   TRX_SYS_N_RSEGS, 0);	/* Maximum value */
 
+static MYSQL_SYSVAR_BOOL(undo_log_truncate, srv_undo_log_truncate,
+  PLUGIN_VAR_OPCMDARG,
+  "Truncate an undo tablespace that has grown bigger than"
+  " innodb_max_undo_log_size, once purge has freed its undo logs."
+  " Requires at least two undo tablespaces.",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_ULONGLONG(max_undo_log_size, srv_max_undo_log_size,
+  PLUGIN_VAR_OPCMDARG,
+  "Size of an undo tablespace in bytes above which it is truncated,"
+  " if innodb_undo_log_truncate is enabled.",
+  NULL, NULL,
+  1024 * 1024 * 1024L,	/* Default setting */
+  10 * 1024 * 1024L,	/* Minimum value */
+  ~0ULL, 0);		/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(purge_rseg_truncate_frequency,
+  srv_purge_rseg_truncate_frequency,
+  PLUGIN_VAR_OPCMDARG,
+  "Free the purged undo logs, and check whether an undo tablespace"
+  " needs truncation, once every this many purge batches.",
+  NULL, NULL,
+  128,			/* Default setting */
+  1,			/* Minimum value */
+  128, 0);		/* Maximum value */
+
 /* Alias for innodb_undo_logs, this config variable is deprecated. */
 static MYSQL_SYSVAR_ULONG(rollback_segments, srv_undo_logs,
   PLUGIN_VAR_OPCMDARG,
@@ -16903,7 +17311,7 @@ static MYSQL_SYSVAR_STR(change_buffering, innobase_change_buffering,
   innodb_change_buffering_update, "all");
 
 static MYSQL_SYSVAR_UINT(change_buffer_max_size,
-  innobase_change_buffer_max_size,
+  srv_change_buffer_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum on-disk size of change buffer in terms of percentage"
   " of the buffer pool.",
@@ -16979,6 +17387,23 @@ static MYSQL_SYSVAR_BOOL(print_all_deadlocks, srv_print_all_deadlocks,
   "Print all deadlocks to MySQL error log (off by default)",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_BOOL(async_deadlock_detect, srv_async_deadlock_detect,
+  PLUGIN_VAR_OPCMDARG,
+  "Look for deadlocks in a background thread instead of checking each"
+  " lock wait when it is enqueued (off by default)",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_ENUM(lock_schedule_algorithm, srv_lock_schedule_algorithm,
+  PLUGIN_VAR_RQCMDARG,
+  "The order in which the waiting record locks are granted when a record "
+  "lock is released. "
+  "FCFS: in the order the locks were requested; "
+  "CATS: first to the transactions that the most other transactions "
+  "wait for, directly or through other waiting transactions. "
+  "The default is FCFS.",
+  NULL, NULL, SRV_LOCK_SCHEDULE_FCFS,
+  &innodb_lock_schedule_algorithm_typelib);
+
 static MYSQL_SYSVAR_ULONG(compression_failure_threshold_pct,
   zip_failure_threshold_pct, PLUGIN_VAR_OPCMDARG,
   "If the compression failure rate of a table is greater than this number"
@@ -17070,16 +17495,20 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(api_bk_commit_interval),
   MYSQL_SYSVAR(autoextend_increment),
   MYSQL_SYSVAR(buffer_pool_size),
+  MYSQL_SYSVAR(buffer_pool_chunk_size),
   MYSQL_SYSVAR(buffer_pool_instances),
   MYSQL_SYSVAR(buffer_pool_filename),
   MYSQL_SYSVAR(buffer_pool_dump_now),
   MYSQL_SYSVAR(buffer_pool_dump_at_shutdown),
+  MYSQL_SYSVAR(buffer_pool_dump_pct),
+  MYSQL_SYSVAR(buffer_pool_dump_interval),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(buffer_pool_evict),
 #endif /* UNIV_DEBUG */
   MYSQL_SYSVAR(buffer_pool_load_now),
   MYSQL_SYSVAR(buffer_pool_load_abort),
   MYSQL_SYSVAR(buffer_pool_load_at_startup),
+  MYSQL_SYSVAR(buffer_pool_load_threads),
   MYSQL_SYSVAR(lru_scan_depth),
   MYSQL_SYSVAR(flush_neighbors),
   MYSQL_SYSVAR(checksum_algorithm),
@@ -17089,9 +17518,12 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(rds_adaptive_tickets_algo),
   MYSQL_SYSVAR(rds_min_concurrency_tickets),
   MYSQL_SYSVAR(compression_level),
+  MYSQL_SYSVAR(compression_algorithm),
   MYSQL_SYSVAR(data_file_path),
   MYSQL_SYSVAR(data_home_dir),
   MYSQL_SYSVAR(doublewrite),
+  MYSQL_SYSVAR(doublewrite_dir),
+  MYSQL_SYSVAR(atomic_writes),
   MYSQL_SYSVAR(api_enable_binlog),
   MYSQL_SYSVAR(api_enable_mdl),
   MYSQL_SYSVAR(api_disable_rowlock),
@@ -17104,6 +17536,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(file_format_check),
   MYSQL_SYSVAR(file_format_max),
   MYSQL_SYSVAR(flush_log_at_timeout),
+  MYSQL_SYSVAR(log_writer_threads),
+  MYSQL_SYSVAR(log_wait_spin_rounds),
   MYSQL_SYSVAR(flush_log_at_trx_commit),
   MYSQL_SYSVAR(flush_method),
   MYSQL_SYSVAR(force_recovery),
@@ -17139,6 +17573,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(adaptive_flushing_lwm),
   MYSQL_SYSVAR(adaptive_flushing),
   MYSQL_SYSVAR(flushing_avg_loops),
+  MYSQL_SYSVAR(page_cleaners),
+  MYSQL_SYSVAR(recovery_apply_threads),
   MYSQL_SYSVAR(max_purge_lag),
   MYSQL_SYSVAR(max_purge_lag_delay),
   MYSQL_SYSVAR(mirrored_log_groups),
@@ -17166,6 +17602,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(strict_mode),
   MYSQL_SYSVAR(support_xa),
   MYSQL_SYSVAR(sort_buffer_size),
+  MYSQL_SYSVAR(index_build_threads),
+  MYSQL_SYSVAR(fill_factor),
   MYSQL_SYSVAR(online_alter_log_max_size),
   MYSQL_SYSVAR(sync_spin_loops),
   MYSQL_SYSVAR(spin_wait_delay),
@@ -17212,11 +17650,16 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(status_output),
   MYSQL_SYSVAR(status_output_locks),
   MYSQL_SYSVAR(print_all_deadlocks),
+  MYSQL_SYSVAR(async_deadlock_detect),
+  MYSQL_SYSVAR(lock_schedule_algorithm),
   MYSQL_SYSVAR(cmp_per_index_enabled),
   MYSQL_SYSVAR(undo_logs),
   MYSQL_SYSVAR(rollback_segments),
   MYSQL_SYSVAR(undo_directory),
   MYSQL_SYSVAR(undo_tablespaces),
+  MYSQL_SYSVAR(undo_log_truncate),
+  MYSQL_SYSVAR(max_undo_log_size),
+  MYSQL_SYSVAR(purge_rseg_truncate_frequency),
   MYSQL_SYSVAR(sync_array_size),
   MYSQL_SYSVAR(compression_failure_threshold_pct),
   MYSQL_SYSVAR(compression_pad_pct_max),
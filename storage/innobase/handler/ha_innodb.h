@@ -80,6 +80,9 @@ class ha_innobase: public handler
 					ROW_SEL_EXACT, ROW_SEL_EXACT_PREFIX,
 					or undefined */
 	uint		num_write_row;	/*!< number of write_row() calls */
+	ibool		atm_sql_stat_start;
+					/*!< prebuilt->sql_stat_start of the
+					parent trx during an autonomous trx */
 
 	uint store_key_val_for_row(uint keynr, char* buff, uint buff_len,
                                    const uchar* record);
@@ -5443,9 +5443,11 @@ i_s_innodb_fill_buffer_pool(
 
 	heap = mem_heap_create(10000);
 
-	/* Go through each chunk of buffer pool. Currently, we only
-	have one single chunk for each buffer pool */
-	for (ulint n = 0; n < buf_pool->n_chunks; n++) {
+	/* Go through each chunk of buffer pool. The chunks can be
+	added or removed by an online resize of the buffer pool, so the
+	chunk is looked up again whenever the mutex is reacquired. */
+	for (ulint n = 0;
+	     n < ut_min(buf_pool->n_chunks, buf_pool->n_chunks_new); n++) {
 		const buf_block_t*	block;
 		ulint			n_blocks;
 		buf_page_info_t*	info_buffer;
@@ -5455,8 +5457,14 @@ i_s_innodb_fill_buffer_pool(
 		ulint			num_to_process = 0;
 		ulint			block_id = 0;
 
-		/* Get buffer block of the nth chunk */
-		block = buf_get_nth_chunk_block(buf_pool, n, &chunk_size);
+		/* Get the size of the nth chunk */
+		buf_pool_mutex_enter(buf_pool);
+		if (n >= ut_min(buf_pool->n_chunks, buf_pool->n_chunks_new)) {
+			buf_pool_mutex_exit(buf_pool);
+			break;
+		}
+		buf_get_nth_chunk_block(buf_pool, n, &chunk_size);
+		buf_pool_mutex_exit(buf_pool);
 		num_page = 0;
 
 		while (chunk_size > 0) {
@@ -5479,6 +5487,18 @@ i_s_innodb_fill_buffer_pool(
 			release mutex periodically */
 			buf_pool_mutex_enter(buf_pool);
 
+			if (n >= ut_min(buf_pool->n_chunks,
+					buf_pool->n_chunks_new)) {
+				/* The chunk was removed by a resize */
+				buf_pool_mutex_exit(buf_pool);
+				break;
+			}
+
+			block = buf_get_nth_chunk_block(
+				buf_pool, n, &chunk_size) + block_id;
+			chunk_size -= block_id;
+			num_to_process = ut_min(num_to_process, chunk_size);
+
 			/* GO through each block in the chunk */
 			for (n_blocks = num_to_process; n_blocks--; block++) {
 				i_s_innodb_buffer_page_get_info(
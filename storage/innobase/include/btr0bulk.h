@@ -0,0 +1,78 @@
+/*****************************************************************************
+
+Copyright (c) 2026, Aliyun and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/********************************************************************//**
+@file include/btr0bulk.h
+Bottom-up loading of an index tree from sorted index entries
+
+Created 10/17/2026
+*************************************************************************/
+
+#ifndef btr0bulk_h
+#define btr0bulk_h
+
+#include "univ.i"
+
+#include "data0types.h"
+#include "dict0types.h"
+#include "trx0types.h"
+
+/** Bulk loader of an index tree */
+struct btr_bulk_t;
+
+/*********************************************************************//**
+Creates a bulk loader for an empty index tree of an uncompressed table.
+The index entries must be passed to btr_bulk_insert() in ascending
+order; the leaf pages are filled left to right up to innodb_fill_factor
+and the node pointer levels are built bottom-up on the way.
+@return own: bulk loader */
+UNIV_INTERN
+btr_bulk_t*
+btr_bulk_create(
+/*============*/
+	dict_index_t*	index,	/*!< in/out: empty index tree */
+	trx_id_t	trx_id)	/*!< in: transaction creating the index */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+/*********************************************************************//**
+Appends an index entry to the index tree being loaded.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_insert(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in/out: bulk loader */
+	dtuple_t*	tuple)	/*!< in/out: index entry, greater than
+				the previous one */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+/*********************************************************************//**
+Writes the last page of every level, copies the single page of the top
+level to the root page and frees the bulk loader.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+btr_bulk_finish(
+/*============*/
+	btr_bulk_t*	bulk,	/*!< in, own: bulk loader */
+	dberr_t		err)	/*!< in: DB_SUCCESS, or the error that
+				aborted the load; the pages are then
+				only released */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+#endif /* btr0bulk_h */
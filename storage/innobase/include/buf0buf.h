@@ -82,6 +82,11 @@ Created 11/5/1995 Heikki Tuuri
 #define MAX_PAGE_HASH_LOCKS	1024	/*!< The maximum number of
 					page_hash locks */
 
+#define BUF_POOL_SIZE_THRESHOLD	(1024 * 1024 * 1024)
+					/*!< Smallest buffer pool size
+					that is split into more than one
+					buffer pool instance */
+
 extern	buf_pool_t*	buf_pool_ptr;	/*!< The buffer pools
 					of the database */
 #ifdef UNIV_DEBUG
@@ -91,6 +96,14 @@ extern ibool		buf_debug_prints;/*!< If this is set TRUE, the program
 #endif /* UNIV_DEBUG */
 extern ulint srv_buf_pool_instances;
 extern ulint srv_buf_pool_curr_size;
+extern ulong srv_buf_pool_chunk_unit;
+
+extern volatile bool	buf_pool_withdrawing;	/*!< true while a shrinking
+						resize is withdrawing
+						blocks */
+extern volatile ulint	buf_withdraw_clock;	/*!< incremented by every
+						resize that withdrew
+						blocks */
 #else /* !UNIV_HOTBACKUP */
 extern buf_block_t*	back_block1;	/*!< first block, for --apply-log */
 extern buf_block_t*	back_block2;	/*!< second block, for page reorganize */
@@ -246,6 +259,71 @@ void
 buf_pool_clear_hash_index(void);
 /*===========================*/
 
+/********************************************************************//**
+Calculates the buffer pool size that innodb_buffer_pool_size is rounded
+to: a multiple of innodb_buffer_pool_chunk_size times the number of
+buffer pool instances.
+@return	aligned size in bytes */
+UNIV_INLINE
+ulint
+buf_pool_size_align(
+/*================*/
+	ulint	size);	/*!< in: requested size in bytes */
+
+/********************************************************************//**
+Determines if a block is in a chunk that is being removed from the
+buffer pool instance by a shrinking resize.
+@return	true if the block will be withdrawn */
+UNIV_INTERN
+bool
+buf_block_will_withdrawn(
+/*=====================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	const buf_block_t*	block);		/*!< in: block */
+
+/********************************************************************//**
+Determines if a frame is in a chunk that is being removed from the
+buffer pool instance by a shrinking resize.
+@return	true if the frame will be withdrawn */
+UNIV_INTERN
+bool
+buf_frame_will_withdrawn(
+/*=====================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	const byte*		ptr);		/*!< in: pointer to a frame */
+
+/********************************************************************//**
+Gets the number of blocks that a shrinking resize still has to withdraw
+from a buffer pool instance. The caller must hold buf_pool->mutex.
+@return	number of blocks, 0 if the instance is not being shrunk */
+UNIV_INLINE
+ulint
+buf_get_withdraw_depth(
+/*===================*/
+	const buf_pool_t*	buf_pool);	/*!< in: buffer pool instance */
+
+/********************************************************************//**
+Checks if a block pointer that was remembered when buf_withdraw_clock
+had the value withdraw_clock may point to a withdrawn block.
+@return	true if the block pointer must not be dereferenced */
+UNIV_INLINE
+bool
+buf_pool_is_obsolete(
+/*=================*/
+	ulint	withdraw_clock);	/*!< in: buf_withdraw_clock when the
+					block pointer was remembered */
+
+/*********************************************************************//**
+This is the thread that resizes the buffer pool when
+innodb_buffer_pool_size is changed. It waits for srv_buf_resize_event.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_resize_thread)(
+/*==============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
 /********************************************************************//**
 Relocate a buffer control block.  Relocates the block on the LRU list
 and in buf_pool->page_hash.  Does not relocate bpage->list.
@@ -1977,8 +2055,14 @@ struct buf_pool_t{
 	ulint		mutex_exit_forbidden; /*!< Forbid release mutex */
 #endif
 	ulint		n_chunks;	/*!< number of buffer pool chunks */
+	ulint		n_chunks_new;	/*!< new number of buffer pool chunks
+					while the buffer pool is being
+					resized */
 	buf_chunk_t*	chunks;		/*!< buffer pool chunks */
 	ulint		curr_size;	/*!< current pool size in pages */
+	ulint		old_size;	/*!< previous pool size in pages;
+					differs from curr_size only while
+					the buffer pool is being resized */
 	hash_table_t*	page_hash;	/*!< hash table of buf_page_t or
 					buf_block_t file pages,
 					buf_page_in_file() == TRUE,
@@ -1990,6 +2074,10 @@ struct buf_pool_t{
 					page_hash mutex. Lookups can happen
 					while holding the buf_pool->mutex or
 					the relevant page_hash mutex. */
+	hash_table_t*	page_hash_old;	/*!< page_hash that was replaced by
+					the last resize, kept until the
+					next one because other threads
+					may still be reading its latches */
 	hash_table_t*	zip_hash;	/*!< hash table of buf_block_t blocks
 					whose frames are allocated to the
 					zip buddy system,
@@ -2080,6 +2168,15 @@ struct buf_pool_t{
 					/*!< base node of the free
 					block list */
 
+	UT_LIST_BASE_NODE_T(buf_page_t) withdraw;
+					/*!< base node of the list of
+					free blocks in the chunks that
+					a shrinking resize is going to
+					remove */
+	ulint		withdraw_target;/*!< number of blocks that have
+					to be in withdraw before the
+					chunks can be freed */
+
 	/** "hazard pointer" used during scan of LRU while doing
 	LRU list batch.  Protected by buf_pool::mutex */
 	LRUHp		lru_hp;
@@ -28,11 +28,22 @@ Created 2011/12/19 Inaam Rana
 
 #include "univ.i"
 #include "ut0byte.h"
+#include "buf0types.h"
+#include "os0file.h"
 #include "log0log.h"
 #include "log0recv.h"
 
 #ifndef UNIV_HOTBACKUP
 
+/** Prefix of the names of the doublewrite files; the buffer pool instance
+number is appended to it */
+#define BUF_DBLWR_FILE_NAME	"ib_doublewrite"
+
+/** Size of a doublewrite file in pages. A file holds a flush list batch,
+an LRU batch and 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE - batch size single page
+flush slots. */
+#define BUF_DBLWR_FILE_PAGES	(4 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)
+
 /** Doublewrite system */
 extern buf_dblwr_t*	buf_dblwr;
 /** Set to TRUE when the doublewrite buffer is being created */
@@ -51,7 +62,8 @@ At a database startup initializes the doublewrite buffer memory structure if
 we already have a doublewrite buffer created in the data files. If we are
 upgrading to an InnoDB version which supports multiple tablespaces, then this
 function performs the necessary update operations. If we are in a crash
-recovery, this function loads the pages from double write buffer into memory. */
+recovery, this function loads the pages from double write buffer and the
+doublewrite files into memory. */
 void
 buf_dblwr_init_or_load_pages(
 /*=========================*/
@@ -65,6 +77,14 @@ void
 buf_dblwr_process(void);
 /*===================*/
 
+/****************************************************************//**
+Frees the pages read from the doublewrite buffer and the doublewrite files
+at startup, once crash recovery no longer needs them. */
+UNIV_INTERN
+void
+buf_dblwr_free_read_buf(void);
+/*=========================*/
+
 /****************************************************************//**
 frees doublewrite buffer. */
 UNIV_INTERN
@@ -98,7 +118,7 @@ buf_dblwr_add_to_batch(
 /*====================*/
 	buf_page_t*	bpage);	/*!< in: buffer block to write */
 /********************************************************************//**
-Flushes possible buffered writes from the doublewrite memory buffer to disk,
+Flushes possible buffered writes from the doublewrite memory buffers to disk,
 and also wakes up the aio thread if simulated aio is used. It is very
 important to call this function after a batch of writes has been posted,
 and also when we may have to wait for a page latch! Otherwise a deadlock
@@ -108,6 +128,17 @@ void
 buf_dblwr_flush_buffered_writes(void);
 /*=================================*/
 /********************************************************************//**
+Flushes the buffered writes of one flush batch type of a buffer pool
+instance from its doublewrite memory buffer to disk. This is called at the
+end of a flush batch. */
+UNIV_INTERN
+void
+buf_dblwr_flush_batch_writes(
+/*=========================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t	flush_type);	/*!< in: BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+/********************************************************************//**
 Writes a page to the doublewrite buffer on disk, sync it, then write
 the page to the datafile and sync the datafile. This function is used
 for single page flushes. If all the buffers allocated for single page
@@ -122,19 +153,28 @@ buf_dblwr_write_single_page(
 	buf_page_t*	bpage,	/*!< in: buffer block to write */
 	bool		sync);	/*!< in: true if sync IO requested */
 
-/** Doublewrite control struct */
-struct buf_dblwr_t{
+/** Doublewrite buffer of one flush batch type of a buffer pool instance.
+Its pages are written to a region of the doublewrite file of the
+instance. */
+struct buf_dblwr_shard_t{
 	ib_mutex_t	mutex;	/*!< mutex protecting the first_free
 				field and write_buf */
-	ulint		block1;	/*!< the page number of the first
-				doublewrite block (64 pages) */
-	ulint		block2;	/*!< page number of the second block */
+	os_file_t	file;	/*!< doublewrite file of the buffer
+				pool instance */
+	const char*	file_name;/*!< name of file */
+	os_offset_t	offset;	/*!< offset of the batch region in
+				the file, in bytes */
+	os_offset_t	s_offset;/*!< offset of the single page flush
+				region in the file, in bytes */
 	ulint		first_free;/*!< first free position in write_buf
 				measured in units of UNIV_PAGE_SIZE */
 	ulint		b_reserved;/*!< number of slots currently reserved
 				for batch flush. */
 	os_event_t	b_event;/*!< event where threads wait for a
 				batch flush to end. */
+	ulint		n_slots;/*!< number of slots for single page
+				flushes; 0 in the shard of the flush
+				list batches */
 	ulint		s_reserved;/*!< number of slots currently
 				reserved for single page flushes. */
 	os_event_t	s_event;/*!< event where threads wait for a
@@ -148,7 +188,9 @@ struct buf_dblwr_t{
 	byte*		write_buf;/*!< write buffer used in writing to the
 				doublewrite buffer, aligned to an
 				address divisible by UNIV_PAGE_SIZE
-				(which is required by Windows aio) */
+				(which is required by Windows aio);
+				the single page flush slots follow
+				the batch pages */
 	byte*		write_buf_unaligned;/*!< pointer to write_buf,
 				but unaligned */
 	buf_page_t**	buf_block_arr;/*!< array to store pointers to
@@ -156,6 +198,31 @@ struct buf_dblwr_t{
 				cached to write_buf */
 };
 
+/** Doublewrite control struct */
+struct buf_dblwr_t{
+	ulint		block1;	/*!< the page number of the first
+				doublewrite block (64 pages) in the
+				system tablespace; the doublewrite
+				blocks there are only read in crash
+				recovery */
+	ulint		block2;	/*!< page number of the second block */
+	byte*		read_buf;/*!< buffer the doublewrite blocks and
+				the doublewrite files are read to at
+				startup, aligned to UNIV_PAGE_SIZE */
+	byte*		read_buf_unaligned;/*!< pointer to read_buf,
+				but unaligned */
+	ulint		n_files;/*!< number of doublewrite files, one
+				for each buffer pool instance, or 0 if
+				the doublewrite buffer is not written */
+	os_file_t*	files;	/*!< handles of the doublewrite files */
+	char**		file_names;/*!< names of the doublewrite files */
+	buf_dblwr_shard_t* shards;/*!< 2 * n_files shards: for each
+				buffer pool instance, the flush list
+				batch shard followed by the LRU batch
+				shard, which also has the single page
+				flush slots */
+};
+
 
 #endif /* UNIV_HOTBACKUP */
 
@@ -174,12 +174,32 @@ buf_flush_ready_for_replace(
 	buf_page_t*	bpage);	/*!< in: buffer control block, must be
 				buf_page_in_file(bpage) and in the LRU list */
 /******************************************************************//**
-page_cleaner thread tasked with flushing dirty pages from the buffer
-pools. As of now we'll have only one instance of this thread.
+Initializes the state shared by the page_cleaner threads. Must be called
+before the threads are created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void);
+/*=============================*/
+/******************************************************************//**
+page_cleaner coordinator thread tasked with flushing dirty pages from
+the buffer pools. It decides what to flush in each round and flushes
+the buffer pool instances together with the page_cleaner worker
+threads.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
 DECLARE_THREAD(buf_flush_page_cleaner_thread)(
+/*==========================================*/
+	void*	arg);		/*!< in: a dummy parameter required by
+				os_thread_create */
+/******************************************************************//**
+page_cleaner worker thread, flushes the buffer pool instances requested
+by the page_cleaner coordinator thread. There are
+innodb_page_cleaners - 1 of them.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
 /*==========================================*/
 	void*	arg);		/*!< in: a dummy parameter required by
 				os_thread_create */
@@ -195,6 +215,19 @@ ulint
 buf_flush_LRU_tail(void);
 /*====================*/
 /*********************************************************************//**
+Clears up tail of the LRU list of a buffer pool instance:
+* Put replaceable pages at the tail of LRU to the free list
+* Flush dirty pages at the tail of LRU to the disk
+The depth to which we scan the buffer pool is controlled by dynamic
+config parameter innodb_LRU_scan_depth, or by the number of blocks
+that a shrinking resize still has to withdraw.
+@return total pages processed */
+UNIV_INTERN
+ulint
+buf_flush_LRU_list(
+/*===============*/
+	buf_pool_t*	buf_pool);	/*!< in/out: buffer pool instance */
+/*********************************************************************//**
 Wait for any possible LRU flushes that are in progress to end. */
 UNIV_INTERN
 void
@@ -55,6 +55,20 @@ buf_read_page_async(
 	ulint	space,	/*!< in: space id */
 	ulint	offset);/*!< in: page number */
 /********************************************************************//**
+Issues asynchronous read requests for pages of one tablespace that a
+buffer pool load wants in the buffer pool. The requests are posted as
+one batch, so that the aio layer can merge the adjacent pages of the
+sorted batch into larger reads.
+@return number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_load_pages(
+/*================*/
+	ulint		space,		/*!< in: space id */
+	const ulint*	page_nos,	/*!< in: ascending page numbers */
+	ulint		n_stored);	/*!< in: number of page numbers
+					in the array */
+/********************************************************************//**
 Applies a random read-ahead in buf_pool if there are at least a threshold
 value of accessed pages from the random read-ahead area. Does not read any
 page, not even the one at the position (space, offset), if the read-ahead
@@ -721,6 +721,17 @@ fil_extend_space_to_desired_size(
 	ulint	size_after_extend);/*!< in: desired size in pages after the
 				extension; if the current space size is bigger
 				than this already, the function does nothing */
+/**********************************************************************//**
+Truncates a tablespace that consists of a single file, such as an undo
+tablespace, to the given size and fills the file with zeros. The pages of
+the tablespace must have been removed from the buffer pool.
+@return	true if success */
+UNIV_INTERN
+bool
+fil_truncate_tablespace(
+/*====================*/
+	ulint	space_id,	/*!< in: space id */
+	ulint	size_in_pages);	/*!< in: new size in pages */
 /*******************************************************************//**
 Tries to reserve free extents in a file space.
 @return	TRUE if succeed */
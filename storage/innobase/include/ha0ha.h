@@ -119,6 +119,22 @@ chosen to be a slightly bigger prime number.
 # define ha_create(n_c,n_m,type,level) ha_create_func(n_c,n_m,type)
 #endif /* UNIV_SYNC_DEBUG */
 
+/*************************************************************//**
+Creates a hash table of at least n array cells that takes over the
+sync objects and memory heaps of a MEM_HEAP_FOR_PAGE_HASH table or
+of a table created with hash_create_aligned() and hash_create_sync_obj(),
+such as lock_sys->rec_hash. Both
+tables map a fold to the same sync object, so the nodes can be moved
+to the new table while holding all the sync objects, and the old table
+can then be freed with hash_table_free().
+@return	own: created table */
+UNIV_INTERN
+hash_table_t*
+ha_recreate(
+/*========*/
+	hash_table_t*	table,	/*!< in: hash table to replace */
+	ulint		n);	/*!< in: number of array cells */
+
 /*************************************************************//**
 Empties a hash table and frees the memory heaps. */
 UNIV_INTERN
@@ -125,6 +125,17 @@ thd_is_replication_slave_thread(
 /*============================*/
 	THD*	thd);	/*!< in: thread handle */
 
+/******************************************************************//**
+Reports that the transaction of a thread has to wait for a row lock
+held by the transaction of another thread. Used by replication slave
+workers to find waits that conflict with their commit order. */
+UNIV_INTERN
+void
+thd_report_lock_wait(
+/*=================*/
+	THD*	thd,		/*!< in: thread waiting for the lock */
+	THD*	wait_for);	/*!< in: thread holding the lock */
+
 /******************************************************************//**
 Gets information on the durability property requested by thread.
 Used when writing either a prepare or commit record to the log
@@ -365,6 +376,15 @@ ulint
 innobase_get_table_cache_size(void);
 /*===============================*/
 
+/**********************************************************************//**
+Sets the value shown for innodb_buffer_pool_size, after the buffer pool
+has been resized. */
+UNIV_INTERN
+void
+innodb_set_buf_pool_size(
+/*=====================*/
+	ulint	buf_pool_size);	/*!< in: new buffer pool size in bytes */
+
 /**********************************************************************//**
 Get the current setting of the lower_case_table_names global parameter from
 mysqld.cc. We do a dirty read because for one there is no synchronization
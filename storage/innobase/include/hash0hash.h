@@ -62,6 +62,19 @@ hash_table_t*
 hash_create(
 /*========*/
 	ulint	n);	/*!< in: number of array cells */
+/*************************************************************//**
+Creates a hash table with >= n array cells. The number of cells is
+chosen to be a multiple of align, so that hash_get_sync_obj_index()
+maps a fold to the same sync object in every table created with the
+same align, whatever its size.
+@return	own: created table */
+UNIV_INTERN
+hash_table_t*
+hash_create_aligned(
+/*================*/
+	ulint	n,	/*!< in: number of array cells */
+	ulint	align);	/*!< in: power of 2 that the number of
+			cells must be a multiple of */
 #ifndef UNIV_HOTBACKUP
 /*************************************************************//**
 Creates a sync object array array to protect a hash table.
@@ -88,6 +101,15 @@ hash_create_sync_obj_func(
 # define hash_create_sync_obj(t, s, n, level)			\
 			hash_create_sync_obj_func(t, s, n)
 #endif /* UNIV_SYNC_DEBUG */
+
+/*************************************************************//**
+Frees the sync object array of a hash table that was created with
+hash_create_sync_obj(). */
+UNIV_INTERN
+void
+hash_free_sync_obj(
+/*===============*/
+	hash_table_t*	table);	/*!< in/out: hash table */
 #endif /* !UNIV_HOTBACKUP */
 
 /*************************************************************//**
@@ -337,10 +359,12 @@ do {\
 	cell_count2222 = hash_get_n_cells(OLD_TABLE);\
 \
 	for (i2222 = 0; i2222 < cell_count2222; i2222++) {\
-		NODE_TYPE*	node2222 = HASH_GET_FIRST((OLD_TABLE), i2222);\
+		NODE_TYPE*	node2222 = (NODE_TYPE*) HASH_GET_FIRST(\
+			(OLD_TABLE), i2222);\
 \
 		while (node2222) {\
-			NODE_TYPE*	next2222 = node2222->PTR_NAME;\
+			NODE_TYPE*	next2222 = (NODE_TYPE*)\
+				node2222->PTR_NAME;\
 			ulint		fold2222 = FOLD_FUNC(node2222);\
 \
 			HASH_INSERT(NODE_TYPE, PTR_NAME, (NEW_TABLE),\
@@ -58,6 +58,13 @@ lock_sys_create(
 /*============*/
 	ulint	n_cells);	/*!< in: number of slots in lock hash table */
 /*********************************************************************//**
+Resizes the lock hash table after the buffer pool was resized. */
+UNIV_INTERN
+void
+lock_sys_resize(
+/*============*/
+	ulint	n_cells);	/*!< in: number of slots in lock hash table */
+/*********************************************************************//**
 Closes the lock system at database shutdown. */
 UNIV_INTERN
 void
@@ -748,6 +755,26 @@ lock_table_has_locks(
 					held on records in this table or on the
 					table itself */
 
+/********************************************************************//**
+Looks for deadlocks among the transactions whose threads are suspended
+in a lock wait, and resolves them by rolling back the lightest
+transaction of each cycle. Used by lock_wait_timeout_thread() if
+innodb_async_deadlock_detect is set. */
+UNIV_INTERN
+void
+lock_deadlock_check_waits(void);
+/*===========================*/
+
+/********************************************************************//**
+Updates the schedule weights of the transactions whose threads are
+suspended in a lock wait: the number of waiting transactions that wait
+for each of them, directly or through other waiting transactions. Used
+by lock_wait_timeout_thread() if innodb_lock_schedule_algorithm=cats. */
+UNIV_INTERN
+void
+lock_update_schedule_weights(void);
+/*==============================*/
+
 /*********************************************************************//**
 A thread which wakes up threads whose lock wait may have lasted too long.
 @return	a dummy parameter */
@@ -910,9 +937,19 @@ struct lock_op_t{
 /** The lock system struct */
 struct lock_sys_t{
 	ib_mutex_t	mutex;			/*!< Mutex protecting the
-						locks */
+						table locks and the lock
+						waits; together with all the
+						rec_hash mutexes it protects
+						all the locks */
 	hash_table_t*	rec_hash;		/*!< hash table of the record
-						locks */
+						locks; the record locks on a
+						page are protected by the
+						mutex of its hash cell */
+	hash_table_t*	rec_hash_old;		/*!< rec_hash before the last
+						lock_sys_resize(), kept so
+						that a thread that read the
+						old pointer can still find
+						the cell mutex */
 	ib_mutex_t	wait_mutex;		/*!< Mutex protecting the
 						next two fields */
 	srv_slot_t*	waiting_threads;	/*!< Array  of user threads
@@ -943,22 +980,97 @@ struct lock_sys_t{
 /** The lock system */
 extern lock_sys_t*	lock_sys;
 
-/** Test if lock_sys->mutex can be acquired without waiting. */
-#define lock_mutex_enter_nowait() mutex_enter_nowait(&lock_sys->mutex)
+/*********************************************************************//**
+Acquires lock_sys->mutex and all the lock_sys->rec_hash mutexes, like
+lock_mutex_enter(), if lock_sys->mutex can be acquired without waiting.
+@return	0 if succeeded, 1 if lock_sys->mutex was reserved by another thread */
+UNIV_INTERN
+ulint
+lock_mutex_enter_nowait(void);
+/*==========================*/
 
 /** Test if lock_sys->mutex is owned. */
 #define lock_mutex_own() mutex_own(&lock_sys->mutex)
 
-/** Acquire the lock_sys->mutex. */
+#ifdef UNIV_DEBUG
+/*********************************************************************//**
+Checks if the current thread owns lock_sys->mutex or one of the
+lock_sys->rec_hash mutexes, which is enough for granting a lock.
+@return	true if owned */
+UNIV_INTERN
+bool
+lock_mutex_own_any(void);
+/*=====================*/
+#endif /* UNIV_DEBUG */
+
+/*********************************************************************//**
+Acquires the lock_sys->rec_hash mutex protecting the record locks whose
+lock_rec_fold() is fold. lock_sys_resize() may replace lock_sys->rec_hash
+while the mutex is being waited for, and the new table maps the fold to
+another mutex, so the mutex is acquired again until the table is the same
+before and after the wait. */
+UNIV_INTERN
+void
+lock_rec_mutex_enter_fold(
+/*======================*/
+	ulint	fold);	/*!< in: lock_rec_fold() of the page */
+
+/** Acquire the lock_sys->mutex and all the lock_sys->rec_hash mutexes.
+This gives exclusive access to all the locks. */
 #define lock_mutex_enter() do {			\
 	mutex_enter(&lock_sys->mutex);		\
+	hash_mutex_enter_all(lock_sys->rec_hash);	\
 } while (0)
 
-/** Release the lock_sys->mutex. */
+/** Release the lock_sys->mutex and all the lock_sys->rec_hash mutexes. */
 #define lock_mutex_exit() do {			\
+	hash_mutex_exit_all(lock_sys->rec_hash);	\
+	mutex_exit(&lock_sys->mutex);		\
+} while (0)
+
+/** Acquire the lock_sys->mutex only. This is enough for the table locks
+and the lock waits, but not for the record locks. */
+#define lock_sys_mutex_enter() do {		\
+	mutex_enter(&lock_sys->mutex);		\
+} while (0)
+
+/** Release the lock_sys->mutex acquired with lock_sys_mutex_enter(). */
+#define lock_sys_mutex_exit() do {		\
 	mutex_exit(&lock_sys->mutex);		\
 } while (0)
 
+/** Acquire all the lock_sys->rec_hash mutexes while holding
+lock_sys->mutex, completing lock_sys_mutex_enter() to lock_mutex_enter(). */
+#define lock_rec_mutex_enter_all() do {		\
+	ut_ad(lock_mutex_own());		\
+	hash_mutex_enter_all(lock_sys->rec_hash);	\
+} while (0)
+
+/** Test if the lock_sys->rec_hash mutex protecting the record locks on
+a page is owned. */
+#define lock_rec_mutex_own(space, page_no)				\
+	mutex_own(hash_get_mutex(lock_sys->rec_hash,			\
+				 lock_rec_fold(space, page_no)))
+
+/** Test if the lock_sys->rec_hash mutex protecting the record locks on
+a buffer block is owned. */
+#define lock_rec_block_mutex_own(block)					\
+	lock_rec_mutex_own(buf_block_get_space(block),			\
+			   buf_block_get_page_no(block))
+
+/** Acquire the lock_sys->rec_hash mutex protecting the record locks on
+a page. */
+#define lock_rec_mutex_enter(space, page_no) do {			\
+	lock_rec_mutex_enter_fold(lock_rec_fold(space, page_no));	\
+} while (0)
+
+/** Release the lock_sys->rec_hash mutex of a page. lock_sys->rec_hash
+cannot be replaced while the mutex is held. */
+#define lock_rec_mutex_exit(space, page_no) do {			\
+	hash_mutex_exit(lock_sys->rec_hash,				\
+			lock_rec_fold(space, page_no));			\
+} while (0)
+
 /** Test if lock_sys->wait_mutex is owned. */
 #define lock_wait_mutex_own() mutex_own(&lock_sys->wait_mutex)
 
@@ -84,17 +84,6 @@ log_calc_where_lsn_is(
 	ib_int64_t	log_file_size);		/*!< in: log file size
 						(including the header) */
 #ifndef UNIV_HOTBACKUP
-/************************************************************//**
-Writes to the log the string given. The log must be released with
-log_release.
-@return	end lsn of the log record, zero if did not succeed */
-UNIV_INLINE
-lsn_t
-log_reserve_and_write_fast(
-/*=======================*/
-	const void*	str,	/*!< in: string */
-	ulint		len,	/*!< in: string length */
-	lsn_t*		start_lsn);/*!< out: start lsn of the log record */
 /***********************************************************************//**
 Releases the log mutex. */
 UNIV_INLINE
@@ -111,30 +100,67 @@ void
 log_free_check(void);
 /*================*/
 /************************************************************//**
-Opens the log for log_write_low. The log must be closed with log_close and
-released with log_release.
-@return	start lsn of the log record */
+Reserves space in the log buffer for a log record group and formats the
+headers of the log blocks it covers. The log mutex is released before
+returning: the records are copied to the reserved space with
+log_buffer_write() concurrently with other threads, after which the
+caller must call log_buffer_write_completed() and, when the group is not
+empty, log_recent_closed_add().
+@return	start lsn of the log record group */
 UNIV_INTERN
 lsn_t
-log_reserve_and_open(
-/*=================*/
-	ulint	len);	/*!< in: length of data to be catenated */
+log_buffer_reserve(
+/*===============*/
+	ulint	len,		/*!< in: length of the log records */
+	byte**	ptr,		/*!< out: where to copy the log records */
+	lsn_t*	end_lsn);	/*!< out: end lsn of the log record group */
+/************************************************************//**
+Copies log records to space reserved with log_buffer_reserve(),
+skipping the log block headers and trailers.
+@return	position following the copied records */
+UNIV_INTERN
+byte*
+log_buffer_write(
+/*=============*/
+	byte*		ptr,	/*!< in: position in the log buffer */
+	const byte*	str,	/*!< in: log records */
+	ulint		len);	/*!< in: length of the log records */
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Notes that the log records of a group reserved with log_buffer_reserve()
+have been copied to the log buffer. */
+UNIV_INLINE
+void
+log_buffer_write_completed(void);
+/*============================*/
+/************************************************************//**
+Waits until a log record group starting at start_lsn may add its dirty
+pages to the flush lists, that is, until start_lsn is less than
+LOG_RECENT_CLOSED_SIZE ahead of log_sys->closed_lsn. */
 UNIV_INTERN
 void
-log_write_low(
-/*==========*/
-	byte*	str,		/*!< in: string */
-	ulint	str_len);	/*!< in: string length */
+log_recent_closed_wait(
+/*===================*/
+	lsn_t	start_lsn);	/*!< in: start lsn of the log record group */
 /************************************************************//**
-Closes the log.
-@return	lsn */
+Notes that the mini-transaction which wrote the log records between
+start_lsn and end_lsn has added its dirty pages to the flush lists, and
+advances log_sys->closed_lsn if possible. */
 UNIV_INTERN
+void
+log_recent_closed_add(
+/*==================*/
+	lsn_t	start_lsn,	/*!< in: start lsn of the log record group */
+	lsn_t	end_lsn);	/*!< in: end lsn of the log record group */
+/************************************************************//**
+Gets the lsn below which all mini-transactions have added their dirty pages
+to the flush lists. It is used as the oldest modification of the pages that
+are added to the flush lists, so that the flush lists stay ordered without
+serializing the mini-transaction commits.
+@return	closed lsn */
+UNIV_INLINE
 lsn_t
-log_close(void);
-/*===========*/
+log_get_closed_lsn(void);
+/*====================*/
 /************************************************************//**
 Gets the current lsn.
 @return	current lsn */
@@ -202,6 +228,40 @@ log_write_up_to(
 	ibool	flush_to_disk);
 			/*!< in: TRUE if we want the written log
 			also to be flushed to disk */
+/******************************************************************//**
+Starts the log writer and log flusher threads. After this, the threads
+calling log_write_up_to() leave the redo log write and flush to them. */
+UNIV_INTERN
+void
+log_start_writer_threads(void);
+/*==========================*/
+/******************************************************************//**
+Stops the log writer and log flusher threads and waits for them to exit.
+log_write_up_to() writes and flushes the log itself afterwards. It is safe
+to call this when the threads have not been started. */
+UNIV_INTERN
+void
+log_stop_writer_threads(void);
+/*=========================*/
+/******************************************************************//**
+The log writer thread writes the log buffer to the log files whenever
+there is something to write.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_writer_thread)(
+/*==============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+/******************************************************************//**
+The log flusher thread flushes the written log to disk.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_flusher_thread)(
+/*===============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
 /****************************************************************//**
 Does a syncronous flush of the log buffer to disk. */
 UNIV_INTERN
@@ -571,6 +631,17 @@ extern log_t*	log_sys;
 #define LOG_BUFFER_SIZE		(srv_log_buffer_size * UNIV_PAGE_SIZE)
 #define LOG_ARCHIVE_BUF_SIZE	(srv_log_buffer_size * UNIV_PAGE_SIZE / 4)
 
+/* Number of slots in log_sys->recent_closed; this is also the maximum
+distance in lsn between the start of a log record group whose dirty pages
+are being added to the flush lists and log_sys->closed_lsn. It must be a
+power of 2. */
+#define LOG_RECENT_CLOSED_SIZE	(1 << 16)
+
+/* Number of events in log_sys->write_events and log_sys->flush_events;
+a thread waiting for the log to be written or flushed up to an lsn waits
+on the event of the log block containing that lsn. */
+#define LOG_N_WAIT_EVENTS	256
+
 /* Offsets of a log block header */
 #define	LOG_BLOCK_HDR_NO	0	/* block number which must be > 0 and
 					is allowed to wrap around at 2G; the
@@ -765,14 +836,27 @@ struct log_t{
 	ib_mutex_t		mutex;		/*!< mutex protecting the log */
 	ib_mutex_t		w_mutex;	/*!< mutex to protect log file */
 
-	ib_mutex_t		log_flush_order_mutex;/*!< mutex to serialize access to
-					the flush list when we are putting
-					dirty blocks in the list. The idea
-					behind this mutex is to be able
-					to release log_sys->mutex during
-					mtr_commit and still ensure that
-					insertions in the flush_list happen
-					in the LSN order. */
+	ib_mutex_t		log_flush_order_mutex;/*!< mutex protecting the
+					advance of closed_lsn over
+					recent_closed; it also serializes
+					the flush list insertions done by
+					recovery */
+	ulint		n_pending_copies;/*!< number of log record groups
+					that have been reserved in the log
+					buffer but not yet copied to it;
+					the log buffer may not be written
+					or moved before this drops to 0 */
+	lsn_t*		recent_closed;	/*!< LOG_RECENT_CLOSED_SIZE slots
+					indexed by the start lsn of a log
+					record group: a non-zero slot holds
+					the end lsn of a group whose
+					mini-transaction has added its dirty
+					pages to the flush lists */
+	volatile lsn_t	closed_lsn;	/*!< all mini-transactions whose log
+					records start below this lsn have
+					added their dirty pages to the flush
+					lists; protected by
+					log_flush_order_mutex */
 #endif /* !UNIV_HOTBACKUP */
 	byte*		buf;		/*!< log buffer */
 	byte*		buf_pair_ptr[2];/*!< unaligned log buffer */
@@ -820,6 +904,27 @@ struct log_t{
 					/*!< how far we have written the log
 					AND flushed to disk */
 	ulint		n_pending_flushes; /*!< number of currently pending flushes.*/
+	os_event_t	writer_event;	/*!< set to wake up the log writer
+					thread */
+	os_event_t	flusher_event;	/*!< set to wake up the log flusher
+					thread */
+	os_event_t*	write_events;	/*!< LOG_N_WAIT_EVENTS events, set by
+					the log writer thread when write_lsn
+					moves past a log block */
+	os_event_t*	flush_events;	/*!< LOG_N_WAIT_EVENTS events, set
+					when flushed_to_disk_lsn moves past a
+					log block */
+	volatile bool	flush_requested;/*!< TRUE if a thread waits for the
+					written log to be flushed; when
+					innodb_flush_log_at_trx_commit != 1
+					the log flusher thread only flushes
+					when this is set */
+	volatile bool	writer_threads_active;
+					/*!< TRUE if the log writer and log
+					flusher threads do the log writes
+					and flushes */
+	ulint		n_writer_threads;/*!< number of running log writer
+					and log flusher threads */
 	os_event_t	flush_event;	/*!< this event is in the reset state
 					when a flush is running; a thread
 					should wait for this without
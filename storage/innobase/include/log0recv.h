@@ -444,6 +444,21 @@ struct recv_sys_t{
 	hash_table_t*	addr_hash;/*!< hash table of file addresses of pages */
 	ulint		n_addrs;/*!< number of not processed hashed file
 				addresses in the hash table */
+	ulint		apply_next_cell;
+				/*!< next cell of addr_hash to be taken by
+				a thread applying the log records */
+	ulint		n_apply_threads;
+				/*!< number of running recovery apply
+				worker threads */
+	ulint		apply_n_pages;
+				/*!< n_addrs when the current log record
+				application batch started */
+	ib_time_t	apply_start_time;
+				/*!< time when the current log record
+				application batch started */
+	ib_time_t	apply_report_time;
+				/*!< time of the last progress report of
+				the current log record application batch */
 
 	recv_dblwr_t	dblwr;
 };
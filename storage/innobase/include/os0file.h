@@ -860,6 +860,17 @@ os_file_close_no_error_handling(
 	os_file_t	file);	/*!< in, own: handle to a file */
 #endif /* UNIV_HOTBACKUP */
 /***********************************************************************//**
+Gets the largest write that the storage of a file reports to write
+atomically, that is, never torn by a crash or a power loss. Such writes
+must be aligned and bypass the file system cache (O_DIRECT).
+@return	atomic write unit in bytes, or 0 if the storage does not report
+one */
+UNIV_INTERN
+ulint
+os_file_get_atomic_write_size(
+/*==========================*/
+	const char*	name);	/*!< in: file path */
+/***********************************************************************//**
 Gets a file size.
 @return	file size, or (os_offset_t) -1 on failure */
 UNIV_INTERN
@@ -889,6 +900,16 @@ os_file_set_eof(
 /*============*/
 	FILE*		file);	/*!< in: file to be truncated */
 /***********************************************************************//**
+Truncates or extends a file to the given size.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+os_file_truncate(
+/*=============*/
+	const char*	name,	/*!< in: name of the file */
+	os_file_t	file,	/*!< in: handle to the file */
+	os_offset_t	size);	/*!< in: new file size in bytes */
+/***********************************************************************//**
 NOTE! Use the corresponding macro os_file_flush(), not directly this function!
 Flushes the write buffers of a given file to the disk.
 @return	TRUE if success */
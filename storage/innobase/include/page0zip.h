@@ -46,6 +46,23 @@ extern uint	page_zip_level;
 /* Default compression level. */
 #define DEFAULT_COMPRESSION_LEVEL	6
 
+/** Codecs of the compressed payload of index pages */
+enum page_zip_codec_t {
+	PAGE_ZIP_CODEC_ZLIB = 0,	/*!< zlib deflate */
+	PAGE_ZIP_CODEC_LZ		/*!< fast LZ77 without entropy
+					coding, see ut0lz.h */
+};
+
+/* Codec to be used for pages compressed from now on. Settable by user.
+Every page records its codec, so that pages compressed with any codec
+can be read back. */
+extern ulong	page_zip_codec;
+
+/** Number of low-order bits of the compression level argument of
+page_zip_compress() that hold the zlib compression level. The bits
+above them hold the page_zip_codec_t. */
+#define PAGE_ZIP_LEVEL_BITS	4
+
 /* Whether or not to log compressed page images to avoid possible
 compression algorithm changes in zlib. */
 extern my_bool	page_zip_log_pages;
@@ -69,6 +86,15 @@ page_zip_set_size(
 	ulint		size);		/*!< in: size in bytes */
 
 #ifndef UNIV_HOTBACKUP
+/**********************************************************************//**
+Determine the compression level and codec for compressing a page,
+from page_zip_level and page_zip_codec.
+@return	compression level for page_zip_compress() */
+UNIV_INLINE
+ulint
+page_zip_level_get(void);
+/*====================*/
+
 /**********************************************************************//**
 Determine if a record is so big that it needs to be stored externally.
 @return	FALSE if the entire record can be stored locally on the page */
@@ -125,7 +151,8 @@ page_zip_compress(
 				m_start, m_end, m_nonempty */
 	const page_t*	page,	/*!< in: uncompressed page */
 	dict_index_t*	index,	/*!< in: index of the B-tree node */
-	ulint		level,	/*!< in: compression level */
+	ulint		level,	/*!< in: compression level and codec,
+				see page_zip_level_get() */
 	mtr_t*		mtr)	/*!< in: mini-transaction, or NULL */
 	MY_ATTRIBUTE((nonnull(1,2,3)));
 
@@ -69,7 +69,7 @@ read_view_remove(
 /*=============*/
 	read_view_t*	view,		/*!< in: read view, can be 0 */
 	bool		own_mutex);	/*!< in: true if caller owns the
-					trx_sys_t::mutex */
+					trx_sys_t::view_mutex */
 /*********************************************************************//**
 Frees memory allocated by a read view. */
 UNIV_INTERN
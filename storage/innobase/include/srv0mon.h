@@ -180,6 +180,12 @@ enum monitor_id_t {
 	MONITOR_FLUSH_LSN_AVG_RATE,
 	MONITOR_FLUSH_PCT_FOR_DIRTY,
 	MONITOR_FLUSH_PCT_FOR_LSN,
+	MONITOR_FLUSH_AVG_TIME,
+	MONITOR_FLUSH_AVG_PASS,
+	MONITOR_FLUSH_ADAPTIVE_AVG_TIME_SLOT,
+	MONITOR_LRU_BATCH_FLUSH_AVG_TIME_SLOT,
+	MONITOR_FLUSH_ADAPTIVE_AVG_TIME_THREAD,
+	MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD,
 	MONITOR_FLUSH_SYNC_WAITS,
 	MONITOR_FLUSH_ADAPTIVE_TOTAL_PAGE,
 	MONITOR_FLUSH_ADAPTIVE_COUNT,
@@ -282,6 +288,7 @@ enum monitor_id_t {
 	MONITOR_DML_PURGE_DELAY,
 	MONITOR_PURGE_STOP_COUNT,
 	MONITOR_PURGE_RESUME_COUNT,
+	MONITOR_UNDO_TRUNCATE_COUNT,
 
 	/* Recovery related counters */
 	MONITOR_MODULE_RECOVERY,
@@ -299,6 +306,7 @@ enum monitor_id_t {
 	MONITOR_OVLD_LOG_WAITS,
 	MONITOR_OVLD_LOG_WRITE_REQUEST,
 	MONITOR_OVLD_LOG_WRITES,
+	MONITOR_LOG_CLOSED_WAITS,
 
 	/* Page Manager related counters */
 	MONITOR_MODULE_PAGE,
@@ -144,6 +144,9 @@ extern os_event_t	srv_error_event;
 /** The buffer pool dump/load thread waits on this event. */
 extern os_event_t	srv_buf_dump_event;
 
+/** The buffer pool resize thread waits on this event. */
+extern os_event_t	srv_buf_resize_event;
+
 /** The buffer pool dump/load file name */
 #define SRV_BUF_DUMP_FILENAME_DEFAULT	"ib_buffer_pool"
 extern char*		srv_buf_dump_filename;
@@ -153,6 +156,16 @@ and/or load it during startup. */
 extern char		srv_buffer_pool_dump_at_shutdown;
 extern char		srv_buffer_pool_load_at_startup;
 
+/** Number of threads that read the pages of a buffer pool load */
+extern ulong		srv_buf_load_threads;
+
+/** Percentage of the most recently used pages of every buffer pool
+instance that a buffer pool dump writes */
+extern ulong		srv_buf_pool_dump_pct;
+
+/** Seconds between the periodic buffer pool dumps, or 0 */
+extern ulong		srv_buf_dump_interval;
+
 /* Whether to disable file system cache if it is defined */
 extern char		srv_disable_sort_file_cache;
 
@@ -215,6 +228,12 @@ extern ibool	srv_locks_unsafe_for_binlog;
 
 /** Sort buffer size in index creation */
 extern ulong	srv_sort_buf_size;
+/** Number of threads that sort and load the secondary indexes
+created by one ALTER TABLE */
+extern ulong	srv_index_build_threads;
+/** Percentage of each index page filled by the bulk load of a sorted
+index build */
+extern ulong	srv_fill_factor;
 /** Maximum modification log file size for online index creation */
 extern unsigned long long	srv_online_max_size;
 
@@ -241,6 +260,16 @@ extern ulint	srv_undo_tablespaces_open;
 /* The number of undo segments to use */
 extern ulong	srv_undo_logs;
 
+/** Whether purge truncates undo tablespaces that grew too big */
+extern my_bool	srv_undo_log_truncate;
+
+/** Size in bytes above which an undo tablespace is truncated */
+extern unsigned long long	srv_max_undo_log_size;
+
+/** Run history truncation, and the undo tablespace truncation check,
+every this many purge batches */
+extern ulong	srv_purge_rseg_truncate_frequency;
+
 extern ulint	srv_n_data_files;
 extern char**	srv_data_file_names;
 extern ulint*	srv_data_file_sizes;
@@ -262,6 +291,12 @@ extern ib_uint64_t	srv_log_file_size_requested;
 extern ulint	srv_log_buffer_size;
 extern ulong	srv_flush_log_at_trx_commit;
 extern uint	srv_flush_log_at_timeout;
+/** Whether the redo log is written and flushed by the log writer and
+log flusher threads instead of the threads that wait for it */
+extern my_bool	srv_log_writer_threads;
+/** Number of spin rounds a thread waiting for a redo log write or flush
+does before waiting on an event */
+extern ulong	srv_log_wait_spin_rounds;
 extern char	srv_adaptive_flushing;
 extern char     srv_autoinc_persistent;
 extern ulong    srv_n_autoinc_interval;
@@ -281,6 +316,9 @@ extern ibool	srv_use_sys_malloc;
 #endif /* UNIV_HOTBACKUP */
 extern ulint	srv_buf_pool_size;	/*!< requested size in bytes */
 extern ulint    srv_buf_pool_instances; /*!< requested number of buffer pool instances */
+extern ulong	srv_buf_pool_chunk_unit;/*!< size of a buffer pool chunk,
+					the unit in which the buffer pool
+					is resized */
 extern ulong	srv_n_page_hash_locks;	/*!< number of locks to
 					protect buf_pool->page_hash */
 extern ulong	srv_LRU_scan_depth;	/*!< Scan depth for LRU
@@ -291,6 +329,9 @@ extern ulint	srv_buf_pool_old_size;	/*!< previously requested size */
 extern ulint	srv_buf_pool_curr_size;	/*!< current size in bytes */
 extern ulint	srv_mem_pool_size;
 extern ulint	srv_lock_table_size;
+extern uint	srv_change_buffer_max_size;/*!< maximum size of the change
+					buffer as a percentage of the
+					buffer pool */
 
 extern ulint	srv_n_file_io_threads;
 extern my_bool	srv_random_read_ahead;
@@ -334,6 +375,14 @@ extern ulong	srv_max_dirty_pages_pct_lwm;
 extern ulong	srv_adaptive_flushing_lwm;
 extern ulong	srv_flushing_avg_loops;
 
+/* The number of page_cleaner threads, at most one per buffer pool
+instance */
+extern ulong	srv_n_page_cleaners;
+
+/* The number of threads applying the hashed log records during crash
+recovery, including the thread running the recovery */
+extern ulong	srv_n_recovery_apply_threads;
+
 extern ulong	srv_force_recovery;
 #ifndef DBUG_OFF
 extern ulong	srv_force_recovery_crash;
@@ -354,7 +403,14 @@ extern unsigned long long	srv_stats_persistent_sample_pages;
 extern my_bool			srv_stats_auto_recalc;
 
 extern ibool	srv_use_doublewrite_buf;
+/** innodb_atomic_writes, see srv_atomic_writes_t */
+extern ulong	srv_atomic_writes;
+/** TRUE if page writes are atomic and skip the doublewrite buffer; a torn
+page found in crash recovery is then a fatal error */
+extern ibool	srv_use_atomic_writes;
 extern ulong	srv_doublewrite_batch_size;
+/** Directory of the doublewrite files; NULL means srv_data_home */
+extern char*	srv_doublewrite_dir;
 extern ulong	srv_checksum_algorithm;
 
 extern ulong	srv_max_buf_pool_modified_pct;
@@ -383,6 +439,9 @@ extern ibool	srv_error_monitor_active;
 /* TRUE during the lifetime of the buffer pool dump/load thread */
 extern ibool	srv_buf_dump_thread_active;
 
+/* TRUE if the buffer pool resize thread is active */
+extern ibool	srv_buf_resize_thread_active;
+
 /* TRUE during the lifetime of the stats thread */
 extern ibool	srv_dict_stats_thread_active;
 
@@ -458,6 +517,13 @@ extern ulong srv_sync_array_size;
 /* print all user-level transactions deadlocks to mysqld stderr */
 extern my_bool srv_print_all_deadlocks;
 
+/* look for deadlocks in the lock wait timeout thread instead of
+checking each lock wait when it is enqueued */
+extern my_bool srv_async_deadlock_detect;
+
+/** innodb_lock_schedule_algorithm, see srv_lock_schedule_t */
+extern ulong	srv_lock_schedule_algorithm;
+
 extern my_bool	srv_cmp_per_index_enabled;
 
 /** Status variables to be passed to MySQL */
@@ -477,6 +543,9 @@ extern mysql_pfs_key_t	srv_monitor_thread_key;
 extern mysql_pfs_key_t	srv_master_thread_key;
 extern mysql_pfs_key_t	srv_purge_thread_key;
 extern mysql_pfs_key_t	recv_writer_thread_key;
+extern mysql_pfs_key_t	recv_apply_thread_key;
+extern mysql_pfs_key_t	log_writer_thread_key;
+extern mysql_pfs_key_t	log_flusher_thread_key;
 
 /* This macro register the current thread and its key with performance
 schema */
@@ -503,6 +572,28 @@ enum {
 	SRV_OLD_RAW		/*!< An initialized raw partition */
 };
 
+/** Alternatives for innodb_atomic_writes */
+enum srv_atomic_writes_t {
+	SRV_ATOMIC_WRITES_OFF,	/*!< write pages through the
+				doublewrite buffer, the default */
+	SRV_ATOMIC_WRITES_ON,	/*!< the storage writes pages
+				atomically: skip the doublewrite
+				buffer */
+	SRV_ATOMIC_WRITES_AUTO	/*!< skip the doublewrite buffer if
+				the storage of the system tablespace
+				reports atomic page writes */
+};
+
+/** Alternatives for innodb_lock_schedule_algorithm */
+enum srv_lock_schedule_t {
+	SRV_LOCK_SCHEDULE_FCFS,	/*!< grant the waiting record locks
+				in the order they were requested,
+				the default */
+	SRV_LOCK_SCHEDULE_CATS	/*!< grant the waiting record locks
+				first to the transactions that the
+				most other transactions wait for */
+};
+
 /** Alternatives for the file flush option in Unix; see the InnoDB manual
 about what these mean */
 enum {
@@ -814,6 +905,8 @@ struct export_var_t{
 	ulint innodb_data_reads;		/*!< I/O read requests */
 	char  innodb_buffer_pool_dump_status[512];/*!< Buf pool dump status */
 	char  innodb_buffer_pool_load_status[512];/*!< Buf pool load status */
+	char  innodb_buffer_pool_resize_status[512];/*!< Buf pool resize
+						status */
 	ulint innodb_buffer_pool_pages_total;	/*!< Buffer pool size */
 	ulint innodb_buffer_pool_pages_data;	/*!< Data pages */
 	ulint innodb_buffer_pool_bytes_data;	/*!< File bytes used */
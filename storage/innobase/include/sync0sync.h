@@ -107,11 +107,13 @@ extern mysql_pfs_key_t	srv_monitor_file_mutex_key;
 extern mysql_pfs_key_t	sync_thread_mutex_key;
 # endif /* UNIV_SYNC_DEBUG */
 extern mysql_pfs_key_t	buf_dblwr_mutex_key;
+extern mysql_pfs_key_t	page_cleaner_mutex_key;
 extern mysql_pfs_key_t	trx_undo_mutex_key;
 extern mysql_pfs_key_t	trx_mutex_key;
 extern mysql_pfs_key_t	lock_sys_mutex_key;
 extern mysql_pfs_key_t	lock_sys_wait_mutex_key;
 extern mysql_pfs_key_t	trx_sys_mutex_key;
+extern mysql_pfs_key_t	trx_sys_view_mutex_key;
 extern mysql_pfs_key_t	srv_sys_mutex_key;
 extern mysql_pfs_key_t	srv_sys_tasks_mutex_key;
 #ifndef HAVE_ATOMIC_BUILTINS
@@ -656,6 +658,7 @@ or row lock! */
 					trx_i_s_cache_t::last_read_mutex */
 #define SYNC_FILE_FORMAT_TAG	1200	/* Used to serialize access to the
 					file format tag */
+#define SYNC_PAGE_CLEANER	1100	/* Used for page_cleaner_t::mutex */
 #define	SYNC_DICT_OPERATION	1010	/* table create, drop, etc. reserve
 					this in X-mode; implicit or backround
 					operations purge, rollback, foreign
@@ -694,8 +697,10 @@ or row lock! */
 /*------------------------------------- MySQL query cache mutex */
 /*------------------------------------- MySQL binlog mutex */
 /*-------------------------------*/
-#define SYNC_LOCK_WAIT_SYS	300
-#define SYNC_LOCK_SYS		299
+#define SYNC_TRX_SYS_VIEW	303
+#define SYNC_LOCK_WAIT_SYS	302
+#define SYNC_LOCK_SYS		301
+#define SYNC_LOCK_REC_HASH	300	/* lock_sys->rec_hash mutexes */
 #define SYNC_TRX_SYS		298
 #define SYNC_TRX		297
 #define SYNC_THREADS		295
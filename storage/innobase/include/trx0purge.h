@@ -91,6 +91,40 @@ trx_purge(
 					records to purge in one batch */
 	bool	truncate);		/*!< in: truncate history if true */
 /*******************************************************************//**
+Checks at startup whether the truncation of an undo tablespace was
+interrupted, and if so truncates its file again. The redo log records
+of the tablespace are then skipped in crash recovery.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+trx_purge_undo_trunc_startup(
+/*=========================*/
+	ulint	space_id);	/*!< in: undo tablespace id */
+/*******************************************************************//**
+Checks whether the truncation of an undo tablespace is being completed
+at startup, so that its redo log records must not be applied.
+@return	true if the tablespace is being truncated */
+UNIV_INTERN
+bool
+trx_purge_undo_trunc_is_recovering(
+/*===============================*/
+	ulint	space_id);	/*!< in: tablespace id */
+/*******************************************************************//**
+Creates the rollback segment headers again in the undo tablespaces that
+trx_purge_undo_trunc_startup() truncated. Must be called in crash recovery
+before the rollback segments are read by trx_sys_init_at_db_start(). */
+UNIV_INTERN
+void
+trx_purge_undo_trunc_recover(void);
+/*===============================*/
+/*******************************************************************//**
+Completes the truncations of undo tablespaces after crash recovery:
+makes a checkpoint and removes the truncate logs. */
+UNIV_INTERN
+void
+trx_purge_undo_trunc_recover_done(void);
+/*===================================*/
+/*******************************************************************//**
 Stop purge and wait for it to stop, move to PURGE_STATE_STOP. */
 UNIV_INTERN
 void
@@ -208,6 +242,15 @@ struct trx_purge_t{
 					rseg_queue_t::trx_no. It is protected
 					by the bh_mutex */
 	ib_mutex_t		bh_mutex;	/*!< Mutex protecting ib_bh */
+	/*-----------------------------*/
+	ulint		undo_trunc_space;/*!< Id of the undo tablespace that
+					is marked for truncation, or
+					ULINT_UNDEFINED; its rollback segments
+					are not assigned to transactions.
+					Only the purge coordinator changes
+					this field. */
+	ulint		undo_trunc_last;/*!< Id of the undo tablespace that
+					was truncated last, or 0 */
 };
 
 /** Info required to purge a record */
@@ -124,6 +124,18 @@ trx_rseg_mem_free(
 /*==============*/
 	trx_rseg_t*	rseg);		/*!< in, own: instance to free */
 
+/***************************************************************************
+Resets the memory object of a rollback segment whose header was created
+again, empty, after its undo tablespace was truncated. */
+UNIV_INTERN
+void
+trx_rseg_mem_reinit(
+/*================*/
+	trx_rseg_t*	rseg,		/*!< in/out: rollback segment */
+	ulint		page_no,	/*!< in: page number of the new
+					segment header */
+	ulint		max_size);	/*!< in: maximum size in pages */
+
 /*********************************************************************
 Creates a rollback segment. */
 UNIV_INTERN
@@ -189,6 +201,14 @@ struct trx_rseg_t{
 					yet purged log */
 	ibool		last_del_marks;	/*!< TRUE if the last not yet purged log
 					needs purging */
+	/*--------------------------------------------------------*/
+	ulint		trx_ref_count;	/*!< Number of transactions that have
+					this rollback segment assigned;
+					updated with atomic operations */
+	bool		skip_allocation;/*!< true if the undo tablespace of
+					this rollback segment is about to be
+					truncated: new transactions are not
+					assigned to it */
 };
 
 /** For prioritising the rollback segments for purge. */
@@ -193,6 +193,21 @@ trx_find_descriptor(
 	const trx_id_t*	descriptors,	/*!< in: descriptors array */
 	ulint		n_descr,	/*!< in: array size */
 	trx_id_t	trx_id);	/*!< in: trx id */
+/*****************************************************************//**
+Marks the start of a modification of the state copied by lock-free read
+view creation: descriptors, descr_n_used, max_trx_id and serial_min_no.
+The caller must hold trx_sys->mutex. */
+UNIV_INLINE
+void
+trx_sys_descr_write_begin(void);
+/*===========================*/
+/*****************************************************************//**
+Marks the end of a modification started with
+trx_sys_descr_write_begin(). */
+UNIV_INLINE
+void
+trx_sys_descr_write_end(void);
+/*=========================*/
 
 #ifdef UNIV_DEBUG
 /* Flag to control TRX_RSEG_N_SLOTS behavior debugging. */
@@ -608,6 +623,9 @@ identifier is added to this 64-bit constant. */
 /* @} */
 
 #define TRX_DESCR_ARRAY_INITIAL_SIZE	1000
+/** Maximum number of times the descriptors array can be grown; the size
+doubles each time, so this is never reached in practice */
+#define TRX_DESCR_ARRAY_MAX_RETIRED	32
 
 #ifndef UNIV_HOTBACKUP
 /** The transaction system central memory data structure. */
@@ -641,6 +659,36 @@ struct trx_sys_t{
 					descriptors array. */
 	char		pad3[64];	/*!< Ensure descriptors do not share
 					cache line with other fields */
+	volatile ulint	descr_version;	/*!< Version of the snapshot state
+					(descriptors, descr_n_used,
+					max_trx_id and serial_min_no). It is
+					odd while a writer holding mutex is
+					modifying the state and even otherwise,
+					which lets read_view_open_now() copy
+					the state without acquiring mutex */
+	trx_id_t	serial_min_no;	/*!< trx_t::no of the first element of
+					trx_serial_list, or TRX_ID_MAX if the
+					list is empty; published together with
+					descr_version */
+	trx_id_t*	descr_retired[TRX_DESCR_ARRAY_MAX_RETIRED];
+					/*!< Descriptor arrays replaced by a
+					larger one. Lock-free readers may still
+					be copying from them, so they are only
+					freed in trx_sys_close() */
+	ulint		descr_n_retired;/*!< Number of used elements in
+					descr_retired */
+	char		pad5[64];	/*!< Ensure view_mutex does not share
+					cache line with descr_version */
+	ib_mutex_t	view_mutex;	/*!< mutex protecting view_list; it is
+					acquired before mutex when both are
+					needed */
+	volatile ulint	n_purge_views;	/*!< Number of views opened by
+					read_view_purge_open(). It is
+					incremented under view_mutex after
+					the purge view has been taken, and
+					read_view_open_now() compares it
+					across its copy of the state, which
+					is made without view_mutex */
 #ifdef UNIV_DEBUG
 	trx_id_t	rw_max_trx_id;	/*!< Max trx id of read-write transactions
 					which exist or existed */
@@ -682,7 +730,8 @@ struct trx_sys_t{
 					rseg->mutex */
 	UT_LIST_BASE_NODE_T(read_view_t) view_list;
 					/*!< List of read views sorted
-					on trx no, biggest first */
+					on trx no, biggest first; protected
+					by view_mutex */
 };
 
 /** When a trx id which is zero modulo this number (which must be a power of
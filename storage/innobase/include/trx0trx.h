@@ -644,6 +644,16 @@ struct trx_lock_t {
 	time_t		wait_started;	/*!< lock wait started at this time,
 					protected only by lock_sys->mutex */
 
+	ulint		schedule_weight;/*!< number of transactions that wait
+					for this one while it is in a lock
+					wait, directly or through other waiting
+					transactions; written under
+					lock_sys->mutex by
+					lock_update_schedule_weights(),
+					read without a mutex as a hint when
+					granting record locks with
+					innodb_lock_schedule_algorithm=cats */
+
 	que_thr_t*	wait_thr;	/*!< query thread belonging to this
 					trx that is in QUE_THR_LOCK_WAIT
 					state. For threads suspended in a
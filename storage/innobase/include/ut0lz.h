@@ -0,0 +1,73 @@
+/*****************************************************************************
+
+Copyright (c) 2026, Aliyun and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/********************************************************************//**
+@file include/ut0lz.h
+Fast LZ77 compression without entropy coding
+
+Created 10/17/2026
+*************************************************************************/
+
+#ifndef ut0lz_h
+#define ut0lz_h
+
+#include "univ.i"
+
+/** Maximum length of the input of ut_lz_compress(), in bytes */
+#define UT_LZ_MAX_INPUT		65536
+
+/** Number of bits in the hash of the match finder */
+#define UT_LZ_HASH_BITS		12
+
+/** Size of the work area of ut_lz_compress(), in bytes */
+#define UT_LZ_WORK_SIZE		(sizeof(uint16) << UT_LZ_HASH_BITS)
+
+/********************************************************************//**
+Compresses a buffer. The output is a sequence of literal runs and
+back-references of at least 4 bytes into the preceding 64 KiB, with
+no entropy coding: ut_lz_decompress() only copies bytes around.
+@return length of the compressed data, or 0 if it would not fit
+in dst_len bytes */
+UNIV_INTERN
+ulint
+ut_lz_compress(
+/*===========*/
+	const byte*	src,	/*!< in: data to compress */
+	ulint		src_len,/*!< in: length of src, at most
+				UT_LZ_MAX_INPUT */
+	byte*		dst,	/*!< out: compressed data */
+	ulint		dst_len,/*!< in: size of dst */
+	void*		work)	/*!< in/out: work area of
+				UT_LZ_WORK_SIZE bytes */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+/********************************************************************//**
+Decompresses the output of ut_lz_compress().
+@return length of the decompressed data, or ULINT_UNDEFINED if src
+is corrupted or the data would not fit in dst_len bytes */
+UNIV_INTERN
+ulint
+ut_lz_decompress(
+/*=============*/
+	const byte*	src,	/*!< in: compressed data */
+	ulint		src_len,/*!< in: length of src */
+	byte*		dst,	/*!< out: decompressed data */
+	ulint		dst_len)/*!< in: size of dst */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+
+#endif /* ut0lz_h */
@@ -48,7 +48,11 @@ Created 5/7/1996 Heikki Tuuri
 #include "ut0vec.h"
 #include "btr0btr.h"
 #include "dict0boot.h"
+#include "ha0ha.h" /* ha_recreate() */
+#include <algorithm>
+#include <map>
 #include <set>
+#include <vector>
 
 /* Restricts the length of search we will do in the waits-for
 graph of transactions */
@@ -69,6 +73,24 @@ bitmap */
 
 #define LOCK_PAGE_BITMAP_MARGIN		64
 
+/* Number of mutexes protecting the record locks in lock_sys->rec_hash.
+The holders of different mutexes update the record lock counts of the
+same transaction or table, which is only possible with atomic builtins;
+otherwise all the record locks are protected by a single mutex. */
+#ifdef HAVE_ATOMIC_BUILTINS
+# define LOCK_REC_N_MUTEXES		64
+# define lock_trx_n_rec_locks_inc(n)	os_atomic_increment_lint(&(n), 1)
+# define lock_trx_n_rec_locks_dec(n)	os_atomic_decrement_lint(&(n), 1)
+# define lock_table_n_rec_locks_inc(n)	os_atomic_increment_ulint(&(n), 1)
+# define lock_table_n_rec_locks_dec(n)	os_atomic_decrement_ulint(&(n), 1)
+#else /* HAVE_ATOMIC_BUILTINS */
+# define LOCK_REC_N_MUTEXES		1
+# define lock_trx_n_rec_locks_inc(n)	(++(n))
+# define lock_trx_n_rec_locks_dec(n)	(--(n))
+# define lock_table_n_rec_locks_inc(n)	(++(n))
+# define lock_table_n_rec_locks_dec(n)	(--(n))
+#endif /* HAVE_ATOMIC_BUILTINS */
+
 /* An explicit record lock affects both the record and the gap before it.
 An implicit x-lock does not affect the gap, it only locks the index
 record from read or update.
@@ -615,7 +637,12 @@ lock_sys_create(
 
 	lock_sys->timeout_event = os_event_create();
 
-	lock_sys->rec_hash = hash_create(n_cells);
+	/* The number of cells is a multiple of the number of mutexes, so
+	that lock_sys_resize() keeps every page under the same mutex */
+	lock_sys->rec_hash = hash_create_aligned(n_cells, LOCK_REC_N_MUTEXES);
+
+	hash_create_sync_obj(lock_sys->rec_hash, HASH_TABLE_SYNC_MUTEX,
+			     LOCK_REC_N_MUTEXES, SYNC_LOCK_REC_HASH);
 
 	if (!srv_read_only_mode) {
 		lock_latest_err_file = os_file_create_tmpfile(NULL);
@@ -623,6 +650,151 @@ lock_sys_create(
 	}
 }
 
+/*********************************************************************//**
+Computes the fold of a record lock in lock_sys->rec_hash.
+@return	fold */
+static
+ulint
+lock_rec_lock_fold(
+/*===============*/
+	const lock_t*	lock)	/*!< in: record lock */
+{
+	return(lock_rec_fold(lock->un_member.rec_lock.space,
+			     lock->un_member.rec_lock.page_no));
+}
+
+/*********************************************************************//**
+Acquires the lock_sys->rec_hash mutex protecting the record locks whose
+lock_rec_fold() is fold. lock_sys_resize() may replace lock_sys->rec_hash
+while the mutex is being waited for, and the new table maps the fold to
+another mutex, so the mutex is acquired again until the table is the same
+before and after the wait. */
+UNIV_INTERN
+void
+lock_rec_mutex_enter_fold(
+/*======================*/
+	ulint	fold)	/*!< in: lock_rec_fold() of the page */
+{
+	for (;;) {
+		hash_table_t*	table = lock_sys->rec_hash;
+		ib_mutex_t*	mutex = hash_get_mutex(table, fold);
+
+		mutex_enter(mutex);
+
+		/* lock_sys_resize() holds all the mutexes while it
+		replaces the table, so it cannot change any more. The
+		old table is kept until the next resize, so reading its
+		mutex above was safe. */
+		if (UNIV_LIKELY(table == lock_sys->rec_hash)) {
+			return;
+		}
+
+		mutex_exit(mutex);
+	}
+}
+
+#ifdef UNIV_DEBUG
+/*********************************************************************//**
+Checks if the current thread owns the mutex protecting the queue of a lock:
+the lock_sys->rec_hash mutex of the page of a record lock, or
+lock_sys->mutex for a table lock.
+@return	true if owned */
+static
+bool
+lock_queue_mutex_own(
+/*=================*/
+	const lock_t*	lock)	/*!< in: lock */
+{
+	if (lock_get_type_low(lock) == LOCK_REC) {
+		return(mutex_own(hash_get_mutex(lock_sys->rec_hash,
+						lock_rec_lock_fold(lock))));
+	}
+
+	return(lock_mutex_own());
+}
+
+/*********************************************************************//**
+Checks if the current thread owns lock_sys->mutex or one of the
+lock_sys->rec_hash mutexes, which is enough for granting a lock.
+@return	true if owned */
+UNIV_INTERN
+bool
+lock_mutex_own_any(void)
+/*====================*/
+{
+	ulint	i;
+
+	if (lock_mutex_own()) {
+		return(true);
+	}
+
+	for (i = 0; i < lock_sys->rec_hash->n_sync_obj; i++) {
+		if (mutex_own(hash_get_nth_mutex(lock_sys->rec_hash, i))) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+#endif /* UNIV_DEBUG */
+
+/*********************************************************************//**
+Resizes the lock hash table after the buffer pool was resized. */
+UNIV_INTERN
+void
+lock_sys_resize(
+/*============*/
+	ulint	n_cells)	/*!< in: number of slots in lock hash table */
+{
+	hash_table_t*	old_hash;
+	ulint		i;
+
+	lock_mutex_enter();
+
+	/* HASH_INSERT() appends to the chain, so that the locks on
+	a page stay in their queue order. The new table shares the
+	mutexes of the old one. */
+	old_hash = lock_sys->rec_hash;
+	lock_sys->rec_hash = ha_recreate(old_hash, n_cells);
+	HASH_MIGRATE(old_hash, lock_sys->rec_hash, lock_t, hash,
+		     lock_rec_lock_fold);
+
+	/* A thread may have read the old lock_sys->rec_hash before it
+	waited for one of its mutexes: keep the old table until the next
+	resize, like buf_pool->page_hash_old. */
+	if (lock_sys->rec_hash_old != NULL) {
+		hash_table_free(lock_sys->rec_hash_old);
+	}
+
+	lock_sys->rec_hash_old = old_hash;
+
+	/* Update the cached lock_rec_hash() of the pages */
+	for (i = 0; i < srv_buf_pool_instances; ++i) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		buf_page_t*	bpage;
+
+		buf_pool_mutex_enter(buf_pool);
+
+		for (bpage = UT_LIST_GET_FIRST(buf_pool->LRU);
+		     bpage != NULL;
+		     bpage = UT_LIST_GET_NEXT(LRU, bpage)) {
+
+			if (buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE) {
+				buf_block_t*	block;
+
+				block = reinterpret_cast<buf_block_t*>(bpage);
+
+				block->lock_hash_val = lock_rec_hash(
+					bpage->space, bpage->offset);
+			}
+		}
+
+		buf_pool_mutex_exit(buf_pool);
+	}
+
+	lock_mutex_exit();
+}
+
 /*********************************************************************//**
 Closes the lock system at database shutdown. */
 UNIV_INTERN
@@ -635,8 +807,13 @@ lock_sys_close(void)
 		lock_latest_err_file = NULL;
 	}
 
+	hash_free_sync_obj(lock_sys->rec_hash);
 	hash_table_free(lock_sys->rec_hash);
 
+	if (lock_sys->rec_hash_old != NULL) {
+		hash_table_free(lock_sys->rec_hash_old);
+	}
+
 	mutex_free(&lock_sys->mutex);
 	mutex_free(&lock_sys->wait_mutex);
 
@@ -647,6 +824,24 @@ lock_sys_close(void)
 	lock_stack = NULL;
 }
 
+/*********************************************************************//**
+Acquires lock_sys->mutex and all the lock_sys->rec_hash mutexes, like
+lock_mutex_enter(), if lock_sys->mutex can be acquired without waiting.
+@return	0 if succeeded, 1 if lock_sys->mutex was reserved by another thread */
+UNIV_INTERN
+ulint
+lock_mutex_enter_nowait(void)
+/*=========================*/
+{
+	if (mutex_enter_nowait(&lock_sys->mutex)) {
+		return(1);
+	}
+
+	hash_mutex_enter_all(lock_sys->rec_hash);
+
+	return(0);
+}
+
 /*********************************************************************//**
 Gets the size of a lock struct.
 @return	size in bytes */
@@ -857,7 +1052,7 @@ lock_reset_lock_and_trx_wait(
 {
 	ut_ad(lock->trx->lock.wait_lock == lock);
 	ut_ad(lock_get_wait(lock));
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 
 	lock->trx->lock.wait_lock = NULL;
 	lock->type_mode &= ~LOCK_WAIT;
@@ -1094,7 +1289,7 @@ lock_rec_set_nth_bit(
 
 	((byte*) &lock[1])[byte_index] |= 1 << bit_index;
 
-	++lock->trx->lock.n_rec_locks;
+	lock_trx_n_rec_locks_inc(lock->trx->lock.n_rec_locks);
 }
 
 /**********************************************************************//**
@@ -1143,7 +1338,7 @@ lock_rec_reset_nth_bit(
 
 	((byte*) &lock[1])[byte_index] &= ~(1 << bit_index);
 
-	--lock->trx->lock.n_rec_locks;
+	lock_trx_n_rec_locks_dec(lock->trx->lock.n_rec_locks);
 
 	ut_ad(lock->trx->lock.n_rec_locks >= 0);
 }
@@ -1160,7 +1355,7 @@ lock_rec_get_next_on_page_const(
 	ulint	space;
 	ulint	page_no;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
@@ -1209,7 +1404,7 @@ lock_rec_get_first_on_page_addr(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(space, page_no));
 
 	for (lock = static_cast<lock_t*>(
 			HASH_GET_FIRST(lock_sys->rec_hash,
@@ -1239,9 +1434,9 @@ lock_rec_expl_exist_on_page(
 {
 	lock_t*	lock;
 
-	lock_mutex_enter();
+	lock_rec_mutex_enter(space, page_no);
 	lock = lock_rec_get_first_on_page_addr(space, page_no);
-	lock_mutex_exit();
+	lock_rec_mutex_exit(space, page_no);
 
 	return(lock);
 }
@@ -1261,7 +1456,7 @@ lock_rec_get_first_on_page(
 	ulint	space	= buf_block_get_space(block);
 	ulint	page_no	= buf_block_get_page_no(block);
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(space, page_no));
 
 	hash = buf_block_get_lock_hash_val(block);
 
@@ -1290,7 +1485,7 @@ lock_rec_get_next(
 	ulint	heap_no,/*!< in: heap number of the record */
 	lock_t*	lock)	/*!< in: lock */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 
 	do {
 		ut_ad(lock_get_type_low(lock) == LOCK_REC);
@@ -1325,7 +1520,7 @@ lock_rec_get_first(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_block_mutex_own(block));
 
 	for (lock = lock_rec_get_first_on_page(block); lock;
 	     lock = lock_rec_get_next_on_page(lock)) {
@@ -1395,7 +1590,7 @@ lock_rec_get_prev(
 	ulint	page_no;
 	lock_t*	found_lock	= NULL;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(in_lock));
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 
 	space = in_lock->un_member.rec_lock.space;
@@ -1492,7 +1687,7 @@ lock_rec_has_expl(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_block_mutex_own(block));
 	ut_ad((precise_mode & LOCK_MODE_MASK) == LOCK_S
 	      || (precise_mode & LOCK_MODE_MASK) == LOCK_X);
 	ut_ad(!(precise_mode & LOCK_INSERT_INTENTION));
@@ -1546,7 +1741,7 @@ lock_rec_other_has_expl_req(
 {
 	const lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_block_mutex_own(block));
 	ut_ad(mode == LOCK_X || mode == LOCK_S);
 	ut_ad(gap == 0 || gap == LOCK_GAP);
 	ut_ad(wait == 0 || wait == LOCK_WAIT);
@@ -1590,7 +1785,7 @@ lock_rec_other_has_conflicting(
 	const lock_t*		lock;
 	ibool			is_supremum;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_block_mutex_own(block));
 
 	is_supremum = (heap_no == PAGE_HEAP_NO_SUPREMUM);
 
@@ -1620,7 +1815,7 @@ lock_rec_find_similar_on_page(
 	lock_t*		lock,		/*!< in: lock_rec_get_first_on_page() */
 	const trx_t*	trx)		/*!< in: transaction */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(!lock || lock_queue_mutex_own(lock));
 
 	for (/* No op */;
 	     lock != NULL;
@@ -1790,7 +1985,7 @@ lock_rec_create(
 	ulint		n_bytes;
 	const page_t*	page;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_block_mutex_own(block));
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
@@ -1823,6 +2018,15 @@ lock_rec_create(
 	n_bits = page_dir_get_n_heap(page) + LOCK_PAGE_BITMAP_MARGIN;
 	n_bytes = 1 + n_bits / 8;
 
+	/* The trx mutex protects trx->lock.lock_heap and trx_locks
+	from lock_rec_convert_impl_to_expl(), which may be creating a
+	lock for trx on a page protected by another mutex */
+
+	if (!caller_owns_trx_mutex) {
+		trx_mutex_enter(trx);
+	}
+	ut_ad(trx_mutex_own(trx));
+
 	lock = static_cast<lock_t*>(
 		mem_heap_alloc(trx->lock.lock_heap, sizeof(lock_t) + n_bytes));
 
@@ -1843,18 +2047,13 @@ lock_rec_create(
 	/* Set the bit corresponding to rec */
 	lock_rec_set_nth_bit(lock, heap_no);
 
-	index->table->n_rec_locks++;
+	lock_table_n_rec_locks_inc(index->table->n_rec_locks);
 
 	ut_ad(index->table->n_ref_count > 0 || !index->table->can_be_evicted);
 
 	HASH_INSERT(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), lock);
 
-	if (!caller_owns_trx_mutex) {
-		trx_mutex_enter(trx);
-	}
-	ut_ad(trx_mutex_own(trx));
-
 	if (type_mode & LOCK_WAIT) {
 
 		lock_set_lock_and_trx_wait(lock, trx);
@@ -1866,12 +2065,47 @@ lock_rec_create(
 		trx_mutex_exit(trx);
 	}
 
-	MONITOR_INC(MONITOR_RECLOCK_CREATED);
-	MONITOR_INC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_CREATED);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK);
 
 	return(lock);
 }
 
+/*********************************************************************//**
+Reports the transactions that a record lock request of a replication
+slave thread has to wait for, so that the slave can break a wait of an
+earlier transaction for a later one when it preserves the commit order. */
+static
+void
+lock_rec_report_wait(
+/*=================*/
+	const lock_t*		wait_lock,/*!< in: the waiting lock request */
+	ulint			type_mode,/*!< in: lock mode requested */
+	const buf_block_t*	block,	/*!< in: buffer block containing
+					the record */
+	ulint			heap_no)/*!< in: heap number of the record */
+{
+	const trx_t*	trx = wait_lock->trx;
+	lock_t*		lock;
+
+	ut_ad(lock_mutex_own());
+
+	for (lock = lock_rec_get_first(block, heap_no);
+	     lock != NULL;
+	     lock = lock_rec_get_next(heap_no, lock)) {
+
+		if (lock != wait_lock
+		    && lock->trx->mysql_thd != NULL
+		    && lock_rec_has_to_wait(
+			    trx, type_mode, lock,
+			    heap_no == PAGE_HEAP_NO_SUPREMUM)) {
+
+			thd_report_lock_wait(
+				trx->mysql_thd, lock->trx->mysql_thd);
+		}
+	}
+}
+
 /*********************************************************************//**
 Enqueues a waiting request for a lock which cannot be granted immediately.
 Checks for deadlocks.
@@ -1948,19 +2182,25 @@ lock_rec_enqueue_waiting(
 	lock = lock_rec_create(
 		type_mode | LOCK_WAIT, block, heap_no, index, trx, TRUE);
 
-	/* Release the mutex to obey the latching order.
-	This is safe, because lock_deadlock_check_and_resolve()
-	is invoked when a lock wait is enqueued for the currently
-	running transaction. Because trx is a running transaction
-	(it is not currently suspended because of a lock wait),
-	its state can only be changed by this thread, which is
-	currently associated with the transaction. */
+	if (srv_async_deadlock_detect) {
+		/* lock_wait_timeout_thread() will look for a deadlock
+		once this thread is suspended. */
+		victim_trx = NULL;
+	} else {
+		/* Release the mutex to obey the latching order.
+		This is safe, because lock_deadlock_check_and_resolve()
+		is invoked when a lock wait is enqueued for the currently
+		running transaction. Because trx is a running transaction
+		(it is not currently suspended because of a lock wait),
+		its state can only be changed by this thread, which is
+		currently associated with the transaction. */
 
-	trx_mutex_exit(trx);
+		trx_mutex_exit(trx);
 
-	victim_trx = lock_deadlock_check_and_resolve(lock, trx);
+		victim_trx = lock_deadlock_check_and_resolve(lock, trx);
 
-	trx_mutex_enter(trx);
+		trx_mutex_enter(trx);
+	}
 
 	if (victim_trx != 0) {
 
@@ -1981,10 +2221,17 @@ lock_rec_enqueue_waiting(
 		return(DB_SUCCESS_LOCKED_REC);
 	}
 
+	if (trx->mysql_thd != NULL
+	    && thd_is_replication_slave_thread(trx->mysql_thd)) {
+
+		lock_rec_report_wait(lock, type_mode, block, heap_no);
+	}
+
 	trx->lock.que_state = TRX_QUE_LOCK_WAIT;
 
 	trx->lock.was_chosen_as_deadlock_victim = FALSE;
 	trx->lock.wait_started = ut_time();
+	trx->lock.schedule_weight = 0;
 
 	ut_a(que_thr_stop(thr));
 
@@ -2028,7 +2275,7 @@ lock_rec_add_to_queue(
 	lock_t*	lock;
 	lock_t*	first_lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_block_mutex_own(block));
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index)
 	      || dict_index_get_online_status(index) != ONLINE_INDEX_CREATION);
@@ -2143,7 +2390,7 @@ lock_rec_lock_fast(
 	trx_t*			trx;
 	enum lock_rec_req_status status = LOCK_REC_SUCCESS;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_block_mutex_own(block));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2275,7 +2522,9 @@ Tries to lock the specified record in the mode requested. If not immediately
 possible, enqueues a waiting lock request. This is a low-level function
 which does NOT look at implicit locks! Checks lock compatibility within
 explicit locks. This function sets a normal next-key lock, or in the case
-of a page supremum record, a gap type lock.
+of a page supremum record, a gap type lock. The common cases are handled
+while holding only the lock_sys->rec_hash mutex of the page; the whole
+lock system is latched only if the request may have to wait.
 @return	DB_SUCCESS, DB_SUCCESS_LOCKED_REC, DB_LOCK_WAIT, DB_DEADLOCK,
 or DB_QUE_THR_SUSPENDED */
 static
@@ -2295,7 +2544,12 @@ lock_rec_lock(
 	dict_index_t*		index,	/*!< in: index of record */
 	que_thr_t*		thr)	/*!< in: query thread */
 {
-	ut_ad(lock_mutex_own());
+	ulint			space	= buf_block_get_space(block);
+	ulint			page_no	= buf_block_get_page_no(block);
+	enum lock_rec_req_status status;
+	dberr_t			err;
+
+	ut_ad(!lock_mutex_own());
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2309,14 +2563,28 @@ lock_rec_lock(
 
 	/* We try a simplified and faster subroutine for the most
 	common cases */
-	switch (lock_rec_lock_fast(impl, mode, block, heap_no, index, thr)) {
+	lock_rec_mutex_enter(space, page_no);
+
+	status = lock_rec_lock_fast(impl, mode, block, heap_no, index, thr);
+
+	lock_rec_mutex_exit(space, page_no);
+
+	switch (status) {
 	case LOCK_REC_SUCCESS:
 		return(DB_SUCCESS);
 	case LOCK_REC_SUCCESS_CREATED:
 		return(DB_SUCCESS_LOCKED_REC);
 	case LOCK_REC_FAIL:
-		return(lock_rec_lock_slow(impl, mode, block,
-					  heap_no, index, thr));
+		/* The slow path may have to enqueue a waiting request
+		and look for deadlocks, which needs all the locks. */
+		lock_mutex_enter();
+
+		err = lock_rec_lock_slow(impl, mode, block,
+					 heap_no, index, thr);
+
+		lock_mutex_exit();
+
+		return(err);
 	}
 
 	ut_error;
@@ -2339,7 +2607,7 @@ lock_rec_has_to_wait_in_queue(
 	ulint		bit_mask;
 	ulint		bit_offset;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(wait_lock));
 	ut_ad(lock_get_wait(wait_lock));
 	ut_ad(lock_get_type_low(wait_lock) == LOCK_REC);
 
@@ -2376,7 +2644,7 @@ lock_grant(
 /*=======*/
 	lock_t*	lock)	/*!< in/out: waiting lock request */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 
 	lock_reset_lock_and_trx_wait(lock);
 
@@ -2456,6 +2724,156 @@ lock_rec_cancel(
 	trx_mutex_exit(lock->trx);
 }
 
+/*************************************************************//**
+Checks if a waiting record lock request conflicts with a granted lock
+ahead of it in the queue. Unlike lock_rec_has_to_wait_in_queue(), the
+waiting locks ahead are ignored.
+@return	lock that is conflicting, or NULL */
+static
+const lock_t*
+lock_rec_has_to_wait_granted(
+/*=========================*/
+	const lock_t*	wait_lock)	/*!< in: waiting record lock */
+{
+	const lock_t*	lock;
+	ulint		heap_no;
+
+	ut_ad(lock_queue_mutex_own(wait_lock));
+	ut_ad(lock_get_wait(wait_lock));
+	ut_ad(lock_get_type_low(wait_lock) == LOCK_REC);
+
+	heap_no = lock_rec_find_set_bit(wait_lock);
+
+	for (lock = lock_rec_get_first_on_page_addr(
+		     wait_lock->un_member.rec_lock.space,
+		     wait_lock->un_member.rec_lock.page_no);
+	     lock != wait_lock;
+	     lock = lock_rec_get_next_on_page_const(lock)) {
+
+		if (!lock_get_wait(lock)
+		    && lock_rec_get_nth_bit(lock, heap_no)
+		    && lock_has_to_wait(wait_lock, lock)) {
+
+			return(lock);
+		}
+	}
+
+	return(NULL);
+}
+
+/*************************************************************//**
+Moves a record lock to the front of its hash chain, so that it is
+ahead of all the other locks on its page. */
+static
+void
+lock_rec_move_to_front(
+/*===================*/
+	lock_t*	lock)	/*!< in/out: record lock */
+{
+	ulint		fold;
+	hash_cell_t*	cell;
+
+	ut_ad(lock_queue_mutex_own(lock));
+
+	fold = lock_rec_fold(lock->un_member.rec_lock.space,
+			     lock->un_member.rec_lock.page_no);
+
+	cell = hash_get_nth_cell(lock_sys->rec_hash,
+				 hash_calc_hash(fold, lock_sys->rec_hash));
+
+	if (cell->node != lock) {
+		HASH_DELETE(lock_t, hash, lock_sys->rec_hash, fold, lock);
+
+		lock->hash = static_cast<lock_t*>(cell->node);
+		cell->node = lock;
+	}
+}
+
+/** Orders waiting record locks by the schedule weight of their
+transactions, heaviest first */
+struct lock_rec_schedule_weight_greater {
+	bool operator()(const lock_t* a, const lock_t* b) const
+	{
+		return(a->trx->lock.schedule_weight
+		       > b->trx->lock.schedule_weight);
+	}
+};
+
+/*************************************************************//**
+Grants the waiting locks on a page, or on one record of it, that no
+longer have to wait. With innodb_lock_schedule_algorithm=cats, the
+waiting transactions that the most other transactions wait for are
+considered first, regardless of their position in the queue; a lock
+granted out of order is moved to the front of the queue, so that the
+granted locks stay ahead of the locks that wait for them. */
+static
+void
+lock_rec_grant(
+/*===========*/
+	ulint	space,		/*!< in: space id */
+	ulint	page_no,	/*!< in: page number */
+	ulint	heap_no)	/*!< in: heap number of the record, or
+				ULINT_UNDEFINED for all the records
+				of the page */
+{
+	lock_t*	lock;
+
+	ut_ad(lock_rec_mutex_own(space, page_no));
+
+	if (srv_lock_schedule_algorithm != SRV_LOCK_SCHEDULE_CATS) {
+
+		/* Grant locks if there are no conflicting locks ahead.
+		Stop at the first X lock that is waiting or has been
+		granted. */
+
+		for (lock = lock_rec_get_first_on_page_addr(space, page_no);
+		     lock != NULL;
+		     lock = lock_rec_get_next_on_page(lock)) {
+
+			if (lock_get_wait(lock)
+			    && (heap_no == ULINT_UNDEFINED
+				|| lock_rec_get_nth_bit(lock, heap_no))
+			    && !lock_rec_has_to_wait_in_queue(lock)) {
+
+				lock_grant(lock);
+			}
+		}
+
+		return;
+	}
+
+	std::vector<lock_t*>	waiting;
+
+	for (lock = lock_rec_get_first_on_page_addr(space, page_no);
+	     lock != NULL;
+	     lock = lock_rec_get_next_on_page(lock)) {
+
+		if (lock_get_wait(lock)
+		    && (heap_no == ULINT_UNDEFINED
+			|| lock_rec_get_nth_bit(lock, heap_no))) {
+
+			waiting.push_back(lock);
+		}
+	}
+
+	/* Among equally heavy transactions, keep the queue order. */
+
+	std::stable_sort(waiting.begin(), waiting.end(),
+			 lock_rec_schedule_weight_greater());
+
+	for (std::vector<lock_t*>::iterator it = waiting.begin();
+	     it != waiting.end();
+	     ++it) {
+
+		lock = *it;
+
+		if (!lock_rec_has_to_wait_granted(lock)) {
+			lock_rec_move_to_front(lock);
+			lock_grant(lock);
+		}
+	}
+}
+
 /*************************************************************//**
 Removes a record lock request, waiting or granted, from the queue and
 grants locks to other transactions in the queue if they now are entitled
@@ -2464,53 +2882,54 @@ static
 void
 lock_rec_dequeue_from_page(
 /*=======================*/
-	lock_t*		in_lock)	/*!< in: record lock object: all
+	lock_t*		in_lock,	/*!< in: record lock object: all
 					record locks which are contained in
 					this lock object are removed;
 					transactions waiting behind will
 					get their lock requests granted,
 					if they are now qualified to it */
+	ibool		caller_owns_trx_mutex)
+					/*!< in: TRUE if caller owns
+					in_lock->trx->mutex */
 {
 	ulint		space;
 	ulint		page_no;
-	lock_t*		lock;
 	trx_lock_t*	trx_lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(in_lock));
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
-	/* We may or may not be holding in_lock->trx->mutex here. */
+	ut_ad(caller_owns_trx_mutex == trx_mutex_own(in_lock->trx));
 
 	trx_lock = &in_lock->trx->lock;
 
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
-	in_lock->index->table->n_rec_locks--;
+	lock_table_n_rec_locks_dec(in_lock->index->table->n_rec_locks);
 
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
 
+	/* The trx mutex protects trx_locks from lock_release(), which
+	walks the list of a committed transaction without holding
+	lock_sys->mutex */
+
+	if (!caller_owns_trx_mutex) {
+		trx_mutex_enter(in_lock->trx);
+	}
+
 	UT_LIST_REMOVE(trx_locks, trx_lock->trx_locks, in_lock);
 
-	MONITOR_INC(MONITOR_RECLOCK_REMOVED);
-	MONITOR_DEC(MONITOR_NUM_RECLOCK);
+	if (!caller_owns_trx_mutex) {
+		trx_mutex_exit(in_lock->trx);
+	}
 
-	/* Check if waiting locks in the queue can now be granted: grant
-	locks if there are no conflicting locks ahead. Stop at the first
-	X lock that is waiting or has been granted. */
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_REMOVED);
+	MONITOR_ATOMIC_DEC(MONITOR_NUM_RECLOCK);
 
-	for (lock = lock_rec_get_first_on_page_addr(space, page_no);
-	     lock != NULL;
-	     lock = lock_rec_get_next_on_page(lock)) {
-
-		if (lock_get_wait(lock)
-		    && !lock_rec_has_to_wait_in_queue(lock)) {
+	/* Check if waiting locks in the queue can now be granted. */
 
-			/* Grant the lock */
-			ut_ad(lock->trx != in_lock->trx);
-			lock_grant(lock);
-		}
-	}
+	lock_rec_grant(space, page_no, ULINT_UNDEFINED);
 }
 
 /*************************************************************//**
@@ -2529,21 +2948,25 @@ lock_rec_discard(
 
 	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
+	ut_ad(!trx_mutex_own(in_lock->trx));
 
 	trx_lock = &in_lock->trx->lock;
 
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
-	in_lock->index->table->n_rec_locks--;
+	lock_table_n_rec_locks_dec(in_lock->index->table->n_rec_locks);
 
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
 
+	/* See lock_rec_dequeue_from_page(). */
+	trx_mutex_enter(in_lock->trx);
 	UT_LIST_REMOVE(trx_locks, trx_lock->trx_locks, in_lock);
+	trx_mutex_exit(in_lock->trx);
 
-	MONITOR_INC(MONITOR_RECLOCK_REMOVED);
-	MONITOR_DEC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_REMOVED);
+	MONITOR_ATOMIC_DEC(MONITOR_NUM_RECLOCK);
 }
 
 /*************************************************************//**
@@ -3928,119 +4351,626 @@ lock_deadlock_joining_trx_print(
 	ut_ad(lock_mutex_own());
 	ut_ad(!srv_read_only_mode);
 
-	/* If the lock search exceeds the max step
-	or the max depth, the current trx will be
-	the victim. Print its information. */
-	lock_deadlock_start_print();
+	/* If the lock search exceeds the max step
+	or the max depth, the current trx will be
+	the victim. Print its information. */
+	lock_deadlock_start_print();
+
+	lock_deadlock_fputs(
+		"TOO DEEP OR LONG SEARCH IN THE LOCK TABLE"
+		" WAITS-FOR GRAPH, WE WILL ROLL BACK"
+		" FOLLOWING TRANSACTION \n\n"
+		"*** TRANSACTION:\n");
+
+	lock_deadlock_trx_print(trx, 3000);
+
+	lock_deadlock_fputs("*** WAITING FOR THIS LOCK TO BE GRANTED:\n");
+
+	lock_deadlock_lock_print(lock);
+}
+
+/********************************************************************//**
+Rollback transaction selected as the victim. */
+static
+void
+lock_deadlock_trx_rollback(
+/*=======================*/
+	lock_deadlock_ctx_t*	ctx)		/*!< in: deadlock context */
+{
+	trx_t*			trx;
+
+	ut_ad(lock_mutex_own());
+
+	trx = ctx->wait_lock->trx;
+
+	lock_deadlock_fputs("*** WE ROLL BACK TRANSACTION (1)\n");
+
+	trx_mutex_enter(trx);
+
+	trx->lock.was_chosen_as_deadlock_victim = TRUE;
+
+	lock_cancel_waiting_and_release(trx->lock.wait_lock);
+
+	trx_mutex_exit(trx);
+}
+
+/********************************************************************//**
+Checks if a joining lock request results in a deadlock. If a deadlock is
+found this function will resolve the dadlock by choosing a victim transaction
+and rolling it back. It will attempt to resolve all deadlocks. The returned
+transaction will be the transaction was chosen as a victim and rolled back or
+NULL if no deadlock found.
+
+@return transaction chosen as victim or NULL */
+static
+const trx_t*
+lock_deadlock_check_and_resolve(
+/*============================*/
+	const lock_t*	lock,	/*!< in: lock the transaction is requesting */
+	const trx_t*	trx)	/*!< in: transaction */
+{
+	const trx_t*	victim_trx;
+
+	ut_ad(trx != NULL);
+	ut_ad(lock != NULL);
+	ut_ad(lock_mutex_own());
+	check_trx_state(trx);
+
+	/* Try and resolve as many deadlocks as possible. */
+	do {
+		lock_deadlock_ctx_t	ctx;
+
+		/* Reset the context. */
+		ctx.cost = 0;
+		ctx.depth = 0;
+		ctx.start = trx;
+		ctx.too_deep = FALSE;
+		ctx.wait_lock = lock;
+		ctx.mark_start = lock_mark_counter;
+
+		victim_trx = lock_deadlock_search(&ctx);
+
+		/* Search too deep, we rollback the joining transaction. */
+		if (ctx.too_deep) {
+
+			ut_a(trx == ctx.start);
+			ut_a(victim_trx == trx);
+
+			if (!srv_read_only_mode) {
+				lock_deadlock_joining_trx_print(trx, lock);
+			}
+
+			MONITOR_INC(MONITOR_DEADLOCK);
+
+		} else if (victim_trx != 0 && victim_trx != trx) {
+
+			ut_ad(victim_trx == ctx.wait_lock->trx);
+			lock_deadlock_trx_rollback(&ctx);
+
+			lock_deadlock_found = TRUE;
+
+			MONITOR_INC(MONITOR_DEADLOCK);
+		}
+
+	} while (victim_trx != 0 && victim_trx != trx);
+
+	/* If the joining transaction was selected as the victim. */
+	if (victim_trx != 0) {
+		ut_a(victim_trx == trx);
+
+		lock_deadlock_fputs("*** WE ROLL BACK TRANSACTION (2)\n");
+
+		lock_deadlock_found = TRUE;
+	}
+
+	return(victim_trx);
+}
+
+
+/*==================== BACKGROUND DEADLOCK DETECTION ==================*/
+
+/** A waiting transaction in a snapshot of the waits-for graph */
+struct lock_wait_node_t {
+	const trx_t*		trx;	/*!< transaction that waits */
+	ib_uint64_t		weight;	/*!< TRX_WEIGHT(trx) */
+	bool			notrans_edit;
+					/*!< whether trx has edited
+					non-transactional tables */
+	bool			victim;	/*!< whether trx was chosen as
+					a victim; its edges are ignored */
+	std::vector<ulint>	edges;	/*!< nodes of the waiting
+					transactions that trx waits for */
+};
+
+/** A snapshot of the waits-for graph of the suspended transactions */
+typedef std::vector<lock_wait_node_t>	lock_wait_graph_t;
+
+/** A deadlock found in the snapshot: the nodes of the cycle, each
+waiting for the next one, and the node of the victim */
+struct lock_wait_cycle_t {
+	std::vector<ulint>	nodes;	/*!< nodes of the cycle */
+	ulint			victim;	/*!< node chosen as the victim */
+};
+
+/********************************************************************//**
+Collects the transactions that own the locks ahead of a waiting lock
+in its queue and that the waiting lock has to wait for. */
+static
+void
+lock_deadlock_get_blockers(
+/*=======================*/
+	const lock_t*			wait_lock,	/*!< in: waiting lock */
+	std::vector<const trx_t*>*	blockers)	/*!< out: transactions
+							that own conflicting
+							locks */
+{
+	const lock_t*	lock;
+	ulint		heap_no;
+
+	ut_ad(lock_mutex_own());
+
+	blockers->clear();
+
+	if (lock_get_type_low(wait_lock) == LOCK_REC) {
+
+		heap_no = lock_rec_find_set_bit(wait_lock);
+		ut_ad(heap_no != ULINT_UNDEFINED);
+
+		lock = lock_rec_get_first_on_page_addr(
+			wait_lock->un_member.rec_lock.space,
+			wait_lock->un_member.rec_lock.page_no);
+
+		if (!lock_rec_get_nth_bit(lock, heap_no)) {
+			lock = lock_rec_get_next_const(heap_no, lock);
+		}
+	} else {
+		heap_no = ULINT_UNDEFINED;
+
+		lock = UT_LIST_GET_FIRST(
+			wait_lock->un_member.tab_lock.table->locks);
+	}
+
+	/* Only the locks ahead of wait_lock in the queue can block it. */
+
+	while (lock != wait_lock) {
+
+		ut_a(lock != NULL);
+
+		if (lock->trx != wait_lock->trx
+		    && lock_has_to_wait(wait_lock, lock)) {
+
+			blockers->push_back(lock->trx);
+		}
+
+		if (heap_no != ULINT_UNDEFINED) {
+			lock = lock_rec_get_next_const(heap_no, lock);
+		} else {
+			lock = UT_LIST_GET_NEXT(un_member.tab_lock.locks, lock);
+		}
+	}
+}
+
+/********************************************************************//**
+Takes a snapshot of the waits-for graph of the transactions whose
+threads are suspended in a lock wait. Only the edges between waiting
+transactions are kept, because a transaction that is not waiting can
+not be part of a deadlock. */
+static
+void
+lock_deadlock_snapshot(
+/*===================*/
+	lock_wait_graph_t*	graph)	/*!< out: waits-for graph */
+{
+	typedef std::map<const trx_t*, ulint>	trx_node_map_t;
+
+	trx_node_map_t			node_of;
+	std::vector<const lock_t*>	wait_locks;
+	std::vector<const trx_t*>	blockers;
+
+	ut_ad(lock_wait_mutex_own());
+	ut_ad(lock_mutex_own());
+
+	graph->clear();
+
+	for (const srv_slot_t* slot = lock_sys->waiting_threads;
+	     slot < lock_sys->last_slot;
+	     ++slot) {
+
+		if (!slot->in_use) {
+			continue;
+		}
+
+		const trx_t*	trx = thr_get_trx(slot->thr);
+
+		/* The lock may have been granted already. */
+		if (trx->lock.wait_lock == NULL) {
+			continue;
+		}
+
+		lock_wait_node_t	node;
+
+		node.trx = trx;
+		node.weight = TRX_WEIGHT(trx);
+		node.notrans_edit = trx->mysql_thd != NULL
+			&& thd_has_edited_nontrans_tables(trx->mysql_thd);
+		node.victim = false;
+
+		node_of[trx] = graph->size();
+		graph->push_back(node);
+		wait_locks.push_back(trx->lock.wait_lock);
+	}
+
+	for (ulint i = 0; i < graph->size(); ++i) {
+
+		lock_deadlock_get_blockers(wait_locks[i], &blockers);
+
+		for (ulint j = 0; j < blockers.size(); ++j) {
+			trx_node_map_t::const_iterator	it
+				= node_of.find(blockers[j]);
+
+			if (it != node_of.end()) {
+				(*graph)[i].edges.push_back(it->second);
+			}
+		}
+	}
+}
+
+/********************************************************************//**
+Looks for a cycle in a snapshot of the waits-for graph, ignoring the
+transactions that were already chosen as victims.
+@return true if a cycle was found */
+static
+bool
+lock_deadlock_find_cycle(
+/*=====================*/
+	const lock_wait_graph_t&	graph,	/*!< in: waits-for graph */
+	std::vector<ulint>*		cycle)	/*!< out: nodes of the cycle */
+{
+	enum { WHITE, GREY, BLACK };
+
+	/* Depth first search state: a node and its next edge to follow */
+	typedef std::pair<ulint, ulint>	dfs_frame_t;
+
+	std::vector<int>		color(graph.size(), WHITE);
+	std::vector<dfs_frame_t>	stack;
+
+	for (ulint root = 0; root < graph.size(); ++root) {
+
+		if (color[root] != WHITE || graph[root].victim) {
+			continue;
+		}
+
+		color[root] = GREY;
+		stack.push_back(dfs_frame_t(root, 0));
+
+		while (!stack.empty()) {
+			dfs_frame_t&		frame = stack.back();
+			const lock_wait_node_t&	node = graph[frame.first];
+
+			if (frame.second == node.edges.size()) {
+				color[frame.first] = BLACK;
+				stack.pop_back();
+				continue;
+			}
+
+			ulint	next = node.edges[frame.second++];
+
+			if (graph[next].victim || color[next] == BLACK) {
+				continue;
+			} else if (color[next] == WHITE) {
+				color[next] = GREY;
+				stack.push_back(dfs_frame_t(next, 0));
+				continue;
+			}
+
+			/* A grey node is on the stack: the nodes from
+			it to the top of the stack form a cycle. */
+
+			cycle->clear();
+
+			for (ulint i = stack.size(); i-- > 0; ) {
+				cycle->push_back(stack[i].first);
+
+				if (stack[i].first == next) {
+					break;
+				}
+			}
+
+			/* Each node waits for the next one. */
+			std::reverse(cycle->begin(), cycle->end());
+
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/********************************************************************//**
+Selects the victim of a deadlock found in the snapshot: the transaction
+with the smallest weight, as trx_weight_ge() would order them.
+@return node of the victim */
+static
+ulint
+lock_deadlock_select_cycle_victim(
+/*==============================*/
+	const lock_wait_graph_t&	graph,	/*!< in: waits-for graph */
+	const std::vector<ulint>&	cycle)	/*!< in: nodes of the cycle */
+{
+	ulint	victim = cycle[0];
+
+	for (ulint i = 1; i < cycle.size(); ++i) {
+		const lock_wait_node_t&	a = graph[victim];
+		const lock_wait_node_t&	b = graph[cycle[i]];
+
+		if (a.notrans_edit != b.notrans_edit
+		    ? a.notrans_edit
+		    : a.weight > b.weight) {
+
+			victim = cycle[i];
+		}
+	}
+
+	return(victim);
+}
+
+/********************************************************************//**
+Checks that a deadlock found in the snapshot still exists: all the
+transactions of the cycle are still suspended and each one waits for
+a lock held or requested ahead of it by the next one.
+@return true if the deadlock still exists */
+static
+bool
+lock_deadlock_cycle_validate(
+/*=========================*/
+	const lock_wait_graph_t&	graph,	/*!< in: waits-for graph */
+	const lock_wait_cycle_t&	cycle,	/*!< in: deadlock */
+	const std::set<const trx_t*>&	waiting)/*!< in: transactions
+						suspended in a lock wait */
+{
+	std::vector<const trx_t*>	blockers;
+
+	ut_ad(lock_wait_mutex_own());
+	ut_ad(lock_mutex_own());
+
+	/* A transaction found in the slots is alive, so its state can be
+	read. A transaction of the snapshot may have been freed since. */
+
+	for (ulint i = 0; i < cycle.nodes.size(); ++i) {
+		if (waiting.find(graph[cycle.nodes[i]].trx) == waiting.end()) {
+			return(false);
+		}
+	}
+
+	for (ulint i = 0; i < cycle.nodes.size(); ++i) {
+		const trx_t*	trx = graph[cycle.nodes[i]].trx;
+		const trx_t*	next = graph[cycle.nodes[
+			(i + 1) % cycle.nodes.size()]].trx;
+
+		if (trx->lock.wait_lock == NULL) {
+			return(false);
+		}
+
+		lock_deadlock_get_blockers(trx->lock.wait_lock, &blockers);
+
+		if (std::find(blockers.begin(), blockers.end(), next)
+		    == blockers.end()) {
+
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/********************************************************************//**
+Prints a deadlock found by the background deadlock detection. */
+static
+void
+lock_deadlock_cycle_print(
+/*======================*/
+	const lock_wait_graph_t&	graph,	/*!< in: waits-for graph */
+	const lock_wait_cycle_t&	cycle)	/*!< in: deadlock */
+{
+	char	buf[80];
+	ulint	victim = 0;
+
+	ut_ad(lock_mutex_own());
+	ut_ad(!srv_read_only_mode);
+
+	lock_deadlock_start_print();
+
+	for (ulint i = 0; i < cycle.nodes.size(); ++i) {
+		const trx_t*	trx = graph[cycle.nodes[i]].trx;
+
+		ut_snprintf(buf, sizeof(buf),
+			    "\n*** (%lu) TRANSACTION:\n", (ulong) i + 1);
+		lock_deadlock_fputs(buf);
+
+		lock_deadlock_trx_print(trx, 3000);
+
+		ut_snprintf(buf, sizeof(buf),
+			    "*** (%lu) WAITING FOR THIS LOCK TO BE GRANTED:\n",
+			    (ulong) i + 1);
+		lock_deadlock_fputs(buf);
+
+		lock_deadlock_lock_print(trx->lock.wait_lock);
+
+		if (cycle.nodes[i] == cycle.victim) {
+			victim = i + 1;
+		}
+	}
+
+	ut_snprintf(buf, sizeof(buf),
+		    "*** WE ROLL BACK TRANSACTION (%lu)\n", (ulong) victim);
+	lock_deadlock_fputs(buf);
+}
+
+/********************************************************************//**
+Looks for deadlocks among the transactions whose threads are suspended
+in a lock wait, and resolves them by rolling back the lightest
+transaction of each cycle. This is used instead of checking each lock
+wait when it is enqueued if innodb_async_deadlock_detect is set. The
+waits-for graph is searched on a snapshot, without holding
+lock_sys->mutex; each deadlock found is checked again before its
+victim is rolled back. */
+UNIV_INTERN
+void
+lock_deadlock_check_waits(void)
+/*===========================*/
+{
+	lock_wait_graph_t		graph;
+	std::vector<lock_wait_cycle_t>	cycles;
+	lock_wait_cycle_t		cycle;
+
+	ut_ad(!srv_read_only_mode);
+	ut_ad(!lock_wait_mutex_own());
+
+	lock_wait_mutex_enter();
+	lock_mutex_enter();
+
+	lock_deadlock_snapshot(&graph);
+
+	lock_mutex_exit();
+	lock_wait_mutex_exit();
+
+	/* Every victim breaks at least one cycle, so this terminates. */
+
+	while (lock_deadlock_find_cycle(graph, &cycle.nodes)) {
+		cycle.victim = lock_deadlock_select_cycle_victim(
+			graph, cycle.nodes);
+
+		graph[cycle.victim].victim = true;
+
+		cycles.push_back(cycle);
+	}
+
+	if (cycles.empty()) {
+		return;
+	}
+
+	lock_wait_mutex_enter();
+	lock_mutex_enter();
+
+	std::set<const trx_t*>	waiting;
+
+	for (const srv_slot_t* slot = lock_sys->waiting_threads;
+	     slot < lock_sys->last_slot;
+	     ++slot) {
 
-	lock_deadlock_fputs(
-		"TOO DEEP OR LONG SEARCH IN THE LOCK TABLE"
-		" WAITS-FOR GRAPH, WE WILL ROLL BACK"
-		" FOLLOWING TRANSACTION \n\n"
-		"*** TRANSACTION:\n");
+		if (slot->in_use) {
+			waiting.insert(thr_get_trx(slot->thr));
+		}
+	}
 
-	lock_deadlock_trx_print(trx, 3000);
+	for (ulint i = 0; i < cycles.size(); ++i) {
 
-	lock_deadlock_fputs("*** WAITING FOR THIS LOCK TO BE GRANTED:\n");
+		if (!lock_deadlock_cycle_validate(graph, cycles[i], waiting)) {
+			continue;
+		}
 
-	lock_deadlock_lock_print(lock);
-}
+		trx_t*	trx = const_cast<trx_t*>(
+			graph[cycles[i].victim].trx);
 
-/********************************************************************//**
-Rollback transaction selected as the victim. */
-static
-void
-lock_deadlock_trx_rollback(
-/*=======================*/
-	lock_deadlock_ctx_t*	ctx)		/*!< in: deadlock context */
-{
-	trx_t*			trx;
+		if (!srv_read_only_mode) {
+			lock_deadlock_cycle_print(graph, cycles[i]);
+		}
 
-	ut_ad(lock_mutex_own());
+		trx_mutex_enter(trx);
 
-	trx = ctx->wait_lock->trx;
+		trx->lock.was_chosen_as_deadlock_victim = TRUE;
 
-	lock_deadlock_fputs("*** WE ROLL BACK TRANSACTION (1)\n");
+		lock_cancel_waiting_and_release(trx->lock.wait_lock);
 
-	trx_mutex_enter(trx);
+		trx_mutex_exit(trx);
 
-	trx->lock.was_chosen_as_deadlock_victim = TRUE;
+		lock_deadlock_found = TRUE;
 
-	lock_cancel_waiting_and_release(trx->lock.wait_lock);
+		MONITOR_INC(MONITOR_DEADLOCK);
+	}
 
-	trx_mutex_exit(trx);
+	lock_mutex_exit();
+	lock_wait_mutex_exit();
 }
-
 /********************************************************************//**
-Checks if a joining lock request results in a deadlock. If a deadlock is
-found this function will resolve the dadlock by choosing a victim transaction
-and rolling it back. It will attempt to resolve all deadlocks. The returned
-transaction will be the transaction was chosen as a victim and rolled back or
-NULL if no deadlock found.
-
-@return transaction chosen as victim or NULL */
-static
-const trx_t*
-lock_deadlock_check_and_resolve(
-/*============================*/
-	const lock_t*	lock,	/*!< in: lock the transaction is requesting */
-	const trx_t*	trx)	/*!< in: transaction */
+Updates the schedule weights of the transactions whose threads are
+suspended in a lock wait, for innodb_lock_schedule_algorithm=cats.
+Each waiting transaction is taken to wait for the owner of the first
+conflicting lock ahead of its lock request; the weight of a transaction
+is the number of waiting transactions that lead to it along these
+edges. */
+UNIV_INTERN
+void
+lock_update_schedule_weights(void)
+/*==============================*/
 {
-	const trx_t*	victim_trx;
+	typedef std::map<const trx_t*, ulint>	trx_node_map_t;
 
-	ut_ad(trx != NULL);
-	ut_ad(lock != NULL);
-	ut_ad(lock_mutex_own());
-	check_trx_state(trx);
+	trx_node_map_t			node_of;
+	std::vector<trx_t*>		waiting;
+	std::vector<ulint>		parent;
+	std::vector<ulint>		weight;
+	std::vector<const trx_t*>	blockers;
 
-	/* Try and resolve as many deadlocks as possible. */
-	do {
-		lock_deadlock_ctx_t	ctx;
+	ut_ad(!srv_read_only_mode);
 
-		/* Reset the context. */
-		ctx.cost = 0;
-		ctx.depth = 0;
-		ctx.start = trx;
-		ctx.too_deep = FALSE;
-		ctx.wait_lock = lock;
-		ctx.mark_start = lock_mark_counter;
+	lock_wait_mutex_enter();
+	lock_mutex_enter();
 
-		victim_trx = lock_deadlock_search(&ctx);
+	for (const srv_slot_t* slot = lock_sys->waiting_threads;
+	     slot < lock_sys->last_slot;
+	     ++slot) {
 
-		/* Search too deep, we rollback the joining transaction. */
-		if (ctx.too_deep) {
+		if (!slot->in_use) {
+			continue;
+		}
 
-			ut_a(trx == ctx.start);
-			ut_a(victim_trx == trx);
+		trx_t*	trx = thr_get_trx(slot->thr);
 
-			if (!srv_read_only_mode) {
-				lock_deadlock_joining_trx_print(trx, lock);
-			}
+		if (trx->lock.wait_lock != NULL) {
+			node_of[trx] = waiting.size();
+			waiting.push_back(trx);
+		}
+	}
 
-			MONITOR_INC(MONITOR_DEADLOCK);
+	parent.resize(waiting.size(), ULINT_UNDEFINED);
+	weight.resize(waiting.size(), 0);
 
-		} else if (victim_trx != 0 && victim_trx != trx) {
+	for (ulint i = 0; i < waiting.size(); ++i) {
 
-			ut_ad(victim_trx == ctx.wait_lock->trx);
-			lock_deadlock_trx_rollback(&ctx);
+		lock_deadlock_get_blockers(waiting[i]->lock.wait_lock,
+					   &blockers);
 
-			lock_deadlock_found = TRUE;
+		if (!blockers.empty()) {
+			trx_node_map_t::const_iterator	it
+				= node_of.find(blockers[0]);
 
-			MONITOR_INC(MONITOR_DEADLOCK);
+			if (it != node_of.end()) {
+				parent[i] = it->second;
+			}
 		}
+	}
 
-	} while (victim_trx != 0 && victim_trx != trx);
+	/* A deadlock makes a cycle of the edges: stop after visiting
+	every node once. */
 
-	/* If the joining transaction was selected as the victim. */
-	if (victim_trx != 0) {
-		ut_a(victim_trx == trx);
+	for (ulint i = 0; i < waiting.size(); ++i) {
+		ulint	n = 0;
 
-		lock_deadlock_fputs("*** WE ROLL BACK TRANSACTION (2)\n");
+		for (ulint j = parent[i];
+		     j != ULINT_UNDEFINED && n < waiting.size();
+		     j = parent[j], ++n) {
 
-		lock_deadlock_found = TRUE;
+			++weight[j];
+		}
 	}
 
-	return(victim_trx);
+	for (ulint i = 0; i < waiting.size(); ++i) {
+		waiting[i]->lock.schedule_weight = weight[i];
+	}
+
+	lock_mutex_exit();
+	lock_wait_mutex_exit();
 }
 
 /*========================= TABLE LOCKS ==============================*/
@@ -4304,19 +5234,25 @@ lock_table_enqueue_waiting(
 
 	lock = lock_table_create(table, mode | LOCK_WAIT, trx);
 
-	/* Release the mutex to obey the latching order.
-	This is safe, because lock_deadlock_check_and_resolve()
-	is invoked when a lock wait is enqueued for the currently
-	running transaction. Because trx is a running transaction
-	(it is not currently suspended because of a lock wait),
-	its state can only be changed by this thread, which is
-	currently associated with the transaction. */
+	if (srv_async_deadlock_detect) {
+		/* lock_wait_timeout_thread() will look for a deadlock
+		once this thread is suspended. */
+		victim_trx = NULL;
+	} else {
+		/* Release the mutex to obey the latching order.
+		This is safe, because lock_deadlock_check_and_resolve()
+		is invoked when a lock wait is enqueued for the currently
+		running transaction. Because trx is a running transaction
+		(it is not currently suspended because of a lock wait),
+		its state can only be changed by this thread, which is
+		currently associated with the transaction. */
 
-	trx_mutex_exit(trx);
+		trx_mutex_exit(trx);
 
-	victim_trx = lock_deadlock_check_and_resolve(lock, trx);
+		victim_trx = lock_deadlock_check_and_resolve(lock, trx);
 
-	trx_mutex_enter(trx);
+		trx_mutex_enter(trx);
+	}
 
 	if (victim_trx != 0) {
 		ut_ad(victim_trx == trx);
@@ -4459,7 +5395,8 @@ lock_table(
 		trx_set_rw_mode(trx);
 	}
 
-	lock_mutex_enter();
+	/* The table locks are protected by lock_sys->mutex alone */
+	lock_sys_mutex_enter();
 
 	/* We have to check if the new lock is compatible with any locks
 	other transactions have in the table lock queue. */
@@ -4467,22 +5404,29 @@ lock_table(
 	wait_for = lock_table_other_has_incompatible(
 		trx, LOCK_WAIT, table, mode);
 
-	trx_mutex_enter(trx);
-
 	/* Another trx has a request on the table in an incompatible
 	mode: this trx may have to wait */
 
 	if (wait_for != NULL) {
+		/* The deadlock check follows the record locks, too */
+		lock_rec_mutex_enter_all();
+
+		trx_mutex_enter(trx);
+
 		err = lock_table_enqueue_waiting(mode | flags, table, thr);
+
+		lock_mutex_exit();
 	} else {
+		trx_mutex_enter(trx);
+
 		lock_table_create(table, mode | flags, trx);
 
 		ut_a(!flags || mode == LOCK_S || mode == LOCK_X);
 
 		err = DB_SUCCESS;
-	}
 
-	lock_mutex_exit();
+		lock_sys_mutex_exit();
+	}
 
 	trx_mutex_exit(trx);
 
@@ -4665,96 +5609,187 @@ released:
 
 	/* Check if we can now grant waiting lock requests */
 
-	for (lock = first_lock; lock != NULL;
-	     lock = lock_rec_get_next(heap_no, lock)) {
-		if (lock_get_wait(lock)
-		    && !lock_rec_has_to_wait_in_queue(lock)) {
+	lock_rec_grant(buf_block_get_space(block),
+		       buf_block_get_page_no(block), heap_no);
 
-			/* Grant the lock */
-			ut_ad(trx != lock->trx);
-			lock_grant(lock);
+	lock_mutex_exit();
+	trx_mutex_exit(trx);
+}
+
+/*********************************************************************//**
+Releases the record locks of a committed transaction on a page, and grants
+the waiting lock requests that no longer have to wait. */
+static
+void
+lock_rec_release_on_page(
+/*=====================*/
+	trx_t*	trx,	/*!< in/out: committed transaction */
+	ulint	space,	/*!< in: space id */
+	ulint	page_no)/*!< in: page number */
+{
+	ut_ad(lock_rec_mutex_own(space, page_no));
+	ut_ad(trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY));
+
+	/* Look the locks up on the page every time, because granting
+	the waiting locks may reorder the queue. */
+
+	for (;;) {
+		lock_t*	lock;
+
+		for (lock = lock_rec_get_first_on_page_addr(space, page_no);
+		     lock != NULL && lock->trx != trx;
+		     lock = lock_rec_get_next_on_page(lock)) {
+		}
+
+		if (lock == NULL) {
+			return;
+		}
+
+#ifdef UNIV_DEBUG
+		/* Check if the transcation locked a record
+		in a system table in X mode. It should have set
+		the dict_op code correctly if it did. */
+		if (lock->index->table->id < DICT_HDR_FIRST_ID
+		    && lock_get_mode(lock) == LOCK_X) {
+
+			ut_ad(lock_get_mode(lock) != LOCK_IX);
+			ut_ad(trx->dict_operation != TRX_DICT_OP_NONE);
 		}
+#endif /* UNIV_DEBUG */
+
+		lock_rec_dequeue_from_page(lock, FALSE);
 	}
+}
 
-	lock_mutex_exit();
-	trx_mutex_exit(trx);
+/*********************************************************************//**
+Gets the last record lock of a transaction. The caller must own the trx
+mutex, or lock_sys->mutex and the mutex of the page of the lock.
+@return	last record lock, or NULL if none */
+static
+lock_t*
+lock_trx_get_last_rec_lock(
+/*=======================*/
+	const trx_t*	trx)	/*!< in: transaction */
+{
+	lock_t*	lock;
+
+	for (lock = UT_LIST_GET_LAST(trx->lock.trx_locks);
+	     lock != NULL && lock_get_type_low(lock) != LOCK_REC;
+	     lock = UT_LIST_GET_PREV(trx_locks, lock)) {
+	}
+
+	return(lock);
 }
 
 /*********************************************************************//**
 Releases transaction locks, and releases possible other transactions waiting
-because of these locks. */
+because of these locks. The record locks are released page by page while
+holding the lock_sys->rec_hash mutex of the page, and the table locks while
+holding lock_sys->mutex. */
 static
 void
 lock_release(
 /*=========*/
-	trx_t*	trx)	/*!< in/out: transaction */
+	trx_t*	trx)	/*!< in/out: committed transaction */
 {
 	lock_t*		lock;
 	ulint		count = 0;
 	trx_id_t	max_trx_id;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(!lock_mutex_own());
 	ut_ad(!trx_mutex_own(trx));
+	ut_ad(trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY));
 
 	max_trx_id = trx_sys_get_max_trx_id();
 
+	/* While no page mutex is held, lock_update_split_and_merge() and
+	the other functions that move locks under lock_mutex_enter() may
+	still create record locks for trx or discard them. trx_locks is
+	protected by the trx mutex, so read the last record lock under it
+	for every page, and release the locks of trx that are on the page
+	when its mutex has been acquired. */
+
+	for (;;) {
+		ulint	space;
+		ulint	page_no;
+
+		trx_mutex_enter(trx);
+
+		lock = lock_trx_get_last_rec_lock(trx);
+
+		if (lock == NULL) {
+			trx_mutex_exit(trx);
+			break;
+		}
+
+		space = lock->un_member.rec_lock.space;
+		page_no = lock->un_member.rec_lock.page_no;
+
+		trx_mutex_exit(trx);
+
+		lock_rec_mutex_enter(space, page_no);
+
+		lock_rec_release_on_page(trx, space, page_no);
+
+		lock_rec_mutex_exit(space, page_no);
+	}
+
+	/* Locks cannot be moved while lock_sys->mutex is held. Release
+	the record locks that were created after the loop above, and the
+	table locks. */
+
+	lock_sys_mutex_enter();
+
 	for (lock = UT_LIST_GET_LAST(trx->lock.trx_locks);
 	     lock != NULL;
 	     lock = UT_LIST_GET_LAST(trx->lock.trx_locks)) {
 
-		if (lock_get_type_low(lock) == LOCK_REC) {
+		dict_table_t*	table;
 
-#ifdef UNIV_DEBUG
-			/* Check if the transcation locked a record
-			in a system table in X mode. It should have set
-			the dict_op code correctly if it did. */
-			if (lock->index->table->id < DICT_HDR_FIRST_ID
-			    && lock_get_mode(lock) == LOCK_X) {
-
-				ut_ad(lock_get_mode(lock) != LOCK_IX);
-				ut_ad(trx->dict_operation != TRX_DICT_OP_NONE);
-			}
-#endif /* UNIV_DEBUG */
+		if (lock_get_type_low(lock) == LOCK_REC) {
+			ulint	space = lock->un_member.rec_lock.space;
+			ulint	page_no = lock->un_member.rec_lock.page_no;
 
-			lock_rec_dequeue_from_page(lock);
-		} else {
-			dict_table_t*	table;
+			lock_rec_mutex_enter(space, page_no);
+			lock_rec_release_on_page(trx, space, page_no);
+			lock_rec_mutex_exit(space, page_no);
+			continue;
+		}
 
-			table = lock->un_member.tab_lock.table;
+		table = lock->un_member.tab_lock.table;
 #ifdef UNIV_DEBUG
-			ut_ad(lock_get_type_low(lock) & LOCK_TABLE);
+		ut_ad(lock_get_type_low(lock) & LOCK_TABLE);
 
-			/* Check if the transcation locked a system table
-			in IX mode. It should have set the dict_op code
-			correctly if it did. */
-			if (table->id < DICT_HDR_FIRST_ID
-			    && (lock_get_mode(lock) == LOCK_X
-				|| lock_get_mode(lock) == LOCK_IX)) {
+		/* Check if the transcation locked a system table
+		in IX mode. It should have set the dict_op code
+		correctly if it did. */
+		if (table->id < DICT_HDR_FIRST_ID
+		    && (lock_get_mode(lock) == LOCK_X
+			|| lock_get_mode(lock) == LOCK_IX)) {
 
-				ut_ad(trx->dict_operation != TRX_DICT_OP_NONE);
-			}
+			ut_ad(trx->dict_operation != TRX_DICT_OP_NONE);
+		}
 #endif /* UNIV_DEBUG */
 
-			if (lock_get_mode(lock) != LOCK_IS
-			    && trx->undo_no != 0) {
-
-				/* The trx may have modified the table. We
-				block the use of the MySQL query cache for
-				all currently active transactions. */
+		if (lock_get_mode(lock) != LOCK_IS
+		    && trx->undo_no != 0) {
 
-				table->query_cache_inv_trx_id = max_trx_id;
-			}
+			/* The trx may have modified the table. We
+			block the use of the MySQL query cache for
+			all currently active transactions. */
 
-			lock_table_dequeue(lock);
+			table->query_cache_inv_trx_id = max_trx_id;
 		}
 
+		lock_table_dequeue(lock);
+
 		if (count == LOCK_RELEASE_INTERVAL) {
 			/* Release the  mutex for a while, so that we
 			do not monopolize it */
 
-			lock_mutex_exit();
+			lock_sys_mutex_exit();
 
-			lock_mutex_enter();
+			lock_sys_mutex_enter();
 
 			count = 0;
 		}
@@ -4773,6 +5808,8 @@ lock_release(
 	ut_a(ib_vector_is_empty(trx->lock.table_locks));
 
 	mem_heap_empty(trx->lock.lock_heap);
+
+	lock_sys_mutex_exit();
 }
 
 /* True if a lock mode is S or X */
@@ -5972,6 +7009,8 @@ lock_rec_insert_check_and_lock(
 	lock_t*		lock;
 	dberr_t		err;
 	ulint		next_rec_heap_no;
+	ulint		space;
+	ulint		page_no;
 	ibool		inherit_in = *inherit;
 
 	ut_ad(block->frame == page_align(rec));
@@ -5987,8 +7026,9 @@ lock_rec_insert_check_and_lock(
 	trx = thr_get_trx(thr);
 	next_rec = page_rec_get_next_const(rec);
 	next_rec_heap_no = page_rec_get_heap_no(next_rec);
+	space = buf_block_get_space(block);
+	page_no = buf_block_get_page_no(block);
 
-	lock_mutex_enter();
 	/* Because this code is invoked for a running transaction by
 	the thread that is serving the transaction, it is not necessary
 	to hold trx->mutex here. */
@@ -5998,13 +7038,15 @@ lock_rec_insert_check_and_lock(
 	BTR_NO_LOCKING_FLAG and skip the locking altogether. */
 	ut_ad(lock_table_has(trx, index->table, LOCK_IX));
 
+	lock_rec_mutex_enter(space, page_no);
+
 	lock = lock_rec_get_first(block, next_rec_heap_no);
 
+	lock_rec_mutex_exit(space, page_no);
+
 	if (UNIV_LIKELY(lock == NULL)) {
 		/* We optimize CPU time usage in the simplest case */
 
-		lock_mutex_exit();
-
 		if (inherit_in && !dict_index_is_clust(index)) {
 			/* Update the page max trx id field */
 			page_update_max_trx_id(block,
@@ -6019,6 +7061,12 @@ lock_rec_insert_check_and_lock(
 
 	*inherit = TRUE;
 
+	/* The insert may have to wait: latch the whole lock system. The
+	locks on the successor are looked up again, because they may have
+	changed after we released the mutex of the page. */
+
+	lock_mutex_enter();
+
 	/* If another transaction has an explicit lock request which locks
 	the gap, waiting or granted, on the successor, the insert has to wait.
 
@@ -6125,8 +7173,10 @@ lock_rec_convert_impl_to_expl(
 	if (trx_id != 0) {
 		trx_t*	impl_trx;
 		ulint	heap_no = page_rec_get_heap_no(rec);
+		ulint	space = buf_block_get_space(block);
+		ulint	page_no = buf_block_get_page_no(block);
 
-		lock_mutex_enter();
+		lock_sys_mutex_enter();
 
 		/* If the transaction is still active and has no
 		explicit x-lock set on the record, set one for it */
@@ -6135,21 +7185,26 @@ lock_rec_convert_impl_to_expl(
 		impl_trx = trx_rw_get_active_trx_by_id(trx_id, NULL);
 		mutex_exit(&trx_sys->mutex);
 
-		/* impl_trx cannot be committed until lock_mutex_exit()
+		/* impl_trx cannot be committed until lock_sys_mutex_exit()
 		because lock_trx_release_locks() acquires lock_sys->mutex */
 
-		if (impl_trx != NULL
-		    && !lock_rec_has_expl(LOCK_X | LOCK_REC_NOT_GAP, block,
-					  heap_no, impl_trx)) {
-			ulint	type_mode = (LOCK_REC | LOCK_X
-					     | LOCK_REC_NOT_GAP);
+		if (impl_trx != NULL) {
+			lock_rec_mutex_enter(space, page_no);
 
-			lock_rec_add_to_queue(
-				type_mode, block, heap_no, index,
-				impl_trx, FALSE);
+			if (!lock_rec_has_expl(LOCK_X | LOCK_REC_NOT_GAP,
+					       block, heap_no, impl_trx)) {
+				ulint	type_mode = (LOCK_REC | LOCK_X
+						     | LOCK_REC_NOT_GAP);
+
+				lock_rec_add_to_queue(
+					type_mode, block, heap_no, index,
+					impl_trx, FALSE);
+			}
+
+			lock_rec_mutex_exit(space, page_no);
 		}
 
-		lock_mutex_exit();
+		lock_sys_mutex_exit();
 	}
 }
 
@@ -6195,16 +7250,12 @@ lock_clust_rec_modify_check_and_lock(
 
 	lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6255,16 +7306,12 @@ lock_sec_rec_modify_check_and_lock(
 	index record, and this would not have been possible if another active
 	transaction had modified this secondary index record. */
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 #ifdef UNIV_DEBUG
 	{
@@ -6354,8 +7401,6 @@ lock_sec_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
@@ -6364,9 +7409,7 @@ lock_sec_rec_read_check_and_lock(
 	err = lock_rec_lock(FALSE, mode | gap_mode,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6426,8 +7469,6 @@ lock_clust_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
@@ -6436,9 +7477,7 @@ lock_clust_rec_read_check_and_lock(
 	err = lock_rec_lock(FALSE, mode | gap_mode,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6796,7 +7835,7 @@ lock_cancel_waiting_and_release(
 
 	if (lock_get_type_low(lock) == LOCK_REC) {
 
-		lock_rec_dequeue_from_page(lock);
+		lock_rec_dequeue_from_page(lock, TRUE);
 	} else {
 		ut_ad(lock_get_type_low(lock) & LOCK_TABLE);
 
@@ -6846,11 +7885,11 @@ lock_unlock_table_autoinc(
 	necessary to hold trx->mutex here. */
 
 	if (lock_trx_holds_autoinc_locks(trx)) {
-		lock_mutex_enter();
+		lock_sys_mutex_enter();
 
 		lock_release_autoinc_locks(trx);
 
-		lock_mutex_exit();
+		lock_sys_mutex_exit();
 	}
 }
 
@@ -6901,7 +7940,7 @@ lock_trx_release_locks(
 	TRX_STATE_COMMITTED_IN_MEMORY must be atomic with removing trx
 	from the descriptors array. */
 	ut_ad(!lock_mutex_own());
-	lock_mutex_enter();
+	lock_sys_mutex_enter();
 	trx_mutex_enter(trx);
 
 	/* The following assignment makes the transaction committed in memory
@@ -6937,11 +7976,14 @@ lock_trx_release_locks(
 
 	trx_mutex_exit(trx);
 
+	lock_sys_mutex_exit();
+
+	/* No new locks can be created for a committed transaction:
+	lock_rec_convert_impl_to_expl() only considers active ones */
+
 	lock_release(trx);
 
 	trx->lock.n_rec_locks = 0;
-
-	lock_mutex_exit();
 }
 
 /*********************************************************************//**
@@ -397,13 +397,14 @@ lock_wait_release_thread_if_suspended(
 	que_thr_t*	thr)	/*!< in: query thread associated with the
 				user OS thread	 */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_mutex_own_any());
 	ut_ad(trx_mutex_own(thr_get_trx(thr)));
 
-	/* We own both the lock mutex and the trx_t::mutex but not the
-	lock wait mutex. This is OK because other threads will see the state
-	of this slot as being in use and no other thread can change the state
-	of the slot to free unless that thread also owns the lock mutex. */
+	/* We own the lock mutex or a lock_sys->rec_hash mutex, and the
+	trx_t::mutex but not the lock wait mutex. This is OK because other
+	threads will see the state of this slot as being in use and no other
+	thread can change the state of the slot to free unless that thread
+	also owns the lock mutex and all the lock_sys->rec_hash mutexes. */
 
 	if (thr->slot != NULL && thr->slot->in_use && thr->slot->thr == thr) {
 		trx_t*	trx = thr_get_trx(thr);
@@ -530,6 +531,21 @@ DECLARE_THREAD(lock_wait_timeout_thread)(
 
 		lock_wait_mutex_exit();
 
+		/* The lock waits were enqueued without a deadlock check:
+		look for deadlocks among the suspended threads. A thread
+		suspended after this sets the event again. */
+
+		if (srv_async_deadlock_detect) {
+			lock_deadlock_check_waits();
+		}
+
+		/* Find the waiting transactions that block the most
+		other transactions, to grant them their locks first. */
+
+		if (srv_lock_schedule_algorithm == SRV_LOCK_SCHEDULE_CATS) {
+			lock_update_schedule_weights();
+		}
+
 	} while (srv_shutdown_state < SRV_SHUTDOWN_CLEANUP);
 
 	lock_sys->timeout_thread_active = false;
@@ -93,6 +93,11 @@ UNIV_INTERN mysql_pfs_key_t	log_sys_w_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	log_flush_order_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
+#ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t	log_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	log_flusher_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
 #ifdef UNIV_DEBUG
 UNIV_INTERN ibool	log_do_write = TRUE;
 #endif /* UNIV_DEBUG */
@@ -162,9 +167,44 @@ log_io_complete_archive(void);
 /*=========================*/
 #endif /* UNIV_LOG_ARCHIVE */
 
+/************************************************************//**
+Advances log_sys->closed_lsn over the log record groups whose
+mini-transactions have added their dirty pages to the flush lists. The
+caller must hold log_flush_order_mutex. */
+static
+void
+log_recent_closed_advance(void)
+/*===========================*/
+{
+	lsn_t	lsn = log_sys->closed_lsn;
+
+	ut_ad(log_flush_order_mutex_own());
+
+	for (;;) {
+		lsn_t*	slot = &log_sys->recent_closed[
+			lsn & (LOG_RECENT_CLOSED_SIZE - 1)];
+		lsn_t	end_lsn = *static_cast<volatile lsn_t*>(slot);
+
+		if (end_lsn == 0) {
+			break;
+		}
+
+		ut_ad(end_lsn > lsn);
+
+		/* Clear the slot before the new closed_lsn lets another
+		log record group reuse it. */
+		*slot = 0;
+		lsn = end_lsn;
+	}
+
+	os_wmb;
+
+	log_sys->closed_lsn = lsn;
+}
+
 /****************************************************************//**
-Returns the oldest modified block lsn in the pool, or log_sys->lsn if none
-exists.
+Returns the oldest modified block lsn in the pool, or log_sys->closed_lsn if
+that is smaller or no modified block exists.
 @return	LSN of oldest modification */
 static
 lsn_t
@@ -173,18 +213,52 @@ log_buf_pool_get_oldest_modification(void)
 {
 	lsn_t	lsn;
 
+	lsn_t	closed_lsn;
+
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
+	/* Read closed_lsn before the flush lists: the pages of the
+	mini-transactions below it are in the flush lists, and the pages
+	of the others will be added with an lsn that is not smaller. */
+	log_flush_order_mutex_enter();
+	log_recent_closed_advance();
+	closed_lsn = log_sys->closed_lsn;
+	log_flush_order_mutex_exit();
+
 	lsn = buf_pool_get_oldest_modification();
 
-	if (!lsn) {
+	if (!lsn || lsn > closed_lsn) {
 
-		lsn = log_sys->lsn;
+		lsn = closed_lsn;
 	}
 
 	return(lsn);
 }
 
+/************************************************************//**
+Waits until the log record groups reserved in the log buffer have been
+copied to it. It is assumed that the caller holds the log mutex, so that no
+new space can be reserved. */
+static
+void
+log_buffer_wait_for_copies(void)
+/*============================*/
+{
+	ulint	i = 0;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	while (log_sys->n_pending_copies > 0) {
+		if (++i < SYNC_SPIN_ROUNDS) {
+			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+		} else {
+			os_thread_yield();
+		}
+	}
+
+	os_rmb;
+}
+
 /** Extends the log buffer.
 @param[in] len	requested minimum size in bytes */
 static
@@ -228,6 +302,8 @@ log_buffer_extend(
 		log_mutex_enter_all();;
 	}
 
+	log_buffer_wait_for_copies();
+
 	move_start = ut_calc_align_down(
 		log_sys->buf_free,
 		OS_FILE_LOG_BLOCK_SIZE);
@@ -274,10 +350,10 @@ log_buffer_extend(
 }
 
 /************************************************************//**
-Opens the log for log_write_low. The log must be closed with log_close and
+Opens the log for log_reserve_low. The log must be closed with log_close and
 released with log_release.
 @return	start lsn of the log record */
-UNIV_INTERN
+static
 lsn_t
 log_reserve_and_open(
 /*=================*/
@@ -372,13 +448,13 @@ loop:
 }
 
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
-UNIV_INTERN
+Reserves space for a string in the log buffer and formats the headers of
+the log blocks it fills. The string is copied to the reserved space with
+log_buffer_write(). It is assumed that the caller holds the log mutex. */
+static
 void
-log_write_low(
-/*==========*/
-	byte*	str,		/*!< in: string */
+log_reserve_low(
+/*============*/
 	ulint	str_len)	/*!< in: string length */
 {
 	log_t*	log	= log_sys;
@@ -406,10 +482,7 @@ part_loop:
 			- LOG_BLOCK_TRL_SIZE;
 	}
 
-	ut_memcpy(log->buf + log->buf_free, str, len);
-
 	str_len -= len;
-	str = str + len;
 
 	log_block = static_cast<byte*>(
 		ut_align_down(
@@ -446,7 +519,7 @@ part_loop:
 /************************************************************//**
 Closes the log.
 @return	lsn */
-UNIV_INTERN
+static
 lsn_t
 log_close(void)
 /*===========*/
@@ -528,13 +601,155 @@ log_close(void)
 		log->check_flush_or_checkpoint = TRUE;
 	}
 function_exit:
+	return(lsn);
+}
 
-#ifdef UNIV_LOG_DEBUG
-	log_check_log_recs(log->buf + log->old_buf_free,
-			   log->buf_free - log->old_buf_free, log->old_lsn);
-#endif
+/************************************************************//**
+Reserves space in the log buffer for a log record group and formats the
+headers of the log blocks it covers. The log mutex is released before
+returning: the records are copied to the reserved space with
+log_buffer_write() concurrently with other threads, after which the
+caller must call log_buffer_write_completed() and, when the group is not
+empty, log_recent_closed_add().
+@return	start lsn of the log record group */
+UNIV_INTERN
+lsn_t
+log_buffer_reserve(
+/*===============*/
+	ulint	len,		/*!< in: length of the log records */
+	byte**	ptr,		/*!< out: where to copy the log records */
+	lsn_t*	end_lsn)	/*!< out: end lsn of the log record group */
+{
+	lsn_t	start_lsn;
 
-	return(lsn);
+	start_lsn = log_reserve_and_open(len);
+
+	*ptr = log_sys->buf + log_sys->buf_free;
+
+	if (len > 0) {
+		log_reserve_low(len);
+	}
+
+	*end_lsn = log_close();
+
+	os_increment_counter_by_amount(
+		log_sys->log_flush_order_mutex, log_sys->n_pending_copies, 1);
+
+	log_release();
+
+	return(start_lsn);
+}
+
+/************************************************************//**
+Copies log records to space reserved with log_buffer_reserve(),
+skipping the log block headers and trailers.
+@return	position following the copied records */
+UNIV_INTERN
+byte*
+log_buffer_write(
+/*=============*/
+	byte*		ptr,	/*!< in: position in the log buffer */
+	const byte*	str,	/*!< in: log records */
+	ulint		len)	/*!< in: length of the log records */
+{
+	while (len > 0) {
+		ulint	n = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+			- ut_align_offset(ptr, OS_FILE_LOG_BLOCK_SIZE);
+
+		ut_ad(n > 0);
+		ut_ad(n <= OS_FILE_LOG_BLOCK_SIZE
+			   - LOG_BLOCK_TRL_SIZE - LOG_BLOCK_HDR_SIZE);
+
+		if (n > len) {
+			n = len;
+		}
+
+		ut_memcpy(ptr, str, n);
+
+		ptr += n;
+		str += n;
+		len -= n;
+
+		if (ut_align_offset(ptr, OS_FILE_LOG_BLOCK_SIZE)
+		    == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+			/* The block became full: skip to the data of
+			the next block, like log_reserve_low() did */
+			ptr += LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
+		}
+	}
+
+	return(ptr);
+}
+
+/************************************************************//**
+Advances log_sys->closed_lsn unless another thread is already doing it. */
+static
+void
+log_recent_closed_try_advance(void)
+/*===============================*/
+{
+	while (!mutex_enter_nowait(&log_sys->log_flush_order_mutex)) {
+		log_recent_closed_advance();
+		log_flush_order_mutex_exit();
+
+		/* A slot may have been filled while we were holding the
+		mutex, by a thread that then failed to acquire it. */
+		if (!log_sys->recent_closed[
+			    log_sys->closed_lsn
+			    & (LOG_RECENT_CLOSED_SIZE - 1)]) {
+			break;
+		}
+	}
+}
+
+/************************************************************//**
+Waits until a log record group starting at start_lsn may add its dirty
+pages to the flush lists, that is, until start_lsn is less than
+LOG_RECENT_CLOSED_SIZE ahead of log_sys->closed_lsn. */
+UNIV_INTERN
+void
+log_recent_closed_wait(
+/*===================*/
+	lsn_t	start_lsn)	/*!< in: start lsn of the log record group */
+{
+	ulint	i = 0;
+
+	while (start_lsn - log_sys->closed_lsn >= LOG_RECENT_CLOSED_SIZE) {
+		if (i == 0) {
+			MONITOR_INC(MONITOR_LOG_CLOSED_WAITS);
+		}
+
+		log_recent_closed_try_advance();
+
+		if (++i < SYNC_SPIN_ROUNDS) {
+			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+		} else {
+			os_thread_yield();
+		}
+	}
+}
+
+/************************************************************//**
+Notes that the mini-transaction which wrote the log records between
+start_lsn and end_lsn has added its dirty pages to the flush lists, and
+advances log_sys->closed_lsn if possible. */
+UNIV_INTERN
+void
+log_recent_closed_add(
+/*==================*/
+	lsn_t	start_lsn,	/*!< in: start lsn of the log record group */
+	lsn_t	end_lsn)	/*!< in: end lsn of the log record group */
+{
+	ut_ad(end_lsn > start_lsn);
+	ut_ad(start_lsn - log_sys->closed_lsn < LOG_RECENT_CLOSED_SIZE);
+
+	/* Make the flush list insertions visible before the slot */
+	os_wmb;
+
+	log_sys->recent_closed[start_lsn & (LOG_RECENT_CLOSED_SIZE - 1)]
+		= end_lsn;
+
+	log_recent_closed_try_advance();
 }
 
 #ifdef UNIV_LOG_ARCHIVE
@@ -546,27 +761,29 @@ void
 log_pad_current_log_block(void)
 /*===========================*/
 {
-	byte		b		= MLOG_DUMMY_RECORD;
 	ulint		pad_length;
-	ulint		i;
-	ib_uint64_t	lsn;
+	lsn_t		start_lsn;
+	lsn_t		lsn;
 
-	/* We retrieve lsn only because otherwise gcc crashed on HP-UX */
-	lsn = log_reserve_and_open(OS_FILE_LOG_BLOCK_SIZE);
+	start_lsn = log_reserve_and_open(OS_FILE_LOG_BLOCK_SIZE);
 
 	pad_length = OS_FILE_LOG_BLOCK_SIZE
 		- (log_sys->buf_free % OS_FILE_LOG_BLOCK_SIZE)
 		- LOG_BLOCK_TRL_SIZE;
 
-	for (i = 0; i < pad_length; i++) {
-		log_write_low(&b, 1);
-	}
+	/* The padding stays within the current block, so it can be
+	written while holding the log mutex. */
+	memset(log_sys->buf + log_sys->buf_free, MLOG_DUMMY_RECORD,
+	       pad_length);
 
-	lsn = log_sys->lsn;
+	log_reserve_low(pad_length);
 
-	log_close();
+	lsn = log_close();
 	log_release();
 
+	log_recent_closed_wait(start_lsn);
+	log_recent_closed_add(start_lsn, lsn);
+
 	ut_a(lsn % OS_FILE_LOG_BLOCK_SIZE == LOG_BLOCK_HDR_SIZE);
 }
 #endif /* UNIV_LOG_ARCHIVE */
@@ -885,6 +1102,10 @@ log_init(void)
 	log_sys->buf_size = LOG_BUFFER_SIZE;
 	log_sys->is_extending = false;
 
+	log_sys->n_pending_copies = 0;
+	log_sys->recent_closed = static_cast<lsn_t*>(
+		mem_zalloc(LOG_RECENT_CLOSED_SIZE * sizeof(lsn_t)));
+
 	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
 		- LOG_BUF_FLUSH_MARGIN;
 	log_sys->check_flush_or_checkpoint = TRUE;
@@ -906,6 +1127,22 @@ log_init(void)
 	log_sys->flush_event = os_event_create();
 	os_event_set(log_sys->flush_event);
 
+	log_sys->writer_event = os_event_create();
+	log_sys->flusher_event = os_event_create();
+	log_sys->write_events = static_cast<os_event_t*>(
+		mem_alloc(LOG_N_WAIT_EVENTS * sizeof(os_event_t)));
+	log_sys->flush_events = static_cast<os_event_t*>(
+		mem_alloc(LOG_N_WAIT_EVENTS * sizeof(os_event_t)));
+
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		log_sys->write_events[i] = os_event_create();
+		log_sys->flush_events[i] = os_event_create();
+	}
+
+	log_sys->flush_requested = false;
+	log_sys->writer_threads_active = false;
+	log_sys->n_writer_threads = 0;
+
 	/*----------------------------*/
 
 	log_sys->next_checkpoint_no = 0;
@@ -955,6 +1192,7 @@ log_init(void)
 
 	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
 	log_sys->lsn = LOG_START_LSN + LOG_BLOCK_HDR_SIZE;
+	log_sys->closed_lsn = log_sys->lsn;
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
 		    log_sys->lsn - log_sys->last_checkpoint_lsn);
@@ -1298,14 +1536,15 @@ loop:
 }
 
 /******************************************************//**
-This function is called, e.g., when a transaction wants to commit. It checks
-that the log has been written to the log file up to the last log entry written
-by the transaction. If there is a flush running, it waits and checks if the
-flush flushed enough. If not, starts a new flush. */
-UNIV_INTERN
+Checks that the log has been written to the log file up to an lsn, and
+writes it if not. If there is a flush running, it waits and checks if the
+flush flushed enough. If not, starts a new flush. This is done by the
+calling thread itself, or by the log writer and log flusher threads when
+they are running. */
+static
 void
-log_write_up_to(
-/*============*/
+log_write_up_to_low(
+/*================*/
 	lsn_t	lsn,	/*!< in: log sequence number up to which
 			the log should be written,
 			LSN_MAX if not specified */
@@ -1392,6 +1631,10 @@ loop:
 
 	mutex_enter(&(log_sys->mutex));
 
+	/* The log buffer is written and switched below: wait for the
+	records of the groups reserved so far to be copied to it. */
+	log_buffer_wait_for_copies();
+
 	if (!flush_to_disk
 	    && log_sys->buf_free == log_sys->buf_next_to_write) {
 		/* Nothing to write and no flush to disk requested */
@@ -1495,6 +1738,323 @@ flush_op:
 	os_event_set(log_sys->flush_event);
 }
 
+/******************************************************//**
+Sets the events of log_sys->write_events or log_sys->flush_events of the
+log blocks between two lsn, waking up the threads waiting for the log to be
+written or flushed up to an lsn in that range. */
+static
+void
+log_wait_events_set(
+/*================*/
+	os_event_t*	events,		/*!< in: log_sys->write_events or
+					log_sys->flush_events */
+	lsn_t		old_lsn,	/*!< in: old write or flushed lsn */
+	lsn_t		new_lsn)	/*!< in: new write or flushed lsn */
+{
+	lsn_t	first = old_lsn / OS_FILE_LOG_BLOCK_SIZE;
+	lsn_t	last = new_lsn / OS_FILE_LOG_BLOCK_SIZE;
+
+	if (last - first >= LOG_N_WAIT_EVENTS) {
+		first = 0;
+		last = LOG_N_WAIT_EVENTS - 1;
+	}
+
+	for (lsn_t i = first; i <= last; i++) {
+		os_event_set(events[i % LOG_N_WAIT_EVENTS]);
+	}
+}
+
+/******************************************************//**
+Waits until the log writer or log flusher thread has moved log_sys->write_lsn
+or log_sys->flushed_to_disk_lsn up to an lsn. Spins for
+innodb_log_wait_spin_rounds rounds before it sleeps on the event of the
+log block of the lsn.
+@return true if the lsn was reached, false if the log writer threads
+were stopped before that */
+static
+bool
+log_wait_for_lsn(
+/*=============*/
+	lsn_t	lsn,		/*!< in: lsn to wait for */
+	bool	flush_to_disk)	/*!< in: true to wait for the flush,
+				false to wait for the write only */
+{
+	volatile lsn_t*	target = flush_to_disk
+		? &log_sys->flushed_to_disk_lsn
+		: &log_sys->write_lsn;
+	os_event_t	event = (flush_to_disk
+				 ? log_sys->flush_events
+				 : log_sys->write_events)[
+		(lsn / OS_FILE_LOG_BLOCK_SIZE) % LOG_N_WAIT_EVENTS];
+
+	for (ulint i = 0; i < srv_log_wait_spin_rounds; i++) {
+		if (*target >= lsn) {
+			return(true);
+		}
+
+		if (srv_spin_wait_delay) {
+			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+		}
+	}
+
+	for (;;) {
+		ib_int64_t	sig_count = os_event_reset(event);
+
+		if (*target >= lsn) {
+			return(true);
+		}
+
+		if (!log_sys->writer_threads_active) {
+			return(false);
+		}
+
+		if (flush_to_disk) {
+			log_sys->flush_requested = true;
+			os_event_set(log_sys->flusher_event);
+		}
+
+		os_event_wait_time_low(event, 100000, sig_count);
+	}
+}
+
+/******************************************************//**
+This function is called, e.g., when a transaction wants to commit. It checks
+that the log has been written to the log file up to the last log entry written
+by the transaction, and flushed if requested. When the log writer threads are
+running, it wakes them up and waits for them to do the write and flush;
+otherwise it does them itself. */
+UNIV_INTERN
+void
+log_write_up_to(
+/*============*/
+	lsn_t	lsn,	/*!< in: log sequence number up to which
+			the log should be written,
+			LSN_MAX if not specified */
+	ibool	flush_to_disk)
+			/*!< in: TRUE if we want the written log
+			also to be flushed to disk */
+{
+	ut_ad(!srv_read_only_mode);
+
+	if (recv_no_ibuf_operations) {
+		/* Recovery is running and no operations on the log files are
+		allowed yet (the variable name .._no_ibuf_.. is misleading) */
+
+		return;
+	}
+
+	if (log_sys->writer_threads_active) {
+		/* The log writer threads only run on platforms where
+		the lsn can be read without log_sys->mutex. */
+		lsn = ut_min(lsn, log_sys->lsn);
+
+		if (flush_to_disk
+		    ? log_sys->flushed_to_disk_lsn >= lsn
+		    : log_sys->write_lsn >= lsn) {
+			return;
+		}
+
+		os_event_set(log_sys->writer_event);
+
+		/* Unless every write is flushed anyway, ask for the flush
+		only after our write is done: the log flusher thread flushes
+		up to write_lsn as it was when it cleared flush_requested. */
+		if (flush_to_disk && srv_flush_log_at_trx_commit != 1
+		    && !log_wait_for_lsn(lsn, false)) {
+			log_write_up_to_low(lsn, flush_to_disk);
+			return;
+		}
+
+		if (log_wait_for_lsn(lsn, flush_to_disk)) {
+			return;
+		}
+	}
+
+	log_write_up_to_low(lsn, flush_to_disk);
+}
+
+/******************************************************************//**
+The log writer thread writes the log buffer to the log files whenever
+there is something to write.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_writer_thread)(
+/*==============================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_writer_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	while (log_sys->writer_threads_active) {
+		ib_int64_t	sig_count = os_event_reset(
+			log_sys->writer_event);
+		lsn_t		old_write_lsn = log_sys->write_lsn;
+		lsn_t		old_flushed_lsn = log_sys->flushed_to_disk_lsn;
+
+		if (log_sys->lsn <= old_write_lsn) {
+			os_event_wait_time_low(log_sys->writer_event,
+					       1000000, sig_count);
+			continue;
+		}
+
+		log_write_up_to_low(log_sys->lsn, FALSE);
+
+		if (log_sys->write_lsn == old_write_lsn) {
+			/* The log could not be written yet, e.g.,
+			because recovery is running */
+			os_event_wait_time_low(log_sys->writer_event,
+					       1000000, sig_count);
+			continue;
+		}
+
+		log_wait_events_set(log_sys->write_events,
+				    old_write_lsn, log_sys->write_lsn);
+
+		if (log_sys->flushed_to_disk_lsn > old_flushed_lsn) {
+			/* With O_DSYNC the write also flushed the log */
+			log_wait_events_set(log_sys->flush_events,
+					    old_flushed_lsn,
+					    log_sys->flushed_to_disk_lsn);
+		} else {
+			os_event_set(log_sys->flusher_event);
+		}
+	}
+
+	mutex_enter(&log_sys->w_mutex);
+	log_sys->n_writer_threads--;
+	mutex_exit(&log_sys->w_mutex);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/******************************************************************//**
+The log flusher thread flushes the written log to disk.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_flusher_thread)(
+/*===============================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_flusher_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	while (log_sys->writer_threads_active) {
+		ib_int64_t	sig_count = os_event_reset(
+			log_sys->flusher_event);
+		lsn_t		old_write_lsn = log_sys->write_lsn;
+		lsn_t		old_flushed_lsn = log_sys->flushed_to_disk_lsn;
+		lsn_t		write_lsn;
+
+		if (srv_flush_log_at_trx_commit != 1
+		    && !log_sys->flush_requested) {
+			os_event_wait_time_low(log_sys->flusher_event,
+					       1000000, sig_count);
+			continue;
+		}
+
+		/* Clear the request and read write_lsn while holding
+		log_sys->w_mutex, which write_lsn is advanced under: a
+		thread requests the flush after it has seen its write done,
+		so either we flush its write now or the request stays for
+		the next round. */
+		mutex_enter(&log_sys->w_mutex);
+		log_sys->flush_requested = false;
+		write_lsn = log_sys->write_lsn;
+		mutex_exit(&log_sys->w_mutex);
+
+		if (write_lsn <= old_flushed_lsn) {
+			os_event_wait_time_low(log_sys->flusher_event,
+					       1000000, sig_count);
+			continue;
+		}
+
+		log_write_up_to_low(write_lsn, TRUE);
+
+		/* The flush also writes what the log writer thread
+		has not written yet */
+		if (log_sys->write_lsn > old_write_lsn) {
+			log_wait_events_set(log_sys->write_events,
+					    old_write_lsn,
+					    log_sys->write_lsn);
+		}
+
+		log_wait_events_set(log_sys->flush_events,
+				    old_flushed_lsn,
+				    log_sys->flushed_to_disk_lsn);
+	}
+
+	mutex_enter(&log_sys->w_mutex);
+	log_sys->n_writer_threads--;
+	mutex_exit(&log_sys->w_mutex);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/******************************************************************//**
+Starts the log writer and log flusher threads. After this, the threads
+calling log_write_up_to() leave the redo log write and flush to them. */
+UNIV_INTERN
+void
+log_start_writer_threads(void)
+/*==========================*/
+{
+	ut_ad(!srv_read_only_mode);
+
+	if (log_sys->writer_threads_active) {
+		return;
+	}
+
+#if UNIV_WORD_SIZE > 7
+	log_sys->n_writer_threads = 2;
+	log_sys->writer_threads_active = true;
+
+	os_thread_create(log_writer_thread, NULL, NULL);
+	os_thread_create(log_flusher_thread, NULL, NULL);
+#else
+	/* log_write_up_to() reads the lsn values without log_sys->mutex
+	to decide whether to wait for the threads: do the writes in the
+	committing threads instead. */
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"innodb_log_writer_threads is not supported "
+		"on this platform");
+#endif /* UNIV_WORD_SIZE > 7 */
+}
+
+/******************************************************************//**
+Stops the log writer and log flusher threads and waits for them to exit.
+log_write_up_to() writes and flushes the log itself afterwards. It is safe
+to call this when the threads have not been started. */
+UNIV_INTERN
+void
+log_stop_writer_threads(void)
+/*=========================*/
+{
+	log_sys->writer_threads_active = false;
+
+	while (log_sys->n_writer_threads > 0) {
+		os_event_set(log_sys->writer_event);
+		os_event_set(log_sys->flusher_event);
+		os_thread_sleep(10000);
+	}
+
+	/* Wake up the threads that were waiting for the log writer
+	threads: they will do the write or flush themselves. */
+	log_wait_events_set(log_sys->write_events, 0, LSN_MAX);
+	log_wait_events_set(log_sys->flush_events, 0, LSN_MAX);
+}
+
 /****************************************************************//**
 Does a syncronous flush of the log buffer to disk. */
 UNIV_INTERN
@@ -1541,6 +2101,16 @@ log_buffer_sync_in_background(
 
 	mutex_exit(&(log_sys->mutex));
 
+	if (log_sys->writer_threads_active) {
+		/* Only wake up the threads, do not wait for them */
+		if (flush) {
+			log_sys->flush_requested = true;
+		}
+
+		os_event_set(log_sys->writer_event);
+		return;
+	}
+
 	log_write_up_to(lsn, flush);
 }
 
@@ -3171,6 +3741,10 @@ loop:
 		}
 	}
 
+	/* The page cleaner has done its last log writes: from now on
+	the shutdown writes and flushes the log itself. */
+	log_stop_writer_threads();
+
 	mutex_enter(&log_sys->mutex);
 	server_busy = log_sys->n_pending_checkpoint_writes
 #ifdef UNIV_LOG_ARCHIVE
@@ -3549,12 +4123,29 @@ log_shutdown(void)
 	log_sys->buf_pair_ptr[1] = NULL;
 
 	log_sys->buf = NULL;
+	mem_free(log_sys->recent_closed);
+	log_sys->recent_closed = NULL;
 	mem_free(log_sys->checkpoint_buf_ptr);
 	log_sys->checkpoint_buf_ptr = NULL;
 	log_sys->checkpoint_buf = NULL;
 
 	os_event_free(log_sys->flush_event);
 
+	log_stop_writer_threads();
+
+	os_event_free(log_sys->writer_event);
+	os_event_free(log_sys->flusher_event);
+
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		os_event_free(log_sys->write_events[i]);
+		os_event_free(log_sys->flush_events[i]);
+	}
+
+	mem_free(log_sys->write_events);
+	log_sys->write_events = NULL;
+	mem_free(log_sys->flush_events);
+	log_sys->flush_events = NULL;
+
 	rw_lock_free(&log_sys->checkpoint_lock);
 
 	mutex_free(&log_sys->mutex);
@@ -53,6 +53,7 @@ Created 9/20/1997 Heikki Tuuri
 # include "srv0srv.h"
 # include "srv0start.h"
 # include "trx0roll.h"
+# include "trx0purge.h"
 # include "row0merge.h"
 # include "sync0sync.h"
 #else /* !UNIV_HOTBACKUP */
@@ -71,6 +72,10 @@ this must be less than UNIV_PAGE_SIZE as it is stored in the buffer pool */
 /** Read-ahead area in applying log records to file pages */
 #define RECV_READ_AHEAD_AREA	32
 
+/** Interval in seconds between the progress reports of a log record
+application batch */
+#define RECV_APPLY_REPORT_INTERVAL	10
+
 /** The recovery system */
 UNIV_INTERN recv_sys_t*	recv_sys = NULL;
 /** TRUE when applying redo log records during crash recovery; FALSE
@@ -166,6 +171,7 @@ UNIV_INTERN mysql_pfs_key_t	recv_sys_mutex_key;
 #ifndef UNIV_HOTBACKUP
 # ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t	recv_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	recv_apply_thread_key;
 # endif /* UNIV_PFS_THREAD */
 
 # ifdef UNIV_PFS_MUTEX
@@ -1470,6 +1476,15 @@ recv_add_to_hash_table(
 		return;
 	}
 
+#ifndef UNIV_HOTBACKUP
+	if (trx_purge_undo_trunc_is_recovering(space)) {
+		/* The undo tablespace was truncated: it is recreated
+		instead of recovered */
+
+		return;
+	}
+#endif /* !UNIV_HOTBACKUP */
+
 	len = rec_end - body;
 
 	recv = static_cast<recv_t*>(
@@ -1833,9 +1848,137 @@ recv_read_in_area(
 	return(n);
 }
 
+/*******************************************************************//**
+Prints the progress of the running log record application batch to the
+error log, at most every RECV_APPLY_REPORT_INTERVAL seconds unless forced.
+The caller must own recv_sys->mutex. */
+static
+void
+recv_apply_report_progress(
+/*=======================*/
+	bool	force)	/*!< in: true to report regardless of the time
+			of the last report */
+{
+	ib_time_t	now = ut_time();
+	ulint		n_done;
+	ulint		elapsed;
+
+	ut_ad(mutex_own(&recv_sys->mutex));
+
+	if (!force
+	    && now - recv_sys->apply_report_time
+	    < RECV_APPLY_REPORT_INTERVAL) {
+		return;
+	}
+
+	recv_sys->apply_report_time = now;
+
+	n_done = recv_sys->apply_n_pages - recv_sys->n_addrs;
+	elapsed = (ulint) (now - recv_sys->apply_start_time);
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Applied log records to %lu of %lu pages (%lu%%)"
+		" in %lu seconds, %lu pages/s",
+		(ulong) n_done, (ulong) recv_sys->apply_n_pages,
+		(ulong) (n_done * 100 / ut_max(recv_sys->apply_n_pages, 1)),
+		(ulong) elapsed,
+		(ulong) (n_done / ut_max(elapsed, 1)));
+}
+
+/*******************************************************************//**
+Applies the log records of the cells of recv_sys->addr_hash that no other
+thread has taken yet. The pages that are in the buffer pool are recovered
+here; the others are read in, together with the other pages to recover
+around them, and recovered in the i/o handler threads when the reads
+complete. The caller must own recv_sys->mutex. */
+static
+void
+recv_apply_hashed_cells(void)
+/*=========================*/
+{
+	ulint	n_cells = hash_get_n_cells(recv_sys->addr_hash);
+
+	ut_ad(mutex_own(&recv_sys->mutex));
+
+	while (recv_sys->apply_next_cell < n_cells) {
+		ulint		i = recv_sys->apply_next_cell++;
+		recv_addr_t*	recv_addr;
+
+		for (recv_addr = static_cast<recv_addr_t*>(
+				HASH_GET_FIRST(recv_sys->addr_hash, i));
+		     recv_addr != 0;
+		     recv_addr = static_cast<recv_addr_t*>(
+				HASH_GET_NEXT(addr_hash, recv_addr))) {
+
+			ulint	space = recv_addr->space;
+			ulint	zip_size = fil_space_get_zip_size(space);
+			ulint	page_no = recv_addr->page_no;
+
+			if (recv_addr->state != RECV_NOT_PROCESSED) {
+				continue;
+			}
+
+			mutex_exit(&(recv_sys->mutex));
+
+			if (buf_page_peek(space, page_no)) {
+				buf_block_t*	block;
+				mtr_t		mtr;
+
+				mtr_start(&mtr);
+
+				block = buf_page_get(
+					space, zip_size, page_no,
+					RW_X_LATCH, &mtr);
+				buf_block_dbg_add_level(
+					block, SYNC_NO_ORDER_CHECK);
+
+				recv_recover_page(FALSE, block);
+				mtr_commit(&mtr);
+			} else {
+				recv_read_in_area(space, zip_size,
+						  page_no);
+			}
+
+			mutex_enter(&(recv_sys->mutex));
+		}
+
+		recv_apply_report_progress(false);
+	}
+}
+
+/******************************************************************//**
+Recovery apply worker thread: helps the thread running
+recv_apply_hashed_log_recs() to go through the hashed log records.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(recv_apply_thread)(
+/*==============================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(recv_apply_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	mutex_enter(&recv_sys->mutex);
+
+	recv_apply_hashed_cells();
+
+	recv_sys->n_apply_threads--;
+
+	mutex_exit(&recv_sys->mutex);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /*******************************************************************//**
 Empties the hash table of stored log records, applying them to appropriate
-pages. */
+pages. The hash cells, and thus the pages, are shared between this thread
+and innodb_recovery_apply_threads - 1 recovery apply worker threads. */
 UNIV_INTERN
 void
 recv_apply_hashed_log_recs(
@@ -1850,10 +1993,7 @@ recv_apply_hashed_log_recs(
 				the caller must in this case own the log
 				mutex */
 {
-	recv_addr_t* recv_addr;
-	ulint	i;
 	ibool	has_printed	= FALSE;
-	mtr_t	mtr;
 loop:
 	mutex_enter(&(recv_sys->mutex));
 
@@ -1875,78 +2015,44 @@ loop:
 	recv_sys->apply_log_recs = TRUE;
 	recv_sys->apply_batch_on = TRUE;
 
-	for (i = 0; i < hash_get_n_cells(recv_sys->addr_hash); i++) {
-
-		for (recv_addr = static_cast<recv_addr_t*>(
-				HASH_GET_FIRST(recv_sys->addr_hash, i));
-		     recv_addr != 0;
-		     recv_addr = static_cast<recv_addr_t*>(
-				HASH_GET_NEXT(addr_hash, recv_addr))) {
-
-			ulint	space = recv_addr->space;
-			ulint	zip_size = fil_space_get_zip_size(space);
-			ulint	page_no = recv_addr->page_no;
-
-			if (recv_addr->state == RECV_NOT_PROCESSED) {
-				if (!has_printed) {
-					ib_logf(IB_LOG_LEVEL_INFO,
-						"Starting an apply batch"
-						" of log records"
-						" to the database...");
-					fputs("InnoDB: Progress in percent: ",
-					      stderr);
-					has_printed = TRUE;
-				}
-
-				mutex_exit(&(recv_sys->mutex));
-
-				if (buf_page_peek(space, page_no)) {
-					buf_block_t*	block;
-
-					mtr_start(&mtr);
-
-					block = buf_page_get(
-						space, zip_size, page_no,
-						RW_X_LATCH, &mtr);
-					buf_block_dbg_add_level(
-						block, SYNC_NO_ORDER_CHECK);
+	recv_sys->apply_next_cell = 0;
+	recv_sys->apply_n_pages = recv_sys->n_addrs;
+	recv_sys->apply_start_time = ut_time();
+	recv_sys->apply_report_time = recv_sys->apply_start_time;
 
-					recv_recover_page(FALSE, block);
-					mtr_commit(&mtr);
-				} else {
-					recv_read_in_area(space, zip_size,
-							  page_no);
-				}
-
-				mutex_enter(&(recv_sys->mutex));
-			}
-		}
+	if (recv_sys->n_addrs != 0) {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Starting an apply batch of log records"
+			" to the database...");
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Applying log records to %lu pages"
+			" with %lu threads",
+			(ulong) recv_sys->n_addrs,
+			(ulong) srv_n_recovery_apply_threads);
+		has_printed = TRUE;
 
-		if (has_printed
-		    && (i * 100) / hash_get_n_cells(recv_sys->addr_hash)
-		    != ((i + 1) * 100)
-		    / hash_get_n_cells(recv_sys->addr_hash)) {
+		recv_sys->n_apply_threads = srv_n_recovery_apply_threads - 1;
 
-			fprintf(stderr, "%lu ", (ulong)
-				((i * 100)
-				 / hash_get_n_cells(recv_sys->addr_hash)));
+		for (ulint i = 1; i < srv_n_recovery_apply_threads; i++) {
+			os_thread_create(recv_apply_thread, NULL, NULL);
 		}
 	}
 
-	/* Wait until all the pages have been processed */
+	recv_apply_hashed_cells();
 
-	while (recv_sys->n_addrs != 0) {
+	/* Wait until the worker threads are done with the hash table
+	and all the pages have been processed */
+
+	while (recv_sys->n_apply_threads != 0 || recv_sys->n_addrs != 0) {
 
 		mutex_exit(&(recv_sys->mutex));
 
-		os_thread_sleep(500000);
+		os_thread_sleep(recv_sys->n_apply_threads != 0
+				? 10000 : 500000);
 
 		mutex_enter(&(recv_sys->mutex));
-	}
-
-	if (has_printed) {
 
-		fprintf(stderr, "\n");
+		recv_apply_report_progress(false);
 	}
 
 	if (!allow_ibuf) {
@@ -1990,7 +2096,8 @@ loop:
 	recv_sys_empty_hash();
 
 	if (has_printed) {
-		fprintf(stderr, "InnoDB: Apply batch completed\n");
+		recv_apply_report_progress(true);
+		ib_logf(IB_LOG_LEVEL_INFO, "Apply batch completed");
 	}
 
 	mutex_exit(&(recv_sys->mutex));
@@ -3328,6 +3435,7 @@ recv_recovery_from_checkpoint_start_func(
 	}
 
 	log_sys->lsn = recv_sys->recovered_lsn;
+	log_sys->closed_lsn = log_sys->lsn;
 
 	ut_memcpy(log_sys->buf, recv_sys->last_block, OS_FILE_LOG_BLOCK_SIZE);
 
@@ -3552,6 +3660,7 @@ recv_reset_logs(
 
 	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
 	log_sys->lsn += LOG_BLOCK_HDR_SIZE;
+	log_sys->closed_lsn = log_sys->lsn;
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
 		    (log_sys->lsn - log_sys->last_checkpoint_lsn));
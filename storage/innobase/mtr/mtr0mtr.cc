@@ -70,11 +70,6 @@ mtr_memo_slot_release_func(
 	void*	object = slot->object;
 	slot->object = NULL;
 
-	/* slot release is a local operation for the current mtr.
-	We must not be holding the flush_order mutex while
-	doing this. */
-	ut_ad(!log_flush_order_mutex_own());
-
 	switch (slot->type) {
 	case MTR_MEMO_PAGE_S_FIX:
 	case MTR_MEMO_PAGE_X_FIX:
@@ -152,7 +147,6 @@ mtr_memo_slot_note_modification(
 	if (slot->object != NULL && slot->type == MTR_MEMO_PAGE_X_FIX) {
 		buf_block_t*	block = (buf_block_t*) slot->object;
 
-		ut_ad(!mtr->made_dirty || log_flush_order_mutex_own());
 		buf_flush_note_modification(block, mtr);
 	}
 }
@@ -197,40 +191,11 @@ mtr_memo_note_modifications(
 }
 
 /************************************************************//**
-Append the dirty pages to the flush list. */
-static
-void
-mtr_add_dirtied_pages_to_flush_list(
-/*================================*/
-	mtr_t*	mtr)	/*!< in/out: mtr */
-{
-	ut_ad(!srv_read_only_mode);
-
-	/* No need to acquire log_flush_order_mutex if this mtr has
-	not dirtied a clean page. log_flush_order_mutex is used to
-	ensure ordered insertions in the flush_list. We need to
-	insert in the flush_list iff the page in question was clean
-	before modifications. */
-	if (mtr->made_dirty) {
-		log_flush_order_mutex_enter();
-	}
-
-	/* It is now safe to release the log mutex because the
-	flush_order mutex will ensure that we are the first one
-	to insert into the flush list. */
-	log_release();
-
-	if (mtr->modifications) {
-		mtr_memo_note_modifications(mtr);
-	}
-
-	if (mtr->made_dirty) {
-		log_flush_order_mutex_exit();
-	}
-}
-
-/************************************************************//**
-Writes the contents of a mini-transaction log, if any, to the database log. */
+Writes the contents of a mini-transaction log, if any, to the database log
+and adds the dirty pages to the flush lists. The space in the log buffer is
+reserved while holding the log mutex, but the log records are copied to it
+and the pages are added to the flush lists concurrently with other
+mini-transactions. */
 static
 void
 mtr_log_reserve_and_write(
@@ -238,8 +203,9 @@ mtr_log_reserve_and_write(
 	mtr_t*	mtr)	/*!< in/out: mtr */
 {
 	dyn_array_t*	mlog;
-	ulint		data_size;
+	ulint		len;
 	byte*		first_data;
+	byte*		ptr;
 
 	ut_ad(!srv_read_only_mode);
 
@@ -254,50 +220,42 @@ mtr_log_reserve_and_write(
 				     | MLOG_SINGLE_REC_FLAG);
 	}
 
-	if (mlog->heap == NULL) {
-		ulint	len;
-
-		len = mtr->log_mode != MTR_LOG_NO_REDO
-			? dyn_block_get_used(mlog) : 0;
-
-		mtr->end_lsn = log_reserve_and_write_fast(
-			first_data, len, &mtr->start_lsn);
-
-		if (mtr->end_lsn) {
-
-			/* Success. We have the log mutex.
-			Add pages to flush list and exit */
-			mtr_add_dirtied_pages_to_flush_list(mtr);
-
-			return;
-		}
+	if (mtr->log_mode == MTR_LOG_ALL) {
+		len = dyn_array_get_data_size(mlog);
+	} else {
+		ut_ad(mtr->log_mode == MTR_LOG_NONE
+		      || mtr->log_mode == MTR_LOG_NO_REDO);
+		len = 0;
 	}
 
-	data_size = dyn_array_get_data_size(mlog);
-
-	/* Open the database log for log_write_low */
-	mtr->start_lsn = log_reserve_and_open(data_size);
-
-	if (mtr->log_mode == MTR_LOG_ALL) {
+	mtr->start_lsn = log_buffer_reserve(len, &ptr, &mtr->end_lsn);
 
+	if (len > 0) {
 		for (dyn_block_t* block = mlog;
 		     block != 0;
 		     block = dyn_array_get_next_block(mlog, block)) {
 
-			log_write_low(
-				dyn_block_get_data(block),
+			ptr = log_buffer_write(
+				ptr, dyn_block_get_data(block),
 				dyn_block_get_used(block));
 		}
+	}
 
-	} else {
-		ut_ad(mtr->log_mode == MTR_LOG_NONE
-		      || mtr->log_mode == MTR_LOG_NO_REDO);
-		/* Do nothing */
+	log_buffer_write_completed();
+
+	if (len > 0) {
+		/* Do not add the pages to the flush lists too far
+		ahead of the mtrs that have not done it yet */
+		log_recent_closed_wait(mtr->start_lsn);
 	}
 
-	mtr->end_lsn = log_close();
+	if (mtr->modifications) {
+		mtr_memo_note_modifications(mtr);
+	}
 
-	mtr_add_dirtied_pages_to_flush_list(mtr);
+	if (len > 0) {
+		log_recent_closed_add(mtr->start_lsn, mtr->end_lsn);
+	}
 }
 #endif /* !UNIV_HOTBACKUP */
 
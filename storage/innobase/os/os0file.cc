@@ -2090,6 +2090,33 @@ os_file_close_no_error_handling(
 }
 #endif /* UNIV_HOTBACKUP */
 
+/***********************************************************************//**
+Gets the largest write that the storage of a file reports to write
+atomically, that is, never torn by a crash or a power loss. Such writes
+must be aligned and bypass the file system cache (O_DIRECT).
+@return	atomic write unit in bytes, or 0 if the storage does not report
+one */
+UNIV_INTERN
+ulint
+os_file_get_atomic_write_size(
+/*==========================*/
+	const char*	name)	/*!< in: file path */
+{
+#if defined(__linux__) && defined(STATX_WRITE_ATOMIC)
+	struct statx	stx;
+
+	if (statx(AT_FDCWD, name, 0, STATX_WRITE_ATOMIC, &stx) == 0
+	    && (stx.stx_mask & STATX_WRITE_ATOMIC)) {
+
+		return(stx.stx_atomic_write_unit_max);
+	}
+#else
+	UT_NOT_USED(name);
+#endif /* __linux__ && STATX_WRITE_ATOMIC */
+
+	return(0);
+}
+
 /***********************************************************************//**
 Gets a file size.
 @return	file size, or (os_offset_t) -1 on failure */
@@ -2215,6 +2242,39 @@ os_file_set_eof(
 #endif /* __WIN__ */
 }
 
+/***********************************************************************//**
+Truncates or extends a file to the given size.
+@return	TRUE if success */
+UNIV_INTERN
+ibool
+os_file_truncate(
+/*=============*/
+	const char*	name,	/*!< in: name of the file */
+	os_file_t	file,	/*!< in: handle to the file */
+	os_offset_t	size)	/*!< in: new file size in bytes */
+{
+#ifdef __WIN__
+	LARGE_INTEGER	length;
+
+	length.QuadPart = size;
+
+	if (SetFilePointerEx(file, length, NULL, FILE_BEGIN)
+	    && SetEndOfFile(file)) {
+
+		return(TRUE);
+	}
+#else /* __WIN__ */
+	if (!ftruncate(file, size)) {
+
+		return(TRUE);
+	}
+#endif /* __WIN__ */
+
+	os_file_handle_error_no_exit(name, "truncate", FALSE);
+
+	return(FALSE);
+}
+
 #ifndef __WIN__
 /***********************************************************************//**
 Wrapper to fsync(2) that retries the call on some errors.
@@ -43,6 +43,7 @@ using namespace std;
 #include "btr0cur.h"
 #include "page0types.h"
 #include "log0recv.h"
+#include "ut0lz.h"
 #include "zlib.h"
 #ifndef UNIV_HOTBACKUP
 # include "buf0buf.h"
@@ -74,6 +75,11 @@ UNIV_INTERN mysql_pfs_key_t		page_zip_stat_per_index_mutex_key;
 /* Compression level to be used by zlib. Settable by user. */
 UNIV_INTERN uint	page_zip_level = DEFAULT_COMPRESSION_LEVEL;
 
+/* Codec to be used for pages compressed from now on. Settable by user.
+Every page records its codec, so that pages compressed with any codec
+can be read back. */
+UNIV_INTERN ulong	page_zip_codec = PAGE_ZIP_CODEC_ZLIB;
+
 /* Whether or not to log compressed page images to avoid possible
 compression algorithm changes in zlib. */
 UNIV_INTERN my_bool	page_zip_log_pages = true;
@@ -761,6 +767,294 @@ page_zip_set_alloc(
 	strm->opaque = heap;
 }
 
+/** First byte of the compressed payload of a page that was compressed
+with PAGE_ZIP_CODEC_LZ. The low nibble of the first byte of a zlib stream
+is always Z_DEFLATED, so this cannot start the payload of a page that
+was compressed with PAGE_ZIP_CODEC_ZLIB. */
+#define PAGE_ZIP_LZ_MAGIC	0x4C
+
+/** Size of the header of a PAGE_ZIP_CODEC_LZ payload: PAGE_ZIP_LZ_MAGIC,
+followed by the uncompressed length of the index information, the
+uncompressed length of the stream and the length of the payload after
+the header, 2 bytes each */
+#define PAGE_ZIP_LZ_HEADER	7
+
+/** Compressed page stream. page_zip_compress() and page_zip_decompress()
+drive all codecs through the zlib interface. Codecs other than zlib
+compress or decompress the whole stream at once: page_zip_deflate()
+collects the uncompressed stream in buf until Z_FINISH, and
+page_zip_inflate() decompresses the payload into buf when it reads the
+header and returns it piece by piece, stopping at the end of the index
+information on Z_BLOCK like inflate() stops at the end of a block. */
+struct page_zip_stream_t {
+	z_stream	zs;	/*!< zlib stream; next_in, avail_in,
+				total_in, next_out, avail_out and
+				total_out are maintained for all codecs.
+				This must be the first field, so that
+				page_zip_deflate() and page_zip_inflate()
+				can find the rest from a z_stream* */
+	ulint		codec;	/*!< page_zip_codec_t */
+	mem_heap_t*	heap;	/*!< memory heap for buf */
+	byte*		buf;	/*!< the uncompressed stream */
+	ulint		size;	/*!< size of buf */
+	ulint		len;	/*!< length of the uncompressed stream */
+	ulint		pos;	/*!< bytes of buf returned by inflate */
+	ulint		block;	/*!< length of the index information,
+				the first block of the stream */
+	ulint		zip_len;/*!< length of the payload after the
+				header that inflate has not consumed */
+	void*		work;	/*!< work area of the compressor */
+};
+
+/**********************************************************************//**
+Initialize a compressed page stream for compressing a page.
+The caller must set next_out and avail_out. */
+static
+void
+page_zip_deflate_init(
+/*==================*/
+	page_zip_stream_t*	strm,	/*!< out: compressed page stream */
+	ulint			level,	/*!< in: zlib compression level */
+	ulint			codec,	/*!< in: page_zip_codec_t */
+	mem_heap_t*		heap)	/*!< in: memory heap to use */
+{
+	strm->codec = codec;
+	strm->heap = heap;
+
+	switch (codec) {
+	case PAGE_ZIP_CODEC_ZLIB:
+		page_zip_set_alloc(&strm->zs, heap);
+
+		if (deflateInit2(&strm->zs, static_cast<int>(level),
+				 Z_DEFLATED, UNIV_PAGE_SIZE_SHIFT,
+				 MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+			ut_error;
+		}
+		return;
+	case PAGE_ZIP_CODEC_LZ:
+		strm->zs.total_in = strm->zs.total_out = 0;
+		/* The index information and the records */
+		strm->size = 2 * UNIV_PAGE_SIZE;
+		strm->buf = static_cast<byte*>(
+			mem_heap_alloc(heap, strm->size));
+		strm->len = strm->block = 0;
+		strm->work = mem_heap_alloc(heap, UT_LZ_WORK_SIZE);
+		return;
+	}
+
+	ut_error;
+}
+
+/**********************************************************************//**
+Compress data like deflate().
+@return	deflate() status: Z_OK, Z_STREAM_END, Z_BUF_ERROR, ... */
+static
+int
+page_zip_deflate(
+/*=============*/
+	z_streamp	zs,	/*!< in/out: zs of a page_zip_stream_t */
+	int		flush)	/*!< in: Z_NO_FLUSH, Z_FULL_FLUSH after
+				the index information, or Z_FINISH */
+{
+	page_zip_stream_t*	strm
+		= reinterpret_cast<page_zip_stream_t*>(zs);
+	ulint			n;
+
+	if (strm->codec == PAGE_ZIP_CODEC_ZLIB) {
+		return(deflate(zs, flush));
+	}
+
+	if (zs->avail_in > strm->size - strm->len) {
+		return(Z_BUF_ERROR);
+	}
+
+	memcpy(strm->buf + strm->len, zs->next_in, zs->avail_in);
+	strm->len += zs->avail_in;
+	zs->next_in += zs->avail_in;
+	zs->total_in += zs->avail_in;
+	zs->avail_in = 0;
+
+	switch (flush) {
+	case Z_NO_FLUSH:
+		return(Z_OK);
+	case Z_FULL_FLUSH:
+		ut_ad(!strm->block);
+		strm->block = strm->len;
+		return(Z_OK);
+	}
+
+	ut_ad(flush == Z_FINISH);
+
+	if (zs->avail_out <= PAGE_ZIP_LZ_HEADER) {
+		return(Z_BUF_ERROR);
+	}
+
+	n = ut_lz_compress(strm->buf, strm->len,
+			   zs->next_out + PAGE_ZIP_LZ_HEADER,
+			   zs->avail_out - PAGE_ZIP_LZ_HEADER, strm->work);
+
+	if (!n) {
+		return(Z_BUF_ERROR);
+	}
+
+	zs->next_out[0] = PAGE_ZIP_LZ_MAGIC;
+	mach_write_to_2(zs->next_out + 1, strm->block);
+	mach_write_to_2(zs->next_out + 3, strm->len);
+	mach_write_to_2(zs->next_out + 5, n);
+
+	n += PAGE_ZIP_LZ_HEADER;
+	zs->next_out += n;
+	zs->avail_out -= static_cast<uInt>(n);
+	zs->total_out += static_cast<uLong>(n);
+
+	return(Z_STREAM_END);
+}
+
+/**********************************************************************//**
+Free a compressed page stream that was used for compressing a page.
+@return	deflateEnd() status: Z_OK, ... */
+static
+int
+page_zip_deflate_end(
+/*=================*/
+	page_zip_stream_t*	strm)	/*!< in/out: compressed page stream */
+{
+	if (strm->codec == PAGE_ZIP_CODEC_ZLIB) {
+		return(deflateEnd(&strm->zs));
+	}
+
+	return(Z_OK);
+}
+
+/**********************************************************************//**
+Initialize a compressed page stream for decompressing a page.
+The codec is determined from the first byte at next_in.
+@return	inflateInit2() status: Z_OK, ... */
+static
+int
+page_zip_inflate_init(
+/*==================*/
+	page_zip_stream_t*	strm,	/*!< in/out: compressed page stream
+					with next_in and avail_in set */
+	mem_heap_t*		heap)	/*!< in: memory heap to use */
+{
+	strm->heap = heap;
+
+	if (!strm->zs.avail_in || *strm->zs.next_in != PAGE_ZIP_LZ_MAGIC) {
+		strm->codec = PAGE_ZIP_CODEC_ZLIB;
+		page_zip_set_alloc(&strm->zs, heap);
+		return(inflateInit2(&strm->zs, UNIV_PAGE_SIZE_SHIFT));
+	}
+
+	strm->codec = PAGE_ZIP_CODEC_LZ;
+	strm->zs.total_in = strm->zs.total_out = 0;
+	strm->zs.msg = NULL;
+	return(Z_OK);
+}
+
+/**********************************************************************//**
+Decompress data like inflate().
+@return	inflate() status: Z_OK, Z_STREAM_END, Z_BUF_ERROR, ... */
+static
+int
+page_zip_inflate(
+/*=============*/
+	z_streamp	zs,	/*!< in/out: zs of a page_zip_stream_t */
+	int		flush)	/*!< in: Z_BLOCK to stop after the header
+				and after the index information,
+				Z_SYNC_FLUSH or Z_FINISH */
+{
+	page_zip_stream_t*	strm
+		= reinterpret_cast<page_zip_stream_t*>(zs);
+	ulint			n;
+
+	if (strm->codec == PAGE_ZIP_CODEC_ZLIB) {
+		return(inflate(zs, flush));
+	}
+
+	if (!zs->total_in) {
+		/* Decode the header and the whole payload. */
+		if (zs->avail_in < PAGE_ZIP_LZ_HEADER) {
+			return(Z_DATA_ERROR);
+		}
+
+		strm->block = mach_read_from_2(zs->next_in + 1);
+		strm->len = mach_read_from_2(zs->next_in + 3);
+		strm->zip_len = mach_read_from_2(zs->next_in + 5);
+
+		if (strm->block > strm->len
+		    || strm->zip_len > zs->avail_in - PAGE_ZIP_LZ_HEADER) {
+			return(Z_DATA_ERROR);
+		}
+
+		strm->buf = static_cast<byte*>(
+			mem_heap_alloc(strm->heap, strm->len));
+
+		if (ut_lz_decompress(zs->next_in + PAGE_ZIP_LZ_HEADER,
+				     strm->zip_len, strm->buf, strm->len)
+		    != strm->len) {
+			return(Z_DATA_ERROR);
+		}
+
+		strm->pos = 0;
+		zs->next_in += PAGE_ZIP_LZ_HEADER;
+		zs->avail_in -= PAGE_ZIP_LZ_HEADER;
+		zs->total_in = PAGE_ZIP_LZ_HEADER;
+
+		if (flush == Z_BLOCK) {
+			return(Z_OK);
+		}
+	}
+
+	n = ut_min(static_cast<ulint>(zs->avail_out),
+		   (flush == Z_BLOCK && strm->pos < strm->block
+		    ? strm->block : strm->len) - strm->pos);
+
+	memcpy(zs->next_out, strm->buf + strm->pos, n);
+	strm->pos += n;
+	zs->next_out += n;
+	zs->avail_out -= static_cast<uInt>(n);
+	zs->total_out += static_cast<uLong>(n);
+
+	if (flush == Z_BLOCK) {
+		return(Z_OK);
+	} else if (strm->pos < strm->len) {
+		return(n ? Z_OK : Z_BUF_ERROR);
+	}
+
+	/* The end of the stream was reached. Consume the payload,
+	so that next_in points to the modification log. */
+	if (strm->zip_len > zs->avail_in) {
+		return(Z_DATA_ERROR);
+	}
+
+	zs->next_in += strm->zip_len;
+	zs->avail_in -= static_cast<uInt>(strm->zip_len);
+	zs->total_in += static_cast<uLong>(strm->zip_len);
+	strm->zip_len = 0;
+
+	return(Z_STREAM_END);
+}
+
+/**********************************************************************//**
+Free a compressed page stream that was used for decompressing a page.
+@return	inflateEnd() status: Z_OK, ... */
+static
+int
+page_zip_inflate_end(
+/*=================*/
+	z_streamp	zs)	/*!< in/out: zs of a page_zip_stream_t */
+{
+	page_zip_stream_t*	strm
+		= reinterpret_cast<page_zip_stream_t*>(zs);
+
+	if (strm->codec == PAGE_ZIP_CODEC_ZLIB) {
+		return(inflateEnd(zs));
+	}
+
+	return(Z_OK);
+}
+
 #if 0 || defined UNIV_DEBUG || defined UNIV_ZIP_DEBUG
 /** Symbol for enabling compression and decompression diagnostics */
 # define PAGE_ZIP_COMPRESS_DBG
@@ -777,7 +1071,7 @@ as a log file name generator. */
 UNIV_INTERN unsigned	page_zip_compress_log;
 
 /**********************************************************************//**
-Wrapper for deflate().  Log the operation if page_zip_compress_dbg is set.
+Wrapper for page_zip_deflate().  Log the operation if page_zip_compress_dbg is set.
 @return	deflate() status: Z_OK, Z_BUF_ERROR, ... */
 static
 int
@@ -794,21 +1088,20 @@ page_zip_compress_deflate(
 	if (UNIV_LIKELY_NULL(logfile)) {
 		fwrite(strm->next_in, 1, strm->avail_in, logfile);
 	}
-	status = deflate(strm, flush);
+	status = page_zip_deflate(strm, flush);
 	if (UNIV_UNLIKELY(page_zip_compress_dbg)) {
 		fprintf(stderr, " -> %d\n", status);
 	}
 	return(status);
 }
 
-/* Redefine deflate(). */
-# undef deflate
-/** Debug wrapper for the zlib compression routine deflate().
+/** Debug wrapper for the compression routine page_zip_deflate().
 Log the operation if page_zip_compress_dbg is set.
 @param strm	in/out: compressed stream
 @param flush	in: flushing method
 @return		deflate() status: Z_OK, Z_BUF_ERROR, ... */
-# define deflate(strm, flush) page_zip_compress_deflate(logfile, strm, flush)
+# define page_zip_deflate(strm, flush)					\
+	page_zip_compress_deflate(logfile, strm, flush)
 /** Declaration of the logfile parameter */
 # define FILE_LOGFILE FILE* logfile,
 /** The logfile parameter */
@@ -856,7 +1149,7 @@ page_zip_compress_node_ptrs(
 			rec - REC_N_NEW_EXTRA_BYTES - c_stream->next_in);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -869,7 +1162,7 @@ page_zip_compress_node_ptrs(
 			rec_offs_data_size(offsets) - REC_NODE_PTR_SIZE);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -914,7 +1207,7 @@ page_zip_compress_sec(
 		if (UNIV_LIKELY(c_stream->avail_in)) {
 			UNIV_MEM_ASSERT_RW(c_stream->next_in,
 					   c_stream->avail_in);
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -978,7 +1271,7 @@ page_zip_compress_clust_ext(
 				src - c_stream->next_in);
 
 			if (c_stream->avail_in) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1007,7 +1300,7 @@ page_zip_compress_clust_ext(
 			c_stream->avail_in = static_cast<uInt>(
 				src - c_stream->next_in);
 			if (UNIV_LIKELY(c_stream->avail_in)) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1105,7 +1398,7 @@ page_zip_compress_clust(
 			- c_stream->next_in);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 
 				goto func_exit;
@@ -1153,7 +1446,7 @@ page_zip_compress_clust(
 				src - c_stream->next_in);
 
 			if (c_stream->avail_in) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1181,7 +1474,7 @@ page_zip_compress_clust(
 			rec + rec_offs_data_size(offsets) - c_stream->next_in);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 
 				goto func_exit;
@@ -1209,7 +1502,9 @@ page_zip_compress(
 	ulint		level,	/*!< in: compression level */
 	mtr_t*		mtr)	/*!< in: mini-transaction, or NULL */
 {
-	z_stream	c_stream;
+	page_zip_stream_t	c_strm;
+	z_stream&	c_stream = c_strm.zs;
+	ulint		codec	= level >> PAGE_ZIP_LEVEL_BITS;
 	int		err;
 	ulint		n_fields;/* number of index fields needed */
 	byte*		fields;	/*!< index field information */
@@ -1328,12 +1623,9 @@ page_zip_compress(
 	buf_end = buf + page_zip_get_size(page_zip) - PAGE_DATA;
 
 	/* Compress the data payload. */
-	page_zip_set_alloc(&c_stream, heap);
-
-	err = deflateInit2(&c_stream, static_cast<int>(level),
-			   Z_DEFLATED, UNIV_PAGE_SIZE_SHIFT,
-			   MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
-	ut_a(err == Z_OK);
+	page_zip_deflate_init(&c_strm,
+			      level & ((1 << PAGE_ZIP_LEVEL_BITS) - 1),
+			      codec, heap);
 
 	c_stream.next_out = buf;
 	/* Subtract the space reserved for uncompressed data. */
@@ -1377,7 +1669,7 @@ page_zip_compress(
 	}
 
 	UNIV_MEM_ASSERT_RW(c_stream.next_in, c_stream.avail_in);
-	err = deflate(&c_stream, Z_FULL_FLUSH);
+	err = page_zip_deflate(&c_stream, Z_FULL_FLUSH);
 	if (err != Z_OK) {
 		goto zlib_error;
 	}
@@ -1431,11 +1723,11 @@ page_zip_compress(
 	ut_a(c_stream.avail_in <= UNIV_PAGE_SIZE - PAGE_ZIP_START - PAGE_DIR);
 
 	UNIV_MEM_ASSERT_RW(c_stream.next_in, c_stream.avail_in);
-	err = deflate(&c_stream, Z_FINISH);
+	err = page_zip_deflate(&c_stream, Z_FINISH);
 
 	if (UNIV_UNLIKELY(err != Z_STREAM_END)) {
 zlib_error:
-		deflateEnd(&c_stream);
+		page_zip_deflate_end(&c_strm);
 		mem_heap_free(heap);
 err_exit:
 #ifdef PAGE_ZIP_COMPRESS_DBG
@@ -1461,7 +1753,7 @@ err_exit:
 		return(FALSE);
 	}
 
-	err = deflateEnd(&c_stream);
+	err = page_zip_deflate_end(&c_strm);
 	ut_a(err == Z_OK);
 
 	ut_ad(buf + c_stream.total_out == c_stream.next_out);
@@ -2240,7 +2532,7 @@ page_zip_decompress_node_ptrs(
 
 		ut_ad(d_stream->avail_out < UNIV_PAGE_SIZE
 		      - PAGE_ZIP_START - PAGE_DIR);
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 			page_zip_decompress_heap_no(
 				d_stream, rec, heap_status);
@@ -2277,7 +2569,7 @@ page_zip_decompress_node_ptrs(
 		d_stream->avail_out =static_cast<uInt>(
 			rec_offs_data_size(offsets) - REC_NODE_PTR_SIZE);
 
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 			goto zlib_done;
 		case Z_OK:
@@ -2316,12 +2608,12 @@ page_zip_decompress_node_ptrs(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_node_ptrs:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2329,7 +2621,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2431,7 +2723,7 @@ page_zip_decompress_sec(
 			rec - REC_N_NEW_EXTRA_BYTES - d_stream->next_out);
 
 		if (UNIV_LIKELY(d_stream->avail_out)) {
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 				page_zip_decompress_heap_no(
 					d_stream, rec, heap_status);
@@ -2473,12 +2765,12 @@ page_zip_decompress_sec(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_sec:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2486,7 +2778,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2579,7 +2871,7 @@ page_zip_decompress_clust_ext(
 			d_stream->avail_out = static_cast<uInt>(
 				dst - d_stream->next_out);
 
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2610,7 +2902,7 @@ page_zip_decompress_clust_ext(
 
 			d_stream->avail_out = static_cast<uInt>(
 				dst - d_stream->next_out);
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2690,7 +2982,7 @@ page_zip_decompress_clust(
 
 		ut_ad(d_stream->avail_out < UNIV_PAGE_SIZE
 		      - PAGE_ZIP_START - PAGE_DIR);
-		err = inflate(d_stream, Z_SYNC_FLUSH);
+		err = page_zip_inflate(d_stream, Z_SYNC_FLUSH);
 		switch (err) {
 		case Z_STREAM_END:
 			page_zip_decompress_heap_no(
@@ -2749,7 +3041,7 @@ page_zip_decompress_clust(
 			d_stream->avail_out = static_cast<uInt>(
 				dst - d_stream->next_out);
 
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2779,7 +3071,7 @@ page_zip_decompress_clust(
 		d_stream->avail_out = static_cast<uInt>(
 			rec_get_end(rec, offsets) - d_stream->next_out);
 
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 		case Z_OK:
 		case Z_BUF_ERROR:
@@ -2809,12 +3101,12 @@ page_zip_decompress_clust(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_clust:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2822,7 +3114,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2966,7 +3258,8 @@ page_zip_decompress(
 				page header fields that should not change
 				after page creation */
 {
-	z_stream	d_stream;
+	page_zip_stream_t	d_strm;
+	z_stream&	d_stream = d_strm.zs;
 	dict_index_t*	index	= NULL;
 	rec_t**		recs;	/*!< dense page directory, sorted by address */
 	ulint		n_dense;/* number of user records on the page */
@@ -3050,8 +3343,6 @@ zlib_error:
 	memcpy(page + (PAGE_NEW_SUPREMUM - REC_N_NEW_EXTRA_BYTES + 1),
 	       supremum_extra_data, sizeof supremum_extra_data);
 
-	page_zip_set_alloc(&d_stream, heap);
-
 	d_stream.next_in = page_zip->data + PAGE_DATA;
 	/* Subtract the space reserved for
 	the page header and the end marker of the modification log. */
@@ -3060,20 +3351,19 @@ zlib_error:
 	d_stream.next_out = page + PAGE_ZIP_START;
 	d_stream.avail_out = UNIV_PAGE_SIZE - PAGE_ZIP_START;
 
-	if (UNIV_UNLIKELY(inflateInit2(&d_stream, UNIV_PAGE_SIZE_SHIFT)
-			  != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_init(&d_strm, heap) != Z_OK)) {
 		ut_error;
 	}
 
-	/* Decode the zlib header and the index information. */
-	if (UNIV_UNLIKELY(inflate(&d_stream, Z_BLOCK) != Z_OK)) {
+	/* Decode the stream header and the index information. */
+	if (UNIV_UNLIKELY(page_zip_inflate(&d_stream, Z_BLOCK) != Z_OK)) {
 
 		page_zip_fail(("page_zip_decompress:"
 			       " 1 inflate(Z_BLOCK)=%s\n", d_stream.msg));
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(&d_stream, Z_BLOCK) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(&d_stream, Z_BLOCK) != Z_OK)) {
 
 		page_zip_fail(("page_zip_decompress:"
 			       " 2 inflate(Z_BLOCK)=%s\n", d_stream.msg));
@@ -4652,7 +4942,8 @@ page_zip_reorganize(
 	/* Restore logging. */
 	mtr_set_log_mode(mtr, log_mode);
 
-	if (!page_zip_compress(page_zip, page, index, page_zip_level, mtr)) {
+	if (!page_zip_compress(page_zip, page, index,
+			       page_zip_level_get(), mtr)) {
 
 #ifndef UNIV_HOTBACKUP
 		buf_block_free(temp_block);
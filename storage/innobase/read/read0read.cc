@@ -32,6 +32,10 @@ Created 2/16/1997 Heikki Tuuri
 #include "srv0srv.h"
 #include "trx0sys.h"
 
+/** Number of times read_view_open_now_low() tries to copy the transaction
+state without trx_sys->mutex before it falls back to acquiring the mutex */
+#define READ_VIEW_SNAPSHOT_ATTEMPTS	8
+
 /*
 -------------------------------------------------------------------------------
 FACT A: Cursor read view on a secondary index sees only committed versions
@@ -167,11 +171,18 @@ For details see: row_vers_old_has_index_entry() and row_purge_poss_sec()
 Some additional issues:
 
 What if trx_sys->view_list == NULL and some transaction T1 and Purge both
-try to open read_view at same time. Only one can acquire trx_sys->mutex.
+try to open read_view at same time. Only one can acquire trx_sys->view_mutex.
 In which order will the views be opened? Should it matter? If no, why?
 
-The order does not matter. No new transactions can be created and no running
-transaction can commit or rollback (or free views).
+The order does not matter. The state copied into a view only moves forward,
+so the view opened second is never older than the first one. The state is
+copied without trx_sys->view_mutex, which only protects the view list, so
+purge may take its view while T1 is copying. T1 remembers
+trx_sys->n_purge_views before the copy and compares it when it adds its
+view to the list under trx_sys->view_mutex. If purge has taken a view in
+between, that view may be newer than the copy, and T1 copies the state
+again while holding trx_sys->view_mutex, which keeps purge out until the
+view is on the list.
 */
 
 /*********************************************************************//**
@@ -233,7 +244,7 @@ read_view_clone(
 	trx_id_t*	old_descriptors;
 	ulint		old_max_descr;
 
-	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(mutex_own(&trx_sys->view_mutex));
 
 	clone = read_view_create_low(view->n_descr, prebuilt_clone);
 
@@ -266,7 +277,7 @@ read_view_add(
 	read_view_t*	elem;
 	read_view_t*	prev_elem;
 
-	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(mutex_own(&trx_sys->view_mutex));
 	ut_ad(read_view_validate(view));
 
 	/* Find the correct slot for insertion. */
@@ -287,32 +298,68 @@ read_view_add(
 }
 
 /*********************************************************************//**
-Opens a read view where exactly the transactions serialized before this
-point in time are seen in the view.
-@return	own: read view struct */
+Copies the state that decides which transactions a new read view sees: the
+active transaction descriptors except the one of the creating transaction,
+trx_sys->max_trx_id and the smallest serialisation number. The copy is made
+without trx_sys->mutex and validated against trx_sys->descr_version, so it
+fails if a writer modified the state meanwhile.
+@return	true if a consistent copy was made */
 static
-read_view_t*
-read_view_open_now_low(
-/*===================*/
+bool
+read_view_snapshot(
+/*===============*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
 					transaction, or 0 used in purge */
-	read_view_t*&	view,		/*!< in/out: pre-allocated view array or
+	read_view_t*&	view)		/*!< in/out: pre-allocated view array or
 					NULL if a new one needs to be created */
-	bool		is_purge)	/*!< in: flag to identify if purge
-					thread or not */
 {
+	ulint		version;
+	ulint		n_max;
+	ulint		n_used;
+	const trx_id_t*	descriptors;
+	trx_id_t	max_trx_id;
+	trx_id_t	serial_min_no;
 	trx_id_t*	descr;
-	ulint		i;
 
-	ut_ad(mutex_own(&trx_sys->mutex));
+	version = trx_sys->descr_version;
 
-	if (view && view->cached) {
-		read_view_remove(view, true);
+	if (version & 1) {
+
+		return(false);
 	}
 
-	view = read_view_create_low(trx_sys->descr_n_used, view);
+	os_rmb;
 
-	ut_ad(!view->cached);
+	/* trx_reserve_descriptor() publishes a grown array before its
+	size, so the array read below has room for n_max elements even if
+	it is being replaced. Retired arrays are not freed until shutdown. */
+	n_max = trx_sys->descr_n_max;
+
+	os_rmb;
+
+	descriptors = trx_sys->descriptors;
+	n_used = trx_sys->descr_n_used;
+	max_trx_id = trx_sys->max_trx_id;
+	serial_min_no = trx_sys->serial_min_no;
+
+	if (UNIV_UNLIKELY(n_used > n_max)) {
+
+		return(false);
+	}
+
+	view = read_view_create_low(n_used, view);
+
+	if (UNIV_LIKELY(n_used > 0)) {
+		memcpy(view->descriptors, descriptors,
+		       n_used * sizeof(trx_id_t));
+	}
+
+	os_rmb;
+
+	if (trx_sys->descr_version != version) {
+
+		return(false);
+	}
 
 	view->undo_no = 0;
 	view->type = VIEW_NORMAL;
@@ -320,50 +367,27 @@ read_view_open_now_low(
 
 	/* No future transactions should be visible in the view */
 
-	view->low_limit_no = trx_sys->max_trx_id;
+	view->low_limit_no = max_trx_id;
 	view->low_limit_id = view->low_limit_no;
 
-	descr = trx_find_descriptor(trx_sys->descriptors,
-				    trx_sys->descr_n_used,
+	descr = trx_find_descriptor(view->descriptors, view->n_descr,
 				    cr_trx_id);
 
 	if (UNIV_LIKELY(descr != NULL)) {
-		ut_ad(trx_sys->descr_n_used > 0);
-		ut_ad(view->n_descr > 0);
-
 		/* trx_id belong to current trx should be excluded. */
-		view->n_descr--;
-		i = descr - trx_sys->descriptors;
-	} else {
-		i = trx_sys->descr_n_used;
-	}
+		ut_memmove(descr, descr + 1,
+			   (view->descriptors + view->n_descr - descr - 1)
+			   * sizeof(trx_id_t));
 
-	if (UNIV_LIKELY(i > 0)) {
-		/* Copy the [0; i - 1] range */
-		memcpy(view->descriptors, trx_sys->descriptors,
-		       i * sizeof(trx_id_t));
-	}
-
-	if (UNIV_UNLIKELY(i + 1 < trx_sys->descr_n_used)) {
-		/* Copy the [i+1; descr_n_used] range */
-		memcpy(view->descriptors + i,
-		       trx_sys->descriptors + i + 1,
-		       (trx_sys->descr_n_used - i - 1) *
-		       sizeof(trx_id_t));
+		view->n_descr--;
 	}
 
 	/* NOTE that a transaction whose trx number is < trx_sys->max_trx_id can
 	still be active, if it is in the middle of its commit! Note that when a
 	transaction starts, we initialize trx->no to IB_ULONGLONG_MAX. */
 
-	if (UT_LIST_GET_LEN(trx_sys->trx_serial_list) > 0) {
-		trx_id_t	trx_no;
-
-		trx_no = UT_LIST_GET_FIRST(trx_sys->trx_serial_list)->no;
-
-		if (trx_no < view->low_limit_no) {
-			view->low_limit_no = trx_no;
-		}
+	if (serial_min_no < view->low_limit_no) {
+		view->low_limit_no = serial_min_no;
 	}
 
 	if (UNIV_LIKELY(view->n_descr > 0)) {
@@ -373,11 +397,104 @@ read_view_open_now_low(
 		view->up_limit_id = view->low_limit_id;
 	}
 
-	/* Purge views are not added to the view list. */
-	if (!is_purge > 0) {
-		read_view_add(view);
+	return(true);
+}
+
+/*********************************************************************//**
+Opens a read view where exactly the transactions serialized before this
+point in time are seen in the view. The transaction state is normally
+copied without acquiring trx_sys->mutex; the mutex is only taken when
+concurrent transaction starts and commits keep invalidating the copy.
+The view is not added to the view list.
+@return	own: read view struct */
+static
+read_view_t*
+read_view_open_now_low(
+/*===================*/
+	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
+					transaction, or 0 used in purge */
+	read_view_t*&	view)		/*!< in/out: pre-allocated view array or
+					NULL if a new one needs to be created */
+{
+	ulint		n_attempts;
+
+	ut_ad(view == NULL || !view->cached);
+
+	n_attempts = 0;
+
+	DBUG_EXECUTE_IF("read_view_snapshot_use_mutex",
+			n_attempts = READ_VIEW_SNAPSHOT_ATTEMPTS;);
+
+	for (;; n_attempts++) {
+
+		if (n_attempts >= READ_VIEW_SNAPSHOT_ATTEMPTS) {
+			bool	success;
+
+			/* Writers hold trx_sys->mutex while they modify
+			the state, so the copy cannot fail under it. */
+			mutex_enter(&trx_sys->mutex);
+			success = read_view_snapshot(cr_trx_id, view);
+			mutex_exit(&trx_sys->mutex);
+
+			ut_a(success);
+			break;
+		}
+
+		if (read_view_snapshot(cr_trx_id, view)) {
+			break;
+		}
+
+		UT_RELAX_CPU();
+	}
+
+	ut_ad(!view->cached);
+
+	return(view);
+}
+
+/*********************************************************************//**
+Opens a read view for a transaction and adds it to the view list. The
+transaction state is copied without trx_sys->view_mutex, which is only
+acquired to modify the view list.
+@return	own: read view struct */
+static
+read_view_t*
+read_view_open_now_add(
+/*===================*/
+	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
+					transaction */
+	read_view_t*&	view)		/*!< in/out: pre-allocated view array or
+					NULL if a new one needs to be created */
+{
+	ulint		n_purge_views;
+
+	if (view && view->cached) {
+		/* The view is overwritten below, so purge must not see
+		it on the list any more. */
+		mutex_enter(&trx_sys->view_mutex);
+		read_view_remove(view, true);
+		mutex_exit(&trx_sys->view_mutex);
 	}
 
+	n_purge_views = trx_sys->n_purge_views;
+
+	os_rmb;
+
+	view = read_view_open_now_low(cr_trx_id, view);
+
+	mutex_enter(&trx_sys->view_mutex);
+
+	if (UNIV_UNLIKELY(trx_sys->n_purge_views != n_purge_views)) {
+		/* Purge took a view that may be newer than the copy.
+		Copy the state again; purge cannot take another view
+		before this one is on the list. */
+		view = read_view_open_now_low(cr_trx_id, view);
+	}
+
+	read_view_add(view);
+
+	mutex_exit(&trx_sys->view_mutex);
+
 	return(view);
 }
 
@@ -408,13 +525,7 @@ read_view_open_now(
 		}
 	}
 
-	mutex_enter(&trx_sys->mutex);
-
-	view = read_view_open_now_low(cr_trx_id, view, false);
-
-	mutex_exit(&trx_sys->mutex);
-
-	return(view);
+	return(read_view_open_now_add(cr_trx_id, view));
 }
 
 /*********************************************************************//**
@@ -439,7 +550,7 @@ read_view_purge_open(
 	trx_id_t	creator_trx_id;
 	ulint		insert_done	= 0;
 
-	mutex_enter(&trx_sys->mutex);
+	mutex_enter(&trx_sys->view_mutex);
 
 	oldest_view = UT_LIST_GET_LAST(trx_sys->view_list);
 
@@ -450,9 +561,13 @@ read_view_purge_open(
 
 	if (oldest_view == NULL) {
 
-		view = read_view_open_now_low(0, prebuilt_view, true);
+		/* Purge views are not added to the view list. */
+		view = read_view_open_now_low(0, prebuilt_view);
 
-		mutex_exit(&trx_sys->mutex);
+		os_wmb;
+		trx_sys->n_purge_views++;
+
+		mutex_exit(&trx_sys->view_mutex);
 
 		return(view);
 	}
@@ -463,7 +578,10 @@ read_view_purge_open(
 
 	ut_ad(read_view_validate(oldest_view));
 
-	mutex_exit(&trx_sys->mutex);
+	os_wmb;
+	trx_sys->n_purge_views++;
+
+	mutex_exit(&trx_sys->view_mutex);
 
 	creator_trx_id = oldest_view->creator_trx_id;
 
@@ -531,9 +649,9 @@ read_view_close_for_mysql(
 		transaction. */
 		read_view_remove(trx->global_read_view, false);
 	} else {
-		mutex_enter(&trx_sys->mutex);
+		mutex_enter(&trx_sys->view_mutex);
 		read_view_remove(trx->global_read_view, true);
-		mutex_exit(&trx_sys->mutex);
+		mutex_exit(&trx_sys->view_mutex);
 	}
 
 	trx->read_view = NULL;
@@ -593,9 +711,9 @@ read_view_free(
 	}
 
 	if (view->cached) {
-		mutex_enter(&trx_sys->mutex);
+		mutex_enter(&trx_sys->view_mutex);
 		read_view_remove(view, true);
-		mutex_exit(&trx_sys->mutex);
+		mutex_exit(&trx_sys->view_mutex);
 	}
 
 	os_atomic_decrement_lint(&srv_read_views_memory,
@@ -642,17 +760,18 @@ read_cursor_view_create_for_mysql(
 
 	cr_trx->n_mysql_tables_in_use = 0;
 
-	mutex_enter(&trx_sys->mutex);
+	curview->read_view = NULL;
+	curview->read_view = read_view_open_now_add(
+		UINT64_UNDEFINED, curview->read_view);
 
-	curview->read_view = read_view_open_now_low(
-		UINT64_UNDEFINED, curview->read_view, false);
+	mutex_enter(&trx_sys->view_mutex);
 
 	view = curview->read_view;
 	view->undo_no = cr_trx->undo_no;
 	view->type = VIEW_HIGH_GRANULARITY;
 	view->creator_trx_id = UINT64_UNDEFINED;
 
-	mutex_exit(&trx_sys->mutex);
+	mutex_exit(&trx_sys->view_mutex);
 
 	return(curview);
 }
@@ -675,9 +794,9 @@ read_cursor_view_close_for_mysql(
 	belong to this transaction */
 	trx->n_mysql_tables_in_use += curview->n_mysql_tables_in_use;
 
-	mutex_enter(&trx_sys->mutex);
+	mutex_enter(&trx_sys->view_mutex);
 	read_view_remove(curview->read_view, true);
-	mutex_exit(&trx_sys->mutex);
+	mutex_exit(&trx_sys->view_mutex);
 
 	read_view_free(curview->read_view);
 
@@ -699,7 +818,7 @@ read_cursor_set_for_mysql(
 {
 	ut_a(trx);
 
-	mutex_enter(&trx_sys->mutex);
+	mutex_enter(&trx_sys->view_mutex);
 
 	if (UNIV_LIKELY(curview != NULL)) {
 		trx->read_view = curview->read_view;
@@ -709,5 +828,5 @@ read_cursor_set_for_mysql(
 
 	ut_ad(read_view_validate(trx->read_view));
 
-	mutex_exit(&trx_sys->mutex);
+	mutex_exit(&trx_sys->view_mutex);
 }
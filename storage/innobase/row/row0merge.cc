@@ -25,6 +25,7 @@ Completed by Sunny Bains and Marko Makela
 *******************************************************/
 
 #include "row0merge.h"
+#include "btr0bulk.h"
 #include "row0ext.h"
 #include "row0log.h"
 #include "row0ins.h"
@@ -39,6 +40,8 @@ Completed by Sunny Bains and Marko Makela
 #include "handler0alter.h"
 #include "ha_prototypes.h"
 
+#include <vector>
+
 /* Ignore posix_fadvise() on those platforms where it does not exist */
 #if defined __WIN__
 # define posix_fadvise(fd, offset, len, advice) /* nothing */
@@ -2445,9 +2448,98 @@ row_merge_copy_blobs(
 	}
 }
 
+/** A sorted run of index entries read by row_merge_insert_index_tuples() */
+struct row_merge_src_t {
+	int			fd;	/*!< file descriptor */
+	ulint			foffs;	/*!< offset of the block in block[] */
+	row_merge_block_t*	block;	/*!< file buffer */
+	const byte*		b;	/*!< position of the next record
+					in block[] */
+	mrec_buf_t*		buf;	/*!< buffer for a record that spans
+					two blocks */
+	const mrec_t*		mrec;	/*!< current record, or NULL at the
+					end of the run */
+	ulint*			offsets;/*!< offsets of mrec */
+};
+
+/*********************************************************************//**
+Reads the next record of a sorted run.
+@return	false if the file is corrupted */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+bool
+row_merge_src_next(
+/*===============*/
+	row_merge_src_t*	src,	/*!< in/out: sorted run */
+	const dict_index_t*	index)	/*!< in: index of the entries */
+{
+	src->b = row_merge_read_rec(src->block, src->buf, src->b, index,
+				    src->fd, &src->foffs, &src->mrec,
+				    src->offsets);
+
+	/* Without b, mrec is NULL at the end of the run, or else the
+	file could not be read. */
+	return(src->b != NULL || src->mrec == NULL);
+}
+
+/*********************************************************************//**
+Compares the current records of two sorted runs.
+@return	true if the record of a sorts before the record of b */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+bool
+row_merge_src_less(
+/*===============*/
+	const row_merge_src_t*	a,	/*!< in: sorted run */
+	const row_merge_src_t*	b,	/*!< in: sorted run */
+	const dict_index_t*	index)	/*!< in: index of the entries */
+{
+	return(cmp_rec_rec_simple(a->mrec, b->mrec, a->offsets, b->offsets,
+				  index, NULL) < 0);
+}
+
+/*********************************************************************//**
+Restores the heap order of the sorted runs after the current record of
+the run at the root has changed. */
+static MY_ATTRIBUTE((nonnull))
+void
+row_merge_src_sift(
+/*===============*/
+	row_merge_src_t**	heap,	/*!< in/out: binary min-heap of
+					the runs that have records */
+	ulint			n,	/*!< in: number of elements in heap */
+	const dict_index_t*	index)	/*!< in: index of the entries */
+{
+	ulint	i = 0;
+
+	for (;;) {
+		ulint	child = 2 * i + 1;
+
+		if (child >= n) {
+			return;
+		}
+
+		if (child + 1 < n
+		    && row_merge_src_less(heap[child + 1], heap[child],
+					  index)) {
+			child++;
+		}
+
+		if (!row_merge_src_less(heap[child], heap[i], index)) {
+			return;
+		}
+
+		row_merge_src_t*	src = heap[i];
+		heap[i] = heap[child];
+		heap[child] = src;
+		i = child;
+	}
+}
+
 /********************************************************************//**
-Read sorted file containing index data tuples and insert these data
-tuples to the index
+Read sorted files containing index data tuples and insert these data
+tuples to the index. Each file contains one sorted run, and when there
+are several, their entries are merged on the fly. The index tree of an
+uncompressed table is built bottom-up by btr_bulk_insert();
+ROW_FORMAT=COMPRESSED pages are filled by inserting the tuples one by one.
 @return	DB_SUCCESS or error number */
 static MY_ATTRIBUTE((nonnull, warn_unused_result))
 dberr_t
@@ -2456,46 +2548,116 @@ row_merge_insert_index_tuples(
 	trx_id_t		trx_id,	/*!< in: transaction identifier */
 	dict_index_t*		index,	/*!< in: index */
 	const dict_table_t*	old_table,/*!< in: old table */
-	int			fd,	/*!< in: file descriptor */
-	row_merge_block_t*	block)	/*!< in/out: file buffer */
+	const merge_file_t*	files,	/*!< in: sorted runs; the ones
+					whose fd is -1 are empty */
+	ulint			n_files,/*!< in: size of files[] */
+	row_merge_block_t*	block,	/*!< in/out: file buffer, used
+					when there is only one file */
+	const row_merge_dup_t*	dup)	/*!< in: for reporting duplicate
+					keys between the files */
 {
-	const byte*		b;
 	mem_heap_t*		heap;
 	mem_heap_t*		tuple_heap;
 	mem_heap_t*		ins_heap;
 	dberr_t			error = DB_SUCCESS;
-	ulint			foffs = 0;
-	ulint*			offsets;
-	mrec_buf_t*		buf;
+	row_merge_src_t*	srcs;
+	row_merge_src_t**	src_heap;
+	row_merge_src_t*	src = NULL;
+	ulint			n_heap = 0;
+	row_merge_block_t*	src_blocks = NULL;
+	ulint			src_blocks_size = 0;
+	btr_bulk_t*		bulk = NULL;
 	DBUG_ENTER("row_merge_insert_index_tuples");
 
 	ut_ad(!srv_read_only_mode);
 	ut_ad(!(index->type & DICT_FTS));
 	ut_ad(trx_id);
+	ut_ad(n_files > 0);
+	ut_ad(dup->index == index);
+
+	if (n_files > 1) {
+		/* Each run is read through a block of its own. */
+		src_blocks_size = n_files * srv_sort_buf_size;
+		src_blocks = static_cast<row_merge_block_t*>(
+			os_mem_alloc_large(&src_blocks_size));
+
+		if (src_blocks == NULL) {
+			DBUG_RETURN(DB_OUT_OF_MEMORY);
+		}
+	}
+
+	if (!dict_table_zip_size(index->table)) {
+		bulk = btr_bulk_create(index, trx_id);
+	}
 
 	tuple_heap = mem_heap_create(1000);
 
 	{
 		ulint i	= 1 + REC_OFFS_HEADER_SIZE
 			+ dict_index_get_n_fields(index);
-		heap = mem_heap_create(sizeof *buf + i * sizeof *offsets);
-		ins_heap = mem_heap_create(sizeof *buf + i * sizeof *offsets);
-		offsets = static_cast<ulint*>(
-			mem_heap_alloc(heap, i * sizeof *offsets));
-		offsets[0] = i;
-		offsets[1] = dict_index_get_n_fields(index);
-	}
+		heap = mem_heap_create(
+			n_files * (sizeof(mrec_buf_t) + i * sizeof(ulint)));
+		ins_heap = mem_heap_create(
+			sizeof(mrec_buf_t) + i * sizeof(ulint));
 
-	b = block;
+		srcs = static_cast<row_merge_src_t*>(
+			mem_heap_alloc(heap, n_files * sizeof *srcs));
+		src_heap = static_cast<row_merge_src_t**>(
+			mem_heap_alloc(heap, n_files * sizeof *src_heap));
 
-	if (!row_merge_read(fd, foffs, block)) {
-		error = DB_CORRUPTION;
-	} else {
-		buf = static_cast<mrec_buf_t*>(
-			mem_heap_alloc(heap, sizeof *buf));
+		for (ulint j = 0; j < n_files; j++) {
+			row_merge_src_t*	s = &srcs[j];
+
+			if (files[j].fd < 0) {
+				continue;
+			}
+
+			s->fd = files[j].fd;
+			s->foffs = 0;
+			s->block = n_files > 1
+				? &src_blocks[j * srv_sort_buf_size]
+				: block;
+			s->b = s->block;
+			s->buf = static_cast<mrec_buf_t*>(
+				mem_heap_alloc(heap, sizeof *s->buf));
+			s->offsets = static_cast<ulint*>(
+				mem_heap_alloc(heap, i * sizeof *s->offsets));
+			s->offsets[0] = i;
+			s->offsets[1] = dict_index_get_n_fields(index);
+
+			if (!row_merge_read(s->fd, 0, s->block)
+			    || !row_merge_src_next(s, index)) {
+				error = DB_CORRUPTION;
+				break;
+			}
+
+			if (s->mrec == NULL) {
+				continue;
+			}
+
+			/* Add the run to the heap, sifting it up. */
+			ulint	k = n_heap++;
+
+			while (k > 0) {
+				ulint	parent = (k - 1) / 2;
+
+				if (!row_merge_src_less(
+					    s, src_heap[parent], index)) {
+					break;
+				}
+
+				src_heap[k] = src_heap[parent];
+				k = parent;
+			}
+
+			src_heap[k] = s;
+		}
+	}
 
+	if (error == DB_SUCCESS) {
 		for (;;) {
 			const mrec_t*	mrec;
+			ulint*		offsets;
 			dtuple_t*	dtuple;
 			ulint		n_ext;
 			big_rec_t*	big_rec;
@@ -2503,16 +2665,51 @@ row_merge_insert_index_tuples(
 			btr_cur_t	cursor;
 			mtr_t		mtr;
 
-			b = row_merge_read_rec(block, buf, b, index,
-					       fd, &foffs, &mrec, offsets);
-			if (UNIV_UNLIKELY(!b)) {
-				/* End of list, or I/O error */
-				if (mrec) {
+			if (src != NULL) {
+				/* Advance the run of the previous
+				record, which was kept until now because
+				the tuple pointed to it. */
+				if (!row_merge_src_next(src, index)) {
 					error = DB_CORRUPTION;
+					break;
+				}
+
+				if (src->mrec == NULL) {
+					src_heap[0] = src_heap[--n_heap];
 				}
+
+				row_merge_src_sift(src_heap, n_heap, index);
+			}
+
+			if (n_heap == 0) {
+				/* End of all the runs */
 				break;
 			}
 
+			src = src_heap[0];
+			mrec = src->mrec;
+			offsets = src->offsets;
+
+			if (n_heap > 1 && dict_index_is_unique(index)) {
+				/* A duplicate between two runs is
+				the smallest record of another run. */
+				const row_merge_src_t*	next = src_heap[1];
+
+				if (n_heap > 2
+				    && row_merge_src_less(
+					    src_heap[2], next, index)) {
+					next = src_heap[2];
+				}
+
+				if (!cmp_rec_rec_simple(
+					    mrec, next->mrec,
+					    offsets, next->offsets,
+					    index, dup->table)) {
+					error = DB_DUPLICATE_KEY;
+					break;
+				}
+			}
+
 			dict_index_t*	old_index
 				= dict_table_get_first_index(old_table);
 
@@ -2563,6 +2760,18 @@ row_merge_insert_index_tuples(
 			}
 
 			ut_ad(dtuple_validate(dtuple));
+
+			if (bulk != NULL) {
+				error = btr_bulk_insert(bulk, dtuple);
+
+				if (error != DB_SUCCESS) {
+					goto err_exit;
+				}
+
+				mem_heap_empty(tuple_heap);
+				continue;
+			}
+
 			log_free_check();
 
 			mtr_start(&mtr);
@@ -2581,7 +2790,7 @@ row_merge_insert_index_tuples(
 
 			if (!page_rec_is_infimum(rec)) {
 				ulint*	rec_offsets = rec_get_offsets(
-					rec, index, offsets,
+					rec, index, NULL,
 					ULINT_UNDEFINED, &tuple_heap);
 				ut_ad(cmp_dtuple_rec(dtuple, rec, rec_offsets)
 				      > 0);
@@ -2653,10 +2862,18 @@ row_merge_insert_index_tuples(
 	}
 
 err_exit:
+	if (bulk != NULL) {
+		error = btr_bulk_finish(bulk, error);
+	}
+
 	mem_heap_free(tuple_heap);
 	mem_heap_free(ins_heap);
 	mem_heap_free(heap);
 
+	if (src_blocks != NULL) {
+		os_mem_free_large(src_blocks, src_blocks_size);
+	}
+
 	DBUG_RETURN(error);
 }
 
@@ -3602,175 +3819,1204 @@ row_merge_drop_table(
 	return(row_drop_table_for_mysql(table->name, trx, false, false));
 }
 
-/*********************************************************************//**
-Build indexes on a table by reading a clustered index,
-creating a temporary file containing index entries, merge sorting
-these index entries and inserting sorted index entries to indexes.
-@return	DB_SUCCESS or error code */
-UNIV_INTERN
-dberr_t
-row_merge_build_indexes(
-/*====================*/
-	trx_t*		trx,		/*!< in: transaction */
-	dict_table_t*	old_table,	/*!< in: table where rows are
-					read from */
-	dict_table_t*	new_table,	/*!< in: table where indexes are
-					created; identical to old_table
-					unless creating a PRIMARY KEY */
-	bool		online,		/*!< in: true if creating indexes
+/** Number of key ranges per thread that row_merge_pscan_split() aims
+at, so that threads finishing early can take over more of the scan */
+#define ROW_MERGE_PSCAN_RANGES_PER_THREAD	4
+
+/** Shared state of the threads that scan the clustered index by key
+range to create secondary indexes without rebuilding the table. Each
+thread takes the next range nobody has scanned yet, adds the index
+entries of its rows to its own sort buffers, and writes them as sorted
+runs to its own temporary file for each index. When no range is left,
+the thread merge sorts its files into one run each, which
+row_merge_insert_index_tuples() merges when loading the index. */
+struct row_merge_pscan_t {
+	os_fast_mutex_t	mutex;		/*!< protects next, error,
+					error_key_num, n_started and
+					n_threads */
+	os_fast_mutex_t	dup_mutex;	/*!< serializes the sorting of
+					unique index entries, which
+					reports duplicates into the MySQL
+					row buffer of the table; acquired
+					before mutex */
+	ulint		next;		/*!< next range to scan */
+	dberr_t		error;		/*!< first error; no more rows
+					are read after an error */
+	ulint		error_key_num;	/*!< trx->error_key_num of error */
+	ulint		n_started;	/*!< number of threads that have
+					picked their files */
+	ulint		n_threads;	/*!< number of running helper
+					threads */
+	os_event_t	done;		/*!< set when n_threads drops
+					to 0 */
+	trx_t*		trx;		/*!< transaction */
+	const dict_table_t*
+			table;		/*!< table where rows are read
+					from */
+	struct TABLE*	mysql_table;	/*!< MySQL table, for reporting
+					duplicate keys */
+	bool		online;		/*!< true if creating indexes
 					online */
-	dict_index_t**	indexes,	/*!< in: indexes to be created */
-	const ulint*	key_numbers,	/*!< in: MySQL key numbers */
-	ulint		n_indexes,	/*!< in: size of indexes[] */
-	struct TABLE*	table,		/*!< in/out: MySQL table, for
-					reporting erroneous key value
-					if applicable */
-	const dtuple_t*	add_cols,	/*!< in: default values of
-					added columns, or NULL */
-	const ulint*	col_map,	/*!< in: mapping of old column
-					numbers to new ones, or NULL
-					if old_table == new_table */
-	ulint		add_autoinc,	/*!< in: number of added
-					AUTO_INCREMENT column, or
-					ULINT_UNDEFINED if none is added */
-	ib_sequence_t&	sequence)	/*!< in: autoinc instance if
-					add_autoinc != ULINT_UNDEFINED */
+	dict_index_t**	indexes;	/*!< indexes to be created */
+	const ulint*	key_numbers;	/*!< MySQL key numbers */
+	ulint		n_indexes;	/*!< size of indexes[] */
+	const char*	path;		/*!< location of the temporary
+					files */
+	const dtuple_t**
+			bounds;		/*!< the first key of each range
+					and of the range after the last
+					one; NULL before the first and
+					after the last key */
+	ulint		n_ranges;	/*!< number of ranges */
+	merge_file_t*	files;		/*!< n_indexes * n_runs files; the
+					files of index i written by thread
+					t are files[i * n_runs + t] */
+	ulint		n_runs;		/*!< number of threads, including
+					the one running
+					row_merge_build_indexes() */
+};
+
+/*********************************************************************//**
+Splits the clustered index of a table into key ranges of about the same
+size, by picking node pointers from the highest level of the tree that
+has enough of them for n ranges.
+@return	bounds of the ranges, see row_merge_pscan_t::bounds */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+const dtuple_t**
+row_merge_pscan_split(
+/*==================*/
+	dict_index_t*	index,		/*!< in: clustered index */
+	ulint		n,		/*!< in: wanted number of ranges */
+	mem_heap_t*	heap,		/*!< in/out: memory heap for the
+					bounds */
+	ulint*		n_ranges)	/*!< out: number of ranges */
 {
-	merge_file_t*		merge_files;
-	row_merge_block_t*	block;
-	ulint			block_size;
-	ulint			i;
-	ulint			j;
-	dberr_t			error;
-	int			tmpfd = -1;
-	dict_index_t*		fts_sort_idx = NULL;
-	fts_psort_t*		psort_info = NULL;
-	fts_psort_t*		merge_info = NULL;
-	ib_int64_t		sig_count = 0;
-	bool			fts_psort_initiated = false;
-	DBUG_ENTER("row_merge_build_indexes");
+	mtr_t			mtr;
+	buf_block_t*		root;
+	ulint			level;
+	ulint			space = dict_index_get_space(index);
+	ulint			zip_size = dict_table_zip_size(index->table);
+	ulint			comp = dict_table_is_comp(index->table);
+	mem_heap_t*		offsets_heap = NULL;
+	ulint			offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*			offsets = offsets_;
+	std::vector<const rec_t*>	node_ptrs;
+	const dtuple_t**	bounds;
+	ulint			n_bounds;
+
+	rec_offs_init(offsets_);
 
-	ut_ad(!srv_read_only_mode);
-	ut_ad((old_table == new_table) == !col_map);
-	ut_ad(!add_cols || col_map);
+	mtr_start(&mtr);
+	mtr_s_lock(dict_index_get_lock(index), &mtr);
 
-	/* Allocate memory for merge file data structure and initialize
-	fields */
+	root = btr_block_get(space, zip_size, dict_index_get_page(index),
+			     RW_S_LATCH, index, &mtr);
+	level = btr_page_get_level(buf_block_get_frame(root), &mtr);
 
-	block_size = 3 * srv_sort_buf_size;
-	block = static_cast<row_merge_block_t*>(
-		os_mem_alloc_large(&block_size));
+	if (level > 0) {
+		/* Collect the node pointers of the root page, and of its
+		children if the root has too few of them. The first
+		record of the leftmost page of each level has no key. */
+		const rec_t*	rec = page_rec_get_next_const(
+			page_get_infimum_rec(buf_block_get_frame(root)));
 
-	if (block == NULL) {
-		DBUG_RETURN(DB_OUT_OF_MEMORY);
-	}
+		for (; !page_rec_is_supremum(rec);
+		     rec = page_rec_get_next_const(rec)) {
 
-	trx_start_if_not_started_xa(trx, true);
+			if (!(rec_get_info_bits(rec, comp)
+			      & REC_INFO_MIN_REC_FLAG)) {
+				node_ptrs.push_back(rec);
+			}
+		}
 
-	merge_files = static_cast<merge_file_t*>(
-		mem_alloc(n_indexes * sizeof *merge_files));
+		if (node_ptrs.size() + 1 < n && level > 1) {
+			std::vector<const rec_t*>	children;
 
-	/* Initialize all the merge file descriptors, so that we
-	don't call row_merge_file_destroy() on uninitialized
-	merge file descriptor */
+			rec = page_rec_get_next_const(
+				page_get_infimum_rec(
+					buf_block_get_frame(root)));
 
-	for (i = 0; i < n_indexes; i++) {
-		merge_files[i].fd = -1;
+			for (; !page_rec_is_supremum(rec);
+			     rec = page_rec_get_next_const(rec)) {
+				const buf_block_t*	block;
+				const rec_t*		child_rec;
+
+				offsets = rec_get_offsets(
+					rec, index, offsets,
+					ULINT_UNDEFINED, &offsets_heap);
+
+				block = btr_block_get(
+					space, zip_size,
+					btr_node_ptr_get_child_page_no(
+						rec, offsets),
+					RW_S_LATCH, index, &mtr);
+
+				child_rec = page_rec_get_next_const(
+					page_get_infimum_rec(
+						buf_block_get_frame(block)));
+
+				for (; !page_rec_is_supremum(child_rec);
+				     child_rec = page_rec_get_next_const(
+					     child_rec)) {
+
+					if (!(rec_get_info_bits(
+						      child_rec, comp)
+					      & REC_INFO_MIN_REC_FLAG)) {
+						children.push_back(child_rec);
+					}
+				}
+			}
+
+			node_ptrs.swap(children);
+		}
 	}
 
-	for (i = 0; i < n_indexes; i++) {
+	/* Pick n - 1 evenly spaced node pointers as the bounds
+	between the ranges. */
+	n_bounds = ut_min(n - 1, node_ptrs.size());
+	*n_ranges = n_bounds + 1;
 
-		if (indexes[i]->type & DICT_FTS) {
-			ibool	opt_doc_id_size = FALSE;
+	bounds = static_cast<const dtuple_t**>(
+		mem_heap_alloc(heap, (n_bounds + 2) * sizeof *bounds));
+	bounds[0] = NULL;
+	bounds[n_bounds + 1] = NULL;
 
-			/* To build FTS index, we would need to extract
-			doc's word, Doc ID, and word's position, so
-			we need to build a "fts sort index" indexing
-			on above three 'fields' */
-			fts_sort_idx = row_merge_create_fts_sort_index(
-				indexes[i], old_table, &opt_doc_id_size);
+	for (ulint i = 1; i <= n_bounds; i++) {
+		const rec_t*	rec = node_ptrs[
+			i * node_ptrs.size() / (n_bounds + 1)];
+		byte*		buf = NULL;
+		ulint		buf_size = 0;
+		ulint		n_fields;
+		rec_t*		copy;
 
-			row_merge_dup_t* dup = static_cast<row_merge_dup_t*>(
-				ut_malloc(sizeof *dup));
-			dup->index = fts_sort_idx;
-			dup->table = table;
-			dup->col_map = col_map;
-			dup->n_dup = 0;
+		copy = dict_index_copy_rec_order_prefix(
+			index, rec, &n_fields, &buf, &buf_size);
 
-			row_fts_psort_info_init(
-				trx, dup, new_table, opt_doc_id_size,
-				&psort_info, &merge_info);
+		/* The fields are copied to heap. */
+		bounds[i] = dict_index_build_data_tuple(
+			index, copy, n_fields, heap);
 
-			/* "We need to ensure that we free the resources
-			allocated */
-			fts_psort_initiated = true;
-		}
+		mem_free(buf);
 	}
 
-	/* Reset the MySQL row buffer that is used when reporting
-	duplicate keys. */
-	innobase_rec_reset(table);
+	mtr_commit(&mtr);
 
-	/* Read clustered index of the table and create files for
-	secondary index entries for merge sort */
+	if (offsets_heap != NULL) {
+		mem_heap_free(offsets_heap);
+	}
 
-	error = row_merge_read_clustered_index(
-		trx, table, old_table, new_table, online, indexes,
-		fts_sort_idx, psort_info, merge_files, key_numbers,
-		n_indexes, add_cols, col_map,
-		add_autoinc, sequence, block, &tmpfd);
+	return(bounds);
+}
 
-	if (error != DB_SUCCESS) {
+/*********************************************************************//**
+Notes the first error of a parallel clustered index scan. */
+static MY_ATTRIBUTE((nonnull))
+void
+row_merge_pscan_set_error(
+/*======================*/
+	row_merge_pscan_t*	pscan,		/*!< in/out: parallel scan */
+	dberr_t			error,		/*!< in: error code */
+	ulint			error_key_num)	/*!< in: MySQL key number,
+						or 0 */
+{
+	ut_ad(error != DB_SUCCESS);
 
-		goto func_exit;
+	os_fast_mutex_lock(&pscan->mutex);
+
+	if (pscan->error == DB_SUCCESS) {
+		pscan->error = error;
+		pscan->error_key_num = error_key_num;
 	}
 
-	DEBUG_SYNC_C("row_merge_after_scan");
+	os_fast_mutex_unlock(&pscan->mutex);
+}
 
-	/* Now we have files containing index entries ready for
-	sorting and inserting. */
+/*********************************************************************//**
+Sorts the entries of a full sort buffer of a parallel clustered index
+scan, and writes them as a run to the file of the thread for the index.
+@return	DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+row_merge_pscan_write(
+/*==================*/
+	row_merge_pscan_t*	pscan,	/*!< in/out: parallel scan */
+	ulint			i,	/*!< in: number of the index */
+	row_merge_buf_t*	buf,	/*!< in/out: sort buffer */
+	merge_file_t*		file,	/*!< in/out: file of the index */
+	row_merge_block_t*	block,	/*!< in/out: file buffer */
+	int*			tmpfd)	/*!< in/out: temporary file handle */
+{
+	ut_ad(buf->n_tuples > 0);
 
-	for (i = 0; i < n_indexes; i++) {
-		dict_index_t*	sort_idx = indexes[i];
+	if (dict_index_is_unique(buf->index)) {
+		row_merge_dup_t	dup = {
+			buf->index, pscan->mysql_table, NULL, 0};
+		dberr_t		error;
 
-		if (indexes[i]->type & DICT_FTS) {
-			os_event_t	fts_parallel_merge_event;
+		/* Only the first duplicate may be reported into the
+		MySQL row buffer. */
+		os_fast_mutex_lock(&pscan->dup_mutex);
 
-			sort_idx = fts_sort_idx;
+		error = pscan->error;
 
-			fts_parallel_merge_event
-				= merge_info[0].psort_common->merge_event;
+		if (error == DB_SUCCESS) {
+			row_merge_buf_sort(buf, &dup);
 
-			if (FTS_PLL_MERGE) {
-				ulint	trial_count = 0;
-				bool	all_exit = false;
+			if (dup.n_dup) {
+				error = DB_DUPLICATE_KEY;
+				row_merge_pscan_set_error(
+					pscan, error, pscan->key_numbers[i]);
+			}
+		}
 
-				os_event_reset(fts_parallel_merge_event);
-				row_fts_start_parallel_merge(merge_info);
-wait_again:
-				os_event_wait_time_low(
-					fts_parallel_merge_event, 1000000,
-					sig_count);
+		os_fast_mutex_unlock(&pscan->dup_mutex);
 
-				for (j = 0; j < FTS_NUM_AUX_INDEX; j++) {
-					if (merge_info[j].child_status
-					    != FTS_CHILD_COMPLETE
-					    && merge_info[j].child_status
-					    != FTS_CHILD_EXITING) {
-						sig_count = os_event_reset(
-						fts_parallel_merge_event);
+		if (error != DB_SUCCESS) {
+			return(error);
+		}
+	} else {
+		row_merge_buf_sort(buf, NULL);
+	}
 
-						goto wait_again;
-					}
-				}
+	if (row_merge_file_create_if_needed(
+		    file, tmpfd, buf->n_tuples, pscan->path) < 0) {
+		return(DB_OUT_OF_MEMORY);
+	}
 
-				/* Now all children should complete, wait
-				a bit until they all finish using event */
-				while (!all_exit && trial_count < 10000) {
-					all_exit = true;
+	row_merge_buf_write(buf, file, block);
 
-					for (j = 0; j < FTS_NUM_AUX_INDEX;
-					     j++) {
+	if (!row_merge_write(file->fd, file->offset++, block)) {
+		return(DB_TEMP_FILE_WRITE_FAILURE);
+	}
+
+	UNIV_MEM_INVALID(&block[0], srv_sort_buf_size);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Reads the rows of a key range of the clustered index and adds their
+index entries to the sort buffers of a thread of a parallel scan.
+@return	DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull(1,3,4,5,6), warn_unused_result))
+dberr_t
+row_merge_pscan_range(
+/*==================*/
+	row_merge_pscan_t*	pscan,	/*!< in/out: parallel scan */
+	ulint			t,	/*!< in: number of the thread */
+	row_merge_buf_t**	bufs,	/*!< in/out: sort buffers of the
+					thread, one for each index */
+	row_merge_block_t*	block,	/*!< in/out: file buffer */
+	int*			tmpfd,	/*!< in/out: temporary file handle */
+	ulint*			error_key_num,
+					/*!< out: MySQL key number of an
+					error, or 0 */
+	const dtuple_t*		start,	/*!< in: first key of the range,
+					or NULL */
+	const dtuple_t*		end)	/*!< in: first key after the range,
+					or NULL */
+{
+	dict_index_t*	clust_index;
+	mem_heap_t*	row_heap;
+	btr_pcur_t	pcur;
+	mtr_t		mtr;
+	dberr_t		err = DB_SUCCESS;
+	trx_t*		trx = pscan->trx;
+	doc_id_t	doc_id = 0;
+
+	clust_index = dict_table_get_first_index(pscan->table);
+	row_heap = mem_heap_create(sizeof(mrec_buf_t));
+
+	mtr_start(&mtr);
+
+	if (start == NULL) {
+		btr_pcur_open_at_index_side(
+			true, clust_index, BTR_SEARCH_LEAF, &pcur, true, 0,
+			&mtr);
+	} else {
+		btr_pcur_open(clust_index, start, PAGE_CUR_GE,
+			      BTR_SEARCH_LEAF, &pcur, &mtr);
+		/* The loop below moves to the next record first. */
+		btr_pcur_move_to_prev_on_page(&pcur);
+	}
+
+	for (;;) {
+		const rec_t*	rec;
+		ulint*		offsets;
+		const dtuple_t*	row;
+		row_ext_t*	ext;
+		page_cur_t*	cur	= btr_pcur_get_page_cur(&pcur);
+
+		page_cur_move_to_next(cur);
+
+		if (page_cur_is_after_last(cur)) {
+			if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
+				err = DB_INTERRUPTED;
+				break;
+			}
+
+			if (pscan->error != DB_SUCCESS) {
+				/* Another thread failed. */
+				break;
+			}
+
+			if (rw_lock_get_waiters(
+				    dict_index_get_lock(clust_index))) {
+				/* Yield to the waiters on the clustered
+				index tree lock, like
+				row_merge_read_clustered_index(). */
+				btr_pcur_move_to_prev_on_page(&pcur);
+				btr_pcur_store_position(&pcur, &mtr);
+				mtr_commit(&mtr);
+
+				os_thread_yield();
+
+				mtr_start(&mtr);
+				btr_pcur_restore_position(
+					BTR_SEARCH_LEAF, &pcur, &mtr);
+
+				if (!btr_pcur_move_to_next_user_rec(
+					    &pcur, &mtr)) {
+					break;
+				}
+			} else {
+				ulint		next_page_no;
+				buf_block_t*	next_block;
+
+				next_page_no = btr_page_get_next(
+					page_cur_get_page(cur), &mtr);
+
+				if (next_page_no == FIL_NULL) {
+					break;
+				}
+
+				next_block = page_cur_get_block(cur);
+				next_block = btr_block_get(
+					buf_block_get_space(next_block),
+					buf_block_get_zip_size(next_block),
+					next_page_no, BTR_SEARCH_LEAF,
+					clust_index, &mtr);
+
+				btr_leaf_page_release(page_cur_get_block(cur),
+						      BTR_SEARCH_LEAF, &mtr);
+				page_cur_set_before_first(next_block, cur);
+				page_cur_move_to_next(cur);
+
+				ut_ad(!page_cur_is_after_last(cur));
+			}
+		}
+
+		rec = page_cur_get_rec(cur);
+
+		offsets = rec_get_offsets(rec, clust_index, NULL,
+					  ULINT_UNDEFINED, &row_heap);
+
+		if (end != NULL && cmp_dtuple_rec(end, rec, offsets) <= 0) {
+			/* The rest belongs to the next range. */
+			break;
+		}
+
+		if (pscan->online) {
+			/* Perform a REPEATABLE READ, see
+			row_merge_read_clustered_index(). */
+			ut_ad(trx->read_view);
+
+			if (!read_view_sees_trx_id(
+				    trx->read_view,
+				    row_get_rec_trx_id(
+					    rec, clust_index, offsets))) {
+				rec_t*	old_vers;
+
+				row_vers_build_for_consistent_read(
+					rec, &mtr, clust_index, &offsets,
+					trx->read_view, &row_heap,
+					row_heap, &old_vers);
+
+				rec = old_vers;
+
+				if (!rec) {
+					continue;
+				}
+			}
+
+			if (rec_get_deleted_flag(
+				    rec, dict_table_is_comp(pscan->table))) {
+				continue;
+			}
+		} else if (rec_get_deleted_flag(
+				   rec, dict_table_is_comp(pscan->table))) {
+			continue;
+		}
+
+		ut_ad(!rec_offs_any_null_extern(rec, offsets));
+
+		row = row_build(ROW_COPY_POINTERS, clust_index,
+				rec, offsets, pscan->table,
+				NULL, NULL, &ext, row_heap);
+
+		for (ulint i = 0; i < pscan->n_indexes; i++) {
+			row_merge_buf_t*	buf	= bufs[i];
+			merge_file_t*		file	= &pscan->files[
+				i * pscan->n_runs + t];
+			bool			exceed_page = false;
+			ulint			rows_added;
+
+			rows_added = row_merge_buf_add(
+				buf, NULL, pscan->table, NULL, row, ext,
+				&doc_id, NULL, &exceed_page);
+
+			if (!rows_added) {
+				/* The buffer is full. Write it out
+				and add the entry again. */
+				err = row_merge_pscan_write(
+					pscan, i, buf, file, block, tmpfd);
+
+				if (err != DB_SUCCESS) {
+					*error_key_num
+						= pscan->key_numbers[i];
+					break;
+				}
+
+				bufs[i] = buf = row_merge_buf_empty(buf);
+
+				rows_added = row_merge_buf_add(
+					buf, NULL, pscan->table, NULL,
+					row, ext, &doc_id, NULL,
+					&exceed_page);
+
+				/* An empty buffer should have enough
+				room for at least one record. */
+				ut_a(rows_added);
+			}
+
+			if (exceed_page) {
+				err = DB_TOO_BIG_RECORD;
+				break;
+			}
+
+			file->n_rec += rows_added;
+		}
+
+		if (err != DB_SUCCESS) {
+			break;
+		}
+
+		mem_heap_empty(row_heap);
+	}
+
+	mtr_commit(&mtr);
+	btr_pcur_close(&pcur);
+	mem_heap_free(row_heap);
+
+	return(err);
+}
+
+/*********************************************************************//**
+Scans key ranges of the clustered index that no thread has picked yet,
+and merge sorts the files of the thread when no range is left. */
+static
+void
+row_merge_pscan_run(
+/*================*/
+	row_merge_pscan_t*	pscan,	/*!< in/out: parallel scan */
+	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
+	int*			tmpfd)	/*!< in/out: temporary file handle */
+{
+	row_merge_buf_t**	bufs;
+	dberr_t			error = DB_SUCCESS;
+	ulint			error_key_num = 0;
+	ulint			t;
+
+	os_fast_mutex_lock(&pscan->mutex);
+	t = pscan->n_started++;
+	os_fast_mutex_unlock(&pscan->mutex);
+
+	ut_ad(t < pscan->n_runs);
+
+	bufs = static_cast<row_merge_buf_t**>(
+		mem_alloc(pscan->n_indexes * sizeof *bufs));
+
+	for (ulint i = 0; i < pscan->n_indexes; i++) {
+		bufs[i] = row_merge_buf_create(pscan->indexes[i]);
+	}
+
+	for (;;) {
+		ulint	r;
+
+		os_fast_mutex_lock(&pscan->mutex);
+
+		r = pscan->next;
+
+		if (r < pscan->n_ranges && pscan->error == DB_SUCCESS) {
+			pscan->next++;
+		} else {
+			r = ULINT_UNDEFINED;
+		}
+
+		os_fast_mutex_unlock(&pscan->mutex);
+
+		if (r == ULINT_UNDEFINED) {
+			break;
+		}
+
+		error = row_merge_pscan_range(
+			pscan, t, bufs, block, tmpfd, &error_key_num,
+			pscan->bounds[r], pscan->bounds[r + 1]);
+
+		if (error != DB_SUCCESS) {
+			break;
+		}
+	}
+
+	/* Write the remaining entries, and merge the runs of each
+	file into one. */
+	for (ulint i = 0; i < pscan->n_indexes; i++) {
+		merge_file_t*	file = &pscan->files[i * pscan->n_runs + t];
+
+		if (error != DB_SUCCESS || pscan->error != DB_SUCCESS) {
+			break;
+		}
+
+		error_key_num = pscan->key_numbers[i];
+
+		if (bufs[i]->n_tuples > 0) {
+			error = row_merge_pscan_write(
+				pscan, i, bufs[i], file, block, tmpfd);
+
+			if (error != DB_SUCCESS) {
+				break;
+			}
+		}
+
+		if (file->fd < 0) {
+			continue;
+		}
+
+		row_merge_dup_t	dup = {
+			pscan->indexes[i], pscan->mysql_table, NULL, 0};
+
+		if (dict_index_is_unique(pscan->indexes[i])) {
+			/* row_merge_blocks() reports duplicates into
+			the MySQL row buffer, see
+			row_merge_pscan_write(). */
+			os_fast_mutex_lock(&pscan->dup_mutex);
+
+			error = pscan->error;
+
+			if (error == DB_SUCCESS) {
+				error = row_merge_sort(
+					pscan->trx, &dup, file, block,
+					tmpfd);
+
+				if (error != DB_SUCCESS) {
+					row_merge_pscan_set_error(
+						pscan, error,
+						error_key_num);
+				}
+			}
+
+			os_fast_mutex_unlock(&pscan->dup_mutex);
+		} else {
+			error = row_merge_sort(
+				pscan->trx, &dup, file, block, tmpfd);
+		}
+	}
+
+	if (error != DB_SUCCESS) {
+		row_merge_pscan_set_error(pscan, error, error_key_num);
+	}
+
+	for (ulint i = 0; i < pscan->n_indexes; i++) {
+		row_merge_buf_free(bufs[i]);
+	}
+
+	mem_free(bufs);
+}
+
+/*********************************************************************//**
+Helper thread of a parallel clustered index scan.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_merge_pscan_thread)(
+/*===================================*/
+	void*	arg)	/*!< in/out: parallel scan, row_merge_pscan_t */
+{
+	row_merge_pscan_t*	pscan = static_cast<row_merge_pscan_t*>(arg);
+	ulint			block_size = 3 * srv_sort_buf_size;
+	row_merge_block_t*	block;
+	int			tmpfd = -1;
+
+	block = static_cast<row_merge_block_t*>(
+		os_mem_alloc_large(&block_size));
+
+	if (block != NULL) {
+		row_merge_pscan_run(pscan, block, &tmpfd);
+		os_mem_free_large(block, block_size);
+	} else {
+		/* The files of this thread were reserved by
+		row_merge_build_indexes(), so the scan cannot go on
+		without it. */
+		os_fast_mutex_lock(&pscan->mutex);
+		pscan->n_started++;
+		os_fast_mutex_unlock(&pscan->mutex);
+
+		row_merge_pscan_set_error(pscan, DB_OUT_OF_MEMORY, 0);
+	}
+
+	row_merge_file_destroy_low(tmpfd);
+
+	os_fast_mutex_lock(&pscan->mutex);
+
+	if (--pscan->n_threads == 0) {
+		os_event_set(pscan->done);
+	}
+
+	os_fast_mutex_unlock(&pscan->mutex);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*********************************************************************//**
+Reads the clustered index of a table in key ranges with several threads,
+and creates sorted temporary files of the entries of the secondary
+indexes to be created, one for each index and thread.
+@return	DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+dberr_t
+row_merge_pscan_read(
+/*=================*/
+	trx_t*			trx,	/*!< in: transaction */
+	struct TABLE*		table,	/*!< in/out: MySQL table, for
+					reporting erroneous key value */
+	const dict_table_t*	old_table,/*!< in: table where rows are
+					read from and indexes created */
+	bool			online,	/*!< in: true if creating indexes
+					online */
+	dict_index_t**		indexes,/*!< in: indexes to be created */
+	const ulint*		key_numbers,/*!< in: MySQL key numbers */
+	ulint			n_indexes,/*!< in: size of indexes[] */
+	const dtuple_t**	bounds,	/*!< in: bounds of the ranges,
+					from row_merge_pscan_split() */
+	ulint			n_ranges,/*!< in: number of ranges */
+	merge_file_t*		files,	/*!< out: temporary files,
+					n_runs for each index */
+	ulint			n_runs,	/*!< in: number of threads */
+	row_merge_block_t*	block,	/*!< in/out: file buffer */
+	int*			tmpfd)	/*!< in/out: temporary file handle */
+{
+	row_merge_pscan_t	pscan;
+	ulint			n_helpers = n_runs - 1;
+
+	trx->op_info = "reading clustered index";
+
+	os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &pscan.mutex);
+	os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &pscan.dup_mutex);
+	pscan.next = 0;
+	pscan.error = DB_SUCCESS;
+	pscan.error_key_num = 0;
+	pscan.n_started = 0;
+	pscan.n_threads = n_helpers;
+	pscan.done = os_event_create();
+	pscan.trx = trx;
+	pscan.table = old_table;
+	pscan.mysql_table = table;
+	pscan.online = online;
+	pscan.indexes = indexes;
+	pscan.key_numbers = key_numbers;
+	pscan.n_indexes = n_indexes;
+	pscan.path = thd_innodb_tmpdir(trx->mysql_thd);
+	pscan.bounds = bounds;
+	pscan.n_ranges = n_ranges;
+	pscan.files = files;
+	pscan.n_runs = n_runs;
+
+	/* The helper threads that have already finished decrement
+	pscan.n_threads. */
+	for (ulint i = 0; i < n_helpers; i++) {
+		os_thread_create(row_merge_pscan_thread, &pscan, NULL);
+	}
+
+	row_merge_pscan_run(&pscan, block, tmpfd);
+
+	os_event_wait(pscan.done);
+
+	/* Let the last helper thread release the mutex. */
+	os_fast_mutex_lock(&pscan.mutex);
+	os_fast_mutex_unlock(&pscan.mutex);
+
+	os_event_free(pscan.done);
+	os_fast_mutex_free(&pscan.dup_mutex);
+	os_fast_mutex_free(&pscan.mutex);
+
+	if (pscan.error != DB_SUCCESS) {
+		trx->error_key_num = pscan.error_key_num;
+	} else if (online) {
+		/* Note the newest transaction that modified each index
+		when the scan was completed, like
+		row_merge_read_clustered_index(). */
+		for (ulint i = 0; i < n_indexes; i++) {
+			dict_index_t*	index = indexes[i];
+			trx_id_t	max_trx_id;
+
+			rw_lock_x_lock(dict_index_get_lock(index));
+			ut_a(dict_index_get_online_status(index)
+			     == ONLINE_INDEX_CREATION);
+
+			max_trx_id = row_log_get_max_trx(index);
+
+			if (max_trx_id > index->trx_id) {
+				index->trx_id = max_trx_id;
+			}
+
+			rw_lock_x_unlock(dict_index_get_lock(index));
+		}
+	}
+
+	trx->op_info = "";
+
+	return(pscan.error);
+}
+
+/*********************************************************************//**
+Checks if an index has any entries in its sorted runs.
+@return	true if a temporary file was created for some run */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+bool
+row_merge_runs_exist(
+/*=================*/
+	const merge_file_t*	files,	/*!< in: sorted runs */
+	ulint			n_runs)	/*!< in: size of files[] */
+{
+	for (ulint i = 0; i < n_runs; i++) {
+		if (files[i].fd != -1) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/** Shared state of the threads that merge sort and load the non-unique
+secondary indexes of one row_merge_build_indexes() call in parallel.
+Each thread takes the next index nobody has picked yet, and sorts and
+loads it with its own buffers and temporary file. Unique indexes report
+duplicates into the MySQL row buffer of the table, so they are left to
+the thread running row_merge_build_indexes(), as are FTS indexes. */
+struct row_merge_pll_t {
+	os_fast_mutex_t	mutex;		/*!< protects next, error and
+					n_threads */
+	ulint		next;		/*!< next index to look at */
+	dberr_t		error;		/*!< first error; no more indexes
+					are started after an error */
+	ulint		n_threads;	/*!< number of running helper
+					threads */
+	os_event_t	done;		/*!< set when n_threads drops
+					to 0 */
+	trx_t*		trx;		/*!< transaction */
+	const dict_table_t*
+			old_table;	/*!< table where rows are read
+					from */
+	struct TABLE*	table;		/*!< MySQL table */
+	const ulint*	col_map;	/*!< mapping of old column numbers
+					to new ones, or NULL */
+	const char*	path;		/*!< location of the temporary
+					files */
+	dict_index_t**	indexes;	/*!< indexes to be created */
+	merge_file_t*	merge_files;	/*!< files of the index entries,
+					n_runs for each index */
+	ulint		n_runs;		/*!< number of sorted runs of each
+					index; 1 unless the clustered index
+					was scanned by row_merge_pscan_t */
+	ulint		n_indexes;	/*!< size of indexes[] */
+	bool*		in_pll;		/*!< whether each index is built
+					by row_merge_pll_build() */
+	dberr_t*	errors;		/*!< outcome of each index built
+					by row_merge_pll_build() */
+};
+
+/*********************************************************************//**
+Merge sorts the entries of the indexes of a parallel build that no
+thread has picked yet, and inserts them into the indexes. */
+static
+void
+row_merge_pll_build(
+/*================*/
+	row_merge_pll_t*	pll,	/*!< in/out: parallel build */
+	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
+	int*			tmpfd)	/*!< in/out: temporary file handle */
+{
+	for (;;) {
+		ulint	i;
+		dberr_t	error;
+
+		os_fast_mutex_lock(&pll->mutex);
+
+		while (pll->next < pll->n_indexes
+		       && !pll->in_pll[pll->next]) {
+			pll->next++;
+		}
+
+		i = pll->next;
+
+		if (i < pll->n_indexes && pll->error == DB_SUCCESS) {
+			pll->next++;
+		} else {
+			i = ULINT_UNDEFINED;
+		}
+
+		os_fast_mutex_unlock(&pll->mutex);
+
+		if (i == ULINT_UNDEFINED) {
+			return;
+		}
+
+		dict_index_t*	index = pll->indexes[i];
+		merge_file_t*	files = &pll->merge_files[i * pll->n_runs];
+		row_merge_dup_t	dup = {index, pll->table, pll->col_map, 0};
+
+		ut_ad(!dict_index_is_unique(index));
+
+		/* The runs of a parallel scan were sorted by the
+		threads that wrote them. */
+		error = pll->n_runs == 1
+			? row_merge_sort(pll->trx, &dup, files, block, tmpfd)
+			: DB_SUCCESS;
+
+		if (error == DB_SUCCESS) {
+			error = row_merge_insert_index_tuples(
+				pll->trx->id, index, pll->old_table,
+				files, pll->n_runs, block, &dup);
+		}
+
+		pll->errors[i] = error;
+
+		if (error != DB_SUCCESS) {
+			os_fast_mutex_lock(&pll->mutex);
+
+			if (pll->error == DB_SUCCESS) {
+				pll->error = error;
+			}
+
+			os_fast_mutex_unlock(&pll->mutex);
+		}
+	}
+}
+
+/*********************************************************************//**
+Helper thread of a parallel index build.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_merge_pll_thread)(
+/*=================================*/
+	void*	arg)	/*!< in/out: parallel build, row_merge_pll_t */
+{
+	row_merge_pll_t*	pll = static_cast<row_merge_pll_t*>(arg);
+	ulint			block_size = 3 * srv_sort_buf_size;
+	row_merge_block_t*	block;
+	int			tmpfd;
+
+	block = static_cast<row_merge_block_t*>(
+		os_mem_alloc_large(&block_size));
+	tmpfd = row_merge_file_create_low(pll->path);
+
+	/* Without memory or a temporary file, leave the indexes to
+	the other threads. */
+
+	if (block != NULL && tmpfd >= 0) {
+		row_merge_pll_build(pll, block, &tmpfd);
+	}
+
+	if (block != NULL) {
+		os_mem_free_large(block, block_size);
+	}
+
+	row_merge_file_destroy_low(tmpfd);
+
+	os_fast_mutex_lock(&pll->mutex);
+
+	if (--pll->n_threads == 0) {
+		os_event_set(pll->done);
+	}
+
+	os_fast_mutex_unlock(&pll->mutex);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*********************************************************************//**
+Build indexes on a table by reading a clustered index,
+creating a temporary file containing index entries, merge sorting
+these index entries and inserting sorted index entries to indexes.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+row_merge_build_indexes(
+/*====================*/
+	trx_t*		trx,		/*!< in: transaction */
+	dict_table_t*	old_table,	/*!< in: table where rows are
+					read from */
+	dict_table_t*	new_table,	/*!< in: table where indexes are
+					created; identical to old_table
+					unless creating a PRIMARY KEY */
+	bool		online,		/*!< in: true if creating indexes
+					online */
+	dict_index_t**	indexes,	/*!< in: indexes to be created */
+	const ulint*	key_numbers,	/*!< in: MySQL key numbers */
+	ulint		n_indexes,	/*!< in: size of indexes[] */
+	struct TABLE*	table,		/*!< in/out: MySQL table, for
+					reporting erroneous key value
+					if applicable */
+	const dtuple_t*	add_cols,	/*!< in: default values of
+					added columns, or NULL */
+	const ulint*	col_map,	/*!< in: mapping of old column
+					numbers to new ones, or NULL
+					if old_table == new_table */
+	ulint		add_autoinc,	/*!< in: number of added
+					AUTO_INCREMENT column, or
+					ULINT_UNDEFINED if none is added */
+	ib_sequence_t&	sequence)	/*!< in: autoinc instance if
+					add_autoinc != ULINT_UNDEFINED */
+{
+	merge_file_t*		merge_files;
+	row_merge_block_t*	block;
+	ulint			block_size;
+	ulint			i;
+	ulint			j;
+	dberr_t			error;
+	int			tmpfd = -1;
+	dict_index_t*		fts_sort_idx = NULL;
+	fts_psort_t*		psort_info = NULL;
+	fts_psort_t*		merge_info = NULL;
+	ib_int64_t		sig_count = 0;
+	bool			fts_psort_initiated = false;
+	bool*			in_pll;
+	dberr_t*		pll_errors;
+	ulint			n_pll = 0;
+	ulint			n_threads = srv_index_build_threads;
+	ulint			n_runs = 1;
+	mem_heap_t*		bounds_heap = NULL;
+	const dtuple_t**	bounds = NULL;
+	ulint			n_ranges = 0;
+	DBUG_ENTER("row_merge_build_indexes");
+
+	ut_ad(!srv_read_only_mode);
+	ut_ad((old_table == new_table) == !col_map);
+	ut_ad(!add_cols || col_map);
+
+	/* Allocate memory for merge file data structure and initialize
+	fields */
+
+	block_size = 3 * srv_sort_buf_size;
+	block = static_cast<row_merge_block_t*>(
+		os_mem_alloc_large(&block_size));
+
+	if (block == NULL) {
+		DBUG_RETURN(DB_OUT_OF_MEMORY);
+	}
+
+	trx_start_if_not_started_xa(trx, true);
+
+	/* Unless the table is rebuilt or a full-text index or an
+	AUTO_INCREMENT column is added, let several threads scan key
+	ranges of the clustered index, each writing sorted runs of the
+	index entries to its own files. */
+	if (n_threads > 1 && old_table == new_table
+	    && add_autoinc == ULINT_UNDEFINED) {
+		for (i = 0; i < n_indexes; i++) {
+			if (indexes[i]->type & DICT_FTS) {
+				break;
+			}
+		}
+
+		if (i == n_indexes) {
+			bounds_heap = mem_heap_create(1024);
+			bounds = row_merge_pscan_split(
+				dict_table_get_first_index(old_table),
+				n_threads * ROW_MERGE_PSCAN_RANGES_PER_THREAD,
+				bounds_heap, &n_ranges);
+
+			if (n_ranges > 1) {
+				n_runs = ut_min(n_threads, n_ranges);
+			}
+		}
+	}
+
+	merge_files = static_cast<merge_file_t*>(
+		mem_alloc(n_indexes * n_runs * sizeof *merge_files));
+	in_pll = static_cast<bool*>(mem_alloc(n_indexes * sizeof *in_pll));
+	pll_errors = static_cast<dberr_t*>(
+		mem_alloc(n_indexes * sizeof *pll_errors));
+
+	/* Initialize all the merge file descriptors, so that we
+	don't call row_merge_file_destroy() on uninitialized
+	merge file descriptor */
+
+	for (i = 0; i < n_indexes * n_runs; i++) {
+		merge_files[i].fd = -1;
+	}
+
+	for (i = 0; i < n_indexes; i++) {
+
+		if (indexes[i]->type & DICT_FTS) {
+			ibool	opt_doc_id_size = FALSE;
+
+			/* To build FTS index, we would need to extract
+			doc's word, Doc ID, and word's position, so
+			we need to build a "fts sort index" indexing
+			on above three 'fields' */
+			fts_sort_idx = row_merge_create_fts_sort_index(
+				indexes[i], old_table, &opt_doc_id_size);
+
+			row_merge_dup_t* dup = static_cast<row_merge_dup_t*>(
+				ut_malloc(sizeof *dup));
+			dup->index = fts_sort_idx;
+			dup->table = table;
+			dup->col_map = col_map;
+			dup->n_dup = 0;
+
+			row_fts_psort_info_init(
+				trx, dup, new_table, opt_doc_id_size,
+				&psort_info, &merge_info);
+
+			/* "We need to ensure that we free the resources
+			allocated */
+			fts_psort_initiated = true;
+		}
+	}
+
+	/* Reset the MySQL row buffer that is used when reporting
+	duplicate keys. */
+	innobase_rec_reset(table);
+
+	/* Read clustered index of the table and create files for
+	secondary index entries for merge sort */
+
+	if (n_runs > 1) {
+		error = row_merge_pscan_read(
+			trx, table, old_table, online, indexes, key_numbers,
+			n_indexes, bounds, n_ranges, merge_files, n_runs,
+			block, &tmpfd);
+	} else {
+		error = row_merge_read_clustered_index(
+			trx, table, old_table, new_table, online, indexes,
+			fts_sort_idx, psort_info, merge_files, key_numbers,
+			n_indexes, add_cols, col_map,
+			add_autoinc, sequence, block, &tmpfd);
+	}
+
+	if (error != DB_SUCCESS) {
+
+		goto func_exit;
+	}
+
+	DEBUG_SYNC_C("row_merge_after_scan");
+
+	/* Now we have files containing index entries ready for
+	sorting and inserting. If there are several non-unique
+	secondary indexes, sort and load them in parallel first. */
+
+	for (i = 0; i < n_indexes; i++) {
+		in_pll[i] = n_threads > 1
+			&& !(indexes[i]->type & DICT_FTS)
+			&& !dict_index_is_unique(indexes[i])
+			&& row_merge_runs_exist(
+				&merge_files[i * n_runs], n_runs);
+
+		/* An index that is not built because another one
+		failed is never looked at. */
+		pll_errors[i] = DB_ERROR;
+
+		n_pll += in_pll[i];
+	}
+
+	if (n_pll > 1) {
+		row_merge_pll_t	pll;
+		ulint		n_helpers = ut_min(n_threads, n_pll) - 1;
+
+		os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &pll.mutex);
+		pll.next = 0;
+		pll.error = DB_SUCCESS;
+		pll.n_threads = n_helpers;
+		pll.done = os_event_create();
+		pll.trx = trx;
+		pll.old_table = old_table;
+		pll.table = table;
+		pll.col_map = col_map;
+		pll.path = thd_innodb_tmpdir(trx->mysql_thd);
+		pll.indexes = indexes;
+		pll.merge_files = merge_files;
+		pll.n_runs = n_runs;
+		pll.n_indexes = n_indexes;
+		pll.in_pll = in_pll;
+		pll.errors = pll_errors;
+
+		/* The helper threads that have already finished
+		decrement pll.n_threads. */
+		for (j = 0; j < n_helpers; j++) {
+			os_thread_create(row_merge_pll_thread, &pll, NULL);
+		}
+
+		row_merge_pll_build(&pll, block, &tmpfd);
+
+		os_event_wait(pll.done);
+
+		/* Let the last helper thread release the mutex. */
+		os_fast_mutex_lock(&pll.mutex);
+		os_fast_mutex_unlock(&pll.mutex);
+
+		os_event_free(pll.done);
+		os_fast_mutex_free(&pll.mutex);
+	} else {
+		memset(in_pll, 0, n_indexes * sizeof *in_pll);
+	}
+
+	for (i = 0; i < n_indexes; i++) {
+		dict_index_t*	sort_idx = indexes[i];
+
+		if (indexes[i]->type & DICT_FTS) {
+			os_event_t	fts_parallel_merge_event;
+
+			sort_idx = fts_sort_idx;
+
+			fts_parallel_merge_event
+				= merge_info[0].psort_common->merge_event;
+
+			if (FTS_PLL_MERGE) {
+				ulint	trial_count = 0;
+				bool	all_exit = false;
+
+				os_event_reset(fts_parallel_merge_event);
+				row_fts_start_parallel_merge(merge_info);
+wait_again:
+				os_event_wait_time_low(
+					fts_parallel_merge_event, 1000000,
+					sig_count);
+
+				for (j = 0; j < FTS_NUM_AUX_INDEX; j++) {
+					if (merge_info[j].child_status
+					    != FTS_CHILD_COMPLETE
+					    && merge_info[j].child_status
+					    != FTS_CHILD_EXITING) {
+						sig_count = os_event_reset(
+						fts_parallel_merge_event);
+
+						goto wait_again;
+					}
+				}
+
+				/* Now all children should complete, wait
+				a bit until they all finish using event */
+				while (!all_exit && trial_count < 10000) {
+					all_exit = true;
+
+					for (j = 0; j < FTS_NUM_AUX_INDEX;
+					     j++) {
 						if (merge_info[j].child_status
 						    != FTS_CHILD_EXITING) {
 							all_exit = false;
@@ -3799,23 +5045,32 @@ wait_again:
 #ifdef FTS_INTERNAL_DIAG_PRINT
 			DEBUG_FTS_SORT_PRINT("FTS_SORT: Complete Insert\n");
 #endif
-		} else if (merge_files[i].fd != -1) {
+		} else if (in_pll[i]) {
+			error = pll_errors[i];
+		} else if (row_merge_runs_exist(
+				   &merge_files[i * n_runs], n_runs)) {
+			merge_file_t*	files = &merge_files[i * n_runs];
 			row_merge_dup_t	dup = {
 				sort_idx, table, col_map, 0};
 
-			error = row_merge_sort(
-				trx, &dup, &merge_files[i],
-				block, &tmpfd);
+			/* The runs of a parallel scan were sorted by
+			the threads that wrote them. */
+			error = n_runs == 1
+				? row_merge_sort(
+					trx, &dup, files, block, &tmpfd)
+				: DB_SUCCESS;
 
 			if (error == DB_SUCCESS) {
 				error = row_merge_insert_index_tuples(
 					trx->id, sort_idx, old_table,
-					merge_files[i].fd, block);
+					files, n_runs, block, &dup);
 			}
 		}
 
-		/* Close the temporary file to free up space. */
-		row_merge_file_destroy(&merge_files[i]);
+		/* Close the temporary files to free up space. */
+		for (j = 0; j < n_runs; j++) {
+			row_merge_file_destroy(&merge_files[i * n_runs + j]);
+		}
 
 		if (indexes[i]->type & DICT_FTS) {
 			row_fts_psort_info_destroy(psort_info, merge_info);
@@ -3864,15 +5119,21 @@ func_exit:
 
 	row_merge_file_destroy_low(tmpfd);
 
-	for (i = 0; i < n_indexes; i++) {
+	for (i = 0; i < n_indexes * n_runs; i++) {
 		row_merge_file_destroy(&merge_files[i]);
 	}
 
+	if (bounds_heap != NULL) {
+		mem_heap_free(bounds_heap);
+	}
+
 	if (fts_sort_idx) {
 		dict_mem_index_free(fts_sort_idx);
 	}
 
 	mem_free(merge_files);
+	mem_free(in_pll);
+	mem_free(pll_errors);
 	os_mem_free_large(block, block_size);
 
 	DICT_TF2_FLAG_UNSET(new_table, DICT_TF2_FTS_ADD_DOC_ID);
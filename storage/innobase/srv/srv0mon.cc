@@ -382,6 +382,41 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_FLUSH_PCT_FOR_LSN},
 
+	{"buffer_flush_avg_time", "buffer",
+	 "Avg time (ms) spent by the page_cleaner threads in a flushing"
+	 " round recently",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_AVG_TIME},
+
+	{"buffer_flush_avg_pass", "buffer",
+	 "Number of flushing rounds of the page_cleaner threads recently",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_AVG_PASS},
+
+	{"buffer_flush_adaptive_avg_time_slot", "buffer",
+	 "Avg time (ms) spent in flush_list flushing of a buffer pool"
+	 " instance recently",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_ADAPTIVE_AVG_TIME_SLOT},
+
+	{"buffer_LRU_batch_flush_avg_time_slot", "buffer",
+	 "Avg time (ms) spent in LRU flushing of a buffer pool instance"
+	 " recently",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_BATCH_FLUSH_AVG_TIME_SLOT},
+
+	{"buffer_flush_adaptive_avg_time_thread", "buffer",
+	 "Avg time (ms) spent in flush_list flushing by a page_cleaner"
+	 " thread in a round recently",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_ADAPTIVE_AVG_TIME_THREAD},
+
+	{"buffer_LRU_batch_flush_avg_time_thread", "buffer",
+	 "Avg time (ms) spent in LRU flushing by a page_cleaner thread"
+	 " in a round recently",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_BATCH_FLUSH_AVG_TIME_THREAD},
+
 	{"buffer_flush_sync_waits", "buffer",
 	 "Number of times a wait happens due to sync flushing",
 	 MONITOR_NONE,
@@ -789,6 +824,11 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_DISPLAY_CURRENT,
 	 MONITOR_DEFAULT_START, MONITOR_PURGE_RESUME_COUNT},
 
+	{"undo_truncate_count", "purge",
+	 "Number of times an undo tablespace was truncated",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_UNDO_TRUNCATE_COUNT},
+
 	/* ========== Counters for Recovery Module ========== */
 	{"module_log", "recovery", "Recovery Module",
 	 MONITOR_MODULE,
@@ -866,6 +906,12 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),
 	 MONITOR_DEFAULT_START, MONITOR_OVLD_LOG_WRITES},
 
+	{"log_closed_waits", "recovery",
+	 "Number of times a mini-transaction waited for older ones to add"
+	 " their dirty pages to the flush lists",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_CLOSED_WAITS},
+
 	/* ========== Counters for Page Compression ========== */
 	{"module_compress", "compression", "Page Compression Info",
 	 MONITOR_MODULE,
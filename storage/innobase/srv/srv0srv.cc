@@ -83,6 +83,8 @@ UNIV_INTERN ibool	srv_error_monitor_active = FALSE;
 
 UNIV_INTERN ibool	srv_buf_dump_thread_active = FALSE;
 
+UNIV_INTERN ibool	srv_buf_resize_thread_active = FALSE;
+
 UNIV_INTERN ibool	srv_dict_stats_thread_active = FALSE;
 
 UNIV_INTERN const char*	srv_main_thread_op_info = "";
@@ -109,6 +111,16 @@ UNIV_INTERN ulint	srv_undo_tablespaces_open = 8;
 /* The number of rollback segments to use */
 UNIV_INTERN ulong	srv_undo_logs = 1;
 
+/** Whether purge truncates undo tablespaces that grew too big */
+UNIV_INTERN my_bool	srv_undo_log_truncate = FALSE;
+
+/** Size in bytes above which an undo tablespace is truncated */
+UNIV_INTERN unsigned long long	srv_max_undo_log_size;
+
+/** Run history truncation, and the undo tablespace truncation check,
+every this many purge batches */
+UNIV_INTERN ulong	srv_purge_rseg_truncate_frequency = 128;
+
 #ifdef UNIV_LOG_ARCHIVE
 UNIV_INTERN char*	srv_arch_dir	= NULL;
 #endif /* UNIV_LOG_ARCHIVE */
@@ -139,6 +151,12 @@ on duplicate key checking and foreign key checking */
 UNIV_INTERN ibool	srv_locks_unsafe_for_binlog = FALSE;
 /** Sort buffer size in index creation */
 UNIV_INTERN ulong	srv_sort_buf_size = 1048576;
+/** Number of threads that sort and load the secondary indexes
+created by one ALTER TABLE */
+UNIV_INTERN ulong	srv_index_build_threads = 1;
+/** Percentage of each index page filled by the bulk load of a sorted
+index build */
+UNIV_INTERN ulong	srv_fill_factor = 100;
 /** Maximum modification log file size for online index creation */
 UNIV_INTERN unsigned long long	srv_online_max_size;
 
@@ -194,6 +212,8 @@ UNIV_INTERN ib_uint64_t	srv_log_file_size_requested;
 UNIV_INTERN ulint	srv_log_buffer_size	= ULINT_MAX;
 UNIV_INTERN ulong	srv_flush_log_at_trx_commit = 1;
 UNIV_INTERN uint	srv_flush_log_at_timeout = 1;
+UNIV_INTERN my_bool	srv_log_writer_threads = TRUE;
+UNIV_INTERN ulong	srv_log_wait_spin_rounds = 30;
 UNIV_INTERN char        srv_autoinc_persistent  = FALSE;
 UNIV_INTERN ulong       srv_n_autoinc_interval  = 1;
 UNIV_INTERN ulong	srv_page_size		= UNIV_PAGE_SIZE_DEF;
@@ -229,6 +249,8 @@ UNIV_INTERN ulong	srv_n_page_hash_locks = 16;
 UNIV_INTERN ulong	srv_LRU_scan_depth	= 1024;
 /** whether or not to flush neighbors of a block */
 UNIV_INTERN ulong	srv_flush_neighbors	= 1;
+/* size of a buffer pool chunk in bytes */
+UNIV_INTERN ulong	srv_buf_pool_chunk_unit;
 /* previously requested size */
 UNIV_INTERN ulint	srv_buf_pool_old_size;
 /* current size in kilobytes */
@@ -236,6 +258,8 @@ UNIV_INTERN ulint	srv_buf_pool_curr_size	= 0;
 /* size in bytes */
 UNIV_INTERN ulint	srv_mem_pool_size	= ULINT_MAX;
 UNIV_INTERN ulint	srv_lock_table_size	= ULINT_MAX;
+/* maximum size of the change buffer in percent of the buffer pool */
+UNIV_INTERN uint	srv_change_buffer_max_size = CHANGE_BUFFER_DEFAULT_SIZE;
 
 /* This parameter is deprecated. Use srv_n_io_[read|write]_threads
 instead. */
@@ -291,6 +315,14 @@ UNIV_INTERN ulong	srv_adaptive_flushing_lwm	= 10;
 /* Number of iterations over which adaptive flushing is averaged. */
 UNIV_INTERN ulong	srv_flushing_avg_loops		= 30;
 
+/* The number of page_cleaner threads: a coordinator and workers that
+flush the buffer pool instances in parallel with it. */
+UNIV_INTERN ulong	srv_n_page_cleaners		= 1;
+
+/* The number of threads applying the hashed log records during crash
+recovery: the thread running the recovery and the recovery apply workers. */
+UNIV_INTERN ulong	srv_n_recovery_apply_threads	= 4;
+
 /* The number of purge threads to use.*/
 UNIV_INTERN ulong	srv_n_purge_threads = 1;
 
@@ -322,6 +354,15 @@ UNIV_INTERN ulong	srv_force_recovery_crash;
 
 UNIV_INTERN my_bool	srv_print_all_deadlocks = FALSE;
 
+/** Look for deadlocks in the lock wait timeout thread, on a snapshot
+of the waits-for graph, instead of checking each lock wait when it is
+enqueued */
+
+UNIV_INTERN my_bool	srv_async_deadlock_detect = FALSE;
+
+/** innodb_lock_schedule_algorithm, see srv_lock_schedule_t */
+UNIV_INTERN ulong	srv_lock_schedule_algorithm = SRV_LOCK_SCHEDULE_FCFS;
+
 /** Enable INFORMATION_SCHEMA.innodb_cmp_per_index */
 UNIV_INTERN my_bool	srv_cmp_per_index_enabled = FALSE;
 
@@ -347,12 +388,22 @@ UNIV_INTERN my_bool		srv_stats_auto_recalc = TRUE;
 
 UNIV_INTERN ibool	srv_use_doublewrite_buf	= TRUE;
 
+/** innodb_atomic_writes, see srv_atomic_writes_t */
+UNIV_INTERN ulong	srv_atomic_writes	= SRV_ATOMIC_WRITES_OFF;
+/** TRUE if page writes are atomic and skip the doublewrite buffer; set at
+startup from srv_atomic_writes */
+UNIV_INTERN ibool	srv_use_atomic_writes	= FALSE;
+
 /** doublewrite buffer is 1MB is size i.e.: it can hold 128 16K pages.
 The following parameter is the size of the buffer that is used for
 batch flushing i.e.: LRU flushing and flush_list flushing. The rest
 of the pages are used for single page flushing. */
 UNIV_INTERN ulong	srv_doublewrite_batch_size	= 120;
 
+/** Directory of the doublewrite files, one for each buffer pool instance;
+NULL means the InnoDB data home directory. */
+UNIV_INTERN char*	srv_doublewrite_dir		= NULL;
+
 UNIV_INTERN ulong	srv_replication_delay		= 0;
 
 /*-------------------------------------------*/
@@ -610,6 +661,9 @@ UNIV_INTERN os_event_t	srv_error_event;
 /** Event to signal the buffer pool dump/load thread */
 UNIV_INTERN os_event_t	srv_buf_dump_event;
 
+/** Event to signal the buffer pool resize thread */
+UNIV_INTERN os_event_t	srv_buf_resize_event;
+
 /** The buffer pool dump/load file name */
 UNIV_INTERN char*	srv_buf_dump_filename;
 
@@ -618,6 +672,16 @@ and/or load it during startup. */
 UNIV_INTERN char	srv_buffer_pool_dump_at_shutdown = FALSE;
 UNIV_INTERN char	srv_buffer_pool_load_at_startup = FALSE;
 
+/** Number of threads that read the pages of a buffer pool load */
+UNIV_INTERN ulong	srv_buf_load_threads = 1;
+
+/** Percentage of the most recently used pages of every buffer pool
+instance that a buffer pool dump writes */
+UNIV_INTERN ulong	srv_buf_pool_dump_pct = 100;
+
+/** Seconds between the periodic buffer pool dumps, or 0 */
+UNIV_INTERN ulong	srv_buf_dump_interval = 0;
+
 /** Slot index in the srv_sys->sys_threads array for the purge thread. */
 static const ulint	SRV_PURGE_SLOT	= 1;
 
@@ -974,6 +1038,8 @@ srv_init(void)
 
 		srv_buf_dump_event = os_event_create();
 
+		srv_buf_resize_event = os_event_create();
+
 		UT_LIST_INIT(srv_sys->tasks);
 	}
 
@@ -1022,6 +1088,9 @@ srv_free(void)
 	if (!srv_read_only_mode) {
 		os_event_free(srv_buf_dump_event);
 		srv_buf_dump_event = NULL;
+
+		os_event_free(srv_buf_resize_event);
+		srv_buf_resize_event = NULL;
 	}
 }
 
@@ -1895,6 +1964,8 @@ srv_any_background_threads_are_active(void)
 		thread_active = "srv_monitor_thread";
 	} else if (srv_buf_dump_thread_active) {
 		thread_active = "buf_dump_thread";
+	} else if (srv_buf_resize_thread_active) {
+		thread_active = "buf_resize_thread";
 	} else if (srv_dict_stats_thread_active) {
 		thread_active = "dict_stats_thread";
 	}
@@ -1902,6 +1973,7 @@ srv_any_background_threads_are_active(void)
 	os_event_set(srv_error_event);
 	os_event_set(srv_monitor_event);
 	os_event_set(srv_buf_dump_event);
+	os_event_set(srv_buf_resize_event);
 	os_event_set(lock_sys->timeout_event);
 	os_event_set(dict_stats_event);
 
@@ -2231,6 +2303,12 @@ srv_master_do_idle_tasks(void)
 	srv_main_thread_op_info = "checking free log space";
 	log_free_check();
 
+	/* Purge is not woken up by transactions that only insert, let it
+	check whether the undo tablespace marked for truncation is free. */
+	if (purge_sys->undo_trunc_space != ULINT_UNDEFINED) {
+		srv_wake_purge_thread_if_not_active();
+	}
+
 	/* Do an ibuf merge */
 	counter_time = ut_time_us(NULL);
 	srv_main_thread_op_info = "doing insert buffer merge";
@@ -2623,12 +2701,23 @@ srv_do_purge(
 
 		/* Take a snapshot of the history list before purge. */
 		if ((rseg_history_len = trx_sys->rseg_history_len) == 0) {
+
+			/* Truncate the undo tablespace marked for
+			truncation once purge has freed its undo logs. */
+			if (purge_sys->undo_trunc_space != ULINT_UNDEFINED) {
+				trx_purge(n_use_threads, srv_purge_batch_size,
+					  true);
+			}
+
 			break;
 		}
 
+		/* Free the purged undo logs in every batch while an undo
+		tablespace waits for truncation. */
 		n_pages_purged = trx_purge(
 			n_use_threads, srv_purge_batch_size,
-			(++count % TRX_SYS_N_RSEGS) == 0);
+			(++count % srv_purge_rseg_truncate_frequency) == 0
+			|| purge_sys->undo_trunc_space != ULINT_UNDEFINED);
 
 		*n_total_purged += n_pages_purged;
 
@@ -139,10 +139,6 @@ static os_fast_mutex_t	srv_os_test_mutex;
 static char*	srv_monitor_file_name;
 #endif /* !UNIV_HOTBACKUP */
 
-/** Default undo tablespace size in UNIV_PAGEs count (10MB). */
-static const ulint SRV_UNDO_TABLESPACE_SIZE_IN_PAGES =
-	((1024 * 1024) * 10) / UNIV_PAGE_SIZE_DEF;
-
 /** */
 #define SRV_N_PENDING_IOS_PER_THREAD	OS_AIO_N_PENDING_IOS_PER_THREAD
 #define SRV_MAX_N_PENDING_SYNC_IOS	100
@@ -758,6 +754,75 @@ open_log_file(
 	return(DB_SUCCESS);
 }
 
+/*********************************************************************//**
+Decides at startup whether page writes are atomic and can skip the
+doublewrite buffer. This must be called before the doublewrite buffer is
+initialized. */
+static
+void
+srv_init_atomic_writes(
+/*===================*/
+	const char*	name)	/*!< in: first system tablespace file */
+{
+	ulint	atomic_write_size;
+
+	switch (srv_atomic_writes) {
+	case SRV_ATOMIC_WRITES_OFF:
+		return;
+	case SRV_ATOMIC_WRITES_ON:
+		srv_use_atomic_writes = TRUE;
+		break;
+	case SRV_ATOMIC_WRITES_AUTO:
+		/* Only writes that bypass the file system cache are
+		written atomically by the device. */
+		if (srv_unix_file_flush_method != SRV_UNIX_O_DIRECT
+		    && srv_unix_file_flush_method
+		    != SRV_UNIX_O_DIRECT_NO_FSYNC) {
+
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"innodb_atomic_writes=AUTO requires"
+				" innodb_flush_method=O_DIRECT:"
+				" using the doublewrite buffer");
+			return;
+		}
+
+		atomic_write_size = os_file_get_atomic_write_size(name);
+
+		if (atomic_write_size < UNIV_PAGE_SIZE) {
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"The storage of %s does not report atomic"
+				" writes of %lu bytes: using the doublewrite"
+				" buffer", name, (ulong) UNIV_PAGE_SIZE);
+			return;
+		}
+
+		srv_use_atomic_writes = TRUE;
+		break;
+	default:
+		ut_error;
+	}
+
+	if (srv_checksum_algorithm == SRV_CHECKSUM_ALGORITHM_NONE
+	    || srv_checksum_algorithm
+	    == SRV_CHECKSUM_ALGORITHM_STRICT_NONE) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"innodb_checksum_algorithm=%s: crash recovery"
+			" cannot detect torn pages",
+			buf_checksum_algorithm_name(
+				static_cast<srv_checksum_algorithm_t>(
+					srv_checksum_algorithm)));
+	}
+
+	/* A page write is never torn, so it does not need a copy in
+	the doublewrite buffer. The doublewrite buffer is still read
+	in crash recovery in case an earlier run wrote it. */
+	srv_use_doublewrite_buf = FALSE;
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Using atomic page writes: the doublewrite buffer"
+		" is not written");
+}
+
 /*********************************************************************//**
 Creates or opens database data files and closes them.
 @return	DB_SUCCESS or error code */
@@ -1020,6 +1085,10 @@ skip_size_check:
 			/* This is the earliest location where we can load
 			the double write buffer. */
 			if (i == 0) {
+				if (!srv_read_only_mode) {
+					srv_init_atomic_writes(name);
+				}
+
 				buf_dblwr_init_or_load_pages(
 					files[i], srv_data_file_names[i], true);
 			}
@@ -1125,6 +1194,10 @@ check_first_page:
 			}
 
 			*sum_of_new_sizes += srv_data_file_sizes[i];
+
+			if (i == 0) {
+				srv_init_atomic_writes(name);
+			}
 		}
 
 		ret = os_file_close(files[i]);
@@ -1406,6 +1479,21 @@ srv_undo_tablespaces_init(
 		prev_space_id = undo_tablespace_ids[i];
 
 		++*n_opened;
+
+		/* Complete a truncation that was interrupted by a crash.
+		This must follow the ++*n_opened above, so that the file
+		is not mistaken for a user tablespace by the fil_system
+		LRU. */
+		err = trx_purge_undo_trunc_startup(undo_tablespace_ids[i]);
+
+		if (err != DB_SUCCESS) {
+
+			ib_logf(IB_LOG_LEVEL_ERROR,
+				"Unable to truncate undo tablespace '%s'.",
+				name);
+
+			return(err);
+		}
 	}
 
 	/* Open any extra unused undo tablespaces. These must be contiguous.
@@ -1819,7 +1907,6 @@ innobase_start_or_create_for_mysql(void)
 	maximum number of threads that can wait in the 'srv_conc array' for
 	their time to enter InnoDB. */
 
-#define BUF_POOL_SIZE_THRESHOLD (1024 * 1024 * 1024)
 	srv_max_n_threads = 1   /* io_ibuf_thread */
 			    + 1 /* io_log_thread */
 			    + 1 /* lock_wait_timeout_thread */
@@ -1828,10 +1915,14 @@ innobase_start_or_create_for_mysql(void)
 			    + 1 /* srv_master_thread */
 			    + 1 /* srv_purge_coordinator_thread */
 			    + 1 /* buf_dump_thread */
+			    + 1 /* buf_resize_thread */
 			    + 1 /* dict_stats_thread */
 			    + 1 /* fts_optimize_thread */
 			    + 1 /* recv_writer_thread */
-			    + 1 /* buf_flush_page_cleaner_thread */
+			    + srv_n_recovery_apply_threads /* recv_apply_thread */
+			    + 1 /* log_writer_thread */
+			    + 1 /* log_flusher_thread */
+			    + srv_n_page_cleaners /* buf_flush_page_cleaner_thread */
 			    + 1 /* trx_rollback_or_clean_all_recovered */
 			    + 128 /* added as margin, for use of
 				  InnoDB Memcached etc. */
@@ -1849,6 +1940,31 @@ innobase_start_or_create_for_mysql(void)
 		srv_buf_pool_instances = 1;
 	}
 
+	if (srv_buf_pool_chunk_unit * srv_buf_pool_instances
+	    > srv_buf_pool_size) {
+		/* A chunk may not be bigger than a buffer pool
+		instance. */
+		srv_buf_pool_chunk_unit = static_cast<ulong>(
+			srv_buf_pool_size / srv_buf_pool_instances);
+	}
+
+	if (srv_buf_pool_size != buf_pool_size_align(srv_buf_pool_size)) {
+		srv_buf_pool_size = buf_pool_size_align(srv_buf_pool_size);
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Rounded innodb_buffer_pool_size up to %lu, a multiple"
+			" of innodb_buffer_pool_chunk_size (%lu) *"
+			" innodb_buffer_pool_instances (%lu)",
+			srv_buf_pool_size, srv_buf_pool_chunk_unit,
+			srv_buf_pool_instances);
+	}
+
+	if (srv_n_page_cleaners > srv_buf_pool_instances) {
+		/* A page_cleaner thread flushes one buffer pool
+		instance at a time, more threads would be idle. */
+		srv_n_page_cleaners = srv_buf_pool_instances;
+	}
+
 	srv_boot();
 
 	ib_logf(IB_LOG_LEVEL_INFO,
@@ -2435,6 +2551,10 @@ files_checked:
 			LOG_CHECKPOINT, LSN_MAX,
 			min_flushed_lsn, max_flushed_lsn);
 
+		/* The pages read from the doublewrite buffer and files
+		are no longer needed. */
+		buf_dblwr_free_read_buf();
+
 		if (err != DB_SUCCESS) {
 
 			return(DB_ERROR);
@@ -2452,6 +2572,10 @@ files_checked:
 			return(err);
 		}
 
+		/* Recreate the rollback segments of the undo tablespaces
+		whose truncation was interrupted. */
+		trx_purge_undo_trunc_recover();
+
 		ib_bh = trx_sys_init_at_db_start();
 		n_recovered_trx = UT_LIST_GET_LEN(trx_sys->rw_trx_list);
 
@@ -2465,6 +2589,8 @@ files_checked:
 
 		recv_recovery_from_checkpoint_finish();
 
+		trx_purge_undo_trunc_recover_done();
+
 		if (srv_force_recovery < SRV_FORCE_NO_IBUF_MERGE) {
 			/* The following call is necessary for the insert
 			buffer to work with multiple tablespaces. We must
@@ -2731,8 +2857,19 @@ files_checked:
 		purge_sys->state = PURGE_STATE_DISABLED;
 	}
 
+	if (!srv_read_only_mode && srv_log_writer_threads) {
+		log_start_writer_threads();
+	}
+
 	if (!srv_read_only_mode) {
+		buf_flush_page_cleaner_init();
+
 		os_thread_create(buf_flush_page_cleaner_thread, NULL, NULL);
+
+		for (i = 1; i < srv_n_page_cleaners; ++i) {
+			os_thread_create(buf_flush_page_cleaner_worker,
+					 NULL, NULL);
+		}
 	}
 
 #ifdef UNIV_DEBUG
@@ -2879,6 +3016,9 @@ files_checked:
 		/* Create the buffer pool dump/load thread */
 		os_thread_create(buf_dump_thread, NULL, NULL);
 
+		/* Create the buffer pool resize thread */
+		os_thread_create(buf_resize_thread, NULL, NULL);
+
 		/* Create the dict stats gathering thread */
 		os_thread_create(dict_stats_thread, NULL, NULL);
 
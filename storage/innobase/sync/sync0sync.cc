@@ -1148,11 +1148,13 @@ sync_thread_add_level(
 	case SYNC_LOG_FLUSH_ORDER:
 	case SYNC_ANY_LATCH:
 	case SYNC_FILE_FORMAT_TAG:
+	case SYNC_PAGE_CLEANER:
 	case SYNC_DOUBLEWRITE:
 	case SYNC_THREADS:
 	case SYNC_LOCK_SYS:
 	case SYNC_LOCK_WAIT_SYS:
 	case SYNC_TRX_SYS:
+	case SYNC_TRX_SYS_VIEW:
 	case SYNC_IBUF_BITMAP_MUTEX:
 	case SYNC_RSEG:
 	case SYNC_TRX_UNDO:
@@ -1181,6 +1183,14 @@ sync_thread_add_level(
 			ut_a(sync_thread_levels_contain(array, SYNC_LOCK_SYS));
 		}
 		break;
+	case SYNC_LOCK_REC_HASH:
+		/* Either the thread must own the lock_sys->mutex, or
+		it is allowed to own only ONE lock_sys->rec_hash mutex. */
+		if (!sync_thread_levels_g(array, level, FALSE)) {
+			ut_a(sync_thread_levels_g(array, level - 1, TRUE));
+			ut_a(sync_thread_levels_contain(array, SYNC_LOCK_SYS));
+		}
+		break;
 	case SYNC_SEARCH_SYS: {
 		/* Verify the lock order inside the split btr_search_latch
 		array */
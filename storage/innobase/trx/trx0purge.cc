@@ -45,6 +45,8 @@ Created 3/26/1996 Heikki Tuuri
 #include "os0thread.h"
 #include "srv0mon.h"
 #include "mtr0log.h"
+#include "buf0lru.h"
+#include "os0file.h"
 
 /** Maximum allowable purge history length.  <=0 means 'infinite'. */
 UNIV_INTERN ulong		srv_max_purge_lag = 0;
@@ -120,6 +122,7 @@ trx_purge_sys_create(
 
 	purge_sys->state = PURGE_STATE_INIT;
 	purge_sys->event = os_event_create();
+	purge_sys->undo_trunc_space = ULINT_UNDEFINED;
 
 	/* Take ownership of ib_bh, we are responsible for freeing it. */
 	purge_sys->ib_bh = ib_bh;
@@ -1159,6 +1162,503 @@ trx_purge_wait_for_workers_to_complete(
 	ut_a(srv_get_task_queue_length() == 0);
 }
 
+/*================ UNDO TABLESPACE TRUNCATION ==========================*/
+
+/** Undo tablespaces whose interrupted truncation is completed at startup,
+indexed by space id */
+static bool	trx_purge_undo_trunc_recv[TRX_SYS_N_RSEGS];
+
+/*******************************************************************//**
+Builds the file name of the truncate log of an undo tablespace. While the
+log exists, the undo tablespace is recreated empty at startup. */
+static
+void
+trx_purge_undo_trunc_log_name(
+/*==========================*/
+	char*	name,		/*!< out: file name */
+	ulint	len,		/*!< in: size of name in bytes */
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	ut_snprintf(name, len, "%s%cundo_%lu_trunc.log",
+		    srv_undo_dir, SRV_PATH_SEPARATOR, space_id);
+}
+
+/*******************************************************************//**
+Creates the truncate log of an undo tablespace.
+@return	true if success */
+static
+bool
+trx_purge_undo_trunc_log_create(
+/*============================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	os_file_t	fh;
+	ibool		ret;
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space_id);
+
+	fh = os_file_create(
+		innodb_file_data_key, name,
+		OS_FILE_OVERWRITE | OS_FILE_ON_ERROR_NO_EXIT,
+		OS_FILE_NORMAL, OS_DATA_FILE, &ret);
+
+	if (!ret) {
+		return(false);
+	}
+
+	ret = os_file_flush(fh);
+
+	os_file_close(fh);
+
+	return(ret);
+}
+
+/*******************************************************************//**
+Checks whether the truncate log of an undo tablespace exists.
+@return	true if the log exists */
+static
+bool
+trx_purge_undo_trunc_log_exists(
+/*============================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	ibool		exists;
+	os_file_type_t	type;
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space_id);
+
+	return(os_file_status(name, &exists, &type) && exists);
+}
+
+/*******************************************************************//**
+Removes the truncate log of an undo tablespace. */
+static
+void
+trx_purge_undo_trunc_log_delete(
+/*============================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char	name[OS_FILE_MAX_PATH];
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space_id);
+
+	os_file_delete_if_exists(innodb_file_data_key, name);
+}
+
+/*******************************************************************//**
+Initializes the header of an undo tablespace that has just been truncated,
+and creates its rollback segment headers again, in the slots of the trx
+system header that they had before. */
+static
+void
+trx_purge_undo_space_init(
+/*======================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	mtr_t		mtr;
+	trx_sysf_t*	sys_header;
+	ulint		rseg_ids[TRX_SYS_N_RSEGS];
+	ulint		n_rsegs = 0;
+	ulint		i;
+
+	mtr_start(&mtr);
+
+	sys_header = trx_sysf_get(&mtr);
+
+	for (i = 0; i < TRX_SYS_N_RSEGS; i++) {
+		if (trx_sysf_rseg_get_page_no(sys_header, i, &mtr) != FIL_NULL
+		    && trx_sysf_rseg_get_space(sys_header, i, &mtr)
+		    == space_id) {
+
+			rseg_ids[n_rsegs++] = i;
+		}
+	}
+
+	mtr_commit(&mtr);
+
+	mtr_start(&mtr);
+
+	fsp_header_init(space_id, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES, &mtr);
+
+	mtr_commit(&mtr);
+
+	for (i = 0; i < n_rsegs; i++) {
+		ulint		page_no;
+		trx_rseg_t*	rseg;
+
+		mtr_start(&mtr);
+
+		mtr_x_lock(fil_space_get_latch(space_id, NULL), &mtr);
+
+		page_no = trx_rseg_header_create(
+			space_id, 0, ULINT_MAX, rseg_ids[i], &mtr);
+
+		ut_a(page_no != FIL_NULL);
+
+		mtr_commit(&mtr);
+
+		/* In crash recovery the memory objects of the rollback
+		segments are not created yet. */
+		rseg = trx_sys->rseg_array[rseg_ids[i]];
+
+		if (rseg != NULL) {
+			trx_rseg_mem_reinit(rseg, page_no, ULINT_MAX);
+		}
+	}
+}
+
+/*******************************************************************//**
+Sets or clears the flag that keeps transactions from being assigned the
+rollback segments of an undo tablespace. */
+static
+void
+trx_purge_undo_space_skip_allocation(
+/*=================================*/
+	ulint	space_id,	/*!< in: undo tablespace id */
+	bool	skip)		/*!< in: value of the flag */
+{
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; i++) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+
+		if (rseg != NULL && rseg->space == space_id) {
+			mutex_enter(&rseg->mutex);
+			rseg->skip_allocation = skip;
+			mutex_exit(&rseg->mutex);
+		}
+	}
+}
+
+/*******************************************************************//**
+Marks an undo tablespace that has grown bigger than innodb_max_undo_log_size
+for truncation. Its rollback segments are no longer assigned to new
+transactions, so that purge can free all of its undo logs. */
+static
+void
+trx_purge_mark_undo_for_truncate(void)
+/*==================================*/
+{
+	ulint	n_spaces = srv_undo_tablespaces_open;
+
+	if (purge_sys->undo_trunc_space != ULINT_UNDEFINED) {
+
+		if (!srv_undo_log_truncate) {
+			trx_purge_undo_space_skip_allocation(
+				purge_sys->undo_trunc_space, false);
+
+			purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+		}
+
+		return;
+	}
+
+	/* Transactions must be able to use another undo tablespace while
+	one is truncated. */
+	if (!srv_undo_log_truncate || n_spaces < 2) {
+		return;
+	}
+
+	/* Start after the undo tablespace that was truncated last, so
+	that all of them get their turn. */
+	for (ulint i = 0; i < n_spaces; i++) {
+		ulint	space_id = (purge_sys->undo_trunc_last + i)
+			% n_spaces + 1;
+		ulint	size = fil_space_get_size(space_id);
+		ulint	n_rsegs = 0;
+		ulint	n_other_rsegs = 0;
+
+		if ((ib_uint64_t) size * UNIV_PAGE_SIZE
+		    <= srv_max_undo_log_size) {
+			continue;
+		}
+
+		for (ulint j = 0; j < TRX_SYS_N_RSEGS; j++) {
+			const trx_rseg_t*	rseg = trx_sys->rseg_array[j];
+
+			if (rseg == NULL || rseg->space == 0) {
+			} else if (rseg->space == space_id) {
+				n_rsegs++;
+			} else {
+				n_other_rsegs++;
+			}
+		}
+
+		if (n_rsegs == 0 || n_other_rsegs == 0) {
+			continue;
+		}
+
+		trx_purge_undo_space_skip_allocation(space_id, true);
+
+		purge_sys->undo_trunc_space = space_id;
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Undo tablespace %lu has grown to %lu pages,"
+			" it will be truncated once its undo logs"
+			" are purged", space_id, size);
+
+		return;
+	}
+}
+
+/*******************************************************************//**
+Checks whether purge has processed all the undo logs of an undo tablespace
+and no transaction uses its rollback segments. The history lists can still
+hold logs that were purged but not yet freed: the last log is only freed
+after more transactions have committed.
+@return	true if the undo tablespace can be truncated */
+static
+bool
+trx_purge_undo_space_is_free(
+/*=========================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; i++) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+		bool		in_use;
+
+		if (rseg == NULL || rseg->space != space_id) {
+			continue;
+		}
+
+		if (purge_sys->rseg == rseg && purge_sys->next_stored) {
+			return(false);
+		}
+
+		mutex_enter(&rseg->mutex);
+
+		/* Read after skip_allocation was set, see
+		trx_assign_rseg_low(). */
+		in_use = rseg->trx_ref_count > 0
+			|| UT_LIST_GET_LEN(rseg->update_undo_list) > 0
+			|| UT_LIST_GET_LEN(rseg->insert_undo_list) > 0
+			|| rseg->last_page_no != FIL_NULL;
+
+		mutex_exit(&rseg->mutex);
+
+		if (in_use) {
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/*******************************************************************//**
+Gets the number of purged undo logs left in the history lists of the
+rollback segments of an undo tablespace.
+@return	number of undo logs */
+static
+ulint
+trx_purge_undo_space_get_history_len(
+/*=================================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	ulint	len = 0;
+
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; i++) {
+		const trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+		mtr_t			mtr;
+		trx_rsegf_t*		rseg_header;
+
+		if (rseg == NULL || rseg->space != space_id) {
+			continue;
+		}
+
+		mtr_start(&mtr);
+
+		rseg_header = trx_rsegf_get(
+			rseg->space, rseg->zip_size, rseg->page_no, &mtr);
+
+		len += flst_get_len(rseg_header + TRX_RSEG_HISTORY, &mtr);
+
+		mtr_commit(&mtr);
+	}
+
+	return(len);
+}
+
+/*******************************************************************//**
+Truncates the undo tablespace marked for truncation, if purge has freed
+all of its undo logs. The file is truncated to its initial size and the
+rollback segment headers are created again in it. A truncate log makes
+this crash safe: while it exists, the tablespace is recreated at startup
+instead of being recovered from the redo log. */
+static
+void
+trx_purge_truncate_undo_space(void)
+/*===============================*/
+{
+	ulint	space_id = purge_sys->undo_trunc_space;
+	ulint	n_removed_logs;
+
+	if (space_id == ULINT_UNDEFINED
+	    || srv_shutdown_state != SRV_SHUTDOWN_NONE
+	    || !trx_purge_undo_space_is_free(space_id)) {
+
+		return;
+	}
+
+	ib_logf(IB_LOG_LEVEL_INFO, "Truncating undo tablespace %lu",
+		space_id);
+
+	if (!trx_purge_undo_trunc_log_create(space_id)) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Cannot create the truncate log of undo tablespace"
+			" %lu in %s, the tablespace is not truncated",
+			space_id, srv_undo_dir);
+
+		trx_purge_undo_space_skip_allocation(space_id, false);
+
+		purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+		purge_sys->undo_trunc_last = space_id;
+
+		return;
+	}
+
+	n_removed_logs = trx_purge_undo_space_get_history_len(space_id);
+
+	/* The pages are neither written nor recovered any more. */
+	buf_LRU_flush_or_remove_pages(
+		space_id, BUF_REMOVE_ALL_NO_WRITE, NULL);
+
+	if (!fil_truncate_tablespace(
+		    space_id, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES)) {
+
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"Cannot truncate undo tablespace %lu, it will be"
+			" recreated at the next startup", space_id);
+	}
+
+	trx_purge_undo_space_init(space_id);
+
+	/* The purged logs in the history lists were discarded. */
+#ifdef HAVE_ATOMIC_BUILTINS
+	os_atomic_decrement_ulint(&trx_sys->rseg_history_len, n_removed_logs);
+#else
+	mutex_enter(&trx_sys->mutex);
+	trx_sys->rseg_history_len -= n_removed_logs;
+	mutex_exit(&trx_sys->mutex);
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+	/* Write the new pages and the rollback segment slots of the trx
+	system header, so that the older redo log of the tablespace is
+	no longer needed. */
+	log_make_checkpoint_at(LSN_MAX, TRUE);
+
+	trx_purge_undo_trunc_log_delete(space_id);
+
+	trx_purge_undo_space_skip_allocation(space_id, false);
+
+	purge_sys->undo_trunc_space = ULINT_UNDEFINED;
+	purge_sys->undo_trunc_last = space_id;
+
+	MONITOR_INC(MONITOR_UNDO_TRUNCATE_COUNT);
+
+	ib_logf(IB_LOG_LEVEL_INFO, "Truncated undo tablespace %lu",
+		space_id);
+}
+
+/*******************************************************************//**
+Checks at startup whether the truncation of an undo tablespace was
+interrupted, and if so truncates its file again. The redo log records
+of the tablespace are then skipped in crash recovery.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+trx_purge_undo_trunc_startup(
+/*=========================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	ut_a(space_id < TRX_SYS_N_RSEGS);
+
+	if (!trx_purge_undo_trunc_log_exists(space_id)) {
+		return(DB_SUCCESS);
+	}
+
+	if (srv_read_only_mode) {
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"The truncation of undo tablespace %lu was"
+			" interrupted, it cannot be completed in"
+			" read-only mode", space_id);
+
+		return(DB_READ_ONLY);
+	}
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Completing the interrupted truncation of undo"
+		" tablespace %lu", space_id);
+
+	if (!fil_truncate_tablespace(
+		    space_id, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES)) {
+
+		return(DB_ERROR);
+	}
+
+	trx_purge_undo_trunc_recv[space_id] = true;
+
+	return(DB_SUCCESS);
+}
+
+/*******************************************************************//**
+Checks whether the truncation of an undo tablespace is being completed
+at startup, so that its redo log records must not be applied.
+@return	true if the tablespace is being truncated */
+UNIV_INTERN
+bool
+trx_purge_undo_trunc_is_recovering(
+/*===============================*/
+	ulint	space_id)	/*!< in: tablespace id */
+{
+	return(space_id < TRX_SYS_N_RSEGS
+	       && trx_purge_undo_trunc_recv[space_id]);
+}
+
+/*******************************************************************//**
+Creates the rollback segment headers again in the undo tablespaces that
+trx_purge_undo_trunc_startup() truncated. Must be called in crash recovery
+before the rollback segments are read by trx_sys_init_at_db_start(). */
+UNIV_INTERN
+void
+trx_purge_undo_trunc_recover(void)
+/*===============================*/
+{
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; i++) {
+		if (trx_purge_undo_trunc_recv[i]) {
+			trx_purge_undo_space_init(i);
+		}
+	}
+}
+
+/*******************************************************************//**
+Completes the truncations of undo tablespaces after crash recovery:
+makes a checkpoint and removes the truncate logs. */
+UNIV_INTERN
+void
+trx_purge_undo_trunc_recover_done(void)
+/*===================================*/
+{
+	bool	checkpoint_done = false;
+
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; i++) {
+		if (!trx_purge_undo_trunc_recv[i]) {
+			continue;
+		}
+
+		if (!checkpoint_done) {
+			log_make_checkpoint_at(LSN_MAX, TRUE);
+			checkpoint_done = true;
+		}
+
+		trx_purge_undo_trunc_log_delete(i);
+
+		trx_purge_undo_trunc_recv[i] = false;
+
+		ib_logf(IB_LOG_LEVEL_INFO, "Truncated undo tablespace %lu",
+			i);
+	}
+}
+
 /******************************************************************//**
 Remove old historical changes from the rollback segments. */
 static
@@ -1173,6 +1673,10 @@ trx_purge_truncate(void)
 	} else {
 		trx_purge_truncate_history(&purge_sys->limit, purge_sys->view);
 	}
+
+	trx_purge_mark_undo_for_truncate();
+
+	trx_purge_truncate_undo_space();
 }
 
 /*******************************************************************//**
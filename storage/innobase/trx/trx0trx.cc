@@ -138,11 +138,28 @@ trx_reserve_descriptor(
 #else
 	if (UNIV_UNLIKELY(n_used > n_max)) {
 #endif
+		trx_id_t*	new_descr;
+
 		n_max = n_max * 2;
 
-		trx_sys->descriptors = static_cast<trx_id_t*>(
-			ut_realloc(trx_sys->descriptors,
-				   n_max * sizeof(trx_id_t)));
+		/* The old array cannot be reallocated in place because
+		read_view_open_now() may be copying from it without
+		holding trx_sys->mutex. Retire it instead. */
+		new_descr = static_cast<trx_id_t*>(
+			ut_malloc(n_max * sizeof(trx_id_t)));
+
+		memcpy(new_descr, trx_sys->descriptors,
+		       trx_sys->descr_n_used * sizeof(trx_id_t));
+
+		ut_a(trx_sys->descr_n_retired < TRX_DESCR_ARRAY_MAX_RETIRED);
+		trx_sys->descr_retired[trx_sys->descr_n_retired++] =
+			trx_sys->descriptors;
+
+		trx_sys->descriptors = new_descr;
+
+		/* A reader that sees the new size must also see the new
+		array. */
+		os_wmb;
 
 		trx_sys->descr_n_max = n_max;
 		srv_descriptors_memory = n_max * sizeof(trx_id_t);
@@ -193,31 +210,38 @@ trx_release_descriptor(
 
 	ut_ad(mutex_own(&trx_sys->mutex));
 
+	trx_sys_descr_write_begin();
+
 	if (UNIV_LIKELY(trx->in_trx_serial_list)) {
 
 		UT_LIST_REMOVE(trx_serial_list, trx_sys->trx_serial_list,
 			       trx);
 		trx->in_trx_serial_list = 0;
+
+		trx_sys->serial_min_no =
+			UT_LIST_GET_LEN(trx_sys->trx_serial_list) > 0
+			? UT_LIST_GET_FIRST(trx_sys->trx_serial_list)->no
+			: TRX_ID_MAX;
 	}
 
 	descr = trx_find_descriptor(trx_sys->descriptors,
 				    trx_sys->descr_n_used,
 				    trx->id);
 
-	if (UNIV_UNLIKELY(descr == NULL)) {
+	if (UNIV_LIKELY(descr != NULL)) {
 
-		return;
-	}
+		size = (trx_sys->descriptors + trx_sys->descr_n_used - 1
+			- descr) * sizeof(trx_id_t);
 
-	size = (trx_sys->descriptors + trx_sys->descr_n_used - 1 - descr) *
-		sizeof(trx_id_t);
+		if (UNIV_LIKELY(size > 0)) {
 
-	if (UNIV_LIKELY(size > 0)) {
+			ut_memmove(descr, descr + 1, size);
+		}
 
-		ut_memmove(descr, descr + 1, size);
+		trx_sys->descr_n_used--;
 	}
 
-	trx_sys->descr_n_used--;
+	trx_sys_descr_write_end();
 }
 
 /****************************************************************//**
@@ -664,6 +688,8 @@ trx_resurrect_insert(
 
 	trx = trx_allocate_for_background();
 
+	os_atomic_inc_ulint(&rseg->mutex, &rseg->trx_ref_count, 1);
+
 	trx->rseg = rseg;
 	trx->xid = undo->xid;
 	trx->id = undo->trx_id;
@@ -785,6 +811,12 @@ trx_resurrect_update(
 	trx_undo_t*	undo,	/*!< in/out: update UNDO record */
 	trx_rseg_t*	rseg)	/*!< in/out: rollback segment */
 {
+	if (trx->rseg == NULL) {
+		os_atomic_inc_ulint(&rseg->mutex, &rseg->trx_ref_count, 1);
+	} else {
+		ut_ad(trx->rseg == rseg);
+	}
+
 	trx->rseg = rseg;
 	trx->xid = undo->xid;
 	trx->id = undo->trx_id;
@@ -845,6 +877,7 @@ trx_lists_init_at_db_start(void)
 
 	UT_LIST_INIT(trx_sys->rw_trx_list);
 	UT_LIST_INIT(trx_sys->trx_serial_list);
+	trx_sys->serial_min_no = TRX_ID_MAX;
 
 	/* Look from the rollback segments if there exist undo logs for
 	transactions */
@@ -950,16 +983,37 @@ trx_assign_rseg_low(
 	defined for rollback segments. We want all UNDO records to be in
 	the non-system tablespaces. */
 
-	do {
+	for (ulint n_skipped = 0;; ++n_skipped) {
 		rseg = trx_sys->rseg_array[i];
 		ut_a(rseg == NULL || i == rseg->id);
 
-		i = (rseg == NULL) ? 0 : i + 1;
+		i = (rseg == NULL || i + 1 == TRX_SYS_N_RSEGS) ? 0 : i + 1;
+
+		if (n_skipped > 2 * TRX_SYS_N_RSEGS) {
+			/* Every rollback segment outside the system
+			tablespace is in an undo tablespace that is being
+			truncated. The system tablespace is never
+			truncated. */
+			rseg = trx_sys->rseg_array[0];
+		} else if (rseg == NULL
+			   || (rseg->space == 0
+			       && n_tablespaces > 0
+			       && trx_sys->rseg_array[1] != NULL)) {
+			continue;
+		}
+
+		/* Take the reference before checking skip_allocation.
+		trx_purge_truncate_undo_space() sets the flag before it
+		checks the references, thus either it sees our reference
+		or we see the flag. */
+		os_atomic_inc_ulint(&rseg->mutex, &rseg->trx_ref_count, 1);
 
-	} while (rseg == NULL
-		 || (rseg->space == 0
-		     && n_tablespaces > 0
-		     && trx_sys->rseg_array[1] != NULL));
+		if (!rseg->skip_allocation) {
+			break;
+		}
+
+		os_atomic_dec_ulint(&rseg->mutex, &rseg->trx_ref_count, 1);
+	}
 
 	return(rseg);
 }
@@ -983,8 +1037,10 @@ trx_assign_rseg(
 
 	if (trx->id == 0) {
 		mutex_enter(&trx_sys->mutex);
+		trx_sys_descr_write_begin();
 		trx->id = trx_sys_get_new_trx_id();
 		trx_reserve_descriptor(trx);
+		trx_sys_descr_write_end();
 		UT_LIST_ADD_FIRST(trx_list, trx_sys->rw_trx_list, trx);
 		ut_d(trx->in_rw_trx_list = TRUE);
 		ut_ad(trx_sys_validate_trx_list());
@@ -1068,12 +1124,16 @@ trx_start_low(
 
 		trx->state = TRX_STATE_ACTIVE;
 
+		trx_sys_descr_write_begin();
+
 		trx->id = trx_sys_get_new_trx_id();
 
 		UT_LIST_ADD_FIRST(trx_list, trx_sys->rw_trx_list, trx);
 
 		trx_reserve_descriptor(trx);
 
+		trx_sys_descr_write_end();
+
 		ut_ad(trx->rseg != 0
 		      || srv_read_only_mode
 		      || srv_force_recovery >= SRV_FORCE_NO_TRX_UNDO);
@@ -1113,6 +1173,8 @@ trx_serialisation_number_get(
 
 	mutex_enter(&trx_sys->mutex);
 
+	trx_sys_descr_write_begin();
+
 	trx->no = trx_sys_get_new_trx_id();
 
 	if (UNIV_LIKELY(trx->in_trx_serial_list == 0)) {
@@ -1121,8 +1183,13 @@ trx_serialisation_number_get(
 				 trx);
 
 		trx->in_trx_serial_list = 1;
+
+		trx_sys->serial_min_no =
+			UT_LIST_GET_FIRST(trx_sys->trx_serial_list)->no;
 	}
 
+	trx_sys_descr_write_end();
+
 	/* If the rollack segment is not empty then the
 	new trx_t::no can't be less than any trx_t::no
 	already in the rollback segment. User threads only
@@ -1412,7 +1479,6 @@ trx_commit_in_memory(
 			      UT_LIST_GET_LEN(trx_sys->rw_trx_list));
 
 			MONITOR_INC(MONITOR_TRX_RW_COMMIT);
-			read_view_remove(trx->global_read_view, true);
 			ut_ad(trx_sys_validate_trx_list());
 			/* If this transaction came from trx_allocate_for_mysql(),
 			trx->in_mysql_trx_list would hold. In that case, the
@@ -1421,6 +1487,12 @@ trx_commit_in_memory(
 			view. */
 			trx->state = TRX_STATE_NOT_STARTED;
 			mutex_exit(&trx_sys->mutex);
+
+			if (trx->global_read_view != NULL) {
+				mutex_enter(&trx_sys->view_mutex);
+				read_view_remove(trx->global_read_view, true);
+				mutex_exit(&trx_sys->view_mutex);
+			}
 		}
 	}
 
@@ -1491,6 +1563,11 @@ trx_commit_in_memory(
 	trx_named_savept_t*	savep = UT_LIST_GET_FIRST(trx->trx_savepoints);
 	trx_roll_savepoints_free(trx, savep);
 
+	if (trx->rseg != NULL) {
+		os_atomic_dec_ulint(
+			&trx->rseg->mutex, &trx->rseg->trx_ref_count, 1);
+	}
+
 	trx->rseg = NULL;
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
@@ -1632,6 +1709,8 @@ trx_cleanup_at_db_startup(
 		trx_undo_insert_cleanup(trx);
 	}
 
+	os_atomic_dec_ulint(&trx->rseg->mutex, &trx->rseg->trx_ref_count, 1);
+
 	trx->rseg = NULL;
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
@@ -2557,6 +2636,8 @@ trx_set_rw_mode(
 
 	mutex_enter(&trx_sys->mutex);
 
+	trx_sys_descr_write_begin();
+
 	ut_ad(trx->id == 0);
 	trx->id = trx_sys_get_new_trx_id();
 
@@ -2577,5 +2658,7 @@ trx_set_rw_mode(
 
 	trx_reserve_descriptor(trx);
 
+	trx_sys_descr_write_end();
+
 	mutex_exit(&trx_sys->mutex);
 }
@@ -0,0 +1,319 @@
+/*****************************************************************************
+
+Copyright (c) 2026, Aliyun and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/********************************************************************//**
+@file ut/ut0lz.cc
+Fast LZ77 compression without entropy coding
+
+The compressed data is a sequence of sequences. Each sequence starts
+with a token byte whose high nibble is the number of literal bytes and
+whose low nibble is the length of the match minus UT_LZ_MIN_MATCH. A
+nibble of 15 is followed by bytes that are added to it, up to and
+including the first byte that is not 255. The literal bytes follow,
+and then the 2-byte big-endian distance of the match. The last sequence
+consists of the token and the literals only; it ends at the end of the
+compressed data. The match finder remembers the last position of each
+hash of 4 bytes, and never looks further.
+
+Created 10/17/2026
+*************************************************************************/
+
+#include "ut0lz.h"
+
+#include <string.h>
+
+/** Minimum length of a match */
+#define UT_LZ_MIN_MATCH		4
+
+/** Maximum distance of a match */
+#define UT_LZ_MAX_DIST		65535
+
+/** Nibble value that is followed by length bytes */
+#define UT_LZ_RUN_MASK		15
+
+/********************************************************************//**
+Reads 4 bytes for the match finder.
+@return the bytes, in native byte order */
+UNIV_INLINE
+ib_uint32_t
+ut_lz_read4(
+/*========*/
+	const byte*	p)	/*!< in: 4 bytes */
+{
+	ib_uint32_t	v;
+	memcpy(&v, p, sizeof v);
+	return(v);
+}
+
+/********************************************************************//**
+Hashes 4 bytes for the match finder.
+@return hash value, less than 1 << UT_LZ_HASH_BITS */
+UNIV_INLINE
+ulint
+ut_lz_hash(
+/*=======*/
+	const byte*	p)	/*!< in: 4 bytes */
+{
+	return((ut_lz_read4(p) * 2654435761U) >> (32 - UT_LZ_HASH_BITS));
+}
+
+/********************************************************************//**
+Writes the bytes that follow a nibble of UT_LZ_RUN_MASK.
+@return end of the written bytes */
+UNIV_INLINE
+byte*
+ut_lz_write_len(
+/*============*/
+	byte*	op,	/*!< out: length bytes */
+	ulint	len)	/*!< in: length minus UT_LZ_RUN_MASK */
+{
+	for (; len >= 255; len -= 255) {
+		*op++ = 255;
+	}
+
+	*op++ = static_cast<byte>(len);
+	return(op);
+}
+
+/********************************************************************//**
+Writes a sequence of literals and a match.
+@return end of the sequence, or NULL if it would not fit */
+static
+byte*
+ut_lz_write_seq(
+/*============*/
+	byte*		op,	/*!< out: sequence */
+	const byte*	op_end,	/*!< in: end of the output buffer */
+	const byte*	lit,	/*!< in: literals */
+	ulint		n_lit,	/*!< in: number of literals */
+	ulint		dist,	/*!< in: distance of the match,
+				or 0 for the last sequence */
+	ulint		len)	/*!< in: length of the match */
+{
+	byte*	token;
+
+	/* The token, the length bytes, the literals and the distance */
+	if (ulint(op_end - op) < 1 + n_lit / 255 + 1 + n_lit
+	    + (dist ? 2 + len / 255 + 1 : 0)) {
+		return(NULL);
+	}
+
+	token = op++;
+
+	if (n_lit >= UT_LZ_RUN_MASK) {
+		*token = UT_LZ_RUN_MASK << 4;
+		op = ut_lz_write_len(op, n_lit - UT_LZ_RUN_MASK);
+	} else {
+		*token = static_cast<byte>(n_lit << 4);
+	}
+
+	memcpy(op, lit, n_lit);
+	op += n_lit;
+
+	if (!dist) {
+		return(op);
+	}
+
+	*op++ = static_cast<byte>(dist >> 8);
+	*op++ = static_cast<byte>(dist);
+
+	len -= UT_LZ_MIN_MATCH;
+
+	if (len >= UT_LZ_RUN_MASK) {
+		*token |= UT_LZ_RUN_MASK;
+		op = ut_lz_write_len(op, len - UT_LZ_RUN_MASK);
+	} else {
+		*token |= static_cast<byte>(len);
+	}
+
+	return(op);
+}
+
+/********************************************************************//**
+Compresses a buffer. The output is a sequence of literal runs and
+back-references of at least 4 bytes into the preceding 64 KiB, with
+no entropy coding: ut_lz_decompress() only copies bytes around.
+@return length of the compressed data, or 0 if it would not fit
+in dst_len bytes */
+UNIV_INTERN
+ulint
+ut_lz_compress(
+/*===========*/
+	const byte*	src,	/*!< in: data to compress */
+	ulint		src_len,/*!< in: length of src, at most
+				UT_LZ_MAX_INPUT */
+	byte*		dst,	/*!< out: compressed data */
+	ulint		dst_len,/*!< in: size of dst */
+	void*		work)	/*!< in/out: work area of
+				UT_LZ_WORK_SIZE bytes */
+{
+	uint16*		hash	= static_cast<uint16*>(work);
+	const byte*	ip	= src;
+	const byte*	anchor	= src;
+	const byte*	end	= src + src_len;
+	byte*		op	= dst;
+	const byte*	op_end	= dst + dst_len;
+
+	if (src_len > UT_LZ_MAX_INPUT) {
+		return(0);
+	}
+
+	memset(hash, 0, UT_LZ_WORK_SIZE);
+
+	while (end - ip >= UT_LZ_MIN_MATCH) {
+		ulint		h	= ut_lz_hash(ip);
+		const byte*	ref	= src + hash[h];
+		const byte*	m;
+
+		hash[h] = static_cast<uint16>(ip - src);
+
+		if (ref >= ip || ip - ref > UT_LZ_MAX_DIST
+		    || ut_lz_read4(ref) != ut_lz_read4(ip)) {
+			/* Skip faster over data that does not compress. */
+			ip += 1 + ((ip - anchor) >> 6);
+			continue;
+		}
+
+		for (m = ip + UT_LZ_MIN_MATCH, ref += UT_LZ_MIN_MATCH;
+		     m < end && *m == *ref; m++, ref++) {
+		}
+
+		op = ut_lz_write_seq(op, op_end, anchor, ip - anchor,
+				     m - ref, m - ip);
+		if (!op) {
+			return(0);
+		}
+
+		ip = anchor = m;
+	}
+
+	op = ut_lz_write_seq(op, op_end, anchor, end - anchor, 0, 0);
+
+	return(op ? op - dst : 0);
+}
+
+/********************************************************************//**
+Reads the bytes that follow a nibble of UT_LZ_RUN_MASK.
+@return end of the length bytes, or NULL if src is corrupted */
+UNIV_INLINE
+const byte*
+ut_lz_read_len(
+/*===========*/
+	const byte*	ip,	/*!< in: length bytes */
+	const byte*	ip_end,	/*!< in: end of the compressed data */
+	ulint*		len)	/*!< in/out: length */
+{
+	ulint	b;
+
+	do {
+		if (ip == ip_end) {
+			return(NULL);
+		}
+
+		b = *ip++;
+		*len += b;
+	} while (b == 255);
+
+	return(ip);
+}
+
+/********************************************************************//**
+Decompresses the output of ut_lz_compress().
+@return length of the decompressed data, or ULINT_UNDEFINED if src
+is corrupted or the data would not fit in dst_len bytes */
+UNIV_INTERN
+ulint
+ut_lz_decompress(
+/*=============*/
+	const byte*	src,	/*!< in: compressed data */
+	ulint		src_len,/*!< in: length of src */
+	byte*		dst,	/*!< out: decompressed data */
+	ulint		dst_len)/*!< in: size of dst */
+{
+	const byte*	ip	= src;
+	const byte*	ip_end	= src + src_len;
+	byte*		op	= dst;
+	const byte*	op_end	= dst + dst_len;
+
+	while (ip < ip_end) {
+		ulint		token	= *ip++;
+		ulint		len	= token >> 4;
+		ulint		dist;
+		const byte*	ref;
+
+		if (len == UT_LZ_RUN_MASK) {
+			ip = ut_lz_read_len(ip, ip_end, &len);
+			if (!ip) {
+				return(ULINT_UNDEFINED);
+			}
+		}
+
+		if (len > ulint(ip_end - ip) || len > ulint(op_end - op)) {
+			return(ULINT_UNDEFINED);
+		}
+
+		memcpy(op, ip, len);
+		op += len;
+		ip += len;
+
+		if (ip == ip_end) {
+			/* The last sequence has no match. */
+			break;
+		}
+
+		if (ip_end - ip < 2) {
+			return(ULINT_UNDEFINED);
+		}
+
+		dist = ulint(ip[0]) << 8 | ip[1];
+		ip += 2;
+
+		if (!dist || dist > ulint(op - dst)) {
+			return(ULINT_UNDEFINED);
+		}
+
+		len = token & UT_LZ_RUN_MASK;
+
+		if (len == UT_LZ_RUN_MASK) {
+			ip = ut_lz_read_len(ip, ip_end, &len);
+			if (!ip) {
+				return(ULINT_UNDEFINED);
+			}
+		}
+
+		len += UT_LZ_MIN_MATCH;
+
+		if (len > ulint(op_end - op)) {
+			return(ULINT_UNDEFINED);
+		}
+
+		ref = op - dist;
+
+		if (dist >= len) {
+			memcpy(op, ref, len);
+			op += len;
+		} else {
+			/* The match overlaps the bytes it produces. */
+			for (byte* end = op + len; op < end; ) {
+				*op++ = *ref++;
+			}
+		}
+	}
+
+	return(op - dst);
+}